@@ -0,0 +1,148 @@
+// hal.h
+// Camada de abstração de hardware usada por rfm95_lora e ssd1306.
+// Backends: hal_pico.c (Pico SDK) e hal_host.c (Linux, dispositivos simulados).
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef HAL_HOST_BUILD
+
+typedef unsigned int uint;
+
+#define HAL_HOST_I2C_DEVICES 4
+
+struct hal_host_device;
+
+// Barramentos simulados (instâncias definidas em hal_host.c)
+typedef struct hal_spi_inst {
+    struct hal_host_device* selected;    // dispositivo com CS em nível baixo
+    uint32_t baudrate;
+} hal_spi_t;
+
+typedef struct hal_i2c_inst {
+    struct hal_host_device* devices[HAL_HOST_I2C_DEVICES];
+    uint8_t addresses[HAL_HOST_I2C_DEVICES];
+    uint8_t count;
+} hal_i2c_t;
+
+extern hal_spi_t hal_host_spi[2];
+extern hal_i2c_t hal_host_i2c[2];
+
+#define spi0 (&hal_host_spi[0])
+#define spi1 (&hal_host_spi[1])
+#define i2c0 (&hal_host_i2c[0])
+#define i2c1 (&hal_host_i2c[1])
+
+#else
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "hardware/i2c.h"
+
+typedef spi_inst_t hal_spi_t;
+typedef i2c_inst_t hal_i2c_t;
+
+#endif // HAL_HOST_BUILD
+
+// Tratador de borda de subida em um pino de entrada
+typedef void (*hal_gpio_irq_handler_t)(uint pin);
+
+// Fim de uma transferência assíncrona (chamado em contexto de interrupção)
+typedef void (*hal_done_callback_t)(void* ctx);
+
+// --- SPI (modo 0, 8 bits, MSB primeiro) ---
+
+// Inicializa o barramento e os pinos; retorna o clock efetivamente configurado
+uint32_t hal_spi_init(hal_spi_t* spi, uint32_t baudrate, uint miso, uint sck, uint mosi);
+
+// Transferência full-duplex; tx == NULL envia zeros, rx == NULL descarta a leitura
+void hal_spi_transfer(hal_spi_t* spi, const uint8_t* tx, uint8_t* rx, size_t len);
+
+// Mesma transferência feita por DMA; retorna imediatamente e chama done ao terminar.
+// Retorna false (sem transferir nada) se não houver DMA disponível no momento.
+bool hal_spi_transfer_async(hal_spi_t* spi, const uint8_t* tx, uint8_t* rx, size_t len,
+                            hal_done_callback_t done, void* ctx);
+
+// --- GPIO ---
+
+void hal_gpio_init_output(uint pin, bool value);
+void hal_gpio_init_input(uint pin);
+void hal_gpio_put(uint pin, bool value);
+bool hal_gpio_get(uint pin);
+
+// Registra o tratador de borda de subida do pino (NULL desativa a interrupção)
+void hal_gpio_set_irq(uint pin, hal_gpio_irq_handler_t handler);
+
+// --- Tempo ---
+
+void hal_sleep_ms(uint32_t ms);
+uint64_t hal_time_us();
+
+// Chamado dentro de laços de espera ativa (no host, avança o relógio simulado)
+void hal_yield();
+
+// Dorme em baixo consumo até a próxima interrupção (alarme ou borda de pino).
+// Chame com as interrupções mascaradas (hal_irq_save) depois de verificar que
+// não há trabalho: uma interrupção que chegue entre o teste e a espera ainda
+// acorda o núcleo e é atendida no hal_irq_restore(). Com uma transferência
+// assíncrona (SPI ou I2C) em andamento, o sono é leve e mantém os clocks
+void hal_low_power_wait();
+
+// Contador livre de ciclos do núcleo chamador, para medir trechos curtos.
+// Pode dar a volta antes de 32 bits: use hal_cycles_since() para a diferença
+uint32_t hal_cycles();
+
+// Ciclos decorridos desde start (obtido com hal_cycles() no mesmo núcleo)
+uint32_t hal_cycles_since(uint32_t start);
+
+// --- Alarmes (disparo único, um por contexto) ---
+
+// Alarmes pendentes ao mesmo tempo (ex: um por rádio)
+#ifndef HAL_ALARM_COUNT
+#define HAL_ALARM_COUNT 4
+#endif
+
+// Chama done(ctx) (em contexto de interrupção, no núcleo chamador) daqui a
+// delay_us; substitui o alarme anterior do mesmo ctx se ele ainda não disparou.
+// Sem alarme livre a chamada é ignorada
+void hal_alarm_start(uint32_t delay_us, hal_done_callback_t done, void* ctx);
+
+// Cancela o alarme pendente de ctx (sem efeito se ele já disparou)
+void hal_alarm_cancel(void* ctx);
+
+// --- Seções críticas (mascaram os tratadores de GPIO) ---
+
+uint32_t hal_irq_save();
+void hal_irq_restore(uint32_t state);
+
+// --- Multinúcleo ---
+
+// Executa entry no núcleo 1; false se a plataforma não tiver segundo núcleo
+bool hal_core1_launch(void (*entry)(void));
+
+// Núcleo que executa o código chamador (0 ou 1)
+uint hal_core_num();
+
+// Acorda o outro núcleo (FIFO entre núcleos); não bloqueia
+void hal_core_notify();
+
+// Dorme até o outro núcleo chamar hal_core_notify()
+void hal_core_wait();
+
+// Garante a ordem das escritas em memória compartilhada vistas pelo outro núcleo
+void hal_memory_barrier();
+
+// --- I2C ---
+
+// Escrita com condição de parada; retorna o número de bytes escritos ou < 0 em erro
+int hal_i2c_write(hal_i2c_t* i2c, uint8_t address, const uint8_t* data, size_t len);
+
+// Mesma escrita feita por DMA; data deve continuar válido até done ser chamado.
+// Retorna false (sem transferir nada) se não houver DMA disponível no momento.
+bool hal_i2c_write_async(hal_i2c_t* i2c, uint8_t address, const uint8_t* data, size_t len,
+                         hal_done_callback_t done, void* ctx);
+
+#endif // HAL_H
@@ -0,0 +1,422 @@
+// hal_host.c - Backend da HAL para Linux com relógio e dispositivos simulados
+#include "hal_host.h"
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+
+hal_spi_t hal_host_spi[2];
+hal_i2c_t hal_host_i2c[2];
+
+// Estado de cada pino virtual
+static struct {
+    bool level;
+    bool pending;                      // borda de subida aguardando despacho
+    hal_gpio_irq_handler_t handler;
+    hal_host_device_t* device;         // recebe pin_changed
+    hal_spi_t* cs_bus;                 // barramento do qual o pino é CS
+    hal_host_device_t* cs_device;
+} pins[HAL_HOST_GPIO_COUNT];
+
+static hal_host_device_t* devices;
+
+// "Controlador DMA": move os bytes na hora e sinaliza o fim após o tempo de barramento
+typedef struct {
+    hal_host_device_t dev;
+    bool attached;
+    bool busy;
+    hal_done_callback_t done;
+    void* ctx;
+} hal_host_dma_t;
+
+static hal_host_dma_t spi_dma;
+static hal_host_dma_t i2c_dma;
+static uint32_t i2c_dma_refusals;      // próximas escritas I2C por DMA recusadas
+
+// Alarmes da HAL: vencem pelo relógio simulado e, como os pinos, respeitam hal_irq_save()
+typedef struct {
+    hal_host_device_t dev;
+    bool attached;
+    bool armed;                        // ocupado por ctx (agendado ou vencido)
+    bool pending;                      // vencido, aguardando despacho
+    hal_done_callback_t done;
+    void* ctx;
+} hal_host_alarm_t;
+
+static hal_host_alarm_t alarms[HAL_ALARM_COUNT];
+
+static uint64_t now_us;
+static uint32_t irq_depth;
+static hal_host_stats_t stats;
+
+// Fila de bordas pendentes (cada pino entra no máximo uma vez)
+static uint pending_queue[HAL_HOST_GPIO_COUNT];
+static uint pending_head, pending_count;
+
+/* Executa os tratadores das bordas e do alarme pendentes, se as interrupções estão liberadas */
+static void hal_host_dispatch() {
+    while (irq_depth == 0 && pending_count > 0) {
+        uint pin = pending_queue[pending_head];
+        pending_head = (pending_head + 1) % HAL_HOST_GPIO_COUNT;
+        pending_count--;
+        pins[pin].pending = false;
+        if (pins[pin].handler) {
+            pins[pin].handler(pin);
+        }
+    }
+    for (int i = 0; i < HAL_ALARM_COUNT && irq_depth == 0; i++) {
+        hal_host_alarm_t* alarm = &alarms[i];
+        if (!alarm->pending) continue;
+        alarm->pending = false;
+        alarm->armed = false;                            // o callback pode reagendar
+        if (alarm->done) {
+            alarm->done(alarm->ctx);
+        }
+    }
+}
+
+static void hal_host_alarm_advance(void* ctx, uint64_t now) {
+    (void)now;
+    hal_host_alarm_t* alarm = ctx;
+    alarm->pending = true;
+}
+
+/* Alarme ocupado por ctx ou, se allocate, um livre; NULL se não houver */
+static hal_host_alarm_t* hal_host_alarm_find(void* ctx, bool allocate) {
+    hal_host_alarm_t* free_alarm = NULL;
+    for (int i = 0; i < HAL_ALARM_COUNT; i++) {
+        if (alarms[i].armed && alarms[i].ctx == ctx) return &alarms[i];
+        if (!alarms[i].armed && !free_alarm) free_alarm = &alarms[i];
+    }
+    return allocate ? free_alarm : NULL;
+}
+
+/* true se algum alarme venceu e espera o despacho */
+static bool hal_host_alarm_pending() {
+    for (int i = 0; i < HAL_ALARM_COUNT; i++) {
+        if (alarms[i].pending) return true;
+    }
+    return false;
+}
+
+/* Tempo (ns) para deslocar len bytes no clock configurado */
+static uint64_t hal_host_spi_ns(const hal_spi_t* spi, size_t len) {
+    return spi->baudrate ? (uint64_t)len * 8 * 1000000000ull / spi->baudrate : 0;
+}
+
+static void hal_host_dma_advance(void* ctx, uint64_t now) {
+    (void)now;
+    hal_host_dma_t* dma = ctx;
+    dma->busy = false;
+    if (dma->done) {
+        dma->done(dma->ctx);
+    }
+}
+
+/* Ocupa o canal e agenda o fim da transferência para daqui a duration_us */
+static void hal_host_dma_start(hal_host_dma_t* dma, uint64_t duration_us,
+                               hal_done_callback_t done, void* ctx) {
+    if (!dma->attached) {
+        dma->dev.ctx = dma;
+        dma->dev.advance = hal_host_dma_advance;
+        hal_host_attach(&dma->dev);
+        dma->attached = true;
+    }
+    dma->busy = true;
+    dma->done = done;
+    dma->ctx  = ctx;
+    hal_host_schedule(&dma->dev, now_us + duration_us);
+}
+
+static uint64_t hal_host_next_event() {
+    uint64_t next = HAL_HOST_NO_EVENT;
+    for (hal_host_device_t* dev = devices; dev; dev = dev->next) {
+        if (dev->next_event_us < next) next = dev->next_event_us;
+    }
+    return next;
+}
+
+// ============================================================================
+// Interface dos dispositivos simulados
+// ============================================================================
+
+void hal_host_reset() {
+    memset(pins, 0, sizeof(pins));
+    memset(hal_host_spi, 0, sizeof(hal_host_spi));
+    memset(hal_host_i2c, 0, sizeof(hal_host_i2c));
+    memset(&stats, 0, sizeof(stats));
+    devices = NULL;
+    memset(&spi_dma, 0, sizeof(spi_dma));
+    memset(&i2c_dma, 0, sizeof(i2c_dma));
+    i2c_dma_refusals = 0;
+    memset(alarms, 0, sizeof(alarms));
+    now_us = 0;
+    irq_depth = 0;
+    pending_head = 0;
+    pending_count = 0;
+}
+
+void hal_host_i2c_dma_refuse(uint32_t count) {
+    i2c_dma_refusals = count;
+}
+
+void hal_host_attach(hal_host_device_t* dev) {
+    dev->next_event_us = HAL_HOST_NO_EVENT;
+    dev->next = devices;
+    devices = dev;
+}
+
+void hal_host_bind_pin(uint pin, hal_host_device_t* dev) {
+    if (pin < HAL_HOST_GPIO_COUNT) pins[pin].device = dev;
+}
+
+void hal_host_bind_spi(hal_spi_t* spi, uint cs_pin, hal_host_device_t* dev) {
+    if (cs_pin >= HAL_HOST_GPIO_COUNT) return;
+    pins[cs_pin].cs_bus = spi;
+    pins[cs_pin].cs_device = dev;
+    pins[cs_pin].device = dev;
+}
+
+void hal_host_bind_i2c(hal_i2c_t* i2c, uint8_t address, hal_host_device_t* dev) {
+    if (i2c->count >= HAL_HOST_I2C_DEVICES) return;
+    i2c->addresses[i2c->count] = address;
+    i2c->devices[i2c->count] = dev;
+    i2c->count++;
+}
+
+void hal_host_drive_pin(uint pin, bool level) {
+    if (pin >= HAL_HOST_GPIO_COUNT) return;
+    bool rising = level && !pins[pin].level;
+    pins[pin].level = level;
+    if (rising && pins[pin].handler && !pins[pin].pending) {
+        pins[pin].pending = true;
+        pending_queue[(pending_head + pending_count) % HAL_HOST_GPIO_COUNT] = pin;
+        pending_count++;
+    }
+}
+
+void hal_host_schedule(hal_host_device_t* dev, uint64_t when_us) {
+    dev->next_event_us = when_us;
+}
+
+void hal_host_advance_us(uint64_t us) {
+    uint64_t target = now_us + us;
+    hal_host_dispatch();
+
+    for (;;) {
+        uint64_t next = hal_host_next_event();
+        if (next > target) break;
+        if (next > now_us) now_us = next;
+
+        for (hal_host_device_t* dev = devices; dev; dev = dev->next) {
+            if (dev->next_event_us <= now_us) {
+                dev->next_event_us = HAL_HOST_NO_EVENT;
+                dev->advance(dev->ctx, now_us);
+            }
+        }
+        hal_host_dispatch();
+    }
+    now_us = target;
+}
+
+const hal_host_stats_t* hal_host_stats() {
+    return &stats;
+}
+
+void hal_host_stats_reset() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+// ============================================================================
+// Implementação da HAL
+// ============================================================================
+
+uint32_t hal_spi_init(hal_spi_t* spi, uint32_t baudrate, uint miso, uint sck, uint mosi) {
+    (void)miso; (void)sck; (void)mosi;
+    spi->baudrate = baudrate;
+    return baudrate;
+}
+
+void hal_spi_transfer(hal_spi_t* spi, const uint8_t* tx, uint8_t* rx, size_t len) {
+    stats.spi_bytes += len;
+    stats.spi_blocking_ns += hal_host_spi_ns(spi, len);
+    hal_host_device_t* dev = spi->selected;
+    if (dev && dev->spi_transfer) {
+        dev->spi_transfer(dev->ctx, tx, rx, len);
+    } else if (rx) {
+        memset(rx, 0xFF, len);           // MISO flutuando
+    }
+}
+
+bool hal_spi_transfer_async(hal_spi_t* spi, const uint8_t* tx, uint8_t* rx, size_t len,
+                            hal_done_callback_t done, void* ctx) {
+    if (spi_dma.busy) return false;
+
+    uint64_t bus_ns = hal_host_spi_ns(spi, len);
+    hal_spi_transfer(spi, tx, rx, len);
+    stats.spi_blocking_ns -= bus_ns;
+    stats.spi_dma_ns += bus_ns;
+
+    hal_host_dma_start(&spi_dma, (bus_ns + 999) / 1000, done, ctx);
+    return true;
+}
+
+void hal_gpio_init_output(uint pin, bool value) {
+    if (pin >= HAL_HOST_GPIO_COUNT) return;
+    pins[pin].level = !value;
+    hal_gpio_put(pin, value);
+}
+
+void hal_gpio_init_input(uint pin) {
+    (void)pin;
+}
+
+void hal_gpio_put(uint pin, bool value) {
+    if (pin >= HAL_HOST_GPIO_COUNT || pins[pin].level == value) return;
+    pins[pin].level = value;
+
+    hal_spi_t* bus = pins[pin].cs_bus;
+    if (bus) {
+        if (!value) {
+            bus->selected = pins[pin].cs_device;
+            stats.spi_transactions++;
+        } else if (bus->selected == pins[pin].cs_device) {
+            bus->selected = NULL;
+        }
+    }
+    hal_host_device_t* dev = pins[pin].device;
+    if (dev && dev->pin_changed) {
+        dev->pin_changed(dev->ctx, pin, value);
+    }
+}
+
+bool hal_gpio_get(uint pin) {
+    return pin < HAL_HOST_GPIO_COUNT && pins[pin].level;
+}
+
+void hal_gpio_set_irq(uint pin, hal_gpio_irq_handler_t handler) {
+    if (pin < HAL_HOST_GPIO_COUNT) pins[pin].handler = handler;
+}
+
+void hal_sleep_ms(uint32_t ms) {
+    hal_host_advance_us((uint64_t)ms * 1000);
+}
+
+uint64_t hal_time_us() {
+    return now_us;
+}
+
+void hal_yield() {
+    uint64_t next = hal_host_next_event();
+    uint64_t step = HAL_HOST_YIELD_US;
+    if (next != HAL_HOST_NO_EVENT && next < now_us + step) {
+        step = next > now_us ? next - now_us : 0;
+    }
+    hal_host_advance_us(step);
+}
+
+void hal_low_power_wait() {
+    if (pending_count > 0 || hal_host_alarm_pending()) return;   // já há o que atender
+    if (spi_dma.busy || i2c_dma.busy) {
+        stats.light_sleeps++;                            // como no Pico, sem cortar clocks
+    } else {
+        stats.deep_sleeps++;
+    }
+    uint64_t next = hal_host_next_event();
+    if (next == HAL_HOST_NO_EVENT) {
+        hal_host_advance_us(HAL_HOST_YIELD_US);          // nada agendado: só o relógio anda
+    } else {
+        hal_host_advance_us(next > now_us ? next - now_us : 0);
+    }
+}
+
+// No host os "ciclos" são nanossegundos reais (não simulados) do processo
+uint32_t hal_cycles() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+uint32_t hal_cycles_since(uint32_t start) {
+    return hal_cycles() - start;
+}
+
+// O host simula um único núcleo: o modo multinúcleo não é iniciado
+bool hal_core1_launch(void (*entry)(void)) {
+    (void)entry;
+    return false;
+}
+
+uint hal_core_num() {
+    return 0;
+}
+
+void hal_core_notify() {
+}
+
+void hal_core_wait() {
+    hal_yield();
+}
+
+void hal_memory_barrier() {
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+void hal_alarm_start(uint32_t delay_us, hal_done_callback_t done, void* ctx) {
+    hal_host_alarm_t* alarm = hal_host_alarm_find(ctx, true);
+    if (!alarm) return;
+    if (!alarm->attached) {
+        alarm->dev.ctx = alarm;
+        alarm->dev.advance = hal_host_alarm_advance;
+        hal_host_attach(&alarm->dev);
+        alarm->attached = true;
+    }
+    alarm->armed = true;
+    alarm->pending = false;
+    alarm->done = done;
+    alarm->ctx  = ctx;
+    hal_host_schedule(&alarm->dev, now_us + delay_us);
+}
+
+void hal_alarm_cancel(void* ctx) {
+    hal_host_alarm_t* alarm = hal_host_alarm_find(ctx, false);
+    if (!alarm) return;
+    alarm->armed = false;
+    alarm->pending = false;
+    hal_host_schedule(&alarm->dev, HAL_HOST_NO_EVENT);
+}
+
+uint32_t hal_irq_save() {
+    return irq_depth++;
+}
+
+void hal_irq_restore(uint32_t state) {
+    irq_depth = state;
+    hal_host_dispatch();
+}
+
+int hal_i2c_write(hal_i2c_t* i2c, uint8_t address, const uint8_t* data, size_t len) {
+    for (uint8_t i = 0; i < i2c->count; i++) {
+        hal_host_device_t* dev = i2c->devices[i];
+        if (i2c->addresses[i] == address && dev->i2c_write) {
+            stats.i2c_transactions++;
+            stats.i2c_bytes += len;
+            return dev->i2c_write(dev->ctx, data, len);
+        }
+    }
+    return -1;                           // sem ACK no endereço
+}
+
+bool hal_i2c_write_async(hal_i2c_t* i2c, uint8_t address, const uint8_t* data, size_t len,
+                         hal_done_callback_t done, void* ctx) {
+    if (i2c_dma.busy) return false;
+    if (i2c_dma_refusals > 0) {
+        i2c_dma_refusals--;
+        return false;
+    }
+    hal_i2c_write(i2c, address, data, len);
+
+    // Endereço + dados, 9 bits cada (8 + ACK)
+    uint64_t bus_us = ((uint64_t)(len + 1) * 9 * 1000000 + HAL_HOST_I2C_HZ - 1) / HAL_HOST_I2C_HZ;
+    hal_host_dma_start(&i2c_dma, bus_us, done, ctx);
+    return true;
+}
@@ -0,0 +1,81 @@
+// hal_host.h
+// Lado "dispositivo" do backend Linux da HAL: os simuladores (sim/) se ligam
+// aos pinos e barramentos virtuais e são avançados pelo relógio simulado.
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include "hal.h"
+
+#ifndef HAL_HOST_GPIO_COUNT
+#define HAL_HOST_GPIO_COUNT 256
+#endif
+
+#define HAL_HOST_NO_EVENT  UINT64_MAX
+
+// Passo máximo do relógio simulado em cada hal_yield()
+#define HAL_HOST_YIELD_US  1000
+
+// Clock dos barramentos I2C simulados (usado para temporizar as escritas por DMA)
+#define HAL_HOST_I2C_HZ    400000
+
+// Dispositivo simulado; os callbacks não usados podem ser NULL
+typedef struct hal_host_device {
+    void* ctx;
+    // O MCU mudou o nível de um pino ligado ao dispositivo
+    void (*pin_changed)(void* ctx, uint pin, bool level);
+    // Bytes trocados enquanto o CS do dispositivo está em nível baixo
+    void (*spi_transfer)(void* ctx, const uint8_t* tx, uint8_t* rx, size_t len);
+    // Escrita I2C endereçada ao dispositivo; retorna bytes aceitos ou < 0
+    int (*i2c_write)(void* ctx, const uint8_t* data, size_t len);
+    // Processa os eventos vencidos; deve reagendar com hal_host_schedule()
+    void (*advance)(void* ctx, uint64_t now_us);
+
+    uint64_t next_event_us;
+    struct hal_host_device* next;
+} hal_host_device_t;
+
+// Tráfego observado nos barramentos desde o último reset
+typedef struct {
+    uint32_t spi_transactions;   // ciclos de CS
+    uint32_t spi_bytes;
+    uint64_t spi_blocking_ns;    // tempo de barramento com a CPU presa na transferência
+    uint64_t spi_dma_ns;         // tempo de barramento coberto por DMA
+    uint32_t i2c_transactions;
+    uint32_t i2c_bytes;
+    uint32_t deep_sleeps;        // hal_low_power_wait() sem transferência assíncrona
+    uint32_t light_sleeps;       // com DMA de SPI ou I2C em andamento (clocks ligados)
+} hal_host_stats_t;
+
+// Zera relógio, pinos, barramentos, dispositivos e estatísticas
+void hal_host_reset();
+
+// Registra o dispositivo no relógio simulado
+void hal_host_attach(hal_host_device_t* dev);
+
+// Liga um pino de saída do MCU ao dispositivo (RST, por exemplo)
+void hal_host_bind_pin(uint pin, hal_host_device_t* dev);
+
+// Liga o dispositivo ao barramento SPI, selecionado pelo pino cs_pin
+void hal_host_bind_spi(hal_spi_t* spi, uint cs_pin, hal_host_device_t* dev);
+
+// Liga o dispositivo ao barramento I2C no endereço indicado
+void hal_host_bind_i2c(hal_i2c_t* i2c, uint8_t address, hal_host_device_t* dev);
+
+// As próximas count chamadas de hal_i2c_write_async() falham como se o canal
+// DMA estivesse com outro driver (testa os caminhos sem DMA)
+void hal_host_i2c_dma_refuse(uint32_t count);
+
+// O dispositivo aciona um pino de entrada do MCU (DIOx); bordas de subida
+// disparam o tratador registrado com hal_gpio_set_irq()
+void hal_host_drive_pin(uint pin, bool level);
+
+// Agenda o próximo evento do dispositivo (HAL_HOST_NO_EVENT cancela)
+void hal_host_schedule(hal_host_device_t* dev, uint64_t when_us);
+
+// Avança o relógio simulado, processando eventos e interrupções no caminho
+void hal_host_advance_us(uint64_t us);
+
+const hal_host_stats_t* hal_host_stats();
+void hal_host_stats_reset();
+
+#endif // HAL_HOST_H
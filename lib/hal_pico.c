@@ -0,0 +1,367 @@
+// hal_pico.c - Backend da HAL sobre o Pico SDK
+#include "hal.h"
+#include "hardware/sync.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/structs/systick.h"
+#include "hardware/structs/scb.h"
+#include "hardware/clocks.h"
+#include "pico/multicore.h"
+
+#define HAL_PICO_GPIO_COUNT 30
+
+// Maior escrita I2C por DMA (um frame completo do SSD1306 mais folga)
+#define HAL_PICO_I2C_DMA_MAX 1040
+
+// O SDK aceita um único callback de GPIO por núcleo; a HAL despacha por pino
+static hal_gpio_irq_handler_t irq_handlers[HAL_PICO_GPIO_COUNT];
+
+// Par de canais DMA (TX/RX) usado pelas transferências SPI assíncronas
+static struct {
+    int tx_chan;
+    int rx_chan;
+    volatile bool busy;
+    hal_done_callback_t done;
+    void* ctx;
+} spi_dma = { -1, -1, false, NULL, NULL };
+
+// Escrita I2C por DMA: o periférico exige palavras de 16 bits em IC_DATA_CMD
+// (bit 9 = STOP), então os bytes são copiados para uma área de preparação
+static struct {
+    int chan;
+    i2c_inst_t* i2c;
+    volatile bool busy;
+    hal_done_callback_t done;
+    void* ctx;
+    uint16_t words[HAL_PICO_I2C_DMA_MAX];
+} i2c_dma = { .chan = -1 };
+
+// Timers do pool de alarmes criado para o núcleo 1
+#define HAL_PICO_CORE1_ALARMS HAL_ALARM_COUNT
+
+// Alarmes da HAL, um por contexto; o núcleo 1 ganha um pool próprio (criado ao
+// ser lançado, fora de contexto de interrupção) para os callbacks rodarem nele
+typedef struct {
+    bool armed;                  // ocupado por ctx
+    alarm_pool_t* pool;          // pool do alarme pendente
+    alarm_id_t id;               // 0 quando não há alarme pendente
+    hal_done_callback_t done;
+    void* ctx;
+} hal_pico_alarm_t;
+
+static struct {
+    alarm_pool_t* pools[2];      // por núcleo
+    hal_pico_alarm_t slots[HAL_ALARM_COUNT];
+} alarm;
+
+static void hal_gpio_dispatch(uint gpio, uint32_t events) {
+    if ((events & GPIO_IRQ_EDGE_RISE) && gpio < HAL_PICO_GPIO_COUNT && irq_handlers[gpio]) {
+        irq_handlers[gpio](gpio);
+    }
+}
+
+uint32_t hal_spi_init(hal_spi_t* spi, uint32_t baudrate, uint miso, uint sck, uint mosi) {
+    uint32_t actual = spi_init(spi, baudrate);
+    gpio_set_function(miso, GPIO_FUNC_SPI);
+    gpio_set_function(sck,  GPIO_FUNC_SPI);
+    gpio_set_function(mosi, GPIO_FUNC_SPI);
+    spi_set_format(spi, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+    return actual;
+}
+
+void hal_spi_transfer(hal_spi_t* spi, const uint8_t* tx, uint8_t* rx, size_t len) {
+    if (tx && rx) {
+        spi_write_read_blocking(spi, tx, rx, len);
+    } else if (tx) {
+        spi_write_blocking(spi, tx, len);
+    } else {
+        spi_read_blocking(spi, 0, rx, len);
+    }
+}
+
+/* Fim do canal RX: todos os bytes já foram deslocados no barramento */
+static void hal_spi_dma_irq() {
+    if (!dma_channel_get_irq0_status(spi_dma.rx_chan)) return;
+    dma_channel_acknowledge_irq0(spi_dma.rx_chan);
+    spi_dma.busy = false;
+    if (spi_dma.done) {
+        spi_dma.done(spi_dma.ctx);
+    }
+}
+
+/* Reserva os canais na primeira utilização */
+static bool hal_spi_dma_claim() {
+    if (spi_dma.rx_chan >= 0) return true;
+    int tx_chan = dma_claim_unused_channel(false);
+    int rx_chan = dma_claim_unused_channel(false);
+    if (tx_chan < 0 || rx_chan < 0) {
+        if (tx_chan >= 0) dma_channel_unclaim(tx_chan);
+        if (rx_chan >= 0) dma_channel_unclaim(rx_chan);
+        return false;
+    }
+    spi_dma.tx_chan = tx_chan;
+    spi_dma.rx_chan = rx_chan;
+    dma_channel_set_irq0_enabled(rx_chan, true);
+    irq_add_shared_handler(DMA_IRQ_0, hal_spi_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+    return true;
+}
+
+bool hal_spi_transfer_async(hal_spi_t* spi, const uint8_t* tx, uint8_t* rx, size_t len,
+                            hal_done_callback_t done, void* ctx) {
+    static uint8_t dummy_tx = 0;
+    static uint8_t dummy_rx;
+    if (spi_dma.busy || !hal_spi_dma_claim()) return false;
+
+    dma_channel_config c = dma_channel_get_default_config(spi_dma.tx_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(spi, true));
+    channel_config_set_read_increment(&c, tx != NULL);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(spi_dma.tx_chan, &c, &spi_get_hw(spi)->dr, tx ? tx : &dummy_tx, len, false);
+
+    c = dma_channel_get_default_config(spi_dma.rx_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, spi_get_dreq(spi, false));
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, rx != NULL);
+    dma_channel_configure(spi_dma.rx_chan, &c, rx ? rx : &dummy_rx, &spi_get_hw(spi)->dr, len, false);
+
+    spi_dma.done = done;
+    spi_dma.ctx  = ctx;
+    spi_dma.busy = true;
+    dma_start_channel_mask((1u << spi_dma.tx_chan) | (1u << spi_dma.rx_chan));
+    return true;
+}
+
+void hal_gpio_init_output(uint pin, bool value) {
+    gpio_init(pin);
+    gpio_set_dir(pin, GPIO_OUT);
+    gpio_put(pin, value);
+}
+
+void hal_gpio_init_input(uint pin) {
+    gpio_init(pin);
+    gpio_set_dir(pin, GPIO_IN);
+}
+
+void hal_gpio_put(uint pin, bool value) {
+    gpio_put(pin, value);
+}
+
+bool hal_gpio_get(uint pin) {
+    return gpio_get(pin);
+}
+
+void hal_gpio_set_irq(uint pin, hal_gpio_irq_handler_t handler) {
+    if (pin >= HAL_PICO_GPIO_COUNT) return;
+    irq_handlers[pin] = handler;
+    gpio_set_irq_enabled_with_callback(pin, GPIO_IRQ_EDGE_RISE, handler != NULL, &hal_gpio_dispatch);
+}
+
+void hal_sleep_ms(uint32_t ms) {
+    sleep_ms(ms);
+}
+
+uint64_t hal_time_us() {
+    return time_us_64();
+}
+
+void hal_yield() {
+    tight_loop_contents();
+}
+
+/* Sono profundo com clk_sys cortado de tudo exceto o timer (alarmes), o banco
+   de GPIO (DIOs) e o controlador USB (stdio). O modo dormant pararia também o
+   timer, que precisa acordar o MCU entre as janelas de recepção. Com um DMA de
+   SPI ou I2C em andamento o corte pararia o DMA e o barramento no meio da
+   transferência: aí o núcleo só espera a interrupção, com todos os clocks */
+void hal_low_power_wait() {
+    if (spi_dma.busy || i2c_dma.busy) {
+        __wfi();
+        return;
+    }
+    clocks_hw->sleep_en0 = CLOCKS_SLEEP_EN0_CLK_SYS_IO_BITS | CLOCKS_SLEEP_EN0_CLK_SYS_PADS_BITS;
+    clocks_hw->sleep_en1 = CLOCKS_SLEEP_EN1_CLK_SYS_TIMER_BITS | CLOCKS_SLEEP_EN1_CLK_SYS_USBCTRL_BITS |
+                           CLOCKS_SLEEP_EN1_CLK_USB_USBCTRL_BITS;
+    scb_hw->scr |= M0PLUS_SCR_SLEEPDEEP_BITS;
+    __wfi();                                             // acorda mesmo com PRIMASK ligado
+    scb_hw->scr &= ~M0PLUS_SCR_SLEEPDEEP_BITS;
+    clocks_hw->sleep_en0 = ~0u;
+    clocks_hw->sleep_en1 = ~0u;
+}
+
+// SysTick: contador decrescente de 24 bits no clock do núcleo (um por núcleo)
+#define HAL_PICO_SYSTICK_MASK 0x00FFFFFF
+
+uint32_t hal_cycles() {
+    if (!(systick_hw->csr & M0PLUS_SYST_CSR_ENABLE_BITS)) {
+        systick_hw->rvr = HAL_PICO_SYSTICK_MASK;
+        systick_hw->cvr = 0;
+        systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+    }
+    return HAL_PICO_SYSTICK_MASK - systick_hw->cvr;     // crescente, como no host
+}
+
+uint32_t hal_cycles_since(uint32_t start) {
+    return (hal_cycles() - start) & HAL_PICO_SYSTICK_MASK;
+}
+
+static void (*core1_entry)(void);
+
+static void hal_core1_trampoline() {
+    alarm.pools[1] = alarm_pool_create_with_unused_hardware_alarm(HAL_PICO_CORE1_ALARMS);
+    core1_entry();
+}
+
+bool hal_core1_launch(void (*entry)(void)) {
+    core1_entry = entry;
+    multicore_launch_core1(hal_core1_trampoline);
+    return true;
+}
+
+uint hal_core_num() {
+    return get_core_num();
+}
+
+void hal_core_notify() {
+    // Com a FIFO cheia o outro núcleo já tem sinais pendentes para processar
+    if (multicore_fifo_wready()) {
+        multicore_fifo_push_blocking(0);
+    }
+}
+
+void hal_core_wait() {
+    (void)multicore_fifo_pop_blocking();
+}
+
+void hal_memory_barrier() {
+    __dmb();
+}
+
+static int64_t hal_alarm_fired(alarm_id_t id, void* user_data) {
+    (void)id;
+    hal_pico_alarm_t* slot = user_data;
+    slot->id = 0;
+    slot->armed = false;                                 // o callback pode reagendar
+    if (slot->done) {
+        slot->done(slot->ctx);
+    }
+    return 0;                                            // não repete
+}
+
+/* Alarme ocupado por ctx ou, se allocate, um livre; NULL se não houver */
+static hal_pico_alarm_t* hal_alarm_find(void* ctx, bool allocate) {
+    hal_pico_alarm_t* free_slot = NULL;
+    for (int i = 0; i < HAL_ALARM_COUNT; i++) {
+        hal_pico_alarm_t* slot = &alarm.slots[i];
+        if (slot->armed && slot->ctx == ctx) return slot;
+        if (!slot->armed && !free_slot) free_slot = slot;
+    }
+    return allocate ? free_slot : NULL;
+}
+
+void hal_alarm_start(uint32_t delay_us, hal_done_callback_t done, void* ctx) {
+    uint core = get_core_num();
+    if (!alarm.pools[core]) {
+        alarm.pools[core] = alarm_pool_get_default();
+    }
+    hal_alarm_cancel(ctx);
+    hal_pico_alarm_t* slot = hal_alarm_find(ctx, true);
+    if (!slot) return;
+    slot->armed = true;
+    slot->done = done;
+    slot->ctx  = ctx;
+    slot->pool = alarm.pools[core];
+    alarm_id_t id = alarm_pool_add_alarm_in_us(slot->pool, delay_us, hal_alarm_fired, slot, true);
+    if (id > 0) {
+        slot->id = id;
+    } else if (id < 0) {
+        slot->armed = false;                             // pool sem espaço
+    }                                                    // 0: já disparou dentro da chamada
+}
+
+void hal_alarm_cancel(void* ctx) {
+    hal_pico_alarm_t* slot = hal_alarm_find(ctx, false);
+    if (!slot) return;
+    if (slot->id > 0) {
+        alarm_pool_cancel_alarm(slot->pool, slot->id);
+        slot->id = 0;
+    }
+    slot->armed = false;
+}
+
+uint32_t hal_irq_save() {
+    return save_and_disable_interrupts();
+}
+
+void hal_irq_restore(uint32_t state) {
+    restore_interrupts(state);
+}
+
+int hal_i2c_write(hal_i2c_t* i2c, uint8_t address, const uint8_t* data, size_t len) {
+    return i2c_write_blocking(i2c, address, data, len, false);
+}
+
+/* STOP_DET: o último byte (e a condição de parada) já saiu no barramento */
+static void hal_i2c_dma_irq() {
+    if (!i2c_dma.busy) return;
+    i2c_hw_t* hw = i2c_get_hw(i2c_dma.i2c);
+    if (!(hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_STOP_DET_BITS)) return;
+    (void)hw->clr_stop_det;
+    hw->intr_mask = 0;
+    i2c_dma.busy = false;
+    if (i2c_dma.done) {
+        i2c_dma.done(i2c_dma.ctx);
+    }
+}
+
+/* Reserva o canal e instala o tratador das duas controladoras na primeira
+   utilização; depois cada escrita só liga a máscara de STOP_DET */
+static bool hal_i2c_dma_claim() {
+    if (i2c_dma.chan >= 0) return true;
+    int chan = dma_claim_unused_channel(false);
+    if (chan < 0) return false;
+    i2c_inst_t* const ports[] = { i2c0, i2c1 };
+    for (uint n = 0; n < 2; n++) {
+        i2c_get_hw(ports[n])->intr_mask = 0;
+        irq_set_exclusive_handler(I2C0_IRQ + i2c_hw_index(ports[n]), hal_i2c_dma_irq);
+        irq_set_enabled(I2C0_IRQ + i2c_hw_index(ports[n]), true);
+    }
+    i2c_dma.chan = chan;
+    return true;
+}
+
+bool hal_i2c_write_async(hal_i2c_t* i2c, uint8_t address, const uint8_t* data, size_t len,
+                         hal_done_callback_t done, void* ctx) {
+    if (i2c_dma.busy || len == 0 || len > HAL_PICO_I2C_DMA_MAX) return false;
+    if (!hal_i2c_dma_claim()) return false;
+
+    // Escritas de 8 bits no APB são replicadas nos 4 bytes e ligariam os bits
+    // CMD/STOP/RESTART de IC_DATA_CMD: o DMA precisa de palavras de 16 bits
+    for (size_t i = 0; i < len; i++) {
+        i2c_dma.words[i] = data[i];
+    }
+    i2c_dma.words[len - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+    i2c_hw_t* hw = i2c_get_hw(i2c);
+    hw->enable = 0;
+    hw->tar = address;
+    hw->enable = 1;
+    (void)hw->clr_stop_det;
+    hw->dma_cr = I2C_IC_DMA_CR_TDMAE_BITS;
+
+    i2c_dma.i2c  = i2c;
+    i2c_dma.done = done;
+    i2c_dma.ctx  = ctx;
+    i2c_dma.busy = true;
+    hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS;
+
+    dma_channel_config c = dma_channel_get_default_config(i2c_dma.chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_dreq(&c, i2c_get_dreq(i2c, true));
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    dma_channel_configure(i2c_dma.chan, &c, &hw->data_cmd, i2c_dma.words, len, true);
+    return true;
+}
@@ -0,0 +1,423 @@
+#include "lora_adr.h"
+#include <string.h>
+
+// ============================================================================
+// Funções Privadas
+// ============================================================================
+
+/* SNR mínimo de demodulação do SF7 ao SF12 (datasheet do SX1276, tabela 13) */
+static const float adr_required_snr[] = { -7.5f, -10.0f, -12.5f, -15.0f, -17.5f, -20.0f };
+
+static bool adr_valid_config(const lora_adr_config_t* config) {
+    return config->min_sf >= 7 && config->max_sf <= 12 && config->min_sf <= config->max_sf &&
+           config->min_power >= 2 && config->max_power <= 17 &&
+           config->min_power <= config->max_power &&
+           config->history > 0 && config->history <= LORA_ADR_HISTORY &&
+           config->target_per >= 0.0f && config->target_per < 1.0f &&
+           config->ack_limit > 0 && config->ack_delay > 0;
+}
+
+/* Aplica o SF mantendo os demais parâmetros do modem (o LDRO segue o SF) */
+static bool adr_apply_sf(rfm95_t* radio, uint8_t spreading_factor) {
+    if (rfm95_tx_busy(radio) || rfm95_tx_queue_length(radio) > 0) return false;
+    lora_modem_config_t config = *rfm95_get_modem_config(radio);
+    config.spreading_factor = spreading_factor;
+    return rfm95_set_modem_config(radio, &config) != 0;
+}
+
+/* Monta e enfileira [operação][identificador][SF][potência] para dst */
+static void adr_send(rfm95_t* radio, lora_link_t* link, uint8_t dst, uint8_t op, uint8_t id, uint8_t sf,
+                     uint8_t power) {
+    uint8_t frame[LORA_LINK_HEADER_SIZE + LORA_ADR_PAYLOAD_SIZE];
+    uint8_t* payload = lora_link_payload(frame);
+    payload[0] = op;
+    payload[1] = id;
+    payload[2] = sf;
+    payload[3] = power;
+    uint8_t length = lora_link_encode(link, frame, dst, LORA_ADR_LINK_TYPE, 0, LORA_ADR_PAYLOAD_SIZE);
+    rfm95_tx_enqueue(radio, frame, length, LORA_PRIO_HIGH);
+}
+
+static lora_adr_node_state_t* adr_find(lora_adr_t* adr, uint8_t address) {
+    for (uint8_t i = 0; i < LORA_ADR_MAX_NODES; i++) {
+        if (adr->nodes[i].in_use && adr->nodes[i].address == address) return &adr->nodes[i];
+    }
+    return NULL;
+}
+
+/* Nó novo (ou substitui o ouvido há mais tempo), no SF do rádio e em max_power */
+static lora_adr_node_state_t* adr_node(lora_adr_t* adr, uint8_t address) {
+    lora_adr_node_state_t* node = adr_find(adr, address);
+    if (node != NULL) return node;
+    node = &adr->nodes[0];
+    for (uint8_t i = 0; i < LORA_ADR_MAX_NODES; i++) {
+        if (!adr->nodes[i].in_use) {
+            node = &adr->nodes[i];
+            break;
+        }
+        if (adr->nodes[i].last_rx_us < node->last_rx_us) node = &adr->nodes[i];
+    }
+    memset(node, 0, sizeof(*node));
+    node->in_use = true;
+    node->address = address;
+    node->sf = adr->radio_sf;
+    node->power = adr->config.max_power;
+    return node;
+}
+
+static void adr_push(lora_adr_node_state_t* node, int16_t sample, uint8_t history) {
+    node->snr[node->head] = sample;
+    node->head = (uint8_t)((node->head + 1) % history);
+    if (node->count < history) node->count++;
+}
+
+static void adr_clear(lora_adr_node_state_t* node) {
+    node->count = 0;
+    node->head = 0;
+}
+
+/* Configuração do nó em vigor: se mudou, o histórico antigo não vale mais;
+   o rádio do gateway passa a escutar no SF dele */
+static void adr_confirm(lora_adr_t* adr, lora_adr_node_state_t* node, uint8_t sf, uint8_t power) {
+    if (sf != node->sf || power != node->power) adr_clear(node);
+    node->sf = sf;
+    node->power = power;
+    node->pending = false;
+    adr->target_sf = sf;
+}
+
+static void adr_command(lora_adr_t* adr, lora_adr_node_state_t* node) {
+    adr_send(adr->radio, adr->link, node->address, LORA_ADR_OP_COMMAND, node->pending_id,
+             node->pending_sf, node->pending_power);
+    adr->counters.commands++;
+}
+
+/* Abre um comando novo (identificador próprio) e o transmite */
+static void adr_propose(lora_adr_t* adr, lora_adr_node_state_t* node, uint8_t sf, uint8_t power) {
+    node->pending = true;
+    node->pending_id = adr->next_id++;
+    node->pending_sf = sf;
+    node->pending_power = power;
+    node->retries = 0;
+    adr_command(adr, node);
+}
+
+/* Menor potência da grade max_power - k * LORA_ADR_POWER_STEP_DB que cobre
+   needed (dBm), limitada a min_power; 0 se nem max_power basta */
+static uint8_t adr_power_for(const lora_adr_config_t* config, float needed) {
+    if (needed > config->max_power) return 0;
+    int power = config->max_power;
+    while (power - LORA_ADR_POWER_STEP_DB >= needed && power - LORA_ADR_POWER_STEP_DB >= config->min_power) {
+        power -= LORA_ADR_POWER_STEP_DB;
+    }
+    if (power > config->min_power && config->min_power >= needed) {
+        power = config->min_power;   // a grade não chega exatamente a min_power
+    }
+    return (uint8_t)power;
+}
+
+/* Decide SF e potência pelo histórico completo. Com perdas acima do alvo não
+   há SNR para medir a falta: sobe um passo. Senão o quantil target_per dos
+   SNRs (os perdidos contam como os piores) é o SNR garantido na potência
+   atual, e cada dB de potência vale um dB de SNR */
+static void adr_decide(const lora_adr_config_t* config, lora_adr_node_state_t* node,
+                       uint8_t* sf, uint8_t* power) {
+    int16_t sorted[LORA_ADR_HISTORY];
+    uint8_t received = 0;
+    for (uint8_t i = 0; i < node->count; i++) {
+        int16_t sample = node->snr[i];
+        if (sample == LORA_ADR_LOST) continue;
+        uint8_t j = received++;
+        while (j > 0 && sorted[j - 1] > sample) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = sample;
+    }
+
+    *sf = node->sf;
+    *power = node->power;
+    int allowed = (int)(config->target_per * node->count) - (node->count - received);
+    if (allowed < 0) {
+        if (node->power < config->max_power) {
+            uint8_t raised = node->power + LORA_ADR_POWER_STEP_DB;
+            *power = raised < config->max_power ? raised : config->max_power;
+        } else if (node->sf < config->max_sf) {
+            *sf = node->sf + 1;
+        }
+        return;
+    }
+
+    float snr = sorted[allowed] / 4.0f;
+    node->margin_db = snr - lora_adr_required_snr(node->sf);
+    for (uint8_t candidate = config->min_sf; candidate <= config->max_sf; candidate++) {
+        float needed = node->power + lora_adr_required_snr(candidate) + config->margin_db - snr;
+        uint8_t candidate_power = adr_power_for(config, needed);
+        if (candidate_power != 0) {
+            *sf = candidate;
+            *power = candidate_power;
+            return;
+        }
+    }
+    *sf = config->max_sf;
+    *power = config->max_power;
+}
+
+/* Maior intervalo médio entre envios dos nós (0 se ainda não medido) */
+static uint32_t adr_interval_us(const lora_adr_t* adr) {
+    uint32_t interval = 0;
+    for (uint8_t i = 0; i < LORA_ADR_MAX_NODES; i++) {
+        if (adr->nodes[i].in_use && adr->nodes[i].interval_us > interval) {
+            interval = adr->nodes[i].interval_us;
+        }
+    }
+    return interval;
+}
+
+// ============================================================================
+// Implementação das Funções Públicas
+// ============================================================================
+
+float lora_adr_required_snr(uint8_t spreading_factor) {
+    if (spreading_factor < 7) return adr_required_snr[0];
+    if (spreading_factor > 12) return adr_required_snr[5];
+    return adr_required_snr[spreading_factor - 7];
+}
+
+bool lora_adr_init(lora_adr_t* adr, rfm95_t* radio, lora_link_t* link, const lora_adr_config_t* config) {
+    if (!adr_valid_config(config)) return false;
+    memset(adr, 0, sizeof(*adr));
+    adr->radio = radio;
+    adr->link = link;
+    adr->config = *config;
+    adr->radio_sf = rfm95_get_modem_config(radio)->spreading_factor;
+    adr->target_sf = adr->radio_sf;
+    if (adr->target_sf < config->min_sf) adr->target_sf = config->min_sf;
+    if (adr->target_sf > config->max_sf) adr->target_sf = config->max_sf;
+    adr->silence_since_us = hal_time_us();
+    lora_adr_service(adr);
+    return true;
+}
+
+bool lora_adr_receive(lora_adr_t* adr, const lora_link_header_t* header, const uint8_t* payload,
+                      uint8_t payload_length, float snr) {
+    const lora_adr_config_t* config = &adr->config;
+    uint64_t now = hal_time_us();
+    lora_adr_node_state_t* node = adr_node(adr, header->src);
+    uint64_t previous_us = node->last_rx_us;
+    node->last_rx_us = adr->silence_since_us = now;
+    adr->silent_steps = 0;
+
+    // Ouvido no SF do rádio: é o SF do nó (ele recuou ou aplicou o comando
+    // cuja confirmação se perdeu)
+    if (node->sf != adr->radio_sf) {
+        if (node->pending && node->pending_sf == adr->radio_sf) {
+            adr_confirm(adr, node, node->pending_sf, node->pending_power);
+            adr->counters.confirmed++;
+        } else {
+            // Recuo do nó: o comando pendente (se havia) já não vale
+            node->sf = adr->radio_sf;
+            node->power = config->max_power;
+            node->pending = false;
+            adr_clear(node);
+        }
+    }
+
+    // Lacunas de sequência entram como perdas; atrasados só como amostra.
+    // O intervalo é medido por envio, sem contar as lacunas como silêncio
+    uint8_t advance = (uint8_t)(header->seq - node->last_seq);
+    if (!node->seq_valid || (header->flags & LORA_LINK_FLAG_SYNC)) {
+        node->seq_valid = true;
+        node->last_seq = header->seq;
+    } else if (advance != 0 && advance < 128) {
+        uint32_t interval = (uint32_t)((now - previous_us) / advance);
+        node->interval_us = node->interval_us
+            ? (uint32_t)((int32_t)node->interval_us + ((int32_t)interval - (int32_t)node->interval_us) / 8)
+            : interval;
+        uint8_t lost = advance - 1;
+        if (lost > config->history) lost = config->history;
+        for (uint8_t i = 0; i < lost; i++) {
+            adr_push(node, LORA_ADR_LOST, config->history);
+        }
+        node->last_seq = header->seq;
+    }
+    float quarters = snr * 4.0f;
+    if (quarters > INT16_MAX) quarters = INT16_MAX;
+    if (quarters < INT16_MIN + 1) quarters = INT16_MIN + 1;
+    adr_push(node, (int16_t)quarters, config->history);
+
+    bool control = header->type == LORA_ADR_LINK_TYPE;
+    if (control && payload_length >= LORA_ADR_PAYLOAD_SIZE && payload[0] == LORA_ADR_OP_STATUS) {
+        if (node->pending && payload[1] == node->pending_id) {
+            adr_confirm(adr, node, payload[2], payload[3]);
+            adr->counters.confirmed++;
+        } else if (!node->pending) {
+            adr_confirm(adr, node, payload[2], payload[3]);
+        }
+        return true;
+    }
+
+    if (header->flags & LORA_LINK_FLAG_ADR_REQ) {
+        // O nó não ouve o gateway há ack_limit envios: repete a decisão em vigor
+        adr->counters.requests++;
+        if (node->pending) {
+            adr_command(adr, node);
+        } else {
+            adr_propose(adr, node, node->sf, node->power);
+        }
+        return control;
+    }
+
+    if (node->pending) {
+        // Ouvido na configuração antiga: o comando ou a confirmação se perdeu
+        if (++node->retries > LORA_ADR_MAX_RETRIES) {
+            node->pending = false;
+            adr->counters.abandoned++;
+        } else {
+            adr->counters.retries++;
+            adr_command(adr, node);
+        }
+        return control;
+    }
+
+    if (node->count == config->history) {
+        uint8_t sf, power;
+        adr_decide(config, node, &sf, &power);
+        adr->counters.decisions++;
+        if (sf != node->sf || power != node->power) {
+            adr_propose(adr, node, sf, power);
+        }
+    }
+    return control;
+}
+
+void lora_adr_service(lora_adr_t* adr) {
+    uint64_t now = hal_time_us();
+    if (adr->target_sf != adr->radio_sf && adr_apply_sf(adr->radio, adr->target_sf)) {
+        adr->radio_sf = adr->target_sf;
+        adr->silence_since_us = now;
+        adr->counters.sf_switches++;
+    }
+
+    uint32_t interval = adr_interval_us(adr);
+    if (interval == 0 || adr->config.min_sf == adr->config.max_sf) return;
+    uint64_t silence = now - adr->silence_since_us;
+
+    // Troca de SF sem confirmação: alterna entre o SF antigo e o novo
+    for (uint8_t i = 0; i < LORA_ADR_MAX_NODES; i++) {
+        lora_adr_node_state_t* node = &adr->nodes[i];
+        if (!node->in_use || !node->pending || node->pending_sf == node->sf) continue;
+        if (silence < 2 * (uint64_t)interval) return;
+        if (++node->retries > LORA_ADR_MAX_RETRIES) {
+            node->pending = false;
+            adr->counters.abandoned++;
+            adr->target_sf = node->sf;
+        } else {
+            adr->counters.retries++;
+            adr->target_sf = adr->radio_sf == node->pending_sf ? node->sf : node->pending_sf;
+        }
+        adr->silence_since_us = now;
+        return;
+    }
+
+    // Silêncio: os nós recuam um SF a cada ack_delay envios depois de
+    // ack_limit + ack_delay sem resposta; o gateway os segue no mesmo ritmo
+    uint32_t frames = adr->silent_steps == 0 ? adr->config.ack_limit + adr->config.ack_delay
+                                             : adr->config.ack_delay;
+    if (silence >= (uint64_t)frames * interval && adr->target_sf < adr->config.max_sf) {
+        adr->target_sf++;
+        adr->silent_steps++;
+        adr->silence_since_us = now;
+        adr->counters.fallback_steps++;
+    }
+}
+
+const lora_adr_node_state_t* lora_adr_node_state(const lora_adr_t* adr, uint8_t address) {
+    return adr_find((lora_adr_t*)adr, address);
+}
+
+const lora_adr_counters_t* lora_adr_counters(const lora_adr_t* adr) {
+    return &adr->counters;
+}
+
+bool lora_adr_node_init(lora_adr_node_t* node, rfm95_t* radio, lora_link_t* link, uint8_t gateway,
+                        const lora_adr_config_t* config) {
+    if (!adr_valid_config(config)) return false;
+    memset(node, 0, sizeof(*node));
+    node->radio = radio;
+    node->link = link;
+    node->gateway = gateway;
+    node->config = *config;
+    node->sf = rfm95_get_modem_config(radio)->spreading_factor;
+    if (node->sf < config->min_sf || node->sf > config->max_sf) {
+        node->apply_sf = node->sf < config->min_sf ? config->min_sf : config->max_sf;
+        lora_adr_node_service(node);
+    }
+    node->power = config->max_power;
+    rfm95_set_power(node->radio, node->power);
+    return true;
+}
+
+uint8_t lora_adr_node_uplink(lora_adr_node_t* node) {
+    const lora_adr_config_t* config = &node->config;
+    if (node->unanswered < UINT16_MAX) node->unanswered++;
+    if (node->unanswered < config->ack_limit) return 0;
+
+    uint16_t late = node->unanswered - config->ack_limit;
+    if (late > 0 && late % config->ack_delay == 0) {
+        // Recuo: primeiro a potência máxima, depois um SF a mais por passo
+        if (node->power < config->max_power) {
+            node->power = config->max_power;
+            rfm95_set_power(node->radio, node->power);
+            node->counters.backoffs++;
+        } else if (node->sf < config->max_sf && node->apply_sf == 0) {
+            node->apply_sf = node->sf + 1;
+            lora_adr_node_service(node);
+            node->counters.backoffs++;
+        }
+    }
+    node->counters.requests++;
+    return LORA_LINK_FLAG_ADR_REQ;
+}
+
+bool lora_adr_node_receive(lora_adr_node_t* node, const lora_link_header_t* header,
+                           const uint8_t* payload, uint8_t payload_length) {
+    const lora_adr_config_t* config = &node->config;
+    if (header->type != LORA_ADR_LINK_TYPE || header->src != node->gateway ||
+        payload_length < LORA_ADR_PAYLOAD_SIZE || payload[0] != LORA_ADR_OP_COMMAND) {
+        return false;
+    }
+    node->counters.commands++;
+    node->unanswered = 0;
+
+    uint8_t sf = payload[2];
+    uint8_t power = payload[3];
+    if (sf < config->min_sf) sf = config->min_sf;
+    if (sf > config->max_sf) sf = config->max_sf;
+    if (power < config->min_power) power = config->min_power;
+    if (power > config->max_power) power = config->max_power;
+
+    uint8_t current_sf = node->apply_sf ? node->apply_sf : node->sf;
+    if (sf != current_sf || power != node->power) node->counters.changes++;
+    if (power != node->power) {
+        node->power = power;
+        rfm95_set_power(node->radio, power);
+    }
+
+    // A confirmação sai no SF antigo, o único em que o gateway escuta agora
+    adr_send(node->radio, node->link, node->gateway, LORA_ADR_OP_STATUS, payload[1], sf, power);
+    node->apply_sf = sf != node->sf ? sf : 0;
+    lora_adr_node_service(node);
+    return true;
+}
+
+void lora_adr_node_service(lora_adr_node_t* node) {
+    if (node->apply_sf != 0 && adr_apply_sf(node->radio, node->apply_sf)) {
+        node->sf = node->apply_sf;
+        node->apply_sf = 0;
+    }
+}
+
+const lora_adr_node_counters_t* lora_adr_node_counters(const lora_adr_node_t* node) {
+    return &node->counters;
+}
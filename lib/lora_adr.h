@@ -0,0 +1,175 @@
+// lora_adr.h
+// Taxa de dados adaptativa (ADR) sobre lora_link. O gateway guarda o SNR dos
+// últimos pacotes de cada nó, contando as lacunas de sequência como perdas, e
+// estima a margem do enlace pelo SNR que os pacotes superam com a taxa de
+// perda alvo (o quantil target_per do histórico, e não o máximo). Com ela
+// escolhe o SF mais rápido e a menor potência (passos de 3 dB abaixo de
+// max_power) que ainda deixam margin_db acima do SNR mínimo de demodulação do
+// SF; se as perdas já passam do alvo, sobe um passo (potência, depois SF).
+// A decisão vai ao nó num quadro LORA_ADR_LINK_TYPE; o nó aplica com
+// rfm95_set_power() e rfm95_set_modem_config() e confirma antes de trocar o SF.
+// Sem respostas do gateway por ack_limit envios o nó marca os quadros com
+// LORA_LINK_FLAG_ADR_REQ e, depois de mais ack_delay, recua sozinho: potência
+// máxima e um SF a mais a cada ack_delay envios (como no LoRaWAN).
+//
+// O SX1276 demodula um SF por vez: o rádio do gateway acompanha o SF dos nós
+// (enlace ponto a ponto, como lora_tx/lora_rx). Com vários nós no mesmo
+// rádio, fixe o SF (min_sf = max_sf) e o ADR ajusta só a potência.
+#ifndef LORA_ADR_H
+#define LORA_ADR_H
+
+#include "lora_link.h"
+
+// Pacotes (recebidos e perdidos) guardados por nó para cada decisão
+#ifndef LORA_ADR_HISTORY
+#define LORA_ADR_HISTORY 32
+#endif
+
+// Nós acompanhados pelo gateway (o menos recente é substituído)
+#ifndef LORA_ADR_MAX_NODES
+#define LORA_ADR_MAX_NODES 8
+#endif
+
+// Tipo de payload de lora_link reservado aos comandos e confirmações
+#ifndef LORA_ADR_LINK_TYPE
+#define LORA_ADR_LINK_TYPE 0x0F
+#endif
+
+// Payload: [operação][identificador][SF][potência em dBm]
+#define LORA_ADR_PAYLOAD_SIZE 4
+#define LORA_ADR_OP_COMMAND   0x01   // gateway -> nó: nova configuração
+#define LORA_ADR_OP_STATUS    0x02   // nó -> gateway: configuração aplicada
+
+// Marca de quadro perdido no histórico de SNR
+#define LORA_ADR_LOST INT16_MIN
+
+// Passo de potência (dB) e reenvios de um comando sem confirmação
+#define LORA_ADR_POWER_STEP_DB 3
+#define LORA_ADR_MAX_RETRIES   4
+
+typedef struct {
+    float target_per;          // taxa de perda de pacotes aceita (ex: 0.1 = 10%)
+    float margin_db;           // folga acima do SNR mínimo do SF
+    uint8_t history;           // pacotes por decisão (até LORA_ADR_HISTORY)
+    uint8_t min_sf;            // 7 a 12
+    uint8_t max_sf;
+    uint8_t min_power;         // dBm, 2 a 17
+    uint8_t max_power;
+    uint8_t ack_limit;         // nó: envios sem resposta antes de pedir uma
+    uint8_t ack_delay;         // nó: envios entre os passos de recuo
+} lora_adr_config_t;
+
+#define LORA_ADR_CONFIG_DEFAULT { 0.1f, 5.0f, 16, 7, 12, 2, 17, 32, 8 }
+
+// Gateway: estimativa por nó e comandos
+
+typedef struct {
+    uint32_t decisions;        // estimativas com histórico completo
+    uint32_t commands;         // comandos transmitidos (inclusive reenvios)
+    uint32_t retries;
+    uint32_t confirmed;        // comandos confirmados pelo nó
+    uint32_t abandoned;        // comandos sem confirmação após LORA_ADR_MAX_RETRIES
+    uint32_t requests;         // quadros com LORA_LINK_FLAG_ADR_REQ
+    uint32_t sf_switches;      // trocas de SF do rádio do gateway
+    uint32_t fallback_steps;   // SF subido por silêncio dos nós
+} lora_adr_counters_t;
+
+typedef struct {
+    bool in_use;
+    uint8_t address;
+    uint8_t sf;                // configuração em uso pelo nó
+    uint8_t power;
+    int16_t snr[LORA_ADR_HISTORY];   // quartos de dB; LORA_ADR_LOST = quadro perdido
+    uint8_t count;
+    uint8_t head;
+    uint8_t last_seq;
+    bool seq_valid;
+    float margin_db;           // última margem estimada (SNR do quantil - SNR mínimo do SF)
+
+    bool pending;              // comando aguardando a confirmação
+    uint8_t pending_id;
+    uint8_t pending_sf;
+    uint8_t pending_power;
+    uint8_t retries;
+    uint64_t last_rx_us;
+    uint32_t interval_us;      // média móvel do intervalo entre envios (lacunas divididas)
+} lora_adr_node_state_t;
+
+typedef struct {
+    rfm95_t* radio;
+    lora_link_t* link;
+    lora_adr_config_t config;
+    lora_adr_node_state_t nodes[LORA_ADR_MAX_NODES];
+    uint8_t next_id;
+    uint8_t radio_sf;          // SF em que o rádio do gateway escuta
+    uint8_t target_sf;         // SF a aplicar assim que o rádio estiver livre
+    uint64_t silence_since_us; // último quadro ouvido de qualquer nó (ou troca de SF)
+    uint8_t silent_steps;      // passos de recuo já dados neste silêncio
+    lora_adr_counters_t counters;
+} lora_adr_t;
+
+// Liga o ADR ao rádio (rfm95_radio(0) é a instância padrão) e a um enlace já
+// inicializado; o SF atual do rádio é o de partida e os nós novos são
+// considerados em max_power. Retorna false se a configuração é inválida
+bool lora_adr_init(lora_adr_t* adr, rfm95_t* radio, lora_link_t* link, const lora_adr_config_t* config);
+
+// Alimenta o estimador com um quadro recebido (LORA_LINK_RX_NEW) e seu SNR
+// (lora_packet_snr() ou o campo snr do pacote). Responde aos pedidos e envia
+// o comando quando a decisão muda. Retorna true se o quadro era do próprio
+// ADR (a aplicação deve ignorá-lo)
+bool lora_adr_receive(lora_adr_t* adr, const lora_link_header_t* header, const uint8_t* payload,
+                      uint8_t payload_length, float snr);
+
+// Troca o SF do rádio quando ele fica livre e o sobe um passo se os nós
+// ficam em silêncio (eles recuam sozinhos) - deve ser chamada em loop
+void lora_adr_service(lora_adr_t* adr);
+
+// Estado de um nó (NULL se ele nunca foi ouvido)
+const lora_adr_node_state_t* lora_adr_node_state(const lora_adr_t* adr, uint8_t address);
+
+// SNR mínimo de demodulação do SF (dB, datasheet do SX1276)
+float lora_adr_required_snr(uint8_t spreading_factor);
+
+const lora_adr_counters_t* lora_adr_counters(const lora_adr_t* adr);
+
+// Nó: aplica os comandos e recua sem respostas
+
+typedef struct {
+    uint32_t commands;         // comandos recebidos do gateway
+    uint32_t changes;          // comandos que mudaram SF ou potência
+    uint32_t requests;         // envios marcados com LORA_LINK_FLAG_ADR_REQ
+    uint32_t backoffs;         // passos de recuo sem resposta do gateway
+} lora_adr_node_counters_t;
+
+typedef struct {
+    rfm95_t* radio;
+    lora_link_t* link;
+    uint8_t gateway;
+    lora_adr_config_t config;
+    uint8_t sf;
+    uint8_t power;
+    uint8_t apply_sf;          // SF a aplicar depois que a confirmação sair (0 = nenhum)
+    uint16_t unanswered;       // envios desde a última resposta do gateway
+    lora_adr_node_counters_t counters;
+} lora_adr_node_t;
+
+// Parte do SF atual do modem em max_power (aplicada aqui). Retorna false
+// se a configuração é inválida
+bool lora_adr_node_init(lora_adr_node_t* node, rfm95_t* radio, lora_link_t* link, uint8_t gateway,
+                        const lora_adr_config_t* config);
+
+// Chamada a cada envio; retorna as flags para lora_link_encode() e aplica o
+// recuo quando o gateway não responde
+uint8_t lora_adr_node_uplink(lora_adr_node_t* node);
+
+// Trata um quadro recebido do gateway. Retorna true se era um comando do ADR
+bool lora_adr_node_receive(lora_adr_node_t* node, const lora_link_header_t* header,
+                           const uint8_t* payload, uint8_t payload_length);
+
+// Aplica o SF pendente quando a confirmação termina de sair - deve ser
+// chamada em loop
+void lora_adr_node_service(lora_adr_node_t* node);
+
+const lora_adr_node_counters_t* lora_adr_node_counters(const lora_adr_node_t* node);
+
+#endif // LORA_ADR_H
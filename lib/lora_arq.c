@@ -0,0 +1,257 @@
+#include "lora_arq.h"
+#include <string.h>
+
+// ============================================================================
+// Funções Privadas
+// ============================================================================
+
+/* Sorteio xorshift32 para espalhar as retransmissões de nós diferentes */
+static uint32_t arq_random(lora_arq_t* arq) {
+    uint32_t x = arq->random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    arq->random = x;
+    return x;
+}
+
+/* Tempo no ar do quadro e do ACK correspondente com o modem atual */
+static uint32_t arq_airtime_us(const lora_arq_t* arq, uint8_t frame_length) {
+    return rfm95_time_on_air_us(arq->radio, frame_length) +
+           rfm95_time_on_air_us(arq->radio, LORA_LINK_HEADER_SIZE + LORA_ARQ_ACK_SIZE);
+}
+
+/* Timeout sem back-off: tempos no ar mais a folga estimada */
+static uint32_t arq_base_timeout_us(const lora_arq_t* arq, uint8_t frame_length) {
+    uint32_t slack = LORA_ARQ_INITIAL_SLACK_US;
+    if (arq->rtt_valid) {
+        uint32_t deviation = 4 * arq->rttvar_us;
+        slack = arq->srtt_us + (deviation > LORA_ARQ_MIN_SLACK_US ? deviation : LORA_ARQ_MIN_SLACK_US);
+    }
+    return arq_airtime_us(arq, frame_length) + slack;
+}
+
+/* O rádio não escuta enquanto transmite: adia os ACKs esperados pelos
+   quadros em voo (exceto skip) pelo tempo no ar de um novo envio. Um envio
+   urgente passa à frente dos quadros que ainda não saíram, então só conta
+   como surdez para os que já tiveram TxDone */
+static void arq_deaf(lora_arq_t* arq, const lora_arq_slot_t* skip, uint32_t airtime_us, bool urgent) {
+    for (uint8_t i = 0; i < LORA_ARQ_WINDOW; i++) {
+        lora_arq_slot_t* slot = &arq->slots[i];
+        if (!slot->in_use || slot == skip) continue;
+        slot->deadline_us += airtime_us;
+        if (!urgent || slot->stamp.done) {
+            slot->deaf_us += airtime_us;
+        }
+    }
+}
+
+/* Passa a contar o timeout do TxDone assim que o driver o marca */
+static void arq_anchor(lora_arq_slot_t* slot) {
+    if (slot->anchored || !slot->stamp.done) return;
+    uint64_t now = hal_time_us();
+    uint64_t done = now - (uint32_t)((uint32_t)now - slot->stamp.done_us);   // volta aos 64 bits
+    slot->anchored = true;
+    slot->deadline_us = done + slot->wait_us + slot->deaf_us;
+}
+
+/* Entrega o quadro ao driver e arma o timeout da tentativa atual */
+static void arq_transmit(lora_arq_t* arq, lora_arq_slot_t* slot) {
+    uint64_t now = hal_time_us();
+    uint32_t airtime = rfm95_time_on_air_us(arq->radio, slot->length);
+    if (slot->retries) {
+        // Só a cópia original pode reiniciar a contagem do receptor
+        slot->frame[3] &= (uint8_t)~(LORA_LINK_FLAG_SYNC << 4);
+    }
+
+    // Até o TxDone, o prazo supõe quadros máximos à frente na fila (e só vale
+    // sozinho se a fila recusar ou descartar o quadro)
+    uint32_t ahead = rfm95_tx_queue_length(arq->radio) + (rfm95_tx_busy(arq->radio) ? 1 : 0);
+    uint64_t ahead_us = (uint64_t)ahead * rfm95_time_on_air_us(arq->radio, LORA_MAX_PACKET_SIZE);
+    slot->anchored = false;
+    slot->deaf_us = 0;
+    if (!rfm95_tx_enqueue_stamped(arq->radio, slot->frame, slot->length, LORA_PRIO_NORMAL, &slot->stamp)) {
+        arq->counters.tx_rejected++;
+    }
+    arq_deaf(arq, slot, airtime, false);
+
+    uint64_t timeout = (uint64_t)arq_base_timeout_us(arq, slot->length) << slot->retries;
+    if (timeout > LORA_ARQ_MAX_TIMEOUT_US) timeout = LORA_ARQ_MAX_TIMEOUT_US;
+    timeout += arq_random(arq) % (airtime + 1);
+    slot->wait_us = (uint32_t)timeout - airtime;
+    slot->deadline_us = now + ahead_us + airtime + slot->wait_us;
+    arq_anchor(slot);
+}
+
+/* Atualiza o estimador com uma amostra do RTT excedente (RFC 6298) */
+static void arq_rtt_sample(lora_arq_t* arq, uint32_t rtt_us, uint8_t frame_length) {
+    uint32_t airtime = arq_airtime_us(arq, frame_length);
+    uint32_t slack = rtt_us > airtime ? rtt_us - airtime : 0;
+
+    if (!arq->rtt_valid) {
+        arq->srtt_us = slack;
+        arq->rttvar_us = slack / 2;
+        arq->rtt_valid = true;
+    } else {
+        uint32_t error = slack > arq->srtt_us ? slack - arq->srtt_us : arq->srtt_us - slack;
+        arq->rttvar_us = arq->rttvar_us - arq->rttvar_us / 4 + error / 4;
+        arq->srtt_us = arq->srtt_us - arq->srtt_us / 8 + slack / 8;
+    }
+
+    arq->counters.rtt_last_us = rtt_us;
+    if (arq->counters.rtt_min_us == 0 || rtt_us < arq->counters.rtt_min_us) arq->counters.rtt_min_us = rtt_us;
+    if (rtt_us > arq->counters.rtt_max_us) arq->counters.rtt_max_us = rtt_us;
+}
+
+static void arq_release(lora_arq_t* arq, lora_arq_slot_t* slot, bool acked) {
+    slot->in_use = false;
+    arq->in_flight--;
+    if (arq->callback) {
+        arq->callback(slot->dst, slot->seq, acked);
+    }
+}
+
+/* Confirma o slot, medindo o RTT se ele não foi retransmitido */
+static void arq_complete(lora_arq_t* arq, lora_arq_slot_t* slot) {
+    // Regra de Karn: com retransmissão não se sabe qual cópia foi confirmada.
+    // O início da transmissão é o TxDone menos o tempo no ar do quadro
+    if (slot->retries == 0 && slot->stamp.done) {
+        uint32_t since_done = (uint32_t)hal_time_us() - slot->stamp.done_us;
+        since_done = since_done > slot->deaf_us ? since_done - slot->deaf_us : 0;
+        arq_rtt_sample(arq, rfm95_time_on_air_us(arq->radio, slot->length) + since_done, slot->length);
+    }
+    arq->counters.acked++;
+    arq->counters.acked_bytes += slot->length - LORA_LINK_HEADER_SIZE;
+    arq_release(arq, slot, true);
+}
+
+/* ACK recebido de src: confirma seq e os quadros marcados no mapa */
+static void arq_acked(lora_arq_t* arq, uint8_t src, const uint8_t* ack) {
+    arq->counters.acks_received++;
+    for (uint8_t i = 0; i < LORA_ARQ_WINDOW; i++) {
+        lora_arq_slot_t* slot = &arq->slots[i];
+        if (!slot->in_use || slot->dst != src) continue;
+
+        uint8_t behind = (uint8_t)(ack[1] - slot->seq);
+        bool acked = slot->seq == ack[0] || behind == 0 ||
+                     (behind >= 1 && behind <= 8 && (ack[2] & (1u << (behind - 1))));
+        if (acked) {
+            arq_complete(arq, slot);
+        }
+    }
+}
+
+/* Confirma o quadro seq recebido de dst (ACKs passam à frente na fila) */
+static void arq_send_ack(lora_arq_t* arq, uint8_t dst, uint8_t seq) {
+    const lora_link_source_t* src = lora_link_source(arq->link, dst);
+    uint8_t frame[LORA_LINK_HEADER_SIZE + LORA_ARQ_ACK_SIZE];
+    uint8_t* ack = lora_link_payload(frame);
+    ack[0] = seq;
+    ack[1] = src->highest_seq;
+    ack[2] = (uint8_t)(src->window >> 1);
+    uint8_t length = lora_link_encode(arq->link, frame, dst, 0, LORA_LINK_FLAG_ACK, LORA_ARQ_ACK_SIZE);
+    if (rfm95_tx_enqueue(arq->radio, frame, length, LORA_PRIO_HIGH)) {
+        arq->counters.acks_sent++;
+        arq_deaf(arq, NULL, rfm95_time_on_air_us(arq->radio, length), true);
+    }
+}
+
+// ============================================================================
+// Implementação das Funções Públicas
+// ============================================================================
+
+void lora_arq_init(lora_arq_t* arq, rfm95_t* radio, lora_link_t* link) {
+    memset(arq, 0, sizeof(*arq));
+    arq->radio = radio;
+    arq->link = link;
+    arq->start_us = hal_time_us();
+    arq->random = ((uint32_t)arq->start_us ^ ((uint32_t)link->address << 24)) | 1;
+}
+
+void lora_arq_set_callback(lora_arq_t* arq, lora_arq_done_callback_t callback) {
+    arq->callback = callback;
+}
+
+bool lora_arq_send(lora_arq_t* arq, uint8_t dst, uint8_t type, const uint8_t* payload,
+                   uint8_t payload_length) {
+    if (dst == LORA_LINK_BROADCAST || payload_length > LORA_LINK_MAX_PAYLOAD) return false;
+    if (arq->in_flight >= LORA_ARQ_WINDOW) return false;
+
+    lora_arq_slot_t* slot = arq->slots;
+    while (slot->in_use) slot++;
+
+    memcpy(lora_link_payload(slot->frame), payload, payload_length);
+    slot->length = lora_link_encode(arq->link, slot->frame, dst, type, LORA_LINK_FLAG_ACK_REQ, payload_length);
+    if (slot->length == 0) return false;
+    slot->in_use = true;
+    slot->dst = dst;
+    slot->seq = slot->frame[2];
+    slot->retries = 0;
+    arq->in_flight++;
+    arq->counters.sent++;
+
+    arq_transmit(arq, slot);
+    return true;
+}
+
+lora_link_rx_result_t lora_arq_receive(lora_arq_t* arq, const uint8_t* frame, uint8_t length,
+                                       lora_link_header_t* header, const uint8_t** payload,
+                                       uint8_t* payload_length) {
+    lora_link_rx_result_t result = lora_link_receive(arq->link, frame, length, header, payload, payload_length);
+    if (result == LORA_LINK_RX_INVALID || result == LORA_LINK_RX_OTHER) return result;
+
+    if (header->flags & LORA_LINK_FLAG_ACK) {
+        if (*payload_length >= LORA_ARQ_ACK_SIZE) {
+            arq_acked(arq, header->src, *payload);
+        }
+        return LORA_LINK_RX_OTHER;                       // nada para a aplicação
+    }
+
+    // Duplicatas também são confirmadas: o ACK anterior pode ter se perdido
+    if ((header->flags & LORA_LINK_FLAG_ACK_REQ) && header->dst == arq->link->address) {
+        arq_send_ack(arq, header->src, header->seq);
+    }
+    if (result == LORA_LINK_RX_DUPLICATE) {
+        arq->counters.duplicates++;
+    }
+    return result;
+}
+
+void lora_arq_service(lora_arq_t* arq) {
+    if (arq->in_flight == 0) return;
+
+    uint64_t now = hal_time_us();
+    for (uint8_t i = 0; i < LORA_ARQ_WINDOW; i++) {
+        lora_arq_slot_t* slot = &arq->slots[i];
+        if (!slot->in_use) continue;
+        arq_anchor(slot);
+        if (now < slot->deadline_us) continue;
+
+        if (slot->retries >= LORA_ARQ_MAX_RETRIES) {
+            arq->counters.failed++;
+            arq_release(arq, slot, false);
+            continue;
+        }
+        slot->retries++;
+        arq->counters.retransmissions++;
+        arq_transmit(arq, slot);
+    }
+}
+
+uint8_t lora_arq_in_flight(const lora_arq_t* arq) {
+    return arq->in_flight;
+}
+
+uint32_t lora_arq_timeout_us(const lora_arq_t* arq, uint8_t payload_length) {
+    return arq_base_timeout_us(arq, LORA_LINK_HEADER_SIZE + payload_length);
+}
+
+uint32_t lora_arq_goodput_bps(const lora_arq_t* arq) {
+    uint64_t elapsed = hal_time_us() - arq->start_us;
+    if (elapsed == 0) return 0;
+    return (uint32_t)(arq->counters.acked_bytes * 8 * 1000000 / elapsed);
+}
+
+const lora_arq_counters_t* lora_arq_counters(const lora_arq_t* arq) {
+    return &arq->counters;
+}
@@ -0,0 +1,121 @@
+// lora_arq.h
+// Entrega confiável opcional sobre lora_link: os quadros de dados levam
+// LORA_LINK_FLAG_ACK_REQ e ficam guardados até a confirmação; o receptor
+// responde automaticamente com um quadro LORA_LINK_FLAG_ACK. Até
+// LORA_ARQ_WINDOW quadros ficam em voo ao mesmo tempo (repetição seletiva).
+// O timeout de cada quadro é o tempo no ar do quadro e do ACK com o modem
+// atual mais a folga medida (média e variação do RTT excedente, como no
+// RFC 6298), dobrado a cada retransmissão e com um pequeno sorteio. O RTT e o
+// timeout contam a partir do TxDone do quadro (lora_tx_enqueue_stamped), não
+// do momento em que ele entrou na fila do driver.
+#ifndef LORA_ARQ_H
+#define LORA_ARQ_H
+
+#include "lora_link.h"
+
+// Quadros em voo (cada um guarda uma cópia de até LORA_MAX_PACKET_SIZE bytes)
+#ifndef LORA_ARQ_WINDOW
+#define LORA_ARQ_WINDOW 4
+#endif
+
+// Retransmissões antes de desistir de um quadro
+#ifndef LORA_ARQ_MAX_RETRIES
+#define LORA_ARQ_MAX_RETRIES 4
+#endif
+
+// Folga usada antes da primeira medida de RTT (processamento do outro lado)
+#define LORA_ARQ_INITIAL_SLACK_US  250000
+// Folga mínima somada à média (cobre a variação quando ela mede quase zero)
+#define LORA_ARQ_MIN_SLACK_US      20000
+// Teto do timeout com back-off
+#define LORA_ARQ_MAX_TIMEOUT_US    30000000
+
+// Payload de um ACK: [sequência confirmada][maior sequência recebida da origem]
+// [bit i = recebida a maior - 1 - i]; o mapa confirma também os quadros
+// anteriores cujos ACKs colidiram com as próprias transmissões do remetente
+#define LORA_ARQ_ACK_SIZE 3
+
+// Resultado de um quadro: confirmado ou descartado após LORA_ARQ_MAX_RETRIES
+typedef void (*lora_arq_done_callback_t)(uint8_t dst, uint8_t seq, bool acked);
+
+typedef struct {
+    uint32_t sent;             // quadros novos aceitos por lora_arq_send()
+    uint32_t retransmissions;
+    uint32_t acked;
+    uint32_t failed;           // descartados sem confirmação
+    uint32_t acks_sent;
+    uint32_t acks_received;    // inclusive duplicados e atrasados
+    uint32_t duplicates;       // dados repetidos recebidos (ACK reenviado)
+    uint32_t tx_rejected;      // fila do driver cheia (tentado de novo no próximo timeout)
+    uint32_t rtt_last_us;      // último RTT medido (sem retransmissão, regra de Karn):
+                               // tempo no ar do quadro + TxDone até o ACK
+    uint32_t rtt_min_us;
+    uint32_t rtt_max_us;
+    uint64_t acked_bytes;      // payload confirmado
+} lora_arq_counters_t;
+
+typedef struct {
+    bool in_use;
+    uint8_t seq;
+    uint8_t dst;
+    uint8_t length;            // quadro completo, com o cabeçalho do enlace
+    uint8_t retries;
+    bool anchored;             // deadline_us já conta do TxDone da última tentativa
+    lora_tx_stamp_t stamp;     // TxDone da última tentativa, gravado pelo driver
+    uint32_t wait_us;          // espera pelo ACK depois do TxDone (timeout - tempo no ar)
+    uint64_t deadline_us;      // estimado pela fila até o TxDone chegar
+    uint32_t deaf_us;          // tempo transmitindo outros quadros desde então
+    uint8_t frame[LORA_MAX_PACKET_SIZE];
+} lora_arq_slot_t;
+
+typedef struct {
+    rfm95_t* radio;
+    lora_link_t* link;
+    lora_arq_slot_t slots[LORA_ARQ_WINDOW];
+    uint8_t in_flight;
+
+    // Estimador do RTT excedente (RTT - tempos no ar), em us
+    bool rtt_valid;
+    uint32_t srtt_us;
+    uint32_t rttvar_us;
+
+    uint32_t random;           // estado do xorshift do sorteio do back-off
+    uint64_t start_us;         // referência para o goodput
+    lora_arq_done_callback_t callback;
+    lora_arq_counters_t counters;
+} lora_arq_t;
+
+// Liga o ARQ ao rádio (rfm95_radio(0) é a instância padrão) e a um enlace já
+// inicializado (o endereço local vem dele)
+void lora_arq_init(lora_arq_t* arq, rfm95_t* radio, lora_link_t* link);
+
+// Chamado ao confirmar ou descartar cada quadro (NULL desativa)
+void lora_arq_set_callback(lora_arq_t* arq, lora_arq_done_callback_t callback);
+
+// Copia o payload para a janela e o transmite pedindo confirmação.
+// Retorna false se a janela está cheia, o payload não cabe ou dst é broadcast
+bool lora_arq_send(lora_arq_t* arq, uint8_t dst, uint8_t type, const uint8_t* payload,
+                   uint8_t payload_length);
+
+// Substitui lora_link_receive() para os quadros recebidos: trata os ACKs,
+// confirma os dados que pedem ACK e devolve LORA_LINK_RX_NEW só para dados
+// inéditos (ACKs retornam LORA_LINK_RX_OTHER)
+lora_link_rx_result_t lora_arq_receive(lora_arq_t* arq, const uint8_t* frame, uint8_t length,
+                                       lora_link_header_t* header, const uint8_t** payload,
+                                       uint8_t* payload_length);
+
+// Retransmite os quadros vencidos - deve ser chamada em loop
+void lora_arq_service(lora_arq_t* arq);
+
+// Quadros aguardando confirmação
+uint8_t lora_arq_in_flight(const lora_arq_t* arq);
+
+// Timeout (us) que um quadro de payload_length bytes receberia agora, sem back-off
+uint32_t lora_arq_timeout_us(const lora_arq_t* arq, uint8_t payload_length);
+
+// Payload confirmado por segundo desde lora_arq_init(), em bits/s
+uint32_t lora_arq_goodput_bps(const lora_arq_t* arq);
+
+const lora_arq_counters_t* lora_arq_counters(const lora_arq_t* arq);
+
+#endif // LORA_ARQ_H
@@ -0,0 +1,115 @@
+#include "lora_channels.h"
+#include <string.h>
+
+// ============================================================================
+// Funções Privadas
+// ============================================================================
+
+/* Mistura de 32 bits (finalizador do tipo murmur): entradas vizinhas viram
+   estados sem relação aparente */
+static uint32_t channels_mix(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7FEB352D;
+    x ^= x >> 15;
+    x *= 0x846CA68B;
+    x ^= x >> 16;
+    return x;
+}
+
+/* Ordem dos canais no ciclo: Fisher-Yates com um xorshift32 semeado pela
+   semente da rede e pelo número do ciclo */
+static void channels_shuffle(lora_channels_t* channels, uint32_t cycle) {
+    uint8_t count = channels->plan.count;
+    uint32_t x = channels_mix(channels->seed ^ channels_mix(cycle)) | 1;
+    for (uint8_t i = 0; i < count; i++) {
+        channels->order[i] = i;
+    }
+    for (uint8_t i = count - 1; i > 0; i--) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        uint8_t j = (uint8_t)(x % (i + 1));
+        uint8_t swap = channels->order[i];
+        channels->order[i] = channels->order[j];
+        channels->order[j] = swap;
+    }
+    channels->cycle = cycle;
+    channels->order_valid = true;
+}
+
+// ============================================================================
+// Implementação das Funções Públicas
+// ============================================================================
+
+bool lora_channels_init(lora_channels_t* channels, rfm95_t* radio, const lora_channel_plan_t* plan,
+                        uint32_t seed) {
+    if (plan->count == 0 || plan->count > LORA_CHANNELS_MAX) return false;
+    memset(channels, 0, sizeof(*channels));
+    channels->radio = radio;
+    channels->plan = *plan;
+    channels->seed = seed;
+    for (uint8_t i = 0; i < plan->count; i++) {
+        channels->frf[i] = lora_frf(plan->first_hz + (uint32_t)i * plan->spacing_hz);
+    }
+    return true;
+}
+
+uint8_t lora_channels_count(const lora_channels_t* channels) {
+    return channels->plan.count;
+}
+
+uint32_t lora_channels_frequency(const lora_channels_t* channels, uint8_t index) {
+    return channels->plan.first_hz + (uint32_t)index * channels->plan.spacing_hz;
+}
+
+const lora_frf_t* lora_channels_frf(const lora_channels_t* channels, uint8_t index) {
+    return &channels->frf[index % channels->plan.count];
+}
+
+/* A ordem só é refeita na virada de ciclo (N trocas para N quadros) */
+uint8_t lora_channels_for(lora_channels_t* channels, uint32_t sequence) {
+    uint32_t cycle = sequence / channels->plan.count;
+    if (!channels->order_valid || channels->cycle != cycle) {
+        channels_shuffle(channels, cycle);
+    }
+    return channels->order[sequence % channels->plan.count];
+}
+
+bool lora_channels_send(lora_channels_t* channels, uint32_t sequence, const uint8_t* frame,
+                        uint8_t length, lora_priority_t priority) {
+    uint8_t index = lora_channels_for(channels, sequence);
+    if (!rfm95_tx_enqueue_channel(channels->radio, frame, length, priority, &channels->frf[index])) {
+        channels->counters.rejected++;
+        return false;
+    }
+    channels->counters.frames++;
+    return true;
+}
+
+void lora_channels_follow(lora_channels_t* channels, uint32_t sequence) {
+    channels->current = lora_channels_for(channels, sequence);
+    rfm95_set_channel(channels->radio, &channels->frf[channels->current]);
+    channels->counters.follows++;
+}
+
+int lora_channels_scan(lora_channels_t* channels, uint8_t rounds) {
+    uint8_t count = channels->plan.count;
+    channels->counters.scans++;
+    for (uint16_t step = 1; step <= (uint16_t)rounds * count; step++) {
+        uint8_t index = (uint8_t)((channels->current + step) % count);
+        rfm95_set_channel(channels->radio, &channels->frf[index]);
+        lora_cad_result_t result = rfm95_cad(channels->radio);
+        if (result == LORA_CAD_DETECTED) {
+            channels->current = index;
+            channels->counters.scan_hits++;
+            return index;
+        }
+        if (result == LORA_CAD_BUSY) break;
+    }
+    rfm95_set_channel(channels->radio, &channels->frf[channels->current]);
+    return -1;
+}
+
+const lora_channels_counters_t* lora_channels_counters(const lora_channels_t* channels) {
+    return &channels->counters;
+}
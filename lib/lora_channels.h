@@ -0,0 +1,93 @@
+// lora_channels.h
+// Plano de canais e salto de frequência por quadro. Os canais do plano são
+// convertidos uma única vez para os registradores FRF (lora_frf_t), então
+// trocar de canal custa só uma rajada de três bytes no rádio. O canal de cada
+// quadro sai do seu número de sequência e de uma semente comum à rede: a cada
+// ciclo de N quadros os N canais são usados uma vez cada, em uma ordem
+// pseudoaleatória diferente por ciclo (uso uniforme, como pedem as regras de
+// salto de frequência em 902-928 MHz). O receptor segue a sequência, se sabe
+// o próximo número (ex: a sequência de lora_link), ou procura o transmissor
+// com CAD canal a canal.
+#ifndef LORA_CHANNELS_H
+#define LORA_CHANNELS_H
+
+#include "rfm95_lora.h"
+
+// Canais de um plano (limite de memória da tabela e da ordem de cada ciclo)
+#ifndef LORA_CHANNELS_MAX
+#define LORA_CHANNELS_MAX 64
+#endif
+
+// Canais igualmente espaçados a partir de first_hz
+typedef struct {
+    uint32_t first_hz;
+    uint32_t spacing_hz;
+    uint8_t count;
+} lora_channel_plan_t;
+
+// Sub-bandas de 8 canais de 125 kHz dos planos LoRaWAN (n = 1 a 8). O AU915
+// (915,2 MHz + 200 kHz por canal) é o usado no Brasil; o US915 começa em 902,3 MHz
+#define LORA_PLAN_AU915_SUBBAND(n) { 915200000 + ((n) - 1) * 1600000, 200000, 8 }
+#define LORA_PLAN_US915_SUBBAND(n) { 902300000 + ((n) - 1) * 1600000, 200000, 8 }
+
+// Os 64 canais de 125 kHz e os 8 de 500 kHz (modem com LORA_BW_500K)
+#define LORA_PLAN_AU915_125K { 915200000, 200000, 64 }
+#define LORA_PLAN_US915_125K { 902300000, 200000, 64 }
+#define LORA_PLAN_AU915_500K { 915900000, 1600000, 8 }
+#define LORA_PLAN_US915_500K { 903000000, 1600000, 8 }
+
+typedef struct {
+    uint32_t frames;           // quadros aceitos pela fila do driver
+    uint32_t rejected;         // fila do driver cheia
+    uint32_t follows;          // receptor sintonizado pela sequência
+    uint32_t scans;
+    uint32_t scan_hits;        // varreduras que acharam um preâmbulo
+} lora_channels_counters_t;
+
+typedef struct {
+    rfm95_t* radio;
+    lora_channel_plan_t plan;
+    lora_frf_t frf[LORA_CHANNELS_MAX];
+    uint32_t seed;
+    uint32_t cycle;            // ciclo da ordem abaixo
+    bool order_valid;
+    uint8_t order[LORA_CHANNELS_MAX];
+    uint8_t current;           // canal em que o receptor escuta
+    lora_channels_counters_t counters;
+} lora_channels_t;
+
+// Calcula a tabela FRF do plano para o rádio (rfm95_radio(0) é a instância
+// padrão); seed deve ser igual em toda a rede. Retorna false se o plano não
+// tem canais ou passa de LORA_CHANNELS_MAX
+bool lora_channels_init(lora_channels_t* channels, rfm95_t* radio, const lora_channel_plan_t* plan,
+                        uint32_t seed);
+
+uint8_t lora_channels_count(const lora_channels_t* channels);
+
+// Frequência (Hz) e registradores do canal index
+uint32_t lora_channels_frequency(const lora_channels_t* channels, uint8_t index);
+const lora_frf_t* lora_channels_frf(const lora_channels_t* channels, uint8_t index);
+
+// Canal do quadro de número sequence (mesmo resultado nos dois lados)
+uint8_t lora_channels_for(lora_channels_t* channels, uint32_t sequence);
+
+// Envia o quadro pela fila do rádio no canal de sequence; o rádio volta ao
+// canal base depois. Retorna false se a fila recusou o quadro
+bool lora_channels_send(lora_channels_t* channels, uint32_t sequence, const uint8_t* frame,
+                        uint8_t length, lora_priority_t priority);
+
+// Receptor: passa a escutar no canal do quadro sequence (ex: o seguinte ao
+// último recebido)
+void lora_channels_follow(lora_channels_t* channels, uint32_t sequence);
+
+// Procura um preâmbulo com rfm95_cad() em cada canal, a partir do seguinte ao
+// atual, por até rounds voltas. Retorna o canal (o rádio fica escutando nele)
+// ou -1 se nada foi detectado ou o rádio está ocupado (ele volta ao canal atual).
+// Cada CAD leva cerca de dois símbolos: o preâmbulo do transmissor precisa
+// cobrir uma volta, perto de 2 x N símbolos mais a margem de
+// rfm95_cad_preamble_length()
+int lora_channels_scan(lora_channels_t* channels, uint8_t rounds);
+
+const lora_channels_counters_t* lora_channels_counters(const lora_channels_t* channels);
+
+#endif // LORA_CHANNELS_H
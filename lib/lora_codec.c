@@ -0,0 +1,337 @@
+#include "lora_codec.h"
+#include <string.h>
+
+// Controle do LZ: 0x00-0x7F = (n + 1) literais em seguida;
+// 0x80-0xFF = cópia de (n & 0x7F) + 3 bytes, seguida de (distância - 1)
+#define LZ_MATCH_FLAG   0x80
+#define LZ_MIN_MATCH    3
+#define LZ_MAX_MATCH    (0x7F + LZ_MIN_MATCH)
+#define LZ_MAX_LITERALS 128
+#define LZ_MAX_DISTANCE 256
+#define LZ_HASH_BITS    6
+#define LZ_EMPTY        0xFFFF
+
+#define VARINT_MAX_BYTES 5
+#define BODY_MAX (LORA_CODEC_MAX_FIELDS * VARINT_MAX_BYTES)
+
+// ============================================================================
+// Funções Privadas
+// ============================================================================
+
+static uint8_t lz_hash(const uint8_t* p) {
+    uint32_t v = p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16);
+    return (uint8_t)((v * 2654435761u) >> (32 - LZ_HASH_BITS));
+}
+
+/* Copia literais em blocos de até LZ_MAX_LITERALS; false se não couber */
+static bool lz_literals(lora_codec_writer_t* out, const uint8_t* in, uint8_t count) {
+    while (count) {
+        uint8_t run = count > LZ_MAX_LITERALS ? LZ_MAX_LITERALS : count;
+        if (out->length + 1 + run > out->capacity) return false;
+        out->data[out->length++] = run - 1;
+        memcpy(out->data + out->length, in, run);
+        out->length += run;
+        in += run;
+        count -= run;
+    }
+    return true;
+}
+
+/* Posição no anel para um novo quadro. No transmissor a referência nunca é
+   sobrescrita; no receptor um id repetido reaproveita a própria posição,
+   para a busca nunca achar uma cópia antiga do mesmo id */
+static lora_codec_snapshot_t* codec_history_slot(lora_codec_stream_t* stream, uint8_t id) {
+    for (uint8_t i = 0; i < LORA_CODEC_HISTORY; i++) {
+        if (stream->history[i].valid && stream->history[i].id == id && i != stream->reference) {
+            return &stream->history[i];
+        }
+    }
+    if (stream->history_next == stream->reference) {
+        stream->history_next = (stream->history_next + 1) % LORA_CODEC_HISTORY;
+    }
+    lora_codec_snapshot_t* slot = &stream->history[stream->history_next];
+    stream->history_next = (stream->history_next + 1) % LORA_CODEC_HISTORY;
+    return slot;
+}
+
+static int8_t codec_history_find(const lora_codec_stream_t* stream, uint8_t id) {
+    for (uint8_t i = 0; i < LORA_CODEC_HISTORY; i++) {
+        if (stream->history[i].valid && stream->history[i].id == id) return (int8_t)i;
+    }
+    return -1;
+}
+
+// ============================================================================
+// Implementação das Funções Públicas
+// ============================================================================
+
+void lora_codec_writer_init(lora_codec_writer_t* writer, uint8_t* buffer, uint8_t capacity) {
+    writer->data = buffer;
+    writer->capacity = capacity;
+    writer->length = 0;
+    writer->overflow = false;
+}
+
+void lora_codec_put_uvarint(lora_codec_writer_t* writer, uint32_t value) {
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if (value) byte |= 0x80;
+        if (writer->length >= writer->capacity) {
+            writer->overflow = true;
+            return;
+        }
+        writer->data[writer->length++] = byte;
+    } while (value);
+}
+
+void lora_codec_put_svarint(lora_codec_writer_t* writer, int32_t value) {
+    lora_codec_put_uvarint(writer, lora_codec_zigzag(value));
+}
+
+void lora_codec_reader_init(lora_codec_reader_t* reader, const uint8_t* data, uint8_t length) {
+    reader->data = data;
+    reader->length = length;
+    reader->position = 0;
+    reader->error = false;
+}
+
+uint32_t lora_codec_get_uvarint(lora_codec_reader_t* reader) {
+    uint32_t value = 0;
+    for (uint8_t shift = 0; shift < 7 * VARINT_MAX_BYTES; shift += 7) {
+        if (reader->position >= reader->length) break;
+        uint8_t byte = reader->data[reader->position++];
+        if (shift == 28 && (byte & 0x70)) break;        // passaria de 32 bits
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    reader->error = true;
+    return 0;
+}
+
+int32_t lora_codec_get_svarint(lora_codec_reader_t* reader) {
+    return lora_codec_unzigzag(lora_codec_get_uvarint(reader));
+}
+
+uint32_t lora_codec_zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+int32_t lora_codec_unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+uint8_t lora_codec_lz_compress(const uint8_t* in, uint8_t length, uint8_t* out, uint8_t capacity) {
+    uint16_t table[1 << LZ_HASH_BITS];
+    memset(table, 0xFF, sizeof(table));
+    lora_codec_writer_t writer;
+    lora_codec_writer_init(&writer, out, capacity);
+
+    uint16_t literal_start = 0;
+    uint16_t i = 0;
+    while (i + LZ_MIN_MATCH <= length) {
+        uint8_t h = lz_hash(in + i);
+        uint16_t candidate = table[h];
+        table[h] = i;
+        if (candidate == LZ_EMPTY || i - candidate > LZ_MAX_DISTANCE ||
+            memcmp(in + candidate, in + i, LZ_MIN_MATCH) != 0) {
+            i++;
+            continue;
+        }
+
+        // Estende a cópia; pode sobrepor a posição atual (distância < tamanho)
+        uint16_t match = LZ_MIN_MATCH;
+        while (match < LZ_MAX_MATCH && i + match < length && in[candidate + match] == in[i + match]) {
+            match++;
+        }
+        if (!lz_literals(&writer, in + literal_start, (uint8_t)(i - literal_start))) return 0;
+        if (writer.length + 2 > capacity) return 0;
+        writer.data[writer.length++] = LZ_MATCH_FLAG | (uint8_t)(match - LZ_MIN_MATCH);
+        writer.data[writer.length++] = (uint8_t)(i - candidate - 1);
+
+        for (uint16_t j = i + 1; j < i + match && j + LZ_MIN_MATCH <= length; j++) {
+            table[lz_hash(in + j)] = j;
+        }
+        i += match;
+        literal_start = i;
+    }
+    if (!lz_literals(&writer, in + literal_start, (uint8_t)(length - literal_start))) return 0;
+    return writer.length;
+}
+
+int lora_codec_lz_decompress(const uint8_t* in, uint8_t length, uint8_t* out, uint8_t capacity) {
+    uint16_t i = 0;
+    uint16_t produced = 0;
+    while (i < length) {
+        uint8_t control = in[i++];
+        if (control & LZ_MATCH_FLAG) {
+            if (i >= length) return -1;
+            uint16_t count = (control & 0x7F) + LZ_MIN_MATCH;
+            uint16_t distance = in[i++] + 1;
+            if (distance > produced || produced + count > capacity) return -1;
+            for (uint16_t j = 0; j < count; j++, produced++) {
+                out[produced] = out[produced - distance];
+            }
+        } else {
+            uint16_t count = control + 1;
+            if (i + count > length || produced + count > capacity) return -1;
+            memcpy(out + produced, in + i, count);
+            i += count;
+            produced += count;
+        }
+    }
+    return produced;
+}
+
+void lora_codec_stream_init(lora_codec_stream_t* stream, uint8_t field_count, bool use_lz) {
+    memset(stream, 0, sizeof(*stream));
+    stream->field_count = field_count;
+    stream->use_lz = use_lz;
+    stream->reference = -1;
+}
+
+uint8_t lora_codec_encode(lora_codec_stream_t* stream, const int32_t* values, uint8_t* out,
+                          uint8_t capacity, uint8_t* id) {
+    uint8_t count = stream->field_count;
+    if (count == 0 || count > LORA_CODEC_MAX_FIELDS) return 0;
+
+    const int32_t* reference = NULL;
+    if (stream->reference >= 0 && stream->since_keyframe < LORA_CODEC_KEYFRAME_INTERVAL) {
+        reference = stream->history[stream->reference].values;
+    }
+
+    // Diferenças em aritmética módulo 2^32: o receptor soma de volta sem estouro
+    uint8_t body[BODY_MAX];
+    lora_codec_writer_t writer;
+    lora_codec_writer_init(&writer, body, sizeof(body));
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t value = (uint32_t)values[i];
+        if (reference) value -= (uint32_t)reference[i];
+        lora_codec_put_svarint(&writer, (int32_t)value);
+    }
+
+    const uint8_t* payload = body;
+    uint8_t payload_length = writer.length;
+    uint8_t flags = reference ? LORA_CODEC_FLAG_DELTA : 0;
+    uint8_t packed[LORA_CODEC_LZ_BOUND(BODY_MAX)];
+    if (stream->use_lz) {
+        uint8_t packed_length = lora_codec_lz_compress(body, writer.length, packed, sizeof(packed));
+        if (packed_length && packed_length < payload_length) {
+            payload = packed;
+            payload_length = packed_length;
+            flags |= LORA_CODEC_FLAG_LZ;
+        }
+    }
+
+    uint8_t header = reference ? LORA_CODEC_DELTA_HEADER_SIZE : LORA_CODEC_HEADER_SIZE;
+    if (header + payload_length > capacity) return 0;
+    uint8_t frame_id = stream->next_id++;
+    out[0] = flags | (uint8_t)(count - 1);
+    out[1] = frame_id;
+    if (reference) out[2] = stream->history[stream->reference].id;
+    memcpy(out + header, payload, payload_length);
+
+    lora_codec_snapshot_t* slot = codec_history_slot(stream, frame_id);
+    slot->valid = true;
+    slot->id = frame_id;
+    memcpy(slot->values, values, count * sizeof(int32_t));
+
+    if (reference) {
+        stream->since_keyframe++;
+        stream->counters.delta_frames++;
+    } else {
+        stream->since_keyframe = 0;
+        stream->counters.keyframes++;
+    }
+    if (flags & LORA_CODEC_FLAG_LZ) stream->counters.lz_frames++;
+    stream->counters.frames++;
+    stream->counters.raw_bytes += count * sizeof(int32_t);
+    stream->counters.encoded_bytes += header + payload_length;
+
+    if (id) *id = frame_id;
+    return header + payload_length;
+}
+
+void lora_codec_ack(lora_codec_stream_t* stream, uint8_t id) {
+    int8_t index = codec_history_find(stream, id);
+    if (index < 0) return;
+    if (stream->reference >= 0 && (int8_t)(id - stream->history[stream->reference].id) <= 0) return;
+    stream->reference = index;
+}
+
+void lora_codec_stream_reset(lora_codec_stream_t* stream) {
+    for (uint8_t i = 0; i < LORA_CODEC_HISTORY; i++) {
+        stream->history[i].valid = false;
+    }
+    stream->reference = -1;
+    stream->since_keyframe = 0;
+}
+
+lora_codec_result_t lora_codec_decode(lora_codec_stream_t* stream, const uint8_t* frame, uint8_t length,
+                                      int32_t* values) {
+    if (length < LORA_CODEC_HEADER_SIZE || (frame[0] & 0x0F) + 1 != stream->field_count) {
+        stream->counters.malformed++;
+        return LORA_CODEC_MALFORMED;
+    }
+    bool delta = frame[0] & LORA_CODEC_FLAG_DELTA;
+    uint8_t header = delta ? LORA_CODEC_DELTA_HEADER_SIZE : LORA_CODEC_HEADER_SIZE;
+    if (length < header) {
+        stream->counters.malformed++;
+        return LORA_CODEC_MALFORMED;
+    }
+
+    const int32_t* reference = NULL;
+    if (delta) {
+        int8_t index = codec_history_find(stream, frame[2]);
+        if (index < 0) {
+            stream->counters.no_reference++;
+            return LORA_CODEC_NO_REFERENCE;
+        }
+        reference = stream->history[index].values;
+    }
+
+    const uint8_t* body = frame + header;
+    uint8_t body_length = length - header;
+    uint8_t unpacked[BODY_MAX];
+    if (frame[0] & LORA_CODEC_FLAG_LZ) {
+        int unpacked_length = lora_codec_lz_decompress(body, body_length, unpacked, sizeof(unpacked));
+        if (unpacked_length < 0) {
+            stream->counters.malformed++;
+            return LORA_CODEC_MALFORMED;
+        }
+        body = unpacked;
+        body_length = (uint8_t)unpacked_length;
+    }
+
+    // Decodifica num buffer local: a referência pode ser o próprio values
+    int32_t decoded[LORA_CODEC_MAX_FIELDS];
+    lora_codec_reader_t reader;
+    lora_codec_reader_init(&reader, body, body_length);
+    for (uint8_t i = 0; i < stream->field_count; i++) {
+        uint32_t value = (uint32_t)lora_codec_get_svarint(&reader);
+        if (reference) value += (uint32_t)reference[i];
+        decoded[i] = (int32_t)value;
+    }
+    if (reader.error || reader.position != reader.length) {
+        stream->counters.malformed++;
+        return LORA_CODEC_MALFORMED;
+    }
+
+    lora_codec_snapshot_t* slot = codec_history_slot(stream, frame[1]);
+    slot->valid = true;
+    slot->id = frame[1];
+    memcpy(slot->values, decoded, stream->field_count * sizeof(int32_t));
+    memcpy(values, decoded, stream->field_count * sizeof(int32_t));
+
+    if (delta) stream->counters.delta_frames++;
+    else stream->counters.keyframes++;
+    if (frame[0] & LORA_CODEC_FLAG_LZ) stream->counters.lz_frames++;
+    stream->counters.frames++;
+    stream->counters.raw_bytes += stream->field_count * sizeof(int32_t);
+    stream->counters.encoded_bytes += length;
+    return LORA_CODEC_OK;
+}
+
+const lora_codec_counters_t* lora_codec_counters(const lora_codec_stream_t* stream) {
+    return &stream->counters;
+}
@@ -0,0 +1,135 @@
+// lora_codec.h
+// Codec de payload para quadros de telemetria, com memória fixa e sem
+// alocação. Os inteiros são empacotados como varint (7 bits por byte) e os
+// com sinal passam antes por zigzag, então valores pequenos ocupam um byte.
+// Um fluxo (lora_codec_stream_t) envia um vetor de campos por quadro, em
+// delta contra o último quadro confirmado pelo receptor; o corpo do quadro
+// ainda passa por um compressor LZ simples quando isso economiza bytes.
+#ifndef LORA_CODEC_H
+#define LORA_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Campos por quadro de um fluxo (no máximo 16, cabem no nibble do cabeçalho)
+#ifndef LORA_CODEC_MAX_FIELDS
+#define LORA_CODEC_MAX_FIELDS 8
+#endif
+
+// Quadros lembrados por fluxo: no transmissor, os enviados ainda sem ACK;
+// no receptor, os últimos decodificados que podem servir de referência.
+// Deve ser maior que o número de quadros em voo (ex: LORA_ARQ_WINDOW)
+#ifndef LORA_CODEC_HISTORY
+#define LORA_CODEC_HISTORY 8
+#endif
+
+// Quadro completo depois de N deltas seguidos, para um receptor reiniciado
+// voltar a decodificar mesmo sem referência
+#ifndef LORA_CODEC_KEYFRAME_INTERVAL
+#define LORA_CODEC_KEYFRAME_INTERVAL 16
+#endif
+
+// Formato: [flags | campos - 1][id][referência, só em delta][corpo...]
+// O corpo são os campos (ou as diferenças) em zigzag varint, comprimido se
+// LORA_CODEC_FLAG_LZ estiver presente
+#define LORA_CODEC_FLAG_LZ     0x80
+#define LORA_CODEC_FLAG_DELTA  0x40
+#define LORA_CODEC_HEADER_SIZE 2
+#define LORA_CODEC_DELTA_HEADER_SIZE 3
+
+// Pior caso do compressor: um byte de controle a cada 128 literais
+#define LORA_CODEC_LZ_BOUND(length) ((length) + ((length) + 127) / 128)
+
+// Escrita sequencial com limite; overflow fica marcado e nada passa do limite
+typedef struct {
+    uint8_t* data;
+    uint8_t capacity;
+    uint8_t length;
+    bool overflow;
+} lora_codec_writer_t;
+
+// Leitura sequencial; error fica marcado em varint truncado, longo demais ou
+// com bits além dos 32
+typedef struct {
+    const uint8_t* data;
+    uint8_t length;
+    uint8_t position;
+    bool error;
+} lora_codec_reader_t;
+
+typedef enum {
+    LORA_CODEC_OK,
+    LORA_CODEC_MALFORMED,      // curto, truncado ou número de campos diferente
+    LORA_CODEC_NO_REFERENCE,   // delta contra um quadro que o receptor não tem
+} lora_codec_result_t;
+
+typedef struct {
+    uint32_t frames;           // codificados (transmissor) ou decodificados (receptor)
+    uint32_t keyframes;
+    uint32_t delta_frames;
+    uint32_t lz_frames;        // corpo comprimido
+    uint32_t raw_bytes;        // 4 bytes por campo, sem codec
+    uint32_t encoded_bytes;    // quadros do codec, com cabeçalho
+    uint32_t no_reference;     // receptor: deltas descartados
+    uint32_t malformed;
+} lora_codec_counters_t;
+
+typedef struct {
+    bool valid;
+    uint8_t id;
+    int32_t values[LORA_CODEC_MAX_FIELDS];
+} lora_codec_snapshot_t;
+
+typedef struct {
+    uint8_t field_count;
+    bool use_lz;
+    uint8_t next_id;
+    uint8_t since_keyframe;
+    lora_codec_snapshot_t history[LORA_CODEC_HISTORY];
+    uint8_t history_next;      // próxima posição do anel
+    int8_t reference;          // transmissor: índice do quadro confirmado mais recente (-1 = nenhum)
+    lora_codec_counters_t counters;
+} lora_codec_stream_t;
+
+// Varint sem sinal (até 5 bytes para 32 bits)
+void lora_codec_writer_init(lora_codec_writer_t* writer, uint8_t* buffer, uint8_t capacity);
+void lora_codec_put_uvarint(lora_codec_writer_t* writer, uint32_t value);
+// Zigzag: 0, -1, 1, -2... viram 0, 1, 2, 3... antes do varint
+void lora_codec_put_svarint(lora_codec_writer_t* writer, int32_t value);
+
+void lora_codec_reader_init(lora_codec_reader_t* reader, const uint8_t* data, uint8_t length);
+uint32_t lora_codec_get_uvarint(lora_codec_reader_t* reader);
+int32_t lora_codec_get_svarint(lora_codec_reader_t* reader);
+
+uint32_t lora_codec_zigzag(int32_t value);
+int32_t lora_codec_unzigzag(uint32_t value);
+
+// Compressor LZ para quadros de até 255 bytes (distância de até 256 bytes).
+// Retorna o tamanho comprimido, ou 0 se não couber em capacity
+uint8_t lora_codec_lz_compress(const uint8_t* in, uint8_t length, uint8_t* out, uint8_t capacity);
+// Retorna o tamanho descomprimido, ou -1 se a entrada for inválida ou não couber
+int lora_codec_lz_decompress(const uint8_t* in, uint8_t length, uint8_t* out, uint8_t capacity);
+
+// Prepara um fluxo com field_count campos, tanto para o transmissor quanto
+// para o receptor (cada lado tem o seu); use_lz liga o compressor
+void lora_codec_stream_init(lora_codec_stream_t* stream, uint8_t field_count, bool use_lz);
+
+// Codifica values (field_count campos) em out; o id do quadro, usado depois
+// em lora_codec_ack(), fica em *id. Retorna o tamanho ou 0 se não couber
+uint8_t lora_codec_encode(lora_codec_stream_t* stream, const int32_t* values, uint8_t* out,
+                          uint8_t capacity, uint8_t* id);
+
+// O receptor confirmou o quadro id: os próximos vão em delta contra ele
+// (ACKs atrasados de quadros mais antigos que a referência são ignorados)
+void lora_codec_ack(lora_codec_stream_t* stream, uint8_t id);
+
+// Esquece a referência: o próximo quadro sai completo
+void lora_codec_stream_reset(lora_codec_stream_t* stream);
+
+// Decodifica um quadro do fluxo em values
+lora_codec_result_t lora_codec_decode(lora_codec_stream_t* stream, const uint8_t* frame, uint8_t length,
+                                      int32_t* values);
+
+const lora_codec_counters_t* lora_codec_counters(const lora_codec_stream_t* stream);
+
+#endif // LORA_CODEC_H
@@ -0,0 +1,155 @@
+#include "lora_dutycycle.h"
+#include <string.h>
+
+// ============================================================================
+// Funções Privadas
+// ============================================================================
+
+/* Descarta da janela os intervalos que já saíram dela */
+static void dc_expire(lora_dc_t* dc, lora_dc_channel_t* ch) {
+    uint32_t now_index = (uint32_t)(hal_time_us() / 1000 / dc->bucket_ms);
+    uint32_t steps = now_index - ch->bucket_index;
+    if (steps > LORA_DC_BUCKETS) steps = LORA_DC_BUCKETS;
+    for (uint32_t i = 1; i <= steps; i++) {
+        uint32_t* bucket = &ch->bucket_us[(ch->bucket_index + i) % LORA_DC_BUCKETS];
+        ch->used_us -= *bucket;
+        *bucket = 0;
+    }
+    ch->bucket_index = now_index;
+}
+
+/* Espera (us) até airtime_us caber no orçamento do canal */
+static uint32_t dc_wait(lora_dc_t* dc, lora_dc_channel_t* ch, uint32_t airtime_us) {
+    if (airtime_us == 0 || airtime_us > dc->limits.budget_us) return LORA_DC_NEVER;
+    if (dc->limits.max_dwell_us && airtime_us > dc->limits.max_dwell_us) return LORA_DC_NEVER;
+
+    dc_expire(dc, ch);
+    uint32_t excess = ch->used_us + airtime_us;
+    if (excess <= dc->limits.budget_us) return 0;
+    excess -= dc->limits.budget_us;
+
+    // O intervalo mais antigo é o seguinte ao atual no anel; ele expira quando
+    // o índice absoluto alcançar bucket_index + k
+    uint32_t freed = 0;
+    for (uint32_t k = 1; k <= LORA_DC_BUCKETS; k++) {
+        freed += ch->bucket_us[(ch->bucket_index + k) % LORA_DC_BUCKETS];
+        if (freed >= excess) {
+            uint64_t at_us = (uint64_t)(ch->bucket_index + k) * dc->bucket_ms * 1000;
+            uint64_t now = hal_time_us();
+            uint64_t wait = at_us > now ? at_us - now : 0;
+            return wait < LORA_DC_NEVER ? (uint32_t)wait : LORA_DC_NEVER - 1;
+        }
+    }
+    return LORA_DC_NEVER;
+}
+
+/* Entrega o quadro à fila do driver, que o copia (o chamador pode reusar o
+   buffer na hora), no canal do escalonador, e debita o tempo no ar */
+static bool dc_transmit(lora_dc_t* dc, uint8_t channel, const uint8_t* buffer, uint8_t size,
+                        uint32_t airtime_us) {
+    lora_dc_channel_t* ch = &dc->channels[channel];
+    if (!rfm95_tx_enqueue_channel(dc->radio, buffer, size, LORA_PRIO_NORMAL, ch->has_frf ? &ch->frf : NULL)) {
+        return false;
+    }
+
+    ch->bucket_us[ch->bucket_index % LORA_DC_BUCKETS] += airtime_us;
+    ch->used_us += airtime_us;
+    dc->sent++;
+    return true;
+}
+
+// ============================================================================
+// Implementação das Funções Públicas
+// ============================================================================
+
+void lora_dc_init(lora_dc_t* dc, rfm95_t* radio, const lora_dc_limits_t* limits, uint8_t channel_count) {
+    memset(dc, 0, sizeof(*dc));
+    dc->radio = radio;
+    dc->limits = *limits;
+    dc->bucket_ms = limits->window_ms / LORA_DC_BUCKETS;
+    if (dc->bucket_ms == 0) dc->bucket_ms = 1;
+    dc->channel_count = channel_count > LORA_DC_MAX_CHANNELS ? LORA_DC_MAX_CHANNELS : channel_count;
+
+    uint32_t now_index = (uint32_t)(hal_time_us() / 1000 / dc->bucket_ms);
+    for (uint8_t i = 0; i < dc->channel_count; i++) {
+        dc->channels[i].bucket_index = now_index;
+    }
+}
+
+void lora_dc_set_channel_frequency(lora_dc_t* dc, uint8_t channel, uint32_t frequency) {
+    if (channel >= dc->channel_count) return;
+    dc->channels[channel].has_frf = frequency != 0;
+    dc->channels[channel].frf = lora_frf(frequency);
+}
+
+lora_dc_result_t lora_dc_send(lora_dc_t* dc, uint8_t channel, const uint8_t* buffer, uint8_t size) {
+    if (channel >= dc->channel_count) {
+        dc->rejected++;
+        return LORA_DC_REJECTED;
+    }
+    uint32_t airtime_us = rfm95_time_on_air_us(dc->radio, size);
+    uint32_t wait = dc_wait(dc, &dc->channels[channel], airtime_us);
+    if (wait == LORA_DC_NEVER) {
+        dc->rejected++;
+        return LORA_DC_REJECTED;
+    }
+
+    // Quadros anteriores do mesmo canal têm prioridade
+    bool channel_queued = false;
+    for (uint8_t i = 0; i < dc->queue_count; i++) {
+        if (dc->queue[i].channel == channel) channel_queued = true;
+    }
+    if (wait == 0 && !channel_queued && !rfm95_tx_busy(dc->radio) &&
+        dc_transmit(dc, channel, buffer, size, airtime_us)) {
+        return LORA_DC_SENT;
+    }
+
+    if (dc->queue_count >= LORA_DC_QUEUE_SIZE) {
+        dc->rejected++;
+        return LORA_DC_REJECTED;
+    }
+    lora_dc_frame_t* frame = &dc->queue[dc->queue_count++];
+    frame->channel = channel;
+    frame->length = size;
+    memcpy(frame->data, buffer, size);
+    if (wait > 0) dc->delayed++;
+    return LORA_DC_QUEUED;
+}
+
+void lora_dc_service(lora_dc_t* dc) {
+    if (dc->queue_count == 0 || rfm95_tx_busy(dc->radio)) return;
+
+    // Primeiro quadro cujo canal tem orçamento, sem ultrapassar outro do mesmo canal
+    uint32_t blocked = 0;
+    for (uint8_t i = 0; i < dc->queue_count; i++) {
+        lora_dc_frame_t* frame = &dc->queue[i];
+        if (blocked & (1u << frame->channel)) continue;
+
+        uint32_t airtime_us = rfm95_time_on_air_us(dc->radio, frame->length);
+        if (dc_wait(dc, &dc->channels[frame->channel], airtime_us) != 0) {
+            blocked |= 1u << frame->channel;
+            continue;
+        }
+        if (dc_transmit(dc, frame->channel, frame->data, frame->length, airtime_us)) {
+            dc->queue_count--;
+            memmove(frame, frame + 1, (dc->queue_count - i) * sizeof(*frame));
+        }
+        return;
+    }
+}
+
+uint32_t lora_dc_remaining_us(lora_dc_t* dc, uint8_t channel) {
+    if (channel >= dc->channel_count) return 0;
+    lora_dc_channel_t* ch = &dc->channels[channel];
+    dc_expire(dc, ch);
+    return ch->used_us < dc->limits.budget_us ? dc->limits.budget_us - ch->used_us : 0;
+}
+
+uint32_t lora_dc_wait_us(lora_dc_t* dc, uint8_t channel, uint8_t size) {
+    if (channel >= dc->channel_count) return LORA_DC_NEVER;
+    return dc_wait(dc, &dc->channels[channel], rfm95_time_on_air_us(dc->radio, size));
+}
+
+uint8_t lora_dc_pending(const lora_dc_t* dc) {
+    return dc->queue_count;
+}
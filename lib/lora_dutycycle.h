@@ -0,0 +1,95 @@
+// lora_dutycycle.h
+// Escalonador de transmissão com orçamento de tempo no ar por canal: cada canal
+// mantém uma janela deslizante (dividida em intervalos fixos) com o tempo de
+// ar já consumido; quadros que estourariam o orçamento ficam na fila até que
+// a janela libere espaço suficiente.
+#ifndef LORA_DUTYCYCLE_H
+#define LORA_DUTYCYCLE_H
+
+#include "rfm95_lora.h"
+
+#define LORA_DC_MAX_CHANNELS 8
+
+// Resolução da janela deslizante: o consumo é somado em intervalos de
+// window_ms / LORA_DC_BUCKETS e cada intervalo expira inteiro
+#define LORA_DC_BUCKETS 16
+
+// Quadros aguardando orçamento (cada um ocupa LORA_MAX_PACKET_SIZE bytes)
+#ifndef LORA_DC_QUEUE_SIZE
+#define LORA_DC_QUEUE_SIZE 4
+#endif
+
+#define LORA_DC_NEVER UINT32_MAX
+
+// Limites regulatórios aplicados a todos os canais
+typedef struct {
+    uint32_t window_ms;      // duração da janela deslizante (ex: 3600000 = 1 h)
+    uint32_t budget_us;      // tempo no ar permitido dentro da janela (1% de 1 h = 36 s)
+    uint32_t max_dwell_us;   // tempo máximo de um único quadro (0 = sem limite)
+} lora_dc_limits_t;
+
+// 1% de duty-cycle em janela de 1 hora, sem limite de dwell
+#define LORA_DC_LIMITS_1_PERCENT { 3600000, 36000000, 0 }
+
+typedef enum {
+    LORA_DC_SENT,            // entregue à fila do driver com o rádio livre (sai na hora)
+    LORA_DC_QUEUED,          // aguardando orçamento ou rádio livre
+    LORA_DC_REJECTED,        // canal inválido, fila cheia ou quadro excede o dwell
+} lora_dc_result_t;
+
+typedef struct {
+    lora_frf_t frf;                      // canal do quadro (convertido uma vez)
+    bool has_frf;                        // false: sai no canal base do rádio
+    uint32_t bucket_us[LORA_DC_BUCKETS]; // consumo de cada intervalo da janela
+    uint32_t bucket_index;               // intervalo absoluto mais recente
+    uint32_t used_us;                    // soma dos intervalos ainda na janela
+} lora_dc_channel_t;
+
+typedef struct {
+    uint8_t channel;
+    uint8_t length;
+    uint8_t data[LORA_MAX_PACKET_SIZE];
+} lora_dc_frame_t;
+
+typedef struct {
+    rfm95_t* radio;
+    lora_dc_limits_t limits;
+    uint32_t bucket_ms;
+    lora_dc_channel_t channels[LORA_DC_MAX_CHANNELS];
+    uint8_t channel_count;
+
+    lora_dc_frame_t queue[LORA_DC_QUEUE_SIZE];   // em ordem de chegada
+    uint8_t queue_count;
+
+    uint32_t sent;
+    uint32_t delayed;                    // quadros que precisaram esperar
+    uint32_t rejected;
+} lora_dc_t;
+
+// Inicializa o escalonador do rádio (rfm95_radio(0) é a instância padrão) com
+// channel_count canais, todos no canal base do rádio
+void lora_dc_init(lora_dc_t* dc, rfm95_t* radio, const lora_dc_limits_t* limits, uint8_t channel_count);
+
+// Associa uma frequência ao canal (0 volta ao canal base); os quadros dele
+// saem por rfm95_tx_enqueue_channel() e o rádio volta ao canal base depois
+void lora_dc_set_channel_frequency(lora_dc_t* dc, uint8_t channel, uint32_t frequency);
+
+// Com orçamento e o rádio livre, entrega o quadro à fila do driver (que o
+// copia) e ele sai na hora; senão copia o quadro para a fila do escalonador
+// (a ordem de envio por canal é preservada). O tempo no ar é o do modem atual
+lora_dc_result_t lora_dc_send(lora_dc_t* dc, uint8_t channel, const uint8_t* buffer, uint8_t size);
+
+// Envia o próximo quadro da fila quando possível - deve ser chamada em loop
+void lora_dc_service(lora_dc_t* dc);
+
+// Tempo no ar (us) ainda disponível na janela do canal
+uint32_t lora_dc_remaining_us(lora_dc_t* dc, uint8_t channel);
+
+// Espera (us) até um quadro de size bytes caber no orçamento do canal
+// (0 = imediatamente, LORA_DC_NEVER = nunca cabe)
+uint32_t lora_dc_wait_us(lora_dc_t* dc, uint8_t channel, uint8_t size);
+
+// Número de quadros na fila
+uint8_t lora_dc_pending(const lora_dc_t* dc);
+
+#endif // LORA_DUTYCYCLE_H
@@ -0,0 +1,450 @@
+#include "lora_fec.h"
+#include <string.h>
+
+#if defined(HAL_HOST_BUILD) && defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+#define GF_POLY 0x11D
+
+// Pontos da matriz de Cauchy: coluna i (dado) = i, linha j (reparo) = 0x80 | j.
+// Como os conjuntos são disjuntos, toda submatriz quadrada é inversível
+#define CAUCHY_ROW_BASE 0x80
+
+static uint8_t gf_exp[512];
+static uint8_t gf_log[256];
+static bool gf_ready = false;
+
+// ============================================================================
+// Funções Privadas
+// ============================================================================
+
+/* Monta as tabelas de log/exp do gerador 2; exp é duplicada para dispensar o módulo 255 */
+static void gf_init() {
+    if (gf_ready) return;
+    uint16_t x = 1;
+    for (uint16_t i = 0; i < 255; i++) {
+        gf_exp[i] = (uint8_t)x;
+        gf_log[x] = (uint8_t)i;
+        x <<= 1;
+        if (x & 0x100) x ^= GF_POLY;
+    }
+    for (uint16_t i = 255; i < 512; i++) {
+        gf_exp[i] = gf_exp[i - 255];
+    }
+    gf_ready = true;
+}
+
+static uint8_t fec_coefficient(uint8_t repair, uint8_t data) {
+    return lora_fec_gf_inv((CAUCHY_ROW_BASE | repair) ^ data);
+}
+
+static uint8_t fec_popcount(uint16_t bits) {
+    uint8_t count = 0;
+    for (; bits; bits &= bits - 1) count++;
+    return count;
+}
+
+/* Inverte a matriz n x n em GF(256) por Gauss-Jordan (Cauchy: sempre inversível) */
+static void fec_invert(uint8_t matrix[LORA_FEC_MAX_M][LORA_FEC_MAX_M],
+                       uint8_t inverse[LORA_FEC_MAX_M][LORA_FEC_MAX_M], uint8_t n) {
+    for (uint8_t r = 0; r < n; r++) {
+        for (uint8_t c = 0; c < n; c++) inverse[r][c] = r == c;
+    }
+    for (uint8_t col = 0; col < n; col++) {
+        uint8_t pivot = col;
+        while (matrix[pivot][col] == 0) pivot++;
+        if (pivot != col) {
+            for (uint8_t c = 0; c < n; c++) {
+                uint8_t t = matrix[col][c]; matrix[col][c] = matrix[pivot][c]; matrix[pivot][c] = t;
+                t = inverse[col][c]; inverse[col][c] = inverse[pivot][c]; inverse[pivot][c] = t;
+            }
+        }
+        uint8_t scale = lora_fec_gf_inv(matrix[col][col]);
+        for (uint8_t c = 0; c < n; c++) {
+            matrix[col][c] = lora_fec_gf_mul(matrix[col][c], scale);
+            inverse[col][c] = lora_fec_gf_mul(inverse[col][c], scale);
+        }
+        for (uint8_t r = 0; r < n; r++) {
+            uint8_t factor = matrix[r][col];
+            if (r == col || factor == 0) continue;
+            for (uint8_t c = 0; c < n; c++) {
+                matrix[r][c] ^= lora_fec_gf_mul(factor, matrix[col][c]);
+                inverse[r][c] ^= lora_fec_gf_mul(factor, inverse[col][c]);
+            }
+        }
+    }
+}
+
+/* Soma o fragmento de dados index (tamanho + quadro) aos reparos do grupo */
+static void fec_accumulate(lora_fec_encoder_t* encoder, uint8_t index, const uint8_t* frame, uint8_t length) {
+    // Os reparos só crescem até o maior fragmento; o trecho novo começa zerado
+    uint8_t shard = length + 1;
+    if (shard > encoder->shard_size) {
+        for (uint8_t j = 0; j < encoder->m; j++) {
+            memset(encoder->repair[j] + encoder->shard_size, 0, shard - encoder->shard_size);
+        }
+        encoder->shard_size = shard;
+    }
+    for (uint8_t j = 0; j < encoder->m; j++) {
+        uint8_t c = fec_coefficient(j, index);
+        encoder->repair[j][0] ^= lora_fec_gf_mul(c, length);
+        lora_fec_gf_muladd(encoder->repair[j] + 1, frame, c, length);
+    }
+}
+
+static void fec_close_group(lora_fec_encoder_t* encoder) {
+    encoder->closing = true;
+    encoder->repair_next = 0;
+    encoder->counters.groups++;
+}
+
+/* Encerra o grupo do decodificador, contabilizando os dados que não chegaram */
+static void fec_decoder_finish(lora_fec_decoder_t* decoder) {
+    if (!decoder->active || decoder->complete) return;
+    uint8_t have = fec_popcount(decoder->data_present & ((1u << decoder->k) - 1));
+    decoder->counters.unrecoverable += decoder->k - have;
+}
+
+/* O FEC não retransmite: um quadro com SYNC numa posição já ocupada do
+   grupo (ou um dado depois dos reparos) vem de um novo início do transmissor */
+static bool fec_slot_taken(const lora_fec_decoder_t* decoder, uint8_t index, uint8_t k, bool repair) {
+    if (repair) return decoder->repair_present & (1u << (index - k));
+    return (decoder->data_present & (1u << index)) || decoder->repair_present;
+}
+
+/* Quadro de um grupo já encerrado: o dado sai pelo callback, a menos que
+   já tenha sido entregue no grupo anterior; o reparo não tem mais uso */
+static lora_fec_rx_result_t fec_receive_late(lora_fec_decoder_t* decoder, uint8_t group, uint8_t index,
+                                             bool repair, const uint8_t* frame, uint8_t size) {
+    if (repair) {
+        decoder->counters.invalid++;
+        return LORA_FEC_RX_INVALID;
+    }
+    decoder->counters.data_frames++;
+    if (group == decoder->previous_group) {
+        if (decoder->previous_present & (1u << index)) {
+            decoder->counters.duplicates++;
+            return LORA_FEC_RX_STORED;
+        }
+        decoder->previous_present |= 1u << index;
+    }
+    decoder->counters.late++;
+    if (decoder->callback) {
+        decoder->callback(frame, size, false);
+    }
+    return LORA_FEC_RX_DATA;
+}
+
+/* Reconstrói os dados ausentes se já há fragmentos suficientes */
+static bool fec_try_decode(lora_fec_decoder_t* decoder) {
+    if (decoder->complete) return false;
+    uint16_t mask = (1u << decoder->k) - 1;
+    uint8_t have = fec_popcount(decoder->data_present & mask);
+    if (have == decoder->k) {
+        decoder->complete = decoder->k_exact;   // sem reparo, k pode ainda diminuir
+        return false;
+    }
+    if (!decoder->k_exact || have + fec_popcount(decoder->repair_present) < decoder->k) return false;
+
+    uint8_t missing[LORA_FEC_MAX_M];
+    uint8_t rows[LORA_FEC_MAX_M];
+    uint8_t e = 0;
+    for (uint8_t i = 0; i < decoder->k; i++) {
+        if (!(decoder->data_present & (1u << i))) missing[e++] = i;
+    }
+    for (uint8_t j = 0, r = 0; r < e; j++) {
+        if (decoder->repair_present & (1u << j)) rows[r++] = j;
+    }
+
+    // Síndromes: tira de cada reparo a contribuição dos dados presentes
+    // (o zero do preenchimento não contribui, basta o tamanho de cada um)
+    for (uint8_t r = 0; r < e; r++) {
+        for (uint8_t i = 0; i < decoder->k; i++) {
+            if (!(decoder->data_present & (1u << i))) continue;
+            lora_fec_gf_muladd(decoder->repair[rows[r]], decoder->data[i],
+                               fec_coefficient(rows[r], i), decoder->length[i] + 1);
+        }
+    }
+
+    uint8_t matrix[LORA_FEC_MAX_M][LORA_FEC_MAX_M];
+    uint8_t inverse[LORA_FEC_MAX_M][LORA_FEC_MAX_M];
+    for (uint8_t r = 0; r < e; r++) {
+        for (uint8_t c = 0; c < e; c++) matrix[r][c] = fec_coefficient(rows[r], missing[c]);
+    }
+    fec_invert(matrix, inverse, e);
+
+    decoder->complete = true;
+    for (uint8_t c = 0; c < e; c++) {
+        uint8_t* shard = decoder->data[missing[c]];
+        memset(shard, 0, decoder->shard_size);
+        for (uint8_t r = 0; r < e; r++) {
+            lora_fec_gf_muladd(shard, decoder->repair[rows[r]], inverse[c][r], decoder->shard_size);
+        }
+        decoder->data_present |= 1u << missing[c];
+        if (shard[0] >= decoder->shard_size) {
+            decoder->counters.invalid++;       // reparo corrompido: tamanho impossível
+            continue;
+        }
+        decoder->length[missing[c]] = shard[0];
+        decoder->counters.recovered++;
+        if (decoder->callback) {
+            decoder->callback(shard + 1, shard[0], true);
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Implementação das Funções Públicas
+// ============================================================================
+
+uint8_t lora_fec_gf_mul(uint8_t a, uint8_t b) {
+    if (a == 0 || b == 0) return 0;
+    gf_init();
+    return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+uint8_t lora_fec_gf_inv(uint8_t a) {
+    if (a == 0) return 0;
+    gf_init();
+    return gf_exp[255 - gf_log[a]];
+}
+
+#if defined(HAL_HOST_BUILD) && defined(__SSSE3__)
+
+/* Host com SSSE3: c * x = tabela(nibble baixo) ^ tabela(nibble alto), 16 bytes por pshufb */
+void lora_fec_gf_muladd(uint8_t* dst, const uint8_t* src, uint8_t c, uint16_t length) {
+    if (c == 0) return;
+    uint8_t low[16], high[16];
+    for (uint8_t i = 0; i < 16; i++) {
+        low[i] = lora_fec_gf_mul(c, i);
+        high[i] = lora_fec_gf_mul(c, (uint8_t)(i << 4));
+    }
+    __m128i table_low = _mm_loadu_si128((const __m128i*)low);
+    __m128i table_high = _mm_loadu_si128((const __m128i*)high);
+    __m128i nibble = _mm_set1_epi8(0x0F);
+
+    uint16_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i lo = _mm_shuffle_epi8(table_low, _mm_and_si128(x, nibble));
+        __m128i hi = _mm_shuffle_epi8(table_high, _mm_and_si128(_mm_srli_epi64(x, 4), nibble));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_xor_si128(d, _mm_xor_si128(lo, hi)));
+    }
+    for (; i < length; i++) {
+        dst[i] ^= low[src[i] & 0x0F] ^ high[src[i] >> 4];
+    }
+}
+
+#elif defined(HAL_HOST_BUILD)
+
+/* Host sem SSSE3: 8 bytes por palavra de 64 bits, somando x * 2^b para cada bit de c */
+void lora_fec_gf_muladd(uint8_t* dst, const uint8_t* src, uint8_t c, uint16_t length) {
+    if (c == 0) return;
+    uint16_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t x, d, product = 0;
+        memcpy(&x, src + i, 8);
+        for (uint8_t bits = c; bits; bits >>= 1) {
+            if (bits & 1) product ^= x;
+            uint64_t carry = (x >> 7) & 0x0101010101010101ull;
+            x = ((x & 0x7F7F7F7F7F7F7F7Full) << 1) ^ (carry * (GF_POLY & 0xFF));
+        }
+        memcpy(&d, dst + i, 8);
+        d ^= product;
+        memcpy(dst + i, &d, 8);
+    }
+    for (; i < length; i++) {
+        dst[i] ^= lora_fec_gf_mul(c, src[i]);
+    }
+}
+
+#else
+
+/* Cortex-M0+ não tem SIMD nem multiplicação sem carry: log/exp por byte */
+void lora_fec_gf_muladd(uint8_t* dst, const uint8_t* src, uint8_t c, uint16_t length) {
+    if (c == 0) return;
+    gf_init();
+    const uint8_t* exp = gf_exp + gf_log[c];
+    for (uint16_t i = 0; i < length; i++) {
+        uint8_t x = src[i];
+        if (x) dst[i] ^= exp[gf_log[x]];
+    }
+}
+
+#endif
+
+bool lora_fec_encoder_init(lora_fec_encoder_t* encoder, rfm95_t* radio, uint8_t k, uint8_t m) {
+    if (k == 0 || k > LORA_FEC_MAX_K || m == 0 || m > LORA_FEC_MAX_M) return false;
+    memset(encoder, 0, sizeof(*encoder));
+    encoder->radio = radio;
+    encoder->k = k;
+    encoder->m = m;
+    encoder->sync = true;
+    gf_init();
+    return true;
+}
+
+bool lora_fec_send(lora_fec_encoder_t* encoder, const uint8_t* frame, uint8_t length,
+                   lora_priority_t priority) {
+    if (length > LORA_FEC_MAX_PAYLOAD) return false;
+    lora_fec_service(encoder);
+    if (encoder->closing) return false;
+
+    uint8_t packet[LORA_MAX_PACKET_SIZE];
+    packet[0] = encoder->group;
+    packet[1] = encoder->count | (encoder->sync ? LORA_FEC_FLAG_SYNC : 0);
+    packet[2] = (uint8_t)(encoder->k << 4) | encoder->m;
+    memcpy(packet + LORA_FEC_HEADER_SIZE, frame, length);
+    if (!rfm95_tx_enqueue(encoder->radio, packet, LORA_FEC_HEADER_SIZE + length, priority)) {
+        encoder->counters.tx_rejected++;
+        return false;
+    }
+    encoder->counters.data_frames++;
+
+    fec_accumulate(encoder, encoder->count, frame, length);
+    if (++encoder->count == encoder->k) {
+        fec_close_group(encoder);
+        lora_fec_service(encoder);
+    }
+    return true;
+}
+
+void lora_fec_flush(lora_fec_encoder_t* encoder) {
+    if (encoder->closing || encoder->count == 0) return;
+    fec_close_group(encoder);
+    lora_fec_service(encoder);
+}
+
+void lora_fec_service(lora_fec_encoder_t* encoder) {
+    if (!encoder->closing) return;
+
+    uint8_t packet[LORA_MAX_PACKET_SIZE];
+    while (encoder->repair_next < encoder->m) {
+        packet[0] = encoder->group;
+        packet[1] = (encoder->count + encoder->repair_next) | (encoder->sync ? LORA_FEC_FLAG_SYNC : 0);
+        packet[2] = (uint8_t)(encoder->count << 4) | encoder->m;
+        memcpy(packet + LORA_FEC_HEADER_SIZE, encoder->repair[encoder->repair_next], encoder->shard_size);
+        uint8_t length = LORA_FEC_HEADER_SIZE + encoder->shard_size;
+        if (!rfm95_tx_enqueue(encoder->radio, packet, length, LORA_PRIO_NORMAL)) {
+            return;                                      // sem espaço: tenta na próxima chamada
+        }
+        encoder->counters.repair_frames++;
+        encoder->repair_next++;
+    }
+
+    encoder->closing = false;
+    encoder->sync = false;
+    encoder->group++;
+    encoder->count = 0;
+    encoder->shard_size = 0;
+}
+
+uint8_t lora_fec_repairs_pending(const lora_fec_encoder_t* encoder) {
+    return encoder->closing ? encoder->m - encoder->repair_next : 0;
+}
+
+void lora_fec_decoder_init(lora_fec_decoder_t* decoder, lora_fec_deliver_callback_t callback) {
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->callback = callback;
+    gf_init();
+}
+
+lora_fec_rx_result_t lora_fec_receive(lora_fec_decoder_t* decoder, const uint8_t* packet, uint8_t length) {
+    if (length < LORA_FEC_HEADER_SIZE) {
+        decoder->counters.invalid++;
+        return LORA_FEC_RX_INVALID;
+    }
+    uint8_t group = packet[0];
+    uint8_t index = packet[1] & LORA_FEC_INDEX_MASK;
+    bool sync = packet[1] & LORA_FEC_FLAG_SYNC;
+    uint8_t k = packet[2] >> 4;
+    uint8_t m = packet[2] & 0x0F;
+    uint8_t size = length - LORA_FEC_HEADER_SIZE;
+    bool repair = index >= k;
+    if (k == 0 || k > LORA_FEC_MAX_K || m == 0 || m > LORA_FEC_MAX_M || index >= k + m ||
+        (!repair && size > LORA_FEC_MAX_PAYLOAD) || (repair && size == 0)) {
+        decoder->counters.invalid++;
+        return LORA_FEC_RX_INVALID;
+    }
+
+    // Atrasado (sem SYNC, ou do primeiro grupo, que tinha SYNC): não derruba
+    // o grupo atual, mas o dado ainda é entregue
+    int8_t distance = (int8_t)(group - decoder->group);
+    if (decoder->active && distance < 0 && distance >= -LORA_FEC_REORDER_GROUPS &&
+        (!sync || (decoder->previous_synced && group == decoder->previous_group))) {
+        return fec_receive_late(decoder, group, index, repair, packet + LORA_FEC_HEADER_SIZE, size);
+    }
+    // SYNC de um grupo que não foi aberto por ele, ou salto grande para trás:
+    // o transmissor reiniciou, mesmo que o número do grupo coincida com o atual
+    bool restart = decoder->active && sync &&
+                   (!decoder->synced || group != decoder->group || fec_slot_taken(decoder, index, k, repair));
+    if (!decoder->active || group != decoder->group || restart) {
+        if (decoder->active && (restart || distance < 0)) {
+            decoder->counters.resyncs++;
+        }
+        fec_decoder_finish(decoder);
+        decoder->previous_group = decoder->group;
+        decoder->previous_synced = decoder->synced;
+        decoder->previous_present = decoder->active ? decoder->data_present : 0;
+        decoder->active = true;
+        decoder->synced = sync;
+        decoder->group = group;
+        decoder->k = k;
+        decoder->k_exact = false;
+        decoder->shard_size = 0;
+        decoder->data_present = 0;
+        decoder->repair_present = 0;
+        decoder->complete = false;
+    }
+
+    if (repair) {
+        uint8_t j = index - k;
+        if ((decoder->k_exact && k != decoder->k) || (decoder->shard_size && size != decoder->shard_size) ||
+            (decoder->data_present >> k)) {
+            decoder->counters.invalid++;
+            return LORA_FEC_RX_INVALID;
+        }
+        decoder->k = k;
+        decoder->k_exact = true;
+        decoder->shard_size = size;
+        decoder->counters.repair_frames++;
+        if (decoder->complete) return LORA_FEC_RX_STORED;   // grupo já completo, reparo sobrando
+        if (decoder->repair_present & (1u << j)) {
+            decoder->counters.duplicates++;
+            return LORA_FEC_RX_STORED;
+        }
+        memcpy(decoder->repair[j], packet + LORA_FEC_HEADER_SIZE, size);
+        decoder->repair_present |= 1u << j;
+        return fec_try_decode(decoder) ? LORA_FEC_RX_RECOVERED : LORA_FEC_RX_STORED;
+    }
+
+    if ((decoder->k_exact && index >= decoder->k) || (decoder->shard_size && size >= decoder->shard_size)) {
+        decoder->counters.invalid++;
+        return LORA_FEC_RX_INVALID;
+    }
+    decoder->counters.data_frames++;
+    if (decoder->data_present & (1u << index)) {
+        decoder->counters.duplicates++;
+        return LORA_FEC_RX_STORED;
+    }
+    decoder->data[index][0] = size;
+    memcpy(decoder->data[index] + 1, packet + LORA_FEC_HEADER_SIZE, size);
+    decoder->length[index] = size;
+    decoder->data_present |= 1u << index;
+    if (decoder->callback) {
+        decoder->callback(packet + LORA_FEC_HEADER_SIZE, size, false);
+    }
+    fec_try_decode(decoder);
+    return LORA_FEC_RX_DATA;
+}
+
+const lora_fec_tx_counters_t* lora_fec_tx_counters(const lora_fec_encoder_t* encoder) {
+    return &encoder->counters;
+}
+
+const lora_fec_rx_counters_t* lora_fec_rx_counters(const lora_fec_decoder_t* decoder) {
+    return &decoder->counters;
+}
@@ -0,0 +1,142 @@
+// lora_fec.h
+// Correção de erros por apagamento na camada de aplicação: os quadros são
+// agrupados de K em K e cada grupo ganha M quadros de reparo, combinações
+// lineares dos dados em GF(256) com coeficientes de uma matriz de Cauchy
+// (Reed-Solomon sistemático). Quaisquer K dos K+M quadros reconstroem o
+// grupo, então até M perdas (CRC inválido, colisão, fora de alcance) são
+// recuperadas sem retransmissão. Os quadros de dados saem na hora, sem
+// esperar o grupo, e chegam à aplicação assim que recebidos.
+#ifndef LORA_FEC_H
+#define LORA_FEC_H
+
+#include "rfm95_lora.h"
+
+// Limites do grupo (cada um cabe num nibble do cabeçalho, máximo 15).
+// O receptor guarda (K + M) quadros e o transmissor M reparos
+#ifndef LORA_FEC_MAX_K
+#define LORA_FEC_MAX_K 8
+#endif
+#ifndef LORA_FEC_MAX_M
+#define LORA_FEC_MAX_M 4
+#endif
+
+// Cabeçalho: [grupo][SYNC | índice: 0..K-1 dados, K..K+M-1 reparos][K << 4 | M]
+// Nos reparos K é o número real de dados do grupo (menor após lora_fec_flush())
+#define LORA_FEC_HEADER_SIZE 3
+
+// Posto pelo transmissor nos quadros do primeiro grupo após
+// lora_fec_encoder_init(): o receptor recomeça a contagem de grupos
+#define LORA_FEC_FLAG_SYNC  0x80
+#define LORA_FEC_INDEX_MASK 0x7F
+
+// Grupos para trás aceitos como atraso; um salto maior para trás (sem
+// SYNC) é tomado como transmissor reiniciado
+#ifndef LORA_FEC_REORDER_GROUPS
+#define LORA_FEC_REORDER_GROUPS 2
+#endif
+
+// O fragmento de um dado é [tamanho][quadro], completado com zeros até o
+// maior do grupo; o reparo leva um fragmento inteiro
+#define LORA_FEC_MAX_PAYLOAD (LORA_MAX_PACKET_SIZE - LORA_FEC_HEADER_SIZE - 1)
+#define LORA_FEC_SHARD_SIZE  (LORA_FEC_MAX_PAYLOAD + 1)
+
+typedef enum {
+    LORA_FEC_RX_DATA,        // quadro de dados entregue
+    LORA_FEC_RX_RECOVERED,   // reparo completou o grupo (quadros recuperados entregues)
+    LORA_FEC_RX_STORED,      // guardado (reparo ainda insuficiente, duplicata ou grupo já completo)
+    LORA_FEC_RX_INVALID,     // cabeçalho inválido ou reparo de grupo antigo
+} lora_fec_rx_result_t;
+
+// Entrega cada quadro do grupo uma única vez; recovered indica reconstrução
+typedef void (*lora_fec_deliver_callback_t)(const uint8_t* frame, uint8_t length, bool recovered);
+
+typedef struct {
+    uint32_t groups;           // grupos fechados
+    uint32_t data_frames;
+    uint32_t repair_frames;
+    uint32_t tx_rejected;      // fila do driver cheia (o quadro não foi aceito)
+} lora_fec_tx_counters_t;
+
+typedef struct {
+    uint32_t data_frames;
+    uint32_t repair_frames;
+    uint32_t recovered;        // quadros reconstruídos
+    uint32_t unrecoverable;    // quadros perdidos em grupos sem reparos suficientes
+    uint32_t duplicates;       // quadros que já tinham chegado ou sido recuperados
+    uint32_t late;             // dados de um grupo anterior, entregues fora do grupo
+    uint32_t resyncs;          // transmissor reiniciado (SYNC ou salto para trás)
+    uint32_t invalid;
+} lora_fec_rx_counters_t;
+
+typedef struct {
+    rfm95_t* radio;
+    uint8_t k;
+    uint8_t m;
+    uint8_t group;
+    uint8_t count;             // dados já enviados no grupo
+    uint8_t shard_size;        // maior fragmento do grupo
+    bool closing;              // reparos do grupo ainda saindo
+    bool sync;                 // primeiro grupo desde o init
+    uint8_t repair_next;
+    uint8_t repair[LORA_FEC_MAX_M][LORA_FEC_SHARD_SIZE];
+    lora_fec_tx_counters_t counters;
+} lora_fec_encoder_t;
+
+typedef struct {
+    bool active;
+    uint8_t group;
+    bool synced;               // grupo aberto por um quadro com SYNC
+    uint8_t previous_group;    // para descartar duplicatas atrasadas
+    bool previous_synced;
+    uint16_t previous_present;
+    uint8_t k;                 // dos dados; confirmado pelo primeiro reparo
+    bool k_exact;
+    uint8_t shard_size;        // conhecido pelo tamanho dos reparos
+    uint16_t data_present;     // bit i = dado i recebido ou recuperado
+    uint16_t repair_present;
+    bool complete;
+    uint8_t length[LORA_FEC_MAX_K];
+    uint8_t data[LORA_FEC_MAX_K][LORA_FEC_SHARD_SIZE];
+    uint8_t repair[LORA_FEC_MAX_M][LORA_FEC_SHARD_SIZE];
+    lora_fec_deliver_callback_t callback;
+    lora_fec_rx_counters_t counters;
+} lora_fec_decoder_t;
+
+// Grupos de k dados e m reparos (1 <= k <= LORA_FEC_MAX_K, 1 <= m <= LORA_FEC_MAX_M)
+// enviados pela fila do rádio (rfm95_radio(0) é a instância padrão)
+bool lora_fec_encoder_init(lora_fec_encoder_t* encoder, rfm95_t* radio, uint8_t k, uint8_t m);
+
+// Envia o quadro (ex: já codificado por lora_link) pela fila do rádio. Ao
+// completar k quadros o grupo fecha e os reparos entram na fila conforme há
+// espaço. Retorna false se a fila está cheia ou ainda há reparos pendentes;
+// nesse caso chame lora_fec_service() e tente de novo
+bool lora_fec_send(lora_fec_encoder_t* encoder, const uint8_t* frame, uint8_t length,
+                   lora_priority_t priority);
+
+// Fecha o grupo atual com menos de k quadros (tráfego esporádico)
+void lora_fec_flush(lora_fec_encoder_t* encoder);
+
+// Coloca na fila os reparos pendentes - deve ser chamada em loop
+void lora_fec_service(lora_fec_encoder_t* encoder);
+
+// Reparos ainda não aceitos pela fila do driver
+uint8_t lora_fec_repairs_pending(const lora_fec_encoder_t* encoder);
+
+void lora_fec_decoder_init(lora_fec_decoder_t* decoder, lora_fec_deliver_callback_t callback);
+
+// Processa um pacote recebido do driver; os quadros de dados (recebidos ou
+// recuperados) saem pelo callback. Um dado atrasado de um grupo anterior
+// também é entregue (só o reparo é descartado); um grupo com SYNC ou muito
+// para trás recomeça a contagem, como depois de um reinício do transmissor
+lora_fec_rx_result_t lora_fec_receive(lora_fec_decoder_t* decoder, const uint8_t* packet, uint8_t length);
+
+const lora_fec_tx_counters_t* lora_fec_tx_counters(const lora_fec_encoder_t* encoder);
+const lora_fec_rx_counters_t* lora_fec_rx_counters(const lora_fec_decoder_t* decoder);
+
+// Aritmética de GF(2^8) (polinômio 0x11D), exposta para medições
+uint8_t lora_fec_gf_mul(uint8_t a, uint8_t b);
+uint8_t lora_fec_gf_inv(uint8_t a);
+// dst[i] ^= c * src[i]: tabelas de log/exp no RP2040, vetorizada no host
+void lora_fec_gf_muladd(uint8_t* dst, const uint8_t* src, uint8_t c, uint16_t length);
+
+#endif // LORA_FEC_H
@@ -0,0 +1,153 @@
+#include "lora_link.h"
+#include <string.h>
+
+// ============================================================================
+// Funções Privadas
+// ============================================================================
+
+/* Entrada da origem na tabela; sem espaço, reaproveita a ouvida há mais tempo */
+static lora_link_source_t* link_source_slot(lora_link_t* link, uint8_t address, bool* created) {
+    *created = false;
+    for (uint8_t i = 0; i < link->source_count; i++) {
+        if (link->sources[i].address == address) return &link->sources[i];
+    }
+
+    lora_link_source_t* slot;
+    if (link->source_count < LORA_LINK_MAX_SOURCES) {
+        slot = &link->sources[link->source_count++];
+    } else {
+        slot = &link->sources[0];
+        for (uint8_t i = 1; i < LORA_LINK_MAX_SOURCES; i++) {
+            if (link->sources[i].last_rx_us < slot->last_rx_us) slot = &link->sources[i];
+        }
+    }
+    memset(slot, 0, sizeof(*slot));
+    slot->address = address;
+    *created = true;
+    return slot;
+}
+
+/* Recomeça a contagem da origem a partir de seq, sem perdas pelo salto */
+static void link_resync(lora_link_source_t* src, uint8_t seq) {
+    src->resyncs++;
+    src->highest_seq = seq;
+    src->window = 1;
+}
+
+/* Registra a sequência na janela da origem; retorna true se é uma duplicata.
+   Uma lacuna conta como perda ao abrir e é descontada se o quadro chegar atrasado.
+   FLAG_SYNC vem só na cópia original do primeiro quadro após o reinício da
+   origem: a sequência anterior não vale mais, para frente ou para trás */
+static bool link_track(lora_link_source_t* src, uint8_t seq, bool sync) {
+    if (sync) {
+        link_resync(src, seq);
+        return false;
+    }
+
+    int8_t ahead = (int8_t)(seq - src->highest_seq);
+    if (ahead > 0) {
+        src->lost += ahead - 1;
+        src->window = ahead >= LORA_LINK_WINDOW ? 1 : (src->window << ahead) | 1;
+        src->highest_seq = seq;
+        return false;
+    }
+
+    uint8_t behind = (uint8_t)-ahead;
+    if (behind >= LORA_LINK_WINDOW) {
+        link_resync(src, seq);                           // a origem recomeçou sem SYNC
+        return false;
+    }
+    if (src->window & (1u << behind)) {
+        src->duplicates++;
+        return true;
+    }
+    src->window |= 1u << behind;
+    src->reordered++;
+    if (src->lost) src->lost--;
+    return false;
+}
+
+// ============================================================================
+// Implementação das Funções Públicas
+// ============================================================================
+
+void lora_link_init(lora_link_t* link, uint8_t address) {
+    memset(link, 0, sizeof(*link));
+    link->address = address;
+}
+
+uint8_t* lora_link_payload(uint8_t* frame) {
+    return frame + LORA_LINK_HEADER_SIZE;
+}
+
+uint8_t lora_link_encode(lora_link_t* link, uint8_t* frame, uint8_t dst, uint8_t type,
+                         uint8_t flags, uint8_t payload_length) {
+    if (payload_length > LORA_LINK_MAX_PAYLOAD) return 0;
+    if (type > LORA_LINK_MAX_TYPE || (flags & ~LORA_LINK_FLAGS_MASK)) return 0;
+
+    frame[0] = dst;
+    frame[1] = link->address;
+    frame[2] = link->tx_seq++;
+    if (link->sent == 0) flags |= LORA_LINK_FLAG_SYNC;
+    frame[3] = (uint8_t)(flags << 4) | type;
+    link->sent++;
+    return LORA_LINK_HEADER_SIZE + payload_length;
+}
+
+bool lora_link_parse(const uint8_t* frame, uint8_t length, lora_link_header_t* header) {
+    if (length < LORA_LINK_HEADER_SIZE) return false;
+    header->dst   = frame[0];
+    header->src   = frame[1];
+    header->seq   = frame[2];
+    header->flags = frame[3] >> 4;
+    header->type  = frame[3] & 0x0F;
+    return true;
+}
+
+lora_link_rx_result_t lora_link_receive(lora_link_t* link, const uint8_t* frame, uint8_t length,
+                                        lora_link_header_t* header, const uint8_t** payload,
+                                        uint8_t* payload_length) {
+    if (!lora_link_parse(frame, length, header)) {
+        link->invalid++;
+        return LORA_LINK_RX_INVALID;
+    }
+    *payload = frame + LORA_LINK_HEADER_SIZE;
+    *payload_length = length - LORA_LINK_HEADER_SIZE;
+
+    // A sequência é acompanhada mesmo nos quadros para outros nós
+    bool created;
+    lora_link_source_t* src = link_source_slot(link, header->src, &created);
+    bool duplicate = false;
+    if (created) {
+        src->highest_seq = header->seq;
+        src->window = 1;
+    } else {
+        duplicate = link_track(src, header->seq, header->flags & LORA_LINK_FLAG_SYNC);
+    }
+
+    if (!duplicate) {
+        uint64_t now = hal_time_us();
+        if (src->last_rx_us) {
+            int32_t delta = (int32_t)(now - src->last_rx_us);
+            src->interval_us = src->interval_us
+                ? (uint32_t)((int32_t)src->interval_us + (delta - (int32_t)src->interval_us) / 8)
+                : (uint32_t)delta;
+        }
+        src->last_rx_us = now;
+        src->received++;
+    }
+
+    if (header->dst != link->address && header->dst != LORA_LINK_BROADCAST) {
+        return LORA_LINK_RX_OTHER;
+    }
+    if (duplicate) return LORA_LINK_RX_DUPLICATE;
+    link->delivered++;
+    return LORA_LINK_RX_NEW;
+}
+
+const lora_link_source_t* lora_link_source(const lora_link_t* link, uint8_t address) {
+    for (uint8_t i = 0; i < link->source_count; i++) {
+        if (link->sources[i].address == address) return &link->sources[i];
+    }
+    return NULL;
+}
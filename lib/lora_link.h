@@ -0,0 +1,106 @@
+// lora_link.h
+// Camada de enlace binária sobre o driver do rádio: cada quadro começa com um
+// cabeçalho fixo de LORA_LINK_HEADER_SIZE bytes (destino, origem, sequência,
+// flags e tipo do payload). A codificação e a decodificação trabalham no
+// próprio buffer do quadro, sem cópias; o receptor acompanha a sequência de
+// cada origem para contar perdas, duplicatas e quadros fora de ordem.
+#ifndef LORA_LINK_H
+#define LORA_LINK_H
+
+#include "rfm95_lora.h"
+
+// Formato no ar: [destino][origem][sequência][flags << 4 | tipo][payload...]
+#define LORA_LINK_HEADER_SIZE 4
+#define LORA_LINK_MAX_PAYLOAD (LORA_MAX_PACKET_SIZE - LORA_LINK_HEADER_SIZE)
+
+#define LORA_LINK_BROADCAST   0xFF
+
+// Flags do cabeçalho (nibble alto do quarto byte)
+#define LORA_LINK_FLAG_ACK_REQ  0x08   // a origem espera confirmação
+#define LORA_LINK_FLAG_ACK      0x04   // o quadro é uma confirmação
+#define LORA_LINK_FLAG_ADR_REQ  0x02   // o nó pede uma resposta do ADR (lora_adr)
+#define LORA_LINK_FLAG_SYNC     0x01   // primeiro quadro após lora_link_init() (posto pelo enlace)
+#define LORA_LINK_FLAGS_MASK    0x0F
+
+// Tipos de payload definidos pela aplicação (nibble baixo do quarto byte)
+#define LORA_LINK_MAX_TYPE      0x0F
+
+// Origens acompanhadas simultaneamente (a menos recente é substituída)
+#ifndef LORA_LINK_MAX_SOURCES
+#define LORA_LINK_MAX_SOURCES 8
+#endif
+
+// Quadros recentes lembrados por origem para detectar duplicatas e atrasos
+#define LORA_LINK_WINDOW 32
+
+typedef struct {
+    uint8_t dst;
+    uint8_t src;
+    uint8_t seq;
+    uint8_t flags;
+    uint8_t type;
+} lora_link_header_t;
+
+typedef enum {
+    LORA_LINK_RX_NEW,        // quadro inédito para este nó (ou broadcast)
+    LORA_LINK_RX_DUPLICATE,  // já recebido (ex: retransmissão)
+    LORA_LINK_RX_OTHER,      // válido, mas endereçado a outro nó
+    LORA_LINK_RX_INVALID,    // curto demais para conter o cabeçalho
+} lora_link_rx_result_t;
+
+// Métricas de uma origem; todos os quadros ouvidos dela contam, mesmo os
+// endereçados a outros nós, já que a sequência é única por origem. Sem relógio
+// comum entre os nós não há latência de ida: a latência fica com os contadores
+// de RTT do lora_arq (rtt_last_us/rtt_min_us/rtt_max_us), e aqui só o intervalo
+// entre chegadas
+typedef struct {
+    uint8_t address;
+    uint8_t highest_seq;     // maior sequência vista (aritmética módulo 256)
+    uint32_t window;         // bit i = recebida highest_seq - i
+    uint32_t received;       // quadros distintos
+    uint32_t lost;           // lacunas na sequência ainda não preenchidas
+    uint32_t duplicates;
+    uint32_t reordered;      // chegaram depois de uma sequência maior
+    uint32_t resyncs;        // origem reiniciada (FLAG_SYNC) ou salto para trás além da janela
+    uint64_t last_rx_us;
+    uint32_t interval_us;    // média móvel do intervalo entre quadros
+} lora_link_source_t;
+
+typedef struct {
+    uint8_t address;
+    uint8_t tx_seq;
+    lora_link_source_t sources[LORA_LINK_MAX_SOURCES];
+    uint8_t source_count;
+
+    uint32_t sent;           // quadros codificados
+    uint32_t delivered;      // LORA_LINK_RX_NEW
+    uint32_t invalid;
+} lora_link_t;
+
+// Inicializa o enlace do nó com o endereço dado (não use LORA_LINK_BROADCAST)
+void lora_link_init(lora_link_t* link, uint8_t address);
+
+// Onde o payload começa dentro do buffer do quadro
+uint8_t* lora_link_payload(uint8_t* frame);
+
+// Escreve o cabeçalho na frente de um payload já montado em
+// lora_link_payload(frame) e consome um número de sequência. O primeiro
+// quadro leva LORA_LINK_FLAG_SYNC, para o receptor aceitar a nova contagem.
+// Retorna o tamanho total do quadro, ou 0 se payload_length, flags ou type
+// estiverem fora dos limites
+uint8_t lora_link_encode(lora_link_t* link, uint8_t* frame, uint8_t dst, uint8_t type,
+                         uint8_t flags, uint8_t payload_length);
+
+// Lê o cabeçalho sem alterar as métricas; false se o quadro é curto demais
+bool lora_link_parse(const uint8_t* frame, uint8_t length, lora_link_header_t* header);
+
+// Decodifica um quadro recebido e atualiza as métricas da origem.
+// payload aponta para dentro de frame (válido enquanto frame for)
+lora_link_rx_result_t lora_link_receive(lora_link_t* link, const uint8_t* frame, uint8_t length,
+                                        lora_link_header_t* header, const uint8_t** payload,
+                                        uint8_t* payload_length);
+
+// Métricas de uma origem (NULL se ela nunca foi ouvida)
+const lora_link_source_t* lora_link_source(const lora_link_t* link, uint8_t address);
+
+#endif // LORA_LINK_H
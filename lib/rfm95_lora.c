@@ -15,14 +15,21 @@
 #define REG_FIFO_RX_CURRENT_ADDR  0x10
 #define REG_IRQ_FLAGS             0x12
 #define REG_RX_NB_BYTES           0x13
+#define REG_MODEM_STAT            0x18
 #define REG_PKT_SNR_VALUE         0x19
 #define REG_PKT_RSSI_VALUE        0x1A
+#define REG_HOP_CHANNEL           0x1C
 #define REG_MODEM_CONFIG_1        0x1D
 #define REG_MODEM_CONFIG_2        0x1E
+#define REG_SYMB_TIMEOUT_LSB      0x1F
 #define REG_PREAMBLE_MSB          0x20
 #define REG_PREAMBLE_LSB          0x21
 #define REG_PAYLOAD_LENGTH        0x22
 #define REG_MAX_PAYLOAD_LENGTH    0x23
+#define REG_HOP_PERIOD            0x24
+#define REG_MODEM_CONFIG_3        0x26
+#define REG_DETECTION_OPTIMIZE    0x31
+#define REG_DETECTION_THRESHOLD   0x37
 #define REG_DIO_MAPPING_1         0x40
 #define REG_VERSION               0x42
 #define REG_PA_DAC                0x4D
@@ -34,180 +41,2141 @@
 #define MODE_TX                   0x03
 #define MODE_RX_CONTINUOUS        0x05
 #define MODE_RX_SINGLE            0x06
+#define MODE_CAD                  0x07
+
+// Mapeamento de DIO0 (bits 7-6 de REG_DIO_MAPPING_1); DIO1 (bits 5-4)
+// fica em 00, RxTimeout, ou em 01, FhssChangeChannel, com o FHSS ligado
+#define DIO0_MASK                 0xC0
+#define DIO0_RX_DONE              0x00
+#define DIO0_TX_DONE              0x40
+#define DIO0_CAD_DONE             0x80
+#define DIO1_FHSS_CHANGE_CHANNEL  0x10
 
 // Máscaras de interrupção
+#define IRQ_RX_TIMEOUT_MASK       0x80
 #define IRQ_RX_DONE_MASK          0x40
 #define IRQ_TX_DONE_MASK          0x08
 #define IRQ_PAYLOAD_CRC_ERROR_MASK 0x20
+#define IRQ_CAD_DONE_MASK         0x04
+#define IRQ_FHSS_CHANGE_CHANNEL_MASK 0x02
+#define IRQ_CAD_DETECTED_MASK     0x01
+
+// Bits de REG_HOP_CHANNEL: canal atual do FHSS (FhssPresentChannel)
+#define HOP_CHANNEL_MASK          0x3F
+
+// Bits de REG_MODEM_STAT
+#define MODEM_STAT_SIGNAL_DETECTED 0x01
+
+// Bits de REG_MODEM_CONFIG_3
+#define MODEM3_LOW_DATA_RATE_OPT  0x08
+
+// Símbolos mais longos que isso exigem LowDataRateOptimize (datasheet 4.1.1.6)
+#define LDRO_SYMBOL_US            16000
+
+// Timeout de RX single em símbolos (valor de reset de REG_SYMB_TIMEOUT_LSB)
+#define DEFAULT_SYMB_TIMEOUT      0x64
 
 // Frequência do cristal do módulo (Hz)
 #define RF_CRYSTAL_FREQ_HZ        32000000
 
+// Bloco lido em uma única rajada ao tratar um pacote (0x10 a 0x1A):
+// endereço atual da FIFO, flags de IRQ, bytes recebidos, SNR e RSSI
+#define RX_INFO_FIRST             REG_FIFO_RX_CURRENT_ADDR
+#define RX_INFO_LENGTH            (REG_PKT_RSSI_VALUE - REG_FIFO_RX_CURRENT_ADDR + 1)
+#define RX_INFO(info, reg)        ((info)[(reg) - RX_INFO_FIRST])
+
+// Blocos menores que isso não compensam a configuração do DMA
+#define FIFO_DMA_MIN_BYTES        16
+
+// Novo disparo do alarme quando ele encontra o DMA da FIFO ocupando o SPI
+#define CAD_RETRY_US              1000
+
+// Símbolos de preâmbulo além do período de CAD: o CAD (~2) e a sincronização
+#define CAD_PREAMBLE_MARGIN       8
+
+// Capacidade da lista de escritas adiadas
+#define RMF95_TXN_MAX             16
+
+// Lista de escritas adiadas: escritas em endereços consecutivos são
+// enviadas em uma única rajada (um só ciclo de CS) no commit
+typedef struct {
+    uint8_t reg[RMF95_TXN_MAX];
+    uint8_t value[RMF95_TXN_MAX];
+    uint8_t count;
+} rmf95_txn_t;
+
+const lora_modem_config_t lora_modem_presets[LORA_PRESET_COUNT] = {
+    [LORA_PRESET_SF7_BW500]  = LORA_MODEM_SF7_BW500,
+    [LORA_PRESET_SF7_BW125]  = LORA_MODEM_SF7_BW125,
+    [LORA_PRESET_SF9_BW125]  = LORA_MODEM_SF9_BW125,
+    [LORA_PRESET_SF10_BW125] = LORA_MODEM_SF10_BW125,
+    [LORA_PRESET_SF12_BW125] = LORA_MODEM_SF12_BW125,
+};
+
+// Largura de banda em Hz de cada valor de lora_bandwidth_t
+static const uint32_t bandwidth_hz[] = {
+    7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000
+};
+
+// Recepção por interrupção (privado): a ISR tira slots do anel de livres e
+// publica os preenchidos no anel de prontos, de onde a aplicação os empresta.
+// Cada anel tem um único produtor e um único consumidor (sem trava), o que
+// também vale com a ISR e a aplicação em núcleos diferentes
+typedef struct {
+    lora_packet_t pool[LORA_RX_POOL_SIZE];
+    uint8_t free_ring[LORA_RX_POOL_SIZE];
+    volatile uint32_t free_in;   // escrito por rfm95_receive_irq_release()
+    volatile uint32_t free_out;  // escrito pela ISR
+    uint8_t ready[LORA_RX_POOL_SIZE];
+    volatile uint32_t ready_in;  // escrito pela ISR
+    volatile uint32_t ready_out; // escrito por rfm95_receive_irq_lease()
+    lora_rx_pool_counters_t counters;
+    lora_rx_callback_t callback;
+    volatile bool active;
+} rmf95_rx_irq_t;
+
+// Fila de transmissão (privado): quadros em slots fixos e um anel de índices
+// por classe de prioridade; os slots livres ficam em uma pilha
+#define TXQ_NONE 0xFF
+
+typedef struct {
+    struct {
+        uint8_t data[LORA_MAX_PACKET_SIZE];
+        uint8_t length;
+        bool has_frf;            // canal próprio (lora_tx_enqueue_channel)
+        lora_frf_t frf;
+        lora_tx_stamp_t* stamp;  // marcado no TxDone (lora_tx_enqueue_stamped)
+    } frames[LORA_TX_QUEUE_SIZE];
+    uint8_t free_slots[LORA_TX_QUEUE_SIZE];
+    uint8_t free_count;
+    uint8_t ring[LORA_PRIO_COUNT][LORA_TX_QUEUE_SIZE];
+    uint8_t head[LORA_PRIO_COUNT];
+    uint8_t count[LORA_PRIO_COUNT];
+    uint8_t queued;
+    uint8_t current;             // slot no ar (TXQ_NONE em um envio direto)
+    lora_txq_policy_t policy;
+    lora_txq_counters_t counters;
+} rmf95_txq_t;
+
+// Modo multinúcleo (privado): os rádios rodam no núcleo 1; o núcleo 0 entrega
+// quadros pelo anel SPSC de cada rádio e as demais chamadas são executadas
+// remotamente, uma por vez, pelo canal único de chamadas
+#define RMF95_RADIO_CORE 1
+
+typedef uint32_t (*rmf95_remote_fn_t)(rfm95_t* radio, uintptr_t a, uintptr_t b);
+
+typedef struct {
+    struct {
+        uint8_t data[LORA_MAX_PACKET_SIZE];
+        uint8_t length;
+        lora_priority_t priority;
+        bool has_frf;
+        lora_frf_t frf;
+        lora_tx_stamp_t* stamp;
+        uint64_t enqueued_us;
+    } tx_ring[LORA_MC_TX_RING_SIZE];
+    volatile uint32_t tx_in;     // escrito pelo núcleo 0
+    volatile uint32_t tx_out;    // escrito pelo núcleo 1
+    lora_multicore_counters_t counters;
+} rmf95_mc_t;
+
+static struct {
+    volatile bool active;
+    volatile rmf95_remote_fn_t call_fn;
+    rfm95_t* call_radio;
+    uintptr_t call_a, call_b;
+    volatile uint32_t call_result;
+    volatile bool call_done;
+} remote;
+
+// Detecção de atividade no canal (privado): lora_cad(), o listen-before-talk
+// e a recepção em ciclos dividem o rádio e o seu alarme da HAL, então um
+// único estado diz quem espera o próximo CadDone ou alarme
+typedef enum {
+    CAD_NONE = 0,
+    CAD_USER,                    // lora_cad() esperando o CadDone
+    CAD_LBT,                     // CAD antes de um envio
+    CAD_LBT_BACKOFF,             // envio adiado até o alarme
+    CAD_CYCLE_SLEEP,             // recepção em ciclos: dormindo até o alarme
+    CAD_CYCLE_CAD,
+    CAD_CYCLE_RX,                // RX single após um preâmbulo detectado
+} rmf95_cad_state_t;
+
+typedef struct {
+    volatile uint8_t state;      // rmf95_cad_state_t
+    volatile bool detected;      // resultado do CAD de lora_cad()
+    bool lbt_enabled;
+    lora_lbt_config_t lbt;
+    uint8_t attempts;            // CADs já feitos para o quadro adiado
+    const uint8_t* tx_buffer;    // quadro adiado (ainda fora da FIFO)
+    uint8_t tx_size;
+    uint32_t cycle_us;           // período da recepção em ciclos (0 = desligada)
+    uint16_t cycle_window;       // símbolos do RX single de cada despertar (0: CAD antes)
+    uint32_t random;             // xorshift do back-off
+    lora_cad_counters_t counters;
+} rmf95_cad_t;
+
+// Tempo do rádio em cada estado de consumo (privado), sempre contado: base do
+// relatório de energia e do mode_us das estatísticas
+typedef struct {
+    uint64_t mode_us[LORA_RADIO_MODE_COUNT];   // estados já encerrados
+    lora_radio_mode_t mode;
+    uint64_t mode_since_us;
+    uint64_t start_us;
+    lora_power_profile_t profile;
+} rmf95_power_t;
+
+#if LORA_STATS
+// Estatísticas (privado): somas para as médias e o início do estado atual
+typedef struct {
+    lora_stats_t data;
+    int32_t rssi_sum;
+    int32_t snr_sum;             // unidades de 0,25 dB
+    int8_t snr_min;              // valores brutos de REG_PKT_SNR_VALUE
+    int8_t snr_max;
+    uint64_t mode_since_us;
+} rmf95_stats_t;
+
+#define RMF95_STATS_INC(field)          (radio->stats.data.field++)
+#define RMF95_STATS_ADD(field, n)       (radio->stats.data.field += (n))
+#define RMF95_STATS_CYCLES()            hal_cycles()
+#define RMF95_STATS_HIST(name, start)   rmf95_stats_cycles(radio->stats.data.name, &radio->stats.data.name##_max, (start))
+#define RMF95_STATS_MODE(now)           rmf95_stats_mode(radio, now)
+#define RMF95_STATS_RX_DONE(info)       rmf95_stats_rx_done(radio, info)
+#else
+#define RMF95_STATS_INC(field)          ((void)0)
+#define RMF95_STATS_ADD(field, n)       ((void)0)
+#define RMF95_STATS_CYCLES()            0
+#define RMF95_STATS_HIST(name, start)   ((void)(start))
+#define RMF95_STATS_MODE(now)           ((void)(now))
+#define RMF95_STATS_RX_DONE(info)       ((void)0)
+#endif
+
+// Barramento SPI (privado), possivelmente dividido entre vários módulos, cada
+// um com o seu CS. busy fica ligado durante o DMA da FIFO de qualquer um deles,
+// quando a transação fica aberta e nenhum outro pode selecionar o seu módulo
+typedef struct {
+    hal_spi_t* spi;
+    uint32_t baudrate;           // clock efetivo
+    volatile bool busy;
+} rmf95_bus_t;
+
+static rmf95_bus_t buses[LORA_MAX_RADIOS];
+
+// Estado de um módulo RFM95 (rfm95_t)
+struct rfm95 {
+    bool in_use;                 // inicializado com sucesso
+    uint16_t index;              // posição em radios[]
+    rfm95_pins_t pins;
+    rmf95_bus_t* bus;
+
+    // Parâmetros do modem aplicados
+    struct {
+        lora_modem_config_t config;
+        uint32_t symbol_us;
+        bool ldro;               // LowDataRateOptimize efetivamente ligado
+        uint16_t symb_timeout;   // valor gravado (10 bits)
+    } modem;
+
+    rmf95_rx_irq_t rx_irq;
+
+    // Estado da transmissão assíncrona
+    struct {
+        volatile bool busy;
+        lora_tx_callback_t callback;
+    } tx_async;
+
+    rmf95_txq_t txq;
+    rmf95_mc_t mc;
+    rmf95_cad_t cad;
+
+    // Cópia dos registradores escritos com frequência, para evitar escritas redundantes
+    struct {
+        uint8_t op_mode;
+        uint8_t dio_mapping;
+    } shadow;
+
+    // Canais: o base (RX e envios comuns), o do quadro sendo enviado, o
+    // gravado no rádio e a tabela do FHSS
+    struct {
+        lora_frf_t base;
+        lora_frf_t tx;
+        lora_frf_t tuned;
+        const lora_frf_t* fhss;  // NULL com o FHSS desligado
+        uint8_t fhss_count;
+        lora_hop_counters_t counters;
+    } channel;
+
+    // RSSI/SNR (valores brutos) do último pacote lido
+    struct {
+        uint8_t rssi;
+        uint8_t snr;
+    } last_packet;
+
+    lora_spi_counters_t spi_counters;
+    rmf95_power_t power;
+#if LORA_STATS
+    rmf95_stats_t stats;
+#endif
+
+    // Configuração ativa do driver
+    struct {
+        bool fifo_dma;
+    } config;
+
+    // Transferência da FIFO por DMA em andamento (a transação SPI fica aberta)
+    struct {
+        volatile bool busy;
+        volatile bool irq_pending;   // DIO0/DIO1 chegou durante um DMA no barramento
+        lora_packet_t* slot;         // destino de uma leitura; NULL em uma carga de TX
+        uint8_t tx_size;
+        uint32_t first_transaction;
+    } fifo_dma;
+};
+
+// Módulos do driver; o primeiro é a instância padrão das funções lora_*
+static rfm95_t radios[LORA_MAX_RADIOS];
+
 // ============================================================================
 // Funções Privadas
 // ============================================================================
 
 /* Reinicia o módulo forçando o pino RST */
-static void rmf95_reset() {
-    gpio_put(PIN_RST, 0);
-    sleep_ms(10);
-    gpio_put(PIN_RST, 1);
-    sleep_ms(10);
+static void rmf95_reset(rfm95_t* radio) {
+    hal_gpio_put(radio->pins.rst, 0);
+    hal_sleep_ms(10);
+    hal_gpio_put(radio->pins.rst, 1);
+    hal_sleep_ms(10);
+}
+
+/* true se outro módulo em uso já tem o CS (no mesmo barramento) ou um dos DIOs */
+static bool rmf95_pins_conflict(const rfm95_pins_t* pins) {
+    for (uint16_t i = 0; i < LORA_MAX_RADIOS; i++) {
+        const rfm95_t* other = &radios[i];
+        if (!other->in_use) continue;
+        if (other->pins.spi == pins->spi && other->pins.cs == pins->cs) return true;
+        if (other->pins.dio0 == pins->dio0 || other->pins.dio0 == pins->dio1 ||
+            other->pins.dio1 == pins->dio0 || other->pins.dio1 == pins->dio1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* true se algum módulo em uso está ligado ao barramento */
+static bool rmf95_bus_in_use(const rmf95_bus_t* bus) {
+    for (uint16_t i = 0; i < LORA_MAX_RADIOS; i++) {
+        if (radios[i].in_use && radios[i].bus == bus) return true;
+    }
+    return false;
+}
+
+/* Barramento do SPI dos pinos: um já em uso é dividido com o clock que tem; senão
+   uma entrada livre (há sempre uma, já que cada módulo usa no máximo uma) é
+   ocupada e o SPI inicializado */
+static rmf95_bus_t* rmf95_bus_attach(const rfm95_pins_t* pins, uint32_t baudrate) {
+    rmf95_bus_t* free_bus = NULL;
+    for (uint16_t i = 0; i < LORA_MAX_RADIOS; i++) {
+        rmf95_bus_t* bus = &buses[i];
+        bool in_use = rmf95_bus_in_use(bus);
+        if (in_use && bus->spi == pins->spi) return bus;
+        if (!in_use && (!free_bus || bus->spi == pins->spi)) free_bus = bus;
+    }
+    free_bus->spi = pins->spi;
+    free_bus->busy = false;
+    free_bus->baudrate = hal_spi_init(pins->spi, baudrate, pins->miso, pins->sck, pins->mosi);
+    return free_bus;
+}
+
+/* Estado de consumo correspondente a um valor de REG_OP_MODE */
+static lora_radio_mode_t rmf95_radio_mode(uint8_t op_mode) {
+    switch (op_mode & 0x07) {
+        case MODE_SLEEP: return LORA_RADIO_SLEEP;
+        case MODE_STDBY: return LORA_RADIO_STANDBY;
+        case 0x02:                                       // FSTX
+        case MODE_TX:    return LORA_RADIO_TX;
+        default:         return LORA_RADIO_RX;           // FSRX, RX e CAD
+    }
+}
+
+#if LORA_STATS
+/* Fecha nas estatísticas o tempo do estado que está terminando (power.mode) */
+static void rmf95_stats_mode(rfm95_t* radio, uint64_t now) {
+    radio->stats.data.mode_us[radio->power.mode] += now - radio->stats.mode_since_us;
+    radio->stats.mode_since_us = now;
+}
+
+/* Soma uma medida ao histograma logarítmico */
+static void rmf95_stats_cycles(uint32_t* hist, uint32_t* max, uint32_t start) {
+    uint32_t cycles = hal_cycles_since(start);
+    uint32_t bucket = cycles ? 31 - __builtin_clz(cycles) : 0;
+    if (bucket >= LORA_STATS_HIST_BUCKETS) bucket = LORA_STATS_HIST_BUCKETS - 1;
+    hist[bucket]++;
+    if (cycles > *max) *max = cycles;
+}
+
+/* Classifica um RxDone pelas flags e metadados lidos em rmf95_read_rx_info() */
+static void rmf95_stats_rx_done(rfm95_t* radio, const uint8_t* info) {
+    if (RX_INFO(info, REG_IRQ_FLAGS) & IRQ_PAYLOAD_CRC_ERROR_MASK) {
+        radio->stats.data.crc_errors++;
+        return;
+    }
+
+    int16_t rssi = (int16_t)RX_INFO(info, REG_PKT_RSSI_VALUE) - 157;
+    int8_t snr = (int8_t)RX_INFO(info, REG_PKT_SNR_VALUE);
+    radio->stats.data.rx_packets++;
+    radio->stats.rssi_sum += rssi;
+    radio->stats.snr_sum += snr;
+    if (rssi < radio->stats.data.rssi_min) radio->stats.data.rssi_min = rssi;
+    if (rssi > radio->stats.data.rssi_max) radio->stats.data.rssi_max = rssi;
+    if (snr < radio->stats.snr_min) radio->stats.snr_min = snr;
+    if (snr > radio->stats.snr_max) radio->stats.snr_max = snr;
+}
+
+/* Zera o bloco; o tempo do estado atual volta a contar de agora */
+static void rmf95_stats_clear(rfm95_t* radio) {
+    memset(&radio->stats, 0, sizeof(radio->stats));
+    radio->stats.data.rssi_min = INT16_MAX;
+    radio->stats.data.rssi_max = INT16_MIN;
+    radio->stats.snr_min = INT8_MAX;
+    radio->stats.snr_max = INT8_MIN;
+    radio->stats.mode_since_us = hal_time_us();
+}
+#endif
+
+/* Fecha o tempo do estado anterior e passa a contar o novo */
+static void rmf95_power_mode(rfm95_t* radio, uint8_t op_mode) {
+    uint64_t now = hal_time_us();
+    RMF95_STATS_MODE(now);
+    radio->power.mode_us[radio->power.mode] += now - radio->power.mode_since_us;
+    radio->power.mode = rmf95_radio_mode(op_mode);
+    radio->power.mode_since_us = now;
+}
+
+/* Zera os tempos mantendo o estado atual do rádio */
+static void rmf95_power_clear(rfm95_t* radio) {
+    memset(radio->power.mode_us, 0, sizeof(radio->power.mode_us));
+    radio->power.start_us = radio->power.mode_since_us = hal_time_us();
+}
+
+/* Abre uma transação SPI (CS em nível baixo) */
+static void rmf95_select(rfm95_t* radio) {
+    radio->spi_counters.total++;
+    RMF95_STATS_INC(spi_transactions);
+    hal_gpio_put(radio->pins.cs, 0);
+}
+
+static void rmf95_deselect(rfm95_t* radio) {
+    hal_gpio_put(radio->pins.cs, 1);
+}
+
+/* Transferência bloqueante dentro da transação aberta */
+static void rmf95_spi_transfer(rfm95_t* radio, const uint8_t* tx, uint8_t* rx, size_t length) {
+    RMF95_STATS_ADD(spi_bytes, length);
+    hal_spi_transfer(radio->bus->spi, tx, rx, length);
 }
 
 /* Leitura de um registrador (1 byte) via SPI */
-static uint8_t rmf95_read_reg(uint8_t reg) {
+static uint8_t rmf95_read_reg(rfm95_t* radio, uint8_t reg) {
     uint8_t tx[] = { reg & 0x7F, 0x00 };   // bit 7=0 → leitura
     uint8_t rx[2];
-    gpio_put(PIN_CS, 0);
-    spi_write_read_blocking(SPI_PORT, tx, rx, 2);
-    gpio_put(PIN_CS, 1);
+    rmf95_select(radio);
+    rmf95_spi_transfer(radio, tx, rx, 2);
+    rmf95_deselect(radio);
     return rx[1];
 }
 
 /* Escrita de um registrador (1 byte) via SPI */
-static void rmf95_write_reg(uint8_t reg, uint8_t value) {
+static void rmf95_write_reg(rfm95_t* radio, uint8_t reg, uint8_t value) {
     uint8_t tx[] = { reg | 0x80, value };  // bit 7=1 → escrita
-    gpio_put(PIN_CS, 0);
-    spi_write_blocking(SPI_PORT, tx, 2);
-    gpio_put(PIN_CS, 1);
+    rmf95_select(radio);
+    rmf95_spi_transfer(radio, tx, NULL, 2);
+    rmf95_deselect(radio);
+}
+
+/* Leitura em rajada: o SX1276 incrementa o endereço a cada byte (exceto na FIFO) */
+static void rmf95_read_burst(rfm95_t* radio, uint8_t reg, uint8_t* buffer, uint8_t length) {
+    uint8_t addr = reg & 0x7F;
+    rmf95_select(radio);
+    rmf95_spi_transfer(radio, &addr, NULL, 1);
+    rmf95_spi_transfer(radio, NULL, buffer, length);
+    rmf95_deselect(radio);
+}
+
+/* Escrita em rajada a partir de reg */
+static void rmf95_write_burst(rfm95_t* radio, uint8_t reg, const uint8_t* buffer, uint8_t length) {
+    uint8_t addr = reg | 0x80;
+    rmf95_select(radio);
+    rmf95_spi_transfer(radio, &addr, NULL, 1);
+    rmf95_spi_transfer(radio, buffer, NULL, length);
+    rmf95_deselect(radio);
+}
+
+static void rmf95_fifo_dma_done(void* ctx);
+
+/* Move um bloco de/para a FIFO (tx != NULL escreve, senão lê em rx). Com DMA,
+   retorna true e a transação é fechada em rmf95_fifo_dma_done(); caso contrário
+   copia com a CPU e retorna false */
+static bool rmf95_fifo_transfer(rfm95_t* radio, const uint8_t* tx, uint8_t* rx, uint8_t length, bool allow_dma) {
+    uint64_t start = hal_time_us();
+    uint32_t cycles = RMF95_STATS_CYCLES();
+    uint8_t addr = tx ? (REG_FIFO | 0x80) : REG_FIFO;
+    bool async = false;
+
+    rmf95_select(radio);
+    rmf95_spi_transfer(radio, &addr, NULL, 1);
+    if (allow_dma && radio->config.fifo_dma && length >= FIFO_DMA_MIN_BYTES) {
+        radio->fifo_dma.busy = radio->bus->busy = true;
+        async = hal_spi_transfer_async(radio->bus->spi, tx, rx, length, rmf95_fifo_dma_done, radio);
+        radio->fifo_dma.busy = radio->bus->busy = async;
+    }
+    if (async) {
+        radio->spi_counters.fifo_dma_transfers++;
+        RMF95_STATS_ADD(spi_bytes, length);
+    } else {
+        rmf95_spi_transfer(radio, tx, rx, length);       // caminho bloqueante
+        rmf95_deselect(radio);
+    }
+
+    radio->spi_counters.fifo_bytes += length;
+    radio->spi_counters.fifo_cpu_us += (uint32_t)(hal_time_us() - start);
+    if (!tx) {
+        RMF95_STATS_HIST(fifo_read_cycles, cycles);
+    }
+    return async;
 }
 
 /* Lê um bloco de dados a partir da FIFO */
-static void rmf95_read_fifo(uint8_t* buffer, uint8_t length) {
-    uint8_t addr = REG_FIFO & 0x7F;
-    gpio_put(PIN_CS, 0);
-    spi_write_blocking(SPI_PORT, &addr, 1);
-    spi_read_blocking(SPI_PORT, 0, buffer, length);
-    gpio_put(PIN_CS, 1);
+static void rmf95_read_fifo(rfm95_t* radio, uint8_t* buffer, uint8_t length) {
+    rmf95_fifo_transfer(radio, NULL, buffer, length, false);
 }
 
-/* Escreve um bloco de dados na FIFO */
-static void rmf95_write_fifo(const uint8_t* buffer, uint8_t length) {
-    uint8_t addr = REG_FIFO | 0x80;
-    gpio_put(PIN_CS, 0);
-    spi_write_blocking(SPI_PORT, &addr, 1);
-    spi_write_blocking(SPI_PORT, buffer, length);
-    gpio_put(PIN_CS, 1);
+/* Seção crítica das chamadas da aplicação: espera o DMA da FIFO no barramento
+   do módulo terminar (o dele ou o de outro módulo no mesmo SPI) e mascara as
+   interrupções dos rádios enquanto os registradores são acessados */
+static uint32_t rmf95_lock(rfm95_t* radio) {
+    for (;;) {
+        uint32_t state = hal_irq_save();
+        if (!radio->bus->busy) return state;
+        hal_irq_restore(state);
+        hal_yield();
+    }
 }
 
-// ============================================================================
-// Implementação das Funções Públicas
-// ============================================================================
+static void rmf95_unlock(uint32_t state) {
+    hal_irq_restore(state);
+}
 
-bool lora_init() {
-    /* --- Configuração básica do barramento SPI --- */
-    spi_init(SPI_PORT, 1 * 1000 * 1000);          // 1 MHz
-    gpio_set_function(PIN_MISO, GPIO_FUNC_SPI);
-    gpio_set_function(PIN_SCK,  GPIO_FUNC_SPI);
-    gpio_set_function(PIN_MOSI, GPIO_FUNC_SPI);
-    spi_set_format(SPI_PORT, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+/* Enfileira uma escrita; a lista é descarregada automaticamente se encher */
+static void rmf95_txn_commit(rfm95_t* radio, rmf95_txn_t* txn);
 
-    /* --- Pinos de controle CS e RST --- */
-    gpio_init(PIN_CS);   gpio_set_dir(PIN_CS, GPIO_OUT);   gpio_put(PIN_CS, 1);
-    gpio_init(PIN_RST);  gpio_set_dir(PIN_RST, GPIO_OUT);
+static void rmf95_txn_write(rfm95_t* radio, rmf95_txn_t* txn, uint8_t reg, uint8_t value) {
+    if (txn->count == RMF95_TXN_MAX) {
+        rmf95_txn_commit(radio, txn);
+    }
+    txn->reg[txn->count] = reg;
+    txn->value[txn->count] = value;
+    txn->count++;
+}
 
-    /* --- Reset do módulo e verificação da versão --- */
-    rmf95_reset();
-    if (rmf95_read_reg(REG_VERSION) != 0x12) {     // 0x12 é a versão esperada
-        return false;
+/* Envia a lista na ordem de inserção, agrupando endereços consecutivos */
+static void rmf95_txn_commit(rfm95_t* radio, rmf95_txn_t* txn) {
+    uint8_t i = 0;
+    while (i < txn->count) {
+        uint8_t j = i + 1;
+        while (j < txn->count && txn->reg[j - 1] != REG_FIFO &&
+               txn->reg[j] == txn->reg[j - 1] + 1) {
+            j++;
+        }
+        rmf95_write_burst(radio, txn->reg[i], &txn->value[i], j - i);
+        i = j;
     }
+    txn->count = 0;
+}
 
-    /* --- Entra em modo sleep para configurar com segurança --- */
-    lora_sleep();
+/* Troca o modo de operação; não reescreve modos estáveis já ativos */
+static void rmf95_set_mode(rfm95_t* radio, uint8_t mode) {
+    // TX termina sozinho em standby, então só sleep/standby/RX contínuo são confiáveis
+    bool stable = mode == (MODE_LORA | MODE_SLEEP) || mode == (MODE_LORA | MODE_STDBY) ||
+                  mode == (MODE_LORA | MODE_RX_CONTINUOUS);
+    if (stable && radio->shadow.op_mode == mode) return;
+    rmf95_write_reg(radio, REG_OP_MODE, mode);
+    radio->shadow.op_mode = mode;
+    rmf95_power_mode(radio, mode);
+}
 
-    /* --- Frequência de operação --- */
-    lora_set_frequency(LORA_FREQUENCY_HZ);
+static void rmf95_set_dio_mapping(rfm95_t* radio, uint8_t mapping) {
+    if (radio->channel.fhss) {
+        mapping |= DIO1_FHSS_CHANGE_CHANNEL;
+    }
+    if (radio->shadow.dio_mapping == mapping) return;
+    rmf95_write_reg(radio, REG_DIO_MAPPING_1, mapping);
+    radio->shadow.dio_mapping = mapping;
+}
 
-    /* --- Ponteiros base da FIFO (TX e RX no início) --- */
-    rmf95_write_reg(REG_FIFO_TX_BASE_ADDR, 0x00);
-    rmf95_write_reg(REG_FIFO_RX_BASE_ADDR, 0x00);
+/* Grava o canal (uma rajada em 0x06-0x08), se ainda não é o do rádio. Fora
+   do FHSS o rádio deve estar em sleep ou standby */
+static void rmf95_tune(rfm95_t* radio, const lora_frf_t* frf) {
+    if (memcmp(&radio->channel.tuned, frf, sizeof(*frf)) == 0) return;
+    rmf95_write_burst(radio, REG_FRF_MSB, frf->reg, sizeof(frf->reg));
+    radio->channel.tuned = *frf;
+    radio->channel.counters.retunes++;
+}
 
-    /* --- LNA: ativa ganho máximo para melhor sensibilidade --- */
-    rmf95_write_reg(REG_LNA, rmf95_read_reg(REG_LNA) | 0x03);
+/* Volta ao canal base, passando por standby se o rádio está em outro */
+static void rmf95_tune_base(rfm95_t* radio) {
+    if (memcmp(&radio->channel.tuned, &radio->channel.base, sizeof(lora_frf_t)) == 0) return;
+    rmf95_set_mode(radio, MODE_LORA | MODE_STDBY);
+    rmf95_tune(radio, &radio->channel.base);
+}
 
-    /* --- Configuração do modem
-         BW 125 kHz, CR 4/5, CRC on, SF7 --- */
-    rmf95_write_reg(REG_MODEM_CONFIG_1, 0x72);
-    rmf95_write_reg(REG_MODEM_CONFIG_2, 0x74);
+/* Grava o timeout do RX single (símbolos, 10 bits divididos entre
+   REG_MODEM_CONFIG_2 e REG_SYMB_TIMEOUT_LSB); rádio em sleep ou standby */
+static void rmf95_set_symb_timeout(rfm95_t* radio, uint16_t symbols) {
+    if (radio->modem.symb_timeout == symbols) return;
+    uint8_t regs[2] = {
+        (uint8_t)((radio->modem.config.spreading_factor << 4) | (radio->modem.config.crc ? 0x04 : 0x00) | (symbols >> 8)),
+        (uint8_t)symbols
+    };
+    rmf95_write_burst(radio, REG_MODEM_CONFIG_2, regs, 2);
+    radio->modem.symb_timeout = symbols;
+}
 
-    /* --- Preâmbulo de 8 símbolos --- */
-    rmf95_write_reg(REG_PREAMBLE_MSB, 0x00);
-    rmf95_write_reg(REG_PREAMBLE_LSB, 0x08);
+/* Lê em uma rajada as flags e os metadados do pacote (RX_INFO_LENGTH bytes) */
+static void rmf95_read_rx_info(rfm95_t* radio, uint8_t* info) {
+    rmf95_read_burst(radio, RX_INFO_FIRST, info, RX_INFO_LENGTH);
+    radio->last_packet.rssi = RX_INFO(info, REG_PKT_RSSI_VALUE);
+    radio->last_packet.snr  = RX_INFO(info, REG_PKT_SNR_VALUE);
+}
 
-    /* --- Volta para standby, pronto para TX/RX --- */
-    lora_idle();
-    return true;
+/* Copia da FIFO o pacote descrito por info (já lido); retorna o tamanho */
+static uint8_t rmf95_read_packet(rfm95_t* radio, const uint8_t* info, uint8_t* buffer, int max_size) {
+    uint8_t len = RX_INFO(info, REG_RX_NB_BYTES);
+    if (len > max_size) len = max_size;
+    rmf95_write_reg(radio, REG_FIFO_ADDR_PTR, RX_INFO(info, REG_FIFO_RX_CURRENT_ADDR));
+    rmf95_read_fifo(radio, buffer, len);
+    return len;
 }
 
-/* Converte frequência em Hz para os três registradores FRF */
-void lora_set_frequency(long frequency) {
-    uint64_t frf = ((uint64_t)frequency << 19) / RF_CRYSTAL_FREQ_HZ;
-    rmf95_write_reg(REG_FRF_MSB, (uint8_t)(frf >> 16));
-    rmf95_write_reg(REG_FRF_MID, (uint8_t)(frf >> 8));
-    rmf95_write_reg(REG_FRF_LSB, (uint8_t) frf);
+/* Publica o slot preenchido pela última leitura da FIFO */
+static void rmf95_commit_slot(rfm95_t* radio) {
+    lora_packet_t* slot = radio->fifo_dma.slot;
+    radio->fifo_dma.slot = NULL;
+    radio->rx_irq.ready[radio->rx_irq.ready_in % LORA_RX_POOL_SIZE] = (uint8_t)(slot - radio->rx_irq.pool);
+    hal_memory_barrier();                                // slot completo antes do índice
+    radio->rx_irq.ready_in++;
+    radio->rx_irq.counters.received++;
+    uint32_t waiting = radio->rx_irq.ready_in - radio->rx_irq.ready_out;
+    if (waiting > radio->mc.counters.rx_ready_high_water) {
+        radio->mc.counters.rx_ready_high_water = (uint8_t)waiting;
+    }
+    radio->spi_counters.last_rx_packet = radio->spi_counters.total - radio->fifo_dma.first_transaction;
+
+    if (radio->rx_irq.callback) {
+        radio->rx_irq.callback(slot);
+    }
 }
 
-/* Define a potência de transmissão (2 dBm–17 dBm) usando PA_BOOST */
-void lora_set_power(uint8_t power) {
-    if (power > 17) power = 17;
-    if (power < 2)  power = 2;
-    rmf95_write_reg(REG_PA_CONFIG, 0x80 | (power - 2));   // 0x80 → PA_BOOST
+/* Copia o pacote sinalizado por RxDone da FIFO para um slot livre do pool */
+static void rmf95_store_packet(rfm95_t* radio, const uint8_t* info, bool allow_dma) {
+    RMF95_STATS_RX_DONE(info);
+    if (RX_INFO(info, REG_IRQ_FLAGS) & IRQ_PAYLOAD_CRC_ERROR_MASK) {
+        radio->rx_irq.counters.crc_errors++;             // CRC inválido
+        return;
+    }
+    if (radio->rx_irq.free_out == radio->rx_irq.free_in) {
+        radio->rx_irq.counters.exhausted++;              // pool esgotado
+        return;
+    }
+
+    hal_memory_barrier();
+    lora_packet_t* slot = &radio->rx_irq.pool[radio->rx_irq.free_ring[radio->rx_irq.free_out % LORA_RX_POOL_SIZE]];
+    radio->rx_irq.free_out++;
+    uint8_t in_use = LORA_RX_POOL_SIZE - (uint8_t)(radio->rx_irq.free_in - radio->rx_irq.free_out);
+    if (in_use > radio->rx_irq.counters.high_water) {
+        radio->rx_irq.counters.high_water = in_use;
+    }
+    slot->length = RX_INFO(info, REG_RX_NB_BYTES);
+    slot->rssi = rfm95_packet_rssi(radio);
+    slot->snr  = rfm95_packet_snr(radio);
+    slot->timestamp_us = hal_time_us();
+    slot->radio = radio->index;
+    radio->fifo_dma.slot = slot;
+
+    rmf95_write_reg(radio, REG_FIFO_ADDR_PTR, RX_INFO(info, REG_FIFO_RX_CURRENT_ADDR));
+    if (!rmf95_fifo_transfer(radio, NULL, slot->data, slot->length, allow_dma)) {
+        rmf95_commit_slot(radio);
+    }
 }
 
-void lora_sleep() {
-    rmf95_write_reg(REG_OP_MODE, MODE_LORA | MODE_SLEEP);
+/* Dispara a transmissão do pacote já carregado na FIFO */
+static void rmf95_tx_start(rfm95_t* radio) {
+    rmf95_write_reg(radio, REG_PAYLOAD_LENGTH, radio->fifo_dma.tx_size);
+    rmf95_set_dio_mapping(radio, DIO0_TX_DONE);
+    rmf95_set_mode(radio, MODE_LORA | MODE_TX);
+    radio->spi_counters.last_tx_packet = radio->spi_counters.total - radio->fifo_dma.first_transaction;
 }
 
-void lora_idle() {
-    rmf95_write_reg(REG_OP_MODE, MODE_LORA | MODE_STDBY);
+/* Carrega o quadro na FIFO (por DMA, se permitido) e dispara a transmissão */
+static void rmf95_tx_fifo(rfm95_t* radio, const uint8_t* buffer, uint8_t size, bool allow_dma) {
+    radio->fifo_dma.first_transaction = radio->spi_counters.total;
+    radio->fifo_dma.tx_size = size;
+    rmf95_set_mode(radio, MODE_LORA | MODE_STDBY);
+    rmf95_tune(radio, &radio->channel.tx);
+    rmf95_write_reg(radio, REG_FIFO_ADDR_PTR, 0);
+    if (!rmf95_fifo_transfer(radio, buffer, NULL, size, allow_dma)) {
+        rmf95_tx_start(radio);                           // senão, no fim do DMA
+    }
 }
 
-/* Envia um pacote: grava FIFO, aciona modo TX e espera IRQ_TX_DONE */
-void lora_send_packet(const uint8_t* buffer, uint8_t size) {
-    lora_idle();
-    rmf95_write_reg(REG_FIFO_ADDR_PTR, 0);
-    rmf95_write_fifo(buffer, size);
-    rmf95_write_reg(REG_PAYLOAD_LENGTH, size);
+/* Coloca o rádio em RX contínuo no canal base com RxDone mapeado em DIO0 */
+static void rmf95_start_rx_irq(rfm95_t* radio) {
+    rmf95_tune_base(radio);
+    rmf95_set_dio_mapping(radio, DIO0_RX_DONE);
+    rmf95_set_mode(radio, MODE_LORA | MODE_RX_CONTINUOUS);
+}
+
+static void rmf95_cad_alarm(void* ctx);
 
-    rmf95_write_reg(REG_OP_MODE, MODE_LORA | MODE_TX);
+/* Sorteio xorshift32 para o back-off do LBT */
+static uint32_t rmf95_random(rfm95_t* radio) {
+    uint32_t x = radio->cad.random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    radio->cad.random = x;
+    return x;
+}
 
-    while (!(rmf95_read_reg(REG_IRQ_FLAGS) & IRQ_TX_DONE_MASK)) {
-        sleep_ms(1);                                    // espera TX terminar
+/* Volta a escutar: RX contínuo ou, na recepção em ciclos, sleep até o próximo CAD */
+static void rmf95_resume_rx(rfm95_t* radio) {
+    if (radio->cad.cycle_us == 0) {
+        rmf95_start_rx_irq(radio);
+        return;
     }
-    rmf95_write_reg(REG_IRQ_FLAGS, IRQ_TX_DONE_MASK);   // limpa flag
-    lora_idle();
+    radio->cad.state = CAD_CYCLE_SLEEP;
+    rmf95_set_mode(radio, MODE_LORA | MODE_SLEEP);
+    hal_alarm_start(radio->cad.cycle_us, rmf95_cad_alarm, radio);
 }
 
-/* Recebe pacote em modo contínuo; retorna tamanho ou 0 se nada recebido */
-int lora_receive_packet(uint8_t* buffer, int max_size) {
-    rmf95_write_reg(REG_OP_MODE, MODE_LORA | MODE_RX_CONTINUOUS);
+/* Dispara um CAD a partir de standby, no canal do quadro adiado (LBT) ou no
+   base; o CadDone chega por DIO0 */
+static void rmf95_cad_start(rfm95_t* radio, rmf95_cad_state_t state) {
+    radio->cad.state = state;
+    radio->cad.counters.cad_runs++;
+    rmf95_set_mode(radio, MODE_LORA | MODE_STDBY);
+    rmf95_tune(radio, state == CAD_LBT ? &radio->channel.tx : &radio->channel.base);
+    rmf95_set_dio_mapping(radio, DIO0_CAD_DONE);
+    rmf95_set_mode(radio, MODE_LORA | MODE_CAD);
+}
 
-    uint8_t irq = rmf95_read_reg(REG_IRQ_FLAGS);
-    if (irq & IRQ_RX_DONE_MASK) {
-        rmf95_write_reg(REG_IRQ_FLAGS, IRQ_RX_DONE_MASK); // limpa flag
+/* Canal ocupado para o quadro adiado: espera um tempo sorteado escutando
+   ou, esgotadas as tentativas, transmite assim mesmo */
+static void rmf95_lbt_busy(rfm95_t* radio, bool allow_dma) {
+    if (++radio->cad.attempts >= radio->cad.lbt.max_attempts) {
+        radio->cad.counters.lbt_fallbacks++;
+        radio->cad.state = CAD_NONE;
+        rmf95_tx_fifo(radio, radio->cad.tx_buffer, radio->cad.tx_size, allow_dma);
+        return;
+    }
+    radio->cad.counters.lbt_backoffs++;
+    radio->cad.state = CAD_LBT_BACKOFF;
+    if (radio->rx_irq.active && radio->cad.cycle_us == 0) {
+        rmf95_start_rx_irq(radio);                       // escuta o canal base enquanto espera
+    }
+    uint32_t span = radio->cad.lbt.backoff_max_us - radio->cad.lbt.backoff_min_us;
+    hal_alarm_start(radio->cad.lbt.backoff_min_us + rmf95_random(radio) % (span + 1), rmf95_cad_alarm, radio);
+}
+
+/* Uma tentativa do LBT: um pacote já chegando (RX contínuo) conta como canal
+   ocupado sem gastar um CAD, que também o abortaria */
+static void rmf95_lbt_attempt(rfm95_t* radio, bool allow_dma) {
+    if (radio->shadow.op_mode == (MODE_LORA | MODE_RX_CONTINUOUS) &&
+        (rmf95_read_reg(radio, REG_MODEM_STAT) & MODEM_STAT_SIGNAL_DETECTED)) {
+        rmf95_lbt_busy(radio, allow_dma);
+        return;
+    }
+    rmf95_cad_start(radio, CAD_LBT);
+}
+
+/* Abre o RX single de um ciclo: RxDone em DIO0, RxTimeout após symbols em DIO1 */
+static void rmf95_cycle_rx(rfm95_t* radio, uint16_t symbols) {
+    radio->cad.state = CAD_CYCLE_RX;
+    rmf95_set_mode(radio, MODE_LORA | MODE_STDBY);
+    rmf95_tune(radio, &radio->channel.base);
+    rmf95_set_symb_timeout(radio, symbols);
+    rmf95_set_dio_mapping(radio, DIO0_RX_DONE);
+    rmf95_set_mode(radio, MODE_LORA | MODE_RX_SINGLE);
+}
+
+/* Desliga a recepção em ciclos (um back-off do LBT em andamento continua) */
+static void rmf95_cad_cycle_stop(rfm95_t* radio) {
+    radio->cad.cycle_us = 0;
+    radio->cad.cycle_window = 0;
+    if (radio->cad.state >= CAD_CYCLE_SLEEP) {
+        hal_alarm_cancel(radio);
+        radio->cad.state = CAD_NONE;
+    }
+}
+
+/* Carrega e transmite o quadro no canal frf (NULL: o base; com o FHSS, sempre
+   o base); com o LBT ligado o CAD vem antes e a FIFO só é escrita com o canal
+   livre, já que a escuta do back-off usa a mesma área.
+   Deve ser chamada com o rádio fora de TX e a interrupção mascarada */
+static void rmf95_tx_load(rfm95_t* radio, const uint8_t* buffer, uint8_t size, const lora_frf_t* frf,
+                          bool allow_dma) {
+    radio->tx_async.busy = true;
+    radio->channel.tx = radio->channel.base;
+    if (frf && !radio->channel.fhss && memcmp(frf, &radio->channel.base, sizeof(*frf)) != 0) {
+        radio->channel.tx = *frf;
+        radio->channel.counters.channel_frames++;
+    }
+    if (radio->cad.state >= CAD_CYCLE_SLEEP) {
+        hal_alarm_cancel(radio);                         // o ciclo recomeça no TxDone
+        radio->cad.state = CAD_NONE;
+    }
+    if (!radio->cad.lbt_enabled) {
+        rmf95_tx_fifo(radio, buffer, size, allow_dma);
+        return;
+    }
+    radio->cad.tx_buffer = buffer;
+    radio->cad.tx_size = size;
+    radio->cad.attempts = 0;
+    rmf95_lbt_attempt(radio, allow_dma);
+}
+
+/* Retira o quadro de maior prioridade da fila; retorna o slot ou TXQ_NONE */
+static uint8_t rmf95_txq_pop(rfm95_t* radio) {
+    for (int prio = 0; prio < LORA_PRIO_COUNT; prio++) {
+        if (radio->txq.count[prio] == 0) continue;
+        uint8_t slot = radio->txq.ring[prio][radio->txq.head[prio]];
+        radio->txq.head[prio] = (radio->txq.head[prio] + 1) % LORA_TX_QUEUE_SIZE;
+        radio->txq.count[prio]--;
+        radio->txq.queued--;
+        return slot;
+    }
+    return TXQ_NONE;
+}
+
+static void rmf95_txq_free(rfm95_t* radio, uint8_t slot) {
+    radio->txq.free_slots[radio->txq.free_count++] = slot;
+}
+
+/* Carrega o próximo quadro da fila, se houver; retorna true se um envio começou */
+static bool rmf95_txq_start_next(rfm95_t* radio, bool allow_dma) {
+    uint8_t slot = rmf95_txq_pop(radio);
+    if (slot == TXQ_NONE) return false;
+    radio->txq.current = slot;
+    rmf95_tx_load(radio, radio->txq.frames[slot].data, radio->txq.frames[slot].length,
+                  radio->txq.frames[slot].has_frf ? &radio->txq.frames[slot].frf : NULL, allow_dma);
+    return true;
+}
+
+/* CadDone (o rádio já voltou para standby): entrega o resultado a quem pediu o CAD.
+   allow_dma vale para a carga da FIFO de um envio liberado pelo LBT */
+static void rmf95_cad_done(rfm95_t* radio, bool detected, bool allow_dma) {
+    if (detected) radio->cad.counters.cad_detected++;
+
+    switch (radio->cad.state) {
+        case CAD_USER:
+            radio->cad.detected = detected;
+            radio->cad.state = CAD_NONE;                 // libera rfm95_cad()
+            break;
+        case CAD_LBT:
+            if (detected) {
+                rmf95_lbt_busy(radio, allow_dma);
+            } else {
+                radio->cad.state = CAD_NONE;
+                rmf95_tx_fifo(radio, radio->cad.tx_buffer, radio->cad.tx_size, allow_dma);
+            }
+            break;
+        case CAD_CYCLE_CAD:
+            if (detected) {
+                rmf95_cycle_rx(radio, DEFAULT_SYMB_TIMEOUT);   // o preâmbulo ainda está no ar
+            } else {
+                rmf95_resume_rx(radio);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/* Trata as flags pendentes do rádio (FhssChangeChannel/TxDone/RxDone/CadDone/
+   RxTimeout); allow_dma libera a leitura da FIFO por DMA (só em contexto de interrupção) */
+static void rmf95_service_irq(rfm95_t* radio, bool allow_dma) {
+    uint32_t first_transaction = radio->spi_counters.total;
+    uint8_t info[RX_INFO_LENGTH];
+    rmf95_read_rx_info(radio, info);
+
+    uint8_t irq = RX_INFO(info, REG_IRQ_FLAGS);
+    if (irq == 0) return;
+    rmf95_write_reg(radio, REG_IRQ_FLAGS, irq);          // limpa as flags lidas
+    if (irq & IRQ_RX_TIMEOUT_MASK) {
+        RMF95_STATS_INC(rx_timeouts);
+    }
+    if ((irq & IRQ_FHSS_CHANGE_CHANNEL_MASK) && radio->channel.fhss) {
+        // Primeiro, já que o próximo salto vem em hop_period símbolos
+        uint8_t hop = rmf95_read_reg(radio, REG_HOP_CHANNEL) & HOP_CHANNEL_MASK;
+        rmf95_tune(radio, &radio->channel.fhss[hop % radio->channel.fhss_count]);
+        radio->channel.counters.fhss_hops++;
+    }
+
+    if ((irq & IRQ_TX_DONE_MASK) && radio->tx_async.busy) {
+        radio->shadow.op_mode = MODE_LORA | MODE_STDBY;   // o rádio volta sozinho para standby
+        rmf95_power_mode(radio, radio->shadow.op_mode);
+        RMF95_STATS_INC(tx_packets);
+        radio->tx_async.busy = false;
+        if (radio->txq.current != TXQ_NONE) {
+            lora_tx_stamp_t* stamp = radio->txq.frames[radio->txq.current].stamp;
+            if (stamp) {
+                stamp->done_us = (uint32_t)hal_time_us();
+                hal_memory_barrier();                    // instante antes da marca
+                stamp->done = true;
+            }
+            rmf95_txq_free(radio, radio->txq.current);
+            radio->txq.current = TXQ_NONE;
+            radio->txq.counters.sent++;
+        }
+        if (radio->tx_async.callback) {
+            radio->tx_async.callback();
+        }
+
+        // O próximo quadro vai para a FIFO sem passar pela aplicação
+        if (!radio->tx_async.busy && !rmf95_txq_start_next(radio, allow_dma)) {
+            if (radio->rx_irq.active) {
+                rmf95_resume_rx(radio);                  // volta a escutar
+            } else {
+                rmf95_tune(radio, &radio->channel.base); // fica em standby no canal base
+            }
+        }
+    }
+    if ((irq & IRQ_CAD_DONE_MASK) &&
+        (radio->cad.state == CAD_USER || radio->cad.state == CAD_LBT || radio->cad.state == CAD_CYCLE_CAD)) {
+        radio->shadow.op_mode = MODE_LORA | MODE_STDBY;   // o CAD termina em standby
+        rmf95_power_mode(radio, radio->shadow.op_mode);
+        rmf95_cad_done(radio, irq & IRQ_CAD_DETECTED_MASK, allow_dma);
+    }
+    if ((irq & IRQ_RX_DONE_MASK) && radio->rx_irq.active) {
+        radio->fifo_dma.first_transaction = first_transaction;
+        rmf95_store_packet(radio, info, allow_dma);
+        if (radio->channel.fhss && radio->shadow.op_mode == (MODE_LORA | MODE_RX_CONTINUOUS) &&
+            !radio->fifo_dma.busy) {
+            rmf95_start_rx_irq(radio);                   // o próximo pacote começa no canal base
+        }
+    }
+    if ((irq & (IRQ_RX_DONE_MASK | IRQ_RX_TIMEOUT_MASK)) && radio->cad.state == CAD_CYCLE_RX) {
+        radio->shadow.op_mode = MODE_LORA | MODE_STDBY;   // RX single termina em standby
+        rmf95_power_mode(radio, radio->shadow.op_mode);
+        if (!(irq & IRQ_RX_DONE_MASK)) {
+            radio->cad.counters.cycle_rx_timeouts++;
+        }
+        if (!radio->fifo_dma.busy) {
+            rmf95_resume_rx(radio);                      // senão, no fim do DMA
+        }
+    }
+}
 
-        if (irq & IRQ_PAYLOAD_CRC_ERROR_MASK) {
-            return 0;                                     // CRC inválido
+/* Fim do DMA da FIFO: fecha a transação, conclui a leitura ou o envio e atende
+   as interrupções que chegaram aos módulos do mesmo barramento durante o DMA */
+static void rmf95_fifo_dma_done(void* ctx) {
+    rfm95_t* radio = ctx;
+    rmf95_bus_t* bus = radio->bus;
+    rmf95_deselect(radio);
+    radio->fifo_dma.busy = bus->busy = false;
+
+    if (radio->fifo_dma.slot) {
+        rmf95_commit_slot(radio);
+        if (radio->cad.state == CAD_CYCLE_RX) {
+            rmf95_resume_rx(radio);
+        } else if (radio->channel.fhss && radio->shadow.op_mode == (MODE_LORA | MODE_RX_CONTINUOUS)) {
+            rmf95_start_rx_irq(radio);
         }
+    } else {
+        rmf95_tx_start(radio);
+    }
 
-        uint8_t len = rmf95_read_reg(REG_RX_NB_BYTES);
-        if (len > max_size) len = max_size;
+    // Um novo DMA ocupa o barramento de novo; os que sobrarem ficam para o fim dele
+    for (uint16_t i = 0; i < LORA_MAX_RADIOS && !bus->busy; i++) {
+        rfm95_t* pending = &radios[i];
+        if (pending->in_use && pending->bus == bus && pending->fifo_dma.irq_pending) {
+            pending->fifo_dma.irq_pending = false;
+            rmf95_service_irq(pending, true);
+        }
+    }
+}
 
-        uint8_t fifo_addr = rmf95_read_reg(REG_FIFO_RX_CURRENT_ADDR);
-        rmf95_write_reg(REG_FIFO_ADDR_PTR, fifo_addr);
-        rmf95_read_fifo(buffer, len);
-        return len;
+/* Interrupção de DIO0 ou DIO1 de um módulo */
+static void rmf95_radio_isr(rfm95_t* radio) {
+    // Em modo polling (lora_receive_packet) as flags ficam para o chamador
+    if (!radio->rx_irq.active && !radio->tx_async.busy && radio->cad.state == CAD_NONE) return;
+    if (radio->bus->busy) {
+        radio->fifo_dma.irq_pending = true;              // tratado no fim do DMA
+        return;
     }
-    return 0;   // nada recebido
+    uint32_t cycles = RMF95_STATS_CYCLES();
+    rmf95_service_irq(radio, true);
+    RMF95_STATS_HIST(isr_cycles, cycles);
 }
 
-/* RSSI absoluto: (-157 dBm para 915 MHz) + valor lido */
-int lora_packet_rssi() {
-    return (rmf95_read_reg(REG_PKT_RSSI_VALUE) - 157);
+/* Tratador das interrupções de DIO0 e DIO1: encontra o módulo pelo pino */
+static void rmf95_dio_isr(uint pin) {
+    for (uint16_t i = 0; i < LORA_MAX_RADIOS; i++) {
+        rfm95_t* radio = &radios[i];
+        if (radio->in_use && (pin == radio->pins.dio0 || pin == radio->pins.dio1)) {
+            rmf95_radio_isr(radio);
+        }
+    }
 }
 
-/* SNR em dB (valor fracionário; cada unidade = 0,25 dB) */
-float lora_packet_snr() {
-    return ((int8_t)rmf95_read_reg(REG_PKT_SNR_VALUE)) * 0.25f;
+/* Alarme da HAL do módulo: fim do back-off do LBT ou hora do próximo despertar dos ciclos */
+static void rmf95_cad_alarm(void* ctx) {
+    rfm95_t* radio = ctx;
+    if (radio->bus->busy) {
+        hal_alarm_start(CAD_RETRY_US, rmf95_cad_alarm, radio);
+        return;
+    }
+    if (radio->cad.state == CAD_LBT_BACKOFF) {
+        rmf95_lbt_attempt(radio, true);
+    } else if (radio->cad.state == CAD_CYCLE_SLEEP) {
+        radio->cad.counters.cycle_wakeups++;
+        if (radio->cad.cycle_window) {
+            rmf95_cycle_rx(radio, radio->cad.cycle_window);   // janela agendada, sem CAD
+        } else {
+            rmf95_cad_start(radio, CAD_CYCLE_CAD);
+        }
+    }
+}
+
+/* Duração do símbolo em us: 2^SF / BW */
+static uint32_t rmf95_symbol_us(uint8_t sf, lora_bandwidth_t bw) {
+    return (uint32_t)(((uint64_t)1000000 << sf) / bandwidth_hz[bw]);
+}
+
+/* Valida a combinação; retorna a duração do símbolo em us (0 se inválida) e
+   se LowDataRateOptimize deve ficar ligado */
+static uint32_t rmf95_validate_modem(const lora_modem_config_t* cfg, bool* ldro) {
+    if (cfg->spreading_factor < 6 || cfg->spreading_factor > 12) return 0;
+    if ((unsigned)cfg->bandwidth > LORA_BW_500K) return 0;
+    if (cfg->coding_rate < LORA_CR_4_5 || cfg->coding_rate > LORA_CR_4_8) return 0;
+    if (cfg->preamble_length < 6) return 0;
+    if (cfg->spreading_factor == 6 && !cfg->implicit_header) return 0;   // SF6 só implícito
+
+    uint32_t symbol_us = rmf95_symbol_us(cfg->spreading_factor, cfg->bandwidth);
+    bool ldro_required = symbol_us > LDRO_SYMBOL_US;
+    if (cfg->ldro == LORA_LDRO_OFF && ldro_required) return 0;
+    *ldro = cfg->ldro == LORA_LDRO_ON || ldro_required;
+    return symbol_us;
+}
+
+/* Valida a combinação e grava os registradores do modem (rádio em sleep/standby).
+   Retorna a duração do símbolo em us ou 0 se a configuração é inválida */
+static uint32_t rmf95_apply_modem(rfm95_t* radio, const lora_modem_config_t* cfg) {
+    bool ldro;
+    uint32_t symbol_us = rmf95_validate_modem(cfg, &ldro);
+    if (symbol_us == 0) return 0;
+
+    /* 0x1D-0x21: modem, timeout de símbolo e preâmbulo em uma rajada */
+    rmf95_txn_t txn = { .count = 0 };
+    rmf95_txn_write(radio, &txn, REG_MODEM_CONFIG_1,
+                    (cfg->bandwidth << 4) | (cfg->coding_rate << 1) | (cfg->implicit_header ? 0x01 : 0x00));
+    rmf95_txn_write(radio, &txn, REG_MODEM_CONFIG_2,
+                    (cfg->spreading_factor << 4) | (cfg->crc ? 0x04 : 0x00) | (radio->modem.symb_timeout >> 8));
+    rmf95_txn_write(radio, &txn, REG_SYMB_TIMEOUT_LSB, (uint8_t)radio->modem.symb_timeout);
+    rmf95_txn_write(radio, &txn, REG_PREAMBLE_MSB, (uint8_t)(cfg->preamble_length >> 8));
+    rmf95_txn_write(radio, &txn, REG_PREAMBLE_LSB, (uint8_t)cfg->preamble_length);
+    rmf95_txn_write(radio, &txn, REG_MODEM_CONFIG_3, ldro ? MODEM3_LOW_DATA_RATE_OPT : 0x00);
+
+    /* Detecção otimizada: valores exigidos para SF6 e para SF7-SF12 */
+    bool sf6 = cfg->spreading_factor == 6;
+    rmf95_txn_write(radio, &txn, REG_DETECTION_OPTIMIZE, sf6 ? 0xC5 : 0xC3);
+    rmf95_txn_write(radio, &txn, REG_DETECTION_THRESHOLD, sf6 ? 0x0C : 0x0A);
+    rmf95_txn_commit(radio, &txn);
+
+    radio->modem.config = *cfg;
+    radio->modem.symbol_us = symbol_us;
+    radio->modem.ldro = ldro;
+    return symbol_us;
+}
+
+/* No modo multinúcleo, executa fn no núcleo dos rádios e espera o resultado.
+   Retorna false (sem executar nada) se a chamada já pode rodar localmente */
+static bool rmf95_forward(rfm95_t* radio, rmf95_remote_fn_t fn, uintptr_t a, uintptr_t b, uint32_t* result) {
+    if (!remote.active || hal_core_num() == RMF95_RADIO_CORE) return false;
+
+    uint64_t start = hal_time_us();
+    remote.call_radio = radio;
+    remote.call_a = a;
+    remote.call_b = b;
+    remote.call_done = false;
+    hal_memory_barrier();
+    remote.call_fn = fn;
+    hal_core_notify();
+    while (!remote.call_done) {
+        hal_yield();
+    }
+    hal_memory_barrier();
+    if (result) *result = remote.call_result;
+
+    uint32_t elapsed = (uint32_t)(hal_time_us() - start);
+    radio->mc.counters.remote_calls++;
+    if (elapsed > radio->mc.counters.remote_call_max_us) radio->mc.counters.remote_call_max_us = elapsed;
+    return true;
+}
+
+/* Parâmetros da recepção em ciclos (mais que os dois de uma chamada remota) */
+typedef struct {
+    uint32_t period_ms;
+    uint16_t window_symbols;     // 0: CAD a cada despertar
+    lora_rx_callback_t callback;
+} rmf95_cycle_args_t;
+
+/* Liga a recepção em ciclos: sleep → alarme → CAD ou janela → RX single → sleep.
+   Não combina com o FHSS, que ocupa DIO1 */
+static bool rmf95_receive_cycle_start(rfm95_t* radio, const rmf95_cycle_args_t* args) {
+    uint32_t irq_state = rmf95_lock(radio);
+    if (radio->channel.fhss) {
+        rmf95_unlock(irq_state);
+        return false;
+    }
+    rmf95_cad_cycle_stop(radio);
+    radio->rx_irq.callback  = args->callback;
+    radio->rx_irq.active    = true;
+    radio->cad.cycle_us     = args->period_ms * 1000;
+    radio->cad.cycle_window = args->window_symbols;
+
+    if (!radio->tx_async.busy && radio->cad.state == CAD_NONE) {   // senão, começa no TxDone
+        rmf95_set_mode(radio, MODE_LORA | MODE_STDBY);
+        rmf95_write_reg(radio, REG_IRQ_FLAGS, 0xFF);     // descarta flags antigas
+        rmf95_resume_rx(radio);
+    }
+    rmf95_unlock(irq_state);
+    return true;
+}
+
+/* Parâmetros do FHSS */
+typedef struct {
+    const lora_frf_t* channels;
+    uint8_t count;
+    uint8_t hop_period;
+} rmf95_fhss_args_t;
+
+/* Liga ou desliga o FHSS com o rádio livre (standby, sem TX nem CAD) */
+static bool rmf95_set_fhss(rfm95_t* radio, const rmf95_fhss_args_t* args) {
+    uint32_t irq_state = rmf95_lock(radio);
+    if (radio->tx_async.busy || radio->cad.state != CAD_NONE || radio->cad.cycle_us) {
+        rmf95_unlock(irq_state);
+        return false;
+    }
+    rmf95_set_mode(radio, MODE_LORA | MODE_STDBY);
+    radio->channel.fhss = args->channels;
+    radio->channel.fhss_count = args->channels ? args->count : 0;
+    rmf95_write_reg(radio, REG_HOP_PERIOD, args->channels ? args->hop_period : 0);
+    rmf95_set_dio_mapping(radio, radio->shadow.dio_mapping & DIO0_MASK);   // DIO1 conforme o FHSS
+    if (args->channels) {
+        radio->channel.base = args->channels[0];
+    }
+    rmf95_tune(radio, &radio->channel.base);
+    if (radio->rx_irq.active) {
+        rmf95_start_rx_irq(radio);
+    }
+    rmf95_unlock(irq_state);
+    return true;
+}
+
+/* Invólucros das chamadas encaminhadas ao núcleo do rádio */
+static uint32_t rmf95_remote_init(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    return rfm95_init(radio, (const rfm95_pins_t*)a, (const lora_config_t*)b);
+}
+
+static uint32_t rmf95_remote_set_channel(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)b;
+    rfm95_set_channel(radio, (const lora_frf_t*)a);
+    return 0;
+}
+
+static uint32_t rmf95_remote_set_modem_config(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)b;
+    return rfm95_set_modem_config(radio, (const lora_modem_config_t*)a);
+}
+
+static uint32_t rmf95_remote_set_power(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)b;
+    rfm95_set_power(radio, (uint8_t)a);
+    return 0;
+}
+
+static uint32_t rmf95_remote_sleep(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)a; (void)b;
+    rfm95_sleep(radio);
+    return 0;
+}
+
+static uint32_t rmf95_remote_idle(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)a; (void)b;
+    rfm95_idle(radio);
+    return 0;
+}
+
+static uint32_t rmf95_remote_send_async(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    return rfm95_send_packet_async(radio, (const uint8_t*)a, (uint8_t)b);
+}
+
+static uint32_t rmf95_remote_tx_queue_flush(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)a; (void)b;
+    rfm95_tx_queue_flush(radio);
+    return 0;
+}
+
+static uint32_t rmf95_remote_receive_packet(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    return (uint32_t)rfm95_receive_packet(radio, (uint8_t*)a, (int)b);
+}
+
+static uint32_t rmf95_remote_receive_irq_start(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)b;
+    rfm95_receive_irq_start(radio, (lora_rx_callback_t)a);
+    return 0;
+}
+
+static uint32_t rmf95_remote_receive_irq_stop(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)a; (void)b;
+    rfm95_receive_irq_stop(radio);
+    return 0;
+}
+
+static uint32_t rmf95_remote_cad(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)a; (void)b;
+    return rfm95_cad(radio);
+}
+
+static uint32_t rmf95_remote_set_lbt(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)b;
+    return rfm95_set_lbt(radio, (const lora_lbt_config_t*)a);
+}
+
+static uint32_t rmf95_remote_receive_cycle_start(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)b;
+    return rmf95_receive_cycle_start(radio, (const rmf95_cycle_args_t*)a);
+}
+
+static uint32_t rmf95_remote_set_fhss(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)b;
+    return rmf95_set_fhss(radio, (const rmf95_fhss_args_t*)a);
+}
+
+static uint32_t rmf95_remote_power_report(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)b;
+    rfm95_power_report(radio, (lora_power_report_t*)a);
+    return 0;
+}
+
+static uint32_t rmf95_remote_power_reset(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)a; (void)b;
+    rfm95_power_reset(radio);
+    return 0;
+}
+
+#if LORA_STATS
+static uint32_t rmf95_remote_stats_snapshot(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)b;
+    return rfm95_stats_snapshot(radio, (lora_stats_t*)a);
+}
+
+static uint32_t rmf95_remote_stats_reset(rfm95_t* radio, uintptr_t a, uintptr_t b) {
+    (void)a; (void)b;
+    rfm95_stats_reset(radio);
+    return 0;
+}
+#endif
+
+/* Copia o quadro para o anel entre núcleos; o núcleo 1 o coloca na fila */
+static bool rmf95_handoff_tx(rfm95_t* radio, const uint8_t* buffer, uint8_t size, lora_priority_t priority,
+                             const lora_frf_t* frf, lora_tx_stamp_t* stamp) {
+    if (radio->mc.tx_in - radio->mc.tx_out >= LORA_MC_TX_RING_SIZE) {
+        radio->mc.counters.tx_ring_full++;
+        return false;
+    }
+    uint32_t waiting = radio->mc.tx_in - radio->mc.tx_out + 1;
+    if (waiting > radio->mc.counters.tx_ring_high_water) {
+        radio->mc.counters.tx_ring_high_water = (uint8_t)waiting;
+    }
+
+    hal_memory_barrier();
+    uint32_t index = radio->mc.tx_in % LORA_MC_TX_RING_SIZE;
+    memcpy(radio->mc.tx_ring[index].data, buffer, size);
+    radio->mc.tx_ring[index].length = size;
+    radio->mc.tx_ring[index].priority = priority;
+    radio->mc.tx_ring[index].has_frf = frf != NULL;
+    if (frf) {
+        radio->mc.tx_ring[index].frf = *frf;
+    }
+    radio->mc.tx_ring[index].stamp = stamp;
+    radio->mc.tx_ring[index].enqueued_us = hal_time_us();
+    hal_memory_barrier();                                // quadro completo antes do índice
+    radio->mc.tx_in++;
+    hal_core_notify();
+    return true;
+}
+
+/* Enfileira em O(1); com a fila cheia aplica a política configurada */
+static bool rmf95_txq_push(rfm95_t* radio, const uint8_t* buffer, uint8_t size, lora_priority_t priority,
+                           const lora_frf_t* frf, lora_tx_stamp_t* stamp) {
+    if (size == 0 || (unsigned)priority >= LORA_PRIO_COUNT) return false;
+    if (remote.active && hal_core_num() != RMF95_RADIO_CORE) {
+        return rmf95_handoff_tx(radio, buffer, size, priority, frf, stamp);
+    }
+    uint32_t irq_state = rmf95_lock(radio);
+    if (radio->txq.free_count == 0 && radio->txq.policy == LORA_TXQ_DROP_OLDEST) {
+        // Vítima: o mais antigo da classe menos prioritária que não supera a nova
+        for (int prio = LORA_PRIO_COUNT - 1; prio >= (int)priority; prio--) {
+            if (radio->txq.count[prio] == 0) continue;
+            rmf95_txq_free(radio, radio->txq.ring[prio][radio->txq.head[prio]]);
+            radio->txq.head[prio] = (radio->txq.head[prio] + 1) % LORA_TX_QUEUE_SIZE;
+            radio->txq.count[prio]--;
+            radio->txq.queued--;
+            radio->txq.counters.dropped++;
+            break;
+        }
+    }
+    if (radio->txq.free_count == 0) {
+        radio->txq.counters.dropped++;
+        rmf95_unlock(irq_state);
+        return false;
+    }
+
+    uint8_t slot = radio->txq.free_slots[--radio->txq.free_count];
+    memcpy(radio->txq.frames[slot].data, buffer, size);
+    radio->txq.frames[slot].length = size;
+    radio->txq.frames[slot].has_frf = frf != NULL;
+    if (frf) {
+        radio->txq.frames[slot].frf = *frf;
+    }
+    radio->txq.frames[slot].stamp = stamp;
+    radio->txq.ring[priority][(radio->txq.head[priority] + radio->txq.count[priority]) % LORA_TX_QUEUE_SIZE] = slot;
+    radio->txq.count[priority]++;
+    radio->txq.queued++;
+    radio->txq.counters.enqueued++;
+    if (radio->txq.queued > radio->txq.counters.high_water) {
+        radio->txq.counters.high_water = radio->txq.queued;
+    }
+
+    if (!radio->tx_async.busy && radio->cad.state != CAD_USER) {   // senão, no fim de rfm95_cad()
+        if (radio->rx_irq.active) {
+            rmf95_service_irq(radio, false);             // não perde um RxDone pendente
+        }
+        if (!radio->tx_async.busy) {
+            rmf95_txq_start_next(radio, true);
+        }
+    }
+    rmf95_unlock(irq_state);
+    return true;
+}
+
+/* Coloca na fila do rádio os quadros que o núcleo 0 deixou no anel */
+static void rmf95_drain_tx_ring(rfm95_t* radio) {
+    while (radio->mc.tx_out != radio->mc.tx_in) {
+        hal_memory_barrier();
+        uint32_t index = radio->mc.tx_out % LORA_MC_TX_RING_SIZE;
+        uint32_t latency = (uint32_t)(hal_time_us() - radio->mc.tx_ring[index].enqueued_us);
+        radio->mc.counters.tx_handoff_last_us = latency;
+        if (latency > radio->mc.counters.tx_handoff_max_us) radio->mc.counters.tx_handoff_max_us = latency;
+
+        rmf95_txq_push(radio, radio->mc.tx_ring[index].data, radio->mc.tx_ring[index].length,
+                       radio->mc.tx_ring[index].priority,
+                       radio->mc.tx_ring[index].has_frf ? &radio->mc.tx_ring[index].frf : NULL,
+                       radio->mc.tx_ring[index].stamp);
+        hal_memory_barrier();
+        radio->mc.tx_out++;                              // depois que tx_async.busy já reflete o quadro
+    }
+}
+
+/* Troca o tratador de DIO0/DIO1 de todos os rádios em uso, no núcleo chamador */
+static void rmf95_set_dio_irqs(hal_gpio_irq_handler_t handler) {
+    for (uint16_t i = 0; i < LORA_MAX_RADIOS; i++) {
+        if (!radios[i].in_use) continue;
+        hal_gpio_set_irq(radios[i].pins.dio0, handler);
+        hal_gpio_set_irq(radios[i].pins.dio1, handler);
+    }
+}
+
+/* Laço do núcleo 1: atende DIO0/DIO1 e os alarmes de CAD dos rádios por interrupção e, a cada
+   sinal do núcleo 0, executa a chamada remota pendente e esvazia os anéis de transmissão */
+static void rmf95_core1_main() {
+    for (uint16_t i = 0; i < LORA_MAX_RADIOS; i++) {
+        rfm95_t* radio = &radios[i];
+        if (!radio->in_use) continue;
+        hal_gpio_set_irq(radio->pins.dio0, &rmf95_dio_isr);
+        hal_gpio_set_irq(radio->pins.dio1, &rmf95_dio_isr);
+
+        // Uma borda de DIO0/DIO1 pode ter chegado durante a troca de núcleo
+        uint32_t irq_state = rmf95_lock(radio);
+        if (radio->rx_irq.active || radio->tx_async.busy || radio->cad.state != CAD_NONE) {
+            rmf95_service_irq(radio, false);
+        }
+        rmf95_unlock(irq_state);
+    }
+
+    for (;;) {
+        hal_core_wait();
+
+        rmf95_remote_fn_t fn = remote.call_fn;
+        if (fn) {
+            hal_memory_barrier();
+            remote.call_result = fn(remote.call_radio, remote.call_a, remote.call_b);
+            remote.call_fn = NULL;
+            hal_memory_barrier();
+            remote.call_done = true;
+        }
+
+        for (uint16_t i = 0; i < LORA_MAX_RADIOS; i++) {
+            if (radios[i].in_use) {
+                rmf95_drain_tx_ring(&radios[i]);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Implementação das Funções Públicas
+// ============================================================================
+
+rfm95_t* rfm95_radio(uint16_t index) {
+    return index < LORA_MAX_RADIOS ? &radios[index] : NULL;
+}
+
+bool rfm95_init(rfm95_t* radio, const rfm95_pins_t* pins, const lora_config_t* cfg) {
+    uint32_t result;
+    if (rmf95_forward(radio, rmf95_remote_init, (uintptr_t)pins, (uintptr_t)cfg, &result)) return result;
+
+    rfm95_pins_t default_pins = RFM95_PINS_DEFAULT;
+    lora_config_t default_config = LORA_CONFIG_DEFAULT;
+    if (!pins) pins = &default_pins;
+    if (!cfg) cfg = &default_config;
+
+    hal_alarm_cancel(radio);
+    uint16_t index = (uint16_t)(radio - radios);
+    memset(radio, 0, sizeof(*radio));                    // in_use = false até o fim
+    radio->index = index;
+    if (rmf95_pins_conflict(pins)) {
+        return false;
+    }
+    radio->pins = *pins;
+
+    for (uint8_t i = 0; i < LORA_RX_POOL_SIZE; i++) {
+        radio->rx_irq.free_ring[i] = i;
+    }
+    radio->rx_irq.free_in = LORA_RX_POOL_SIZE;
+    for (uint8_t i = 0; i < LORA_TX_QUEUE_SIZE; i++) {
+        radio->txq.free_slots[i] = i;
+    }
+    radio->txq.free_count = LORA_TX_QUEUE_SIZE;
+    radio->txq.current = TXQ_NONE;
+    radio->txq.policy = cfg->tx_queue_policy;
+    radio->power.mode = LORA_RADIO_STANDBY;              // estado do rádio após o reset
+    radio->power.profile = (lora_power_profile_t)LORA_POWER_PROFILE_RFM95;
+    rmf95_power_clear(radio);
+#if LORA_STATS
+    rmf95_stats_clear(radio);
+#endif
+
+    /* --- Barramento SPI (inicializado só pelo primeiro módulo que o usa) --- */
+    radio->bus = rmf95_bus_attach(pins, cfg->spi_baudrate);
+    radio->config.fifo_dma = cfg->fifo_dma;
+
+    /* --- Pinos de controle CS, RST e interrupções DIO0/DIO1 --- */
+    hal_gpio_init_output(pins->cs, 1);
+    hal_gpio_init_output(pins->rst, 1);
+    hal_gpio_init_input(pins->dio0);
+    hal_gpio_init_input(pins->dio1);
+    hal_gpio_set_irq(pins->dio0, &rmf95_dio_isr);
+    hal_gpio_set_irq(pins->dio1, &rmf95_dio_isr);
+
+    /* --- Reset do módulo e verificação da versão --- */
+    rmf95_reset(radio);
+    radio->shadow.op_mode = 0xFF;                        // modo desconhecido após o reset
+    radio->shadow.dio_mapping = 0x00;                    // valor de reset de REG_DIO_MAPPING_1
+    if (rmf95_read_reg(radio, REG_VERSION) != 0x12) {    // 0x12 é a versão esperada
+        return false;
+    }
+
+    /* --- Entra em modo sleep para configurar com segurança --- */
+    rfm95_sleep(radio);
+
+    /* --- Frequência de operação --- */
+    rfm95_set_frequency(radio, LORA_FREQUENCY_HZ);
+
+    /* --- Demais registradores, agrupados em rajadas de endereços consecutivos --- */
+    rmf95_txn_t txn = { .count = 0 };
+
+    /* LNA com ganho máximo e ponteiros da FIFO (TX e RX no início): 0x0C-0x0F */
+    rmf95_txn_write(radio, &txn, REG_LNA, rmf95_read_reg(radio, REG_LNA) | 0x03);
+    rmf95_txn_write(radio, &txn, REG_FIFO_ADDR_PTR, 0x00);
+    rmf95_txn_write(radio, &txn, REG_FIFO_TX_BASE_ADDR, 0x00);
+    rmf95_txn_write(radio, &txn, REG_FIFO_RX_BASE_ADDR, 0x00);
+
+    rmf95_txn_commit(radio, &txn);
+
+    /* --- Modem: SF7, BW 125 kHz, CR 4/5, CRC on, preâmbulo de 8 símbolos --- */
+    radio->modem.symb_timeout = DEFAULT_SYMB_TIMEOUT;
+    rmf95_apply_modem(radio, &lora_modem_presets[LORA_PRESET_SF7_BW125]);
+
+    /* --- Volta para standby, pronto para TX/RX --- */
+    rfm95_idle(radio);
+    radio->in_use = true;                                // a partir daqui as interrupções são atendidas
+    return true;
+}
+
+/* Converte frequência em Hz para os três registradores FRF (passo de 32 MHz / 2^19) */
+lora_frf_t lora_frf(uint32_t frequency_hz) {
+    uint64_t frf = ((uint64_t)frequency_hz << 19) / RF_CRYSTAL_FREQ_HZ;
+    lora_frf_t out = { { (uint8_t)(frf >> 16), (uint8_t)(frf >> 8), (uint8_t)frf } };
+    return out;
+}
+
+void rfm95_set_frequency(rfm95_t* radio, long frequency) {
+    lora_frf_t frf = lora_frf((uint32_t)frequency);
+    rfm95_set_channel(radio, &frf);
+}
+
+/* Troca o canal base; durante um envio ou CAD ele só vale a partir do fim */
+void rfm95_set_channel(rfm95_t* radio, const lora_frf_t* frf) {
+    if (rmf95_forward(radio, rmf95_remote_set_channel, (uintptr_t)frf, 0, NULL)) return;
+    uint32_t irq_state = rmf95_lock(radio);
+    radio->channel.base = *frf;
+    bool idle = !radio->tx_async.busy && (radio->cad.state == CAD_NONE || radio->cad.state == CAD_CYCLE_SLEEP);
+    if (idle && radio->shadow.op_mode == (MODE_LORA | MODE_RX_CONTINUOUS)) {
+        rmf95_start_rx_irq(radio);
+    } else if (idle) {
+        rmf95_tune(radio, frf);                          // sleep ou standby
+    }
+    rmf95_unlock(irq_state);
+}
+
+/* Troca os parâmetros do modem; a recepção por interrupção é retomada em seguida
+   (não durante um CAD ou o RX single de um ciclo) */
+uint32_t rfm95_set_modem_config(rfm95_t* radio, const lora_modem_config_t* cfg) {
+    uint32_t result;
+    if (rmf95_forward(radio, rmf95_remote_set_modem_config, (uintptr_t)cfg, 0, &result)) return result;
+    uint32_t irq_state = rmf95_lock(radio);
+    if (radio->tx_async.busy || (radio->cad.state != CAD_NONE && radio->cad.state != CAD_CYCLE_SLEEP)) {
+        rmf95_unlock(irq_state);
+        return 0;
+    }
+    rmf95_set_mode(radio, MODE_LORA | MODE_STDBY);
+    uint32_t symbol_us = rmf95_apply_modem(radio, cfg);
+    if (radio->rx_irq.active) {
+        rmf95_resume_rx(radio);
+    }
+    rmf95_unlock(irq_state);
+    return symbol_us;
+}
+
+const lora_modem_config_t* rfm95_get_modem_config(rfm95_t* radio) {
+    return &radio->modem.config;
+}
+
+/* Fórmula de tempo no ar da Semtech (datasheet SX1276, seção 4.1.1.7):
+   T = (Npreamble + 4,25) * Tsym + (8 + max(ceil((8PL - 4SF + 28 + 16CRC - 20IH)
+       / (4(SF - 2DE))) * (CR + 4), 0)) * Tsym
+   contada em quartos de símbolo e dividida pela largura de banda só no fim,
+   para não acumular o arredondamento de Tsym */
+uint32_t lora_time_on_air_config_us(const lora_modem_config_t* cfg, uint8_t payload_length) {
+    bool ldro;
+    if (rmf95_validate_modem(cfg, &ldro) == 0) return 0;
+
+    int sf = cfg->spreading_factor;
+    int num = 8 * payload_length - 4 * sf + 28 + (cfg->crc ? 16 : 0) - (cfg->implicit_header ? 20 : 0);
+    int den = 4 * (sf - (ldro ? 2 : 0));
+    int blocks = num > 0 ? (num + den - 1) / den : 0;
+    uint64_t payload_symbols = 8 + (uint64_t)blocks * (cfg->coding_rate + 4);
+
+    uint64_t quarter_symbols = 4 * (uint64_t)cfg->preamble_length + 17 + 4 * payload_symbols;
+    uint64_t bw4 = 4 * (uint64_t)bandwidth_hz[cfg->bandwidth];
+    uint64_t total_us = ((quarter_symbols * 1000000 << sf) + bw4 / 2) / bw4;
+    return total_us < UINT32_MAX ? (uint32_t)total_us : UINT32_MAX;   // preâmbulos enormes em SF alto
+}
+
+uint32_t rfm95_time_on_air_us(rfm95_t* radio, uint8_t payload_length) {
+    return lora_time_on_air_config_us(&radio->modem.config, payload_length);
+}
+
+/* Define a potência de transmissão (2 dBm–17 dBm) usando PA_BOOST */
+void rfm95_set_power(rfm95_t* radio, uint8_t power) {
+    if (power > 17) power = 17;
+    if (power < 2)  power = 2;
+    if (rmf95_forward(radio, rmf95_remote_set_power, power, 0, NULL)) return;
+    uint32_t irq_state = rmf95_lock(radio);
+    rmf95_write_reg(radio, REG_PA_CONFIG, 0x80 | (power - 2));   // 0x80 → PA_BOOST
+    rmf95_unlock(irq_state);
+}
+
+void rfm95_sleep(rfm95_t* radio) {
+    if (rmf95_forward(radio, rmf95_remote_sleep, 0, 0, NULL)) return;
+    uint32_t irq_state = rmf95_lock(radio);
+    rmf95_set_mode(radio, MODE_LORA | MODE_SLEEP);
+    rmf95_unlock(irq_state);
+}
+
+void rfm95_idle(rfm95_t* radio) {
+    if (rmf95_forward(radio, rmf95_remote_idle, 0, 0, NULL)) return;
+    uint32_t irq_state = rmf95_lock(radio);
+    rmf95_set_mode(radio, MODE_LORA | MODE_STDBY);
+    rmf95_unlock(irq_state);
+}
+
+/* Inicia a transmissão: grava FIFO (por DMA, se ativo), mapeia TxDone em DIO0
+   e retorna imediatamente */
+bool rfm95_send_packet_async(rfm95_t* radio, const uint8_t* buffer, uint8_t size) {
+    uint32_t result;
+    if (rmf95_forward(radio, rmf95_remote_send_async, (uintptr_t)buffer, size, &result)) return result;
+    uint32_t irq_state = rmf95_lock(radio);
+    if (radio->tx_async.busy || radio->cad.state == CAD_USER) {
+        rmf95_unlock(irq_state);
+        return false;
+    }
+    if (radio->rx_irq.active) {
+        rmf95_service_irq(radio, false);                 // não perde um RxDone pendente
+    }
+
+    rmf95_tx_load(radio, buffer, size, NULL, true);
+    rmf95_unlock(irq_state);
+    return true;
+}
+
+bool rfm95_tx_enqueue(rfm95_t* radio, const uint8_t* buffer, uint8_t size, lora_priority_t priority) {
+    return rmf95_txq_push(radio, buffer, size, priority, NULL, NULL);
+}
+
+bool rfm95_tx_enqueue_channel(rfm95_t* radio, const uint8_t* buffer, uint8_t size, lora_priority_t priority,
+                              const lora_frf_t* frf) {
+    return rmf95_txq_push(radio, buffer, size, priority, frf, NULL);
+}
+
+bool rfm95_tx_enqueue_stamped(rfm95_t* radio, const uint8_t* buffer, uint8_t size, lora_priority_t priority,
+                              lora_tx_stamp_t* stamp) {
+    stamp->done = false;
+    return rmf95_txq_push(radio, buffer, size, priority, NULL, stamp);
+}
+
+uint8_t rfm95_tx_queue_length(rfm95_t* radio) {
+    return radio->txq.queued + (uint8_t)(radio->mc.tx_in - radio->mc.tx_out);
+}
+
+void rfm95_tx_queue_flush(rfm95_t* radio) {
+    if (rmf95_forward(radio, rmf95_remote_tx_queue_flush, 0, 0, NULL)) return;
+    uint32_t irq_state = rmf95_lock(radio);
+    uint8_t slot;
+    while ((slot = rmf95_txq_pop(radio)) != TXQ_NONE) {
+        rmf95_txq_free(radio, slot);
+        radio->txq.counters.dropped++;
+    }
+    rmf95_unlock(irq_state);
+}
+
+const lora_txq_counters_t* rfm95_tx_queue_counters(rfm95_t* radio) {
+    return &radio->txq.counters;
+}
+
+bool rfm95_tx_busy(rfm95_t* radio) {
+    return radio->tx_async.busy || radio->mc.tx_out != radio->mc.tx_in;   // inclui quadros ainda a caminho do núcleo 1
+}
+
+void rfm95_set_tx_callback(rfm95_t* radio, lora_tx_callback_t callback) {
+    radio->tx_async.callback = callback;
+}
+
+/* Envia um pacote e espera o TxDone (invólucro bloqueante da versão assíncrona) */
+void rfm95_send_packet(rfm95_t* radio, const uint8_t* buffer, uint8_t size) {
+    while (!rfm95_send_packet_async(radio, buffer, size)) {
+        hal_yield();                          // envio anterior ou CAD em andamento
+    }
+    while (rfm95_tx_busy(radio)) {
+        hal_yield();                          // espera TX terminar
+    }
+}
+
+/* Recebe pacote em modo contínuo; retorna tamanho ou 0 se nada recebido */
+int rfm95_receive_packet(rfm95_t* radio, uint8_t* buffer, int max_size) {
+    uint32_t result;
+    if (rmf95_forward(radio, rmf95_remote_receive_packet, (uintptr_t)buffer, (uintptr_t)max_size, &result)) {
+        return (int)result;
+    }
+    int len = 0;
+    uint32_t irq_state = rmf95_lock(radio);
+    if (radio->tx_async.busy || radio->cad.state != CAD_NONE) {
+        rmf95_unlock(irq_state);                         // mudar o modo abortaria o TX ou o CAD
+        return 0;
+    }
+    rmf95_tune_base(radio);
+    rmf95_set_mode(radio, MODE_LORA | MODE_RX_CONTINUOUS);
+
+    uint32_t first_transaction = radio->spi_counters.total;
+    uint8_t info[RX_INFO_LENGTH];
+    rmf95_read_rx_info(radio, info);                     // flags + metadados em uma rajada
+
+    uint8_t irq = RX_INFO(info, REG_IRQ_FLAGS);
+    if (irq & IRQ_RX_DONE_MASK) {
+        rmf95_write_reg(radio, REG_IRQ_FLAGS, IRQ_RX_DONE_MASK | IRQ_PAYLOAD_CRC_ERROR_MASK);
+        RMF95_STATS_RX_DONE(info);
+
+        if (!(irq & IRQ_PAYLOAD_CRC_ERROR_MASK)) {       // CRC inválido → 0 (contado nas estatísticas)
+            len = rmf95_read_packet(radio, info, buffer, max_size);
+            radio->spi_counters.last_rx_packet = radio->spi_counters.total - first_transaction;
+        }
+    }
+    rmf95_unlock(irq_state);
+    return len;   // 0 se nada recebido
+}
+
+/* Recepção contínua com RxDone em DIO0; os pacotes vão para o pool */
+void rfm95_receive_irq_start(rfm95_t* radio, lora_rx_callback_t callback) {
+    if (rmf95_forward(radio, rmf95_remote_receive_irq_start, (uintptr_t)callback, 0, NULL)) return;
+    uint32_t irq_state = rmf95_lock(radio);
+    rmf95_cad_cycle_stop(radio);
+    radio->rx_irq.callback = callback;
+    radio->rx_irq.active   = true;
+
+    if (!radio->tx_async.busy) {                         // senão, começa no TxDone
+        rmf95_set_mode(radio, MODE_LORA | MODE_STDBY);
+        rmf95_write_reg(radio, REG_IRQ_FLAGS, 0xFF);     // descarta flags antigas
+        rmf95_start_rx_irq(radio);
+    }
+    rmf95_unlock(irq_state);
+}
+
+void rfm95_receive_irq_stop(rfm95_t* radio) {
+    if (rmf95_forward(radio, rmf95_remote_receive_irq_stop, 0, 0, NULL)) return;
+    uint32_t irq_state = rmf95_lock(radio);
+    rmf95_cad_cycle_stop(radio);
+    radio->rx_irq.active = false;
+    if (!radio->tx_async.busy) {
+        rmf95_set_mode(radio, MODE_LORA | MODE_STDBY);
+    }
+    rmf95_unlock(irq_state);
+}
+
+/* Consumidor do anel de prontos: não acessa o rádio nem mascara interrupções */
+lora_packet_t* rfm95_receive_irq_lease(rfm95_t* radio) {
+    if (radio->rx_irq.ready_out == radio->rx_irq.ready_in) return NULL;   // nada pronto
+
+    hal_memory_barrier();
+    lora_packet_t* packet = &radio->rx_irq.pool[radio->rx_irq.ready[radio->rx_irq.ready_out % LORA_RX_POOL_SIZE]];
+    radio->rx_irq.ready_out++;
+
+    uint32_t latency = (uint32_t)(hal_time_us() - packet->timestamp_us);
+    radio->mc.counters.rx_handoff_last_us = latency;
+    if (latency > radio->mc.counters.rx_handoff_max_us) radio->mc.counters.rx_handoff_max_us = latency;
+    return packet;
+}
+
+void rfm95_receive_irq_release(rfm95_t* radio, lora_packet_t* packet) {
+    if (packet < radio->rx_irq.pool || packet >= radio->rx_irq.pool + LORA_RX_POOL_SIZE) return;
+
+    radio->rx_irq.free_ring[radio->rx_irq.free_in % LORA_RX_POOL_SIZE] = (uint8_t)(packet - radio->rx_irq.pool);
+    hal_memory_barrier();
+    radio->rx_irq.free_in++;
+}
+
+const lora_rx_pool_counters_t* rfm95_receive_irq_counters(rfm95_t* radio) {
+    return &radio->rx_irq.counters;
+}
+
+/* CAD avulso: espera o CadDone (tratado pela interrupção) com o rádio livre */
+lora_cad_result_t rfm95_cad(rfm95_t* radio) {
+    uint32_t result;
+    if (rmf95_forward(radio, rmf95_remote_cad, 0, 0, &result)) return (lora_cad_result_t)result;
+    uint32_t irq_state = rmf95_lock(radio);
+    if (radio->tx_async.busy || (radio->cad.state != CAD_NONE && radio->cad.state != CAD_CYCLE_SLEEP)) {
+        rmf95_unlock(irq_state);
+        return LORA_CAD_BUSY;
+    }
+    if (radio->rx_irq.active) {
+        rmf95_service_irq(radio, false);                 // não perde um RxDone pendente
+    }
+    if (radio->cad.state == CAD_CYCLE_SLEEP) {
+        hal_alarm_cancel(radio);
+    }
+    rmf95_cad_start(radio, CAD_USER);
+    rmf95_unlock(irq_state);
+
+    while (radio->cad.state == CAD_USER) {
+        hal_yield();
+    }
+
+    irq_state = rmf95_lock(radio);
+    bool detected = radio->cad.detected;
+    // Quadros enfileirados durante o CAD saem agora; senão volta a escutar
+    if (!radio->tx_async.busy && !rmf95_txq_start_next(radio, true) && radio->rx_irq.active) {
+        rmf95_resume_rx(radio);
+    }
+    rmf95_unlock(irq_state);
+    return detected ? LORA_CAD_DETECTED : LORA_CAD_FREE;
+}
+
+bool rfm95_set_lbt(rfm95_t* radio, const lora_lbt_config_t* cfg) {
+    if (cfg && (cfg->max_attempts == 0 || cfg->backoff_min_us > cfg->backoff_max_us)) return false;
+    uint32_t result;
+    if (rmf95_forward(radio, rmf95_remote_set_lbt, (uintptr_t)cfg, 0, &result)) return result;
+    uint32_t irq_state = rmf95_lock(radio);
+    radio->cad.lbt_enabled = cfg != NULL;
+    if (cfg) {
+        radio->cad.lbt = *cfg;
+    }
+    if (radio->cad.random == 0) {
+        radio->cad.random = ((uint32_t)hal_time_us() ^ hal_cycles()) | 1;   // semente diferente por nó
+    }
+    rmf95_unlock(irq_state);
+    return true;
+}
+
+bool rfm95_receive_cad_start(rfm95_t* radio, uint32_t period_ms, lora_rx_callback_t callback) {
+    if (period_ms == 0) return false;
+    rmf95_cycle_args_t args = { period_ms, 0, callback };
+    uint32_t result;
+    if (rmf95_forward(radio, rmf95_remote_receive_cycle_start, (uintptr_t)&args, 0, &result)) return result;
+    return rmf95_receive_cycle_start(radio, &args);
+}
+
+bool rfm95_receive_window_start(rfm95_t* radio, uint32_t period_ms, uint16_t window_symbols, lora_rx_callback_t callback) {
+    if (period_ms == 0 || window_symbols < LORA_RX_WINDOW_MIN_SYMBOLS ||
+        window_symbols > LORA_RX_WINDOW_MAX_SYMBOLS) {
+        return false;
+    }
+    rmf95_cycle_args_t args = { period_ms, window_symbols, callback };
+    uint32_t result;
+    if (rmf95_forward(radio, rmf95_remote_receive_cycle_start, (uintptr_t)&args, 0, &result)) return result;
+    return rmf95_receive_cycle_start(radio, &args);
+}
+
+/* Espera sem perder eventos: o teste do pool e o sono ficam com as
+   interrupções mascaradas, e a que chegar no meio acorda o núcleo. Com um
+   DMA da FIFO em andamento hal_low_power_wait() dorme sem cortar os clocks */
+void lora_wait_for_event() {
+    if (remote.active) {
+        hal_yield();                                     // os rádios interrompem o outro núcleo
+        return;
+    }
+    uint32_t irq_state = hal_irq_save();
+    bool ready = false;
+    for (uint16_t i = 0; i < LORA_MAX_RADIOS; i++) {
+        if (radios[i].in_use && radios[i].rx_irq.ready_out != radios[i].rx_irq.ready_in) {
+            ready = true;
+        }
+    }
+    if (!ready) {
+        hal_low_power_wait();
+    }
+    hal_irq_restore(irq_state);
+}
+
+bool rfm95_set_fhss(rfm95_t* radio, const lora_frf_t* channels, uint8_t count, uint8_t hop_period) {
+    if (channels && (count == 0 || count > LORA_FHSS_MAX_CHANNELS || hop_period == 0)) return false;
+    rmf95_fhss_args_t args = { channels, count, hop_period };
+    uint32_t result;
+    if (rmf95_forward(radio, rmf95_remote_set_fhss, (uintptr_t)&args, 0, &result)) return result;
+    return rmf95_set_fhss(radio, &args);
+}
+
+const lora_hop_counters_t* rfm95_hop_counters(rfm95_t* radio) {
+    return &radio->channel.counters;
+}
+
+uint16_t rfm95_cad_preamble_length(rfm95_t* radio, uint32_t period_ms) {
+    uint64_t symbols = ((uint64_t)period_ms * 1000 + radio->modem.symbol_us - 1) / radio->modem.symbol_us +
+                       CAD_PREAMBLE_MARGIN;
+    return symbols > UINT16_MAX ? UINT16_MAX : (uint16_t)symbols;
+}
+
+const lora_cad_counters_t* rfm95_cad_counters(rfm95_t* radio) {
+    return &radio->cad.counters;
+}
+
+/* RSSI absoluto: (-157 dBm para 915 MHz) + valor lido */
+int rfm95_packet_rssi(rfm95_t* radio) {
+    return (radio->last_packet.rssi - 157);
+}
+
+/* SNR em dB (valor fracionário; cada unidade = 0,25 dB) */
+float rfm95_packet_snr(rfm95_t* radio) {
+    return ((int8_t)radio->last_packet.snr) * 0.25f;
+}
+
+/* Move o driver para o núcleo 1: as interrupções de DIO0/DIO1 dos rádios já
+   inicializados passam a ser atendidas lá e as chamadas do núcleo 0 são encaminhadas */
+bool lora_multicore_start() {
+    if (remote.active) return true;
+
+    rmf95_set_dio_irqs(NULL);                            // deixam de ser atendidas no núcleo 0
+    remote.active = true;
+    if (!hal_core1_launch(rmf95_core1_main)) {
+        remote.active = false;
+        rmf95_set_dio_irqs(&rmf95_dio_isr);
+        return false;
+    }
+    return true;
+}
+
+bool lora_multicore_active() {
+    return remote.active;
+}
+
+const lora_multicore_counters_t* rfm95_multicore_counters(rfm95_t* radio) {
+    return &radio->mc.counters;
+}
+
+const lora_spi_counters_t* rfm95_spi_counters(rfm95_t* radio) {
+    return &radio->spi_counters;
+}
+
+uint32_t rfm95_spi_baudrate(rfm95_t* radio) {
+    return radio->bus->baudrate;
+}
+
+void rfm95_power_set_profile(rfm95_t* radio, const lora_power_profile_t* profile) {
+    uint32_t irq_state = hal_irq_save();
+    radio->power.profile = *profile;
+    hal_irq_restore(irq_state);
+}
+
+/* Carga = soma de corrente x tempo em cada estado, com o estado atual até agora */
+void rfm95_power_report(rfm95_t* radio, lora_power_report_t* out) {
+    if (rmf95_forward(radio, rmf95_remote_power_report, (uintptr_t)out, 0, NULL)) return;
+    uint32_t irq_state = hal_irq_save();
+    uint64_t now = hal_time_us();
+    memcpy(out->mode_us, radio->power.mode_us, sizeof(out->mode_us));
+    out->mode_us[radio->power.mode] += now - radio->power.mode_since_us;
+    out->elapsed_us = now - radio->power.start_us;
+    lora_power_profile_t profile = radio->power.profile;
+    hal_irq_restore(irq_state);
+
+    double ua_us = 0;
+    for (int mode = 0; mode < LORA_RADIO_MODE_COUNT; mode++) {
+        ua_us += (double)profile.current_ua[mode] * out->mode_us[mode];
+    }
+    out->charge_uah = ua_us / 3600e6;
+    out->average_ua = out->elapsed_us ? (float)(ua_us / out->elapsed_us) : 0.0f;
+}
+
+void rfm95_power_reset(rfm95_t* radio) {
+    if (rmf95_forward(radio, rmf95_remote_power_reset, 0, 0, NULL)) return;
+    uint32_t irq_state = hal_irq_save();
+    rmf95_power_clear(radio);
+    hal_irq_restore(irq_state);
+}
+
+bool rfm95_stats_snapshot(rfm95_t* radio, lora_stats_t* out) {
+    memset(out, 0, sizeof(*out));
+#if LORA_STATS
+    uint32_t result;
+    if (rmf95_forward(radio, rmf95_remote_stats_snapshot, (uintptr_t)out, 0, &result)) return result;
+    uint32_t irq_state = hal_irq_save();
+    *out = radio->stats.data;
+    out->mode_us[radio->power.mode] += hal_time_us() - radio->stats.mode_since_us;
+    if (out->rx_packets) {
+        out->rssi_avg = (float)radio->stats.rssi_sum / out->rx_packets;
+        out->snr_avg  = radio->stats.snr_sum * 0.25f / out->rx_packets;
+        out->snr_min  = radio->stats.snr_min * 0.25f;
+        out->snr_max  = radio->stats.snr_max * 0.25f;
+    } else {
+        out->rssi_min = out->rssi_max = 0;               // sem pacotes, sem extremos
+    }
+    hal_irq_restore(irq_state);
+    return true;
+#else
+    (void)radio;
+    return false;
+#endif
+}
+
+void rfm95_stats_reset(rfm95_t* radio) {
+#if LORA_STATS
+    if (rmf95_forward(radio, rmf95_remote_stats_reset, 0, 0, NULL)) return;
+    uint32_t irq_state = hal_irq_save();
+    rmf95_stats_clear(radio);
+    hal_irq_restore(irq_state);
+#else
+    (void)radio;
+#endif
+}
+
+// ============================================================================
+// Instância Padrão (módulo 0, pinos PIN_*)
+// ============================================================================
+
+bool lora_init() {
+    return rfm95_init(&radios[0], NULL, NULL);
+}
+
+bool lora_init_config(const lora_config_t* cfg) {
+    return rfm95_init(&radios[0], NULL, cfg);
+}
+
+void lora_idle() {
+    rfm95_idle(&radios[0]);
+}
+
+void lora_sleep() {
+    rfm95_sleep(&radios[0]);
+}
+
+void lora_set_frequency(long frequency) {
+    rfm95_set_frequency(&radios[0], frequency);
+}
+
+void lora_set_power(uint8_t power) {
+    rfm95_set_power(&radios[0], power);
+}
+
+void lora_set_channel(const lora_frf_t* frf) {
+    rfm95_set_channel(&radios[0], frf);
+}
+
+uint32_t lora_set_modem_config(const lora_modem_config_t* cfg) {
+    return rfm95_set_modem_config(&radios[0], cfg);
+}
+
+const lora_modem_config_t* lora_get_modem_config() {
+    return rfm95_get_modem_config(&radios[0]);
+}
+
+uint32_t lora_time_on_air_us(uint8_t payload_length) {
+    return rfm95_time_on_air_us(&radios[0], payload_length);
+}
+
+void lora_send_packet(const uint8_t* buffer, uint8_t size) {
+    rfm95_send_packet(&radios[0], buffer, size);
+}
+
+bool lora_send_packet_async(const uint8_t* buffer, uint8_t size) {
+    return rfm95_send_packet_async(&radios[0], buffer, size);
+}
+
+bool lora_tx_busy() {
+    return rfm95_tx_busy(&radios[0]);
+}
+
+void lora_set_tx_callback(lora_tx_callback_t callback) {
+    rfm95_set_tx_callback(&radios[0], callback);
+}
+
+bool lora_tx_enqueue(const uint8_t* buffer, uint8_t size, lora_priority_t priority) {
+    return rfm95_tx_enqueue(&radios[0], buffer, size, priority);
+}
+
+bool lora_tx_enqueue_channel(const uint8_t* buffer, uint8_t size, lora_priority_t priority,
+                             const lora_frf_t* frf) {
+    return rfm95_tx_enqueue_channel(&radios[0], buffer, size, priority, frf);
+}
+
+bool lora_tx_enqueue_stamped(const uint8_t* buffer, uint8_t size, lora_priority_t priority,
+                             lora_tx_stamp_t* stamp) {
+    return rfm95_tx_enqueue_stamped(&radios[0], buffer, size, priority, stamp);
+}
+
+uint8_t lora_tx_queue_length() {
+    return rfm95_tx_queue_length(&radios[0]);
+}
+
+void lora_tx_queue_flush() {
+    rfm95_tx_queue_flush(&radios[0]);
+}
+
+const lora_txq_counters_t* lora_tx_queue_counters() {
+    return rfm95_tx_queue_counters(&radios[0]);
+}
+
+int lora_receive_packet(uint8_t* buffer, int max_size) {
+    return rfm95_receive_packet(&radios[0], buffer, max_size);
+}
+
+void lora_receive_irq_start(lora_rx_callback_t callback) {
+    rfm95_receive_irq_start(&radios[0], callback);
+}
+
+void lora_receive_irq_stop() {
+    rfm95_receive_irq_stop(&radios[0]);
+}
+
+lora_packet_t* lora_receive_irq_lease() {
+    return rfm95_receive_irq_lease(&radios[0]);
+}
+
+void lora_receive_irq_release(lora_packet_t* packet) {
+    rfm95_receive_irq_release(&radios[0], packet);
+}
+
+const lora_rx_pool_counters_t* lora_receive_irq_counters() {
+    return rfm95_receive_irq_counters(&radios[0]);
+}
+
+lora_cad_result_t lora_cad() {
+    return rfm95_cad(&radios[0]);
+}
+
+bool lora_set_lbt(const lora_lbt_config_t* cfg) {
+    return rfm95_set_lbt(&radios[0], cfg);
+}
+
+bool lora_receive_cad_start(uint32_t period_ms, lora_rx_callback_t callback) {
+    return rfm95_receive_cad_start(&radios[0], period_ms, callback);
+}
+
+bool lora_receive_window_start(uint32_t period_ms, uint16_t window_symbols, lora_rx_callback_t callback) {
+    return rfm95_receive_window_start(&radios[0], period_ms, window_symbols, callback);
+}
+
+uint16_t lora_cad_preamble_length(uint32_t period_ms) {
+    return rfm95_cad_preamble_length(&radios[0], period_ms);
+}
+
+const lora_cad_counters_t* lora_cad_counters() {
+    return rfm95_cad_counters(&radios[0]);
+}
+
+bool lora_set_fhss(const lora_frf_t* channels, uint8_t count, uint8_t hop_period) {
+    return rfm95_set_fhss(&radios[0], channels, count, hop_period);
+}
+
+const lora_hop_counters_t* lora_hop_counters() {
+    return rfm95_hop_counters(&radios[0]);
+}
+
+const lora_multicore_counters_t* lora_multicore_counters() {
+    return rfm95_multicore_counters(&radios[0]);
+}
+
+int lora_packet_rssi() {
+    return rfm95_packet_rssi(&radios[0]);
+}
+
+float lora_packet_snr() {
+    return rfm95_packet_snr(&radios[0]);
+}
+
+const lora_spi_counters_t* lora_spi_counters() {
+    return rfm95_spi_counters(&radios[0]);
+}
+
+uint32_t lora_spi_baudrate() {
+    return rfm95_spi_baudrate(&radios[0]);
+}
+
+bool lora_stats_snapshot(lora_stats_t* out) {
+    return rfm95_stats_snapshot(&radios[0], out);
+}
+
+void lora_stats_reset() {
+    rfm95_stats_reset(&radios[0]);
+}
+
+void lora_power_set_profile(const lora_power_profile_t* profile) {
+    rfm95_power_set_profile(&radios[0], profile);
+}
+
+void lora_power_report(lora_power_report_t* out) {
+    rfm95_power_report(&radios[0], out);
+}
+
+void lora_power_reset() {
+    rfm95_power_reset(&radios[0]);
 }
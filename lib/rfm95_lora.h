@@ -1,12 +1,11 @@
 #ifndef RFM95_LORA_H
 #define RFM95_LORA_H
 
-#include "pico/stdlib.h"
-#include "hardware/spi.h"
+#include "hal.h"
 #include <stdbool.h>
 
 
-// Definições de Pinos e SPI
+// Definições de Pinos e SPI (módulo da instância padrão, rfm95_radio(0))
 
 #define SPI_PORT spi0
 #define PIN_MISO 16
@@ -14,17 +13,319 @@
 #define PIN_SCK  18
 #define PIN_MOSI 19
 #define PIN_RST  20
+#define PIN_DIO0 21   // Interrupção do rádio (RxDone/TxDone/CadDone)
+#define PIN_DIO1 22   // RxTimeout da recepção em ciclos ou FhssChangeChannel do FHSS
+
+// Pinos e barramento de um módulo. Vários módulos podem dividir o mesmo SPI
+// (e os mesmos MISO/SCK/MOSI), cada um com o seu CS, RST e DIOs
+typedef struct {
+    hal_spi_t* spi;
+    uint miso;
+    uint sck;
+    uint mosi;
+    uint cs;
+    uint rst;
+    uint dio0;
+    uint dio1;
+} rfm95_pins_t;
+
+#define RFM95_PINS_DEFAULT { SPI_PORT, PIN_MISO, PIN_SCK, PIN_MOSI, PIN_CS, PIN_RST, PIN_DIO0, PIN_DIO1 }
+
+// Módulos controlados pelo driver (cada um reserva seus pools de RX/TX)
+#ifndef LORA_MAX_RADIOS
+#define LORA_MAX_RADIOS 2
+#endif
+
+// Contexto de um módulo (opaco): pinos, barramento, interrupções e estado
+typedef struct rfm95 rfm95_t;
 
 // Frequência de operação (915 MHz para o Brasil)
 #define LORA_FREQUENCY_HZ 915E6
 
+// Clock SPI padrão (o SX1276 aceita até 10 MHz)
+#define LORA_DEFAULT_SPI_BAUDRATE (10 * 1000 * 1000)
+
+// Tamanho máximo de um pacote LoRa (limite da FIFO do SX1276)
+#define LORA_MAX_PACKET_SIZE 255
+
+
+// Slots do pool de recepção (cada um ocupa pouco mais de LORA_MAX_PACKET_SIZE bytes)
+#ifndef LORA_RX_POOL_SIZE
+#define LORA_RX_POOL_SIZE 4
+#endif
+
+// Quadros em trânsito do núcleo 0 para o núcleo 1 no modo multinúcleo
+#ifndef LORA_MC_TX_RING_SIZE
+#define LORA_MC_TX_RING_SIZE 4
+#endif
+
+// Capacidade da fila de transmissão (cada quadro ocupa LORA_MAX_PACKET_SIZE bytes)
+#ifndef LORA_TX_QUEUE_SIZE
+#define LORA_TX_QUEUE_SIZE 8
+#endif
+
+// Classes de prioridade da fila de transmissão (a menor sai primeiro)
+typedef enum {
+    LORA_PRIO_HIGH = 0,
+    LORA_PRIO_NORMAL,
+    LORA_PRIO_LOW,
+    LORA_PRIO_COUNT
+} lora_priority_t;
+
+// O que fazer com um quadro novo quando a fila está cheia
+typedef enum {
+    LORA_TXQ_DROP_OLDEST = 0,    // descarta o mais antigo de prioridade igual ou menor
+    LORA_TXQ_REJECT_NEW          // recusa o quadro novo
+} lora_txq_policy_t;
+
+// Parâmetros de inicialização do driver
+typedef struct {
+    uint32_t spi_baudrate;   // clock SPI desejado em Hz
+    bool fifo_dma;           // move a FIFO por DMA; false usa apenas cópias bloqueantes
+    lora_txq_policy_t tx_queue_policy;
+} lora_config_t;
+
+#define LORA_CONFIG_DEFAULT { LORA_DEFAULT_SPI_BAUDRATE, true, LORA_TXQ_DROP_OLDEST }
+
+// Larguras de banda (valor do campo Bw de REG_MODEM_CONFIG_1)
+typedef enum {
+    LORA_BW_7K8 = 0,
+    LORA_BW_10K4,
+    LORA_BW_15K6,
+    LORA_BW_20K8,
+    LORA_BW_31K25,
+    LORA_BW_41K7,
+    LORA_BW_62K5,
+    LORA_BW_125K,
+    LORA_BW_250K,
+    LORA_BW_500K
+} lora_bandwidth_t;
+
+// Taxas de codificação (valor do campo CodingRate)
+typedef enum {
+    LORA_CR_4_5 = 1,
+    LORA_CR_4_6,
+    LORA_CR_4_7,
+    LORA_CR_4_8
+} lora_coding_rate_t;
+
+// Otimização para baixa taxa de dados (LowDataRateOptimize)
+typedef enum {
+    LORA_LDRO_AUTO = 0,      // liga quando o símbolo passa de 16 ms
+    LORA_LDRO_OFF,
+    LORA_LDRO_ON
+} lora_ldro_t;
+
+// Parâmetros do modem LoRa
+typedef struct {
+    uint8_t spreading_factor;        // 6 a 12 (SF6 exige cabeçalho implícito)
+    lora_bandwidth_t bandwidth;
+    lora_coding_rate_t coding_rate;
+    uint16_t preamble_length;        // símbolos (mínimo 6)
+    bool crc;
+    bool implicit_header;
+    lora_ldro_t ldro;
+} lora_modem_config_t;
+
+// Presets (inicializadores constantes, utilizáveis em tabelas estáticas)
+#define LORA_MODEM_SF7_BW500  { 7,  LORA_BW_500K, LORA_CR_4_5, 8, true, false, LORA_LDRO_AUTO }
+#define LORA_MODEM_SF7_BW125  { 7,  LORA_BW_125K, LORA_CR_4_5, 8, true, false, LORA_LDRO_AUTO }
+#define LORA_MODEM_SF9_BW125  { 9,  LORA_BW_125K, LORA_CR_4_5, 8, true, false, LORA_LDRO_AUTO }
+#define LORA_MODEM_SF10_BW125 { 10, LORA_BW_125K, LORA_CR_4_5, 8, true, false, LORA_LDRO_AUTO }
+#define LORA_MODEM_SF12_BW125 { 12, LORA_BW_125K, LORA_CR_4_8, 8, true, false, LORA_LDRO_AUTO }
+
+// Índices da tabela lora_modem_presets
+typedef enum {
+    LORA_PRESET_SF7_BW500 = 0,   // enlace rápido, perto do gateway
+    LORA_PRESET_SF7_BW125,       // padrão de lora_init()
+    LORA_PRESET_SF9_BW125,
+    LORA_PRESET_SF10_BW125,
+    LORA_PRESET_SF12_BW125,      // alcance máximo
+    LORA_PRESET_COUNT
+} lora_preset_t;
+
+extern const lora_modem_config_t lora_modem_presets[LORA_PRESET_COUNT];
+
+// Slot do pool de recepção, preenchido diretamente da FIFO pela interrupção
+typedef struct {
+    uint8_t data[LORA_MAX_PACKET_SIZE];
+    uint8_t length;
+    int rssi;                // dBm
+    float snr;               // dB
+    uint64_t timestamp_us;   // instante do tratamento do RxDone (hal_time_us)
+    uint16_t radio;          // índice do módulo que recebeu (rfm95_radio)
+} lora_packet_t;
+
+// Contadores do pool de recepção
+typedef struct {
+    uint32_t received;       // pacotes entregues ao pool
+    uint32_t exhausted;      // pacotes perdidos por falta de slot livre
+    uint32_t crc_errors;
+    uint8_t high_water;      // maior número de slots ocupados (prontos + emprestados)
+} lora_rx_pool_counters_t;
+
+// Callback chamado (em contexto de interrupção) a cada pacote armazenado
+typedef void (*lora_rx_callback_t)(const lora_packet_t* packet);
+
+// Contadores de transações SPI (ciclos de CS) do driver
+typedef struct {
+    uint32_t total;            // desde a inicialização
+    uint32_t last_tx_packet;   // usadas para carregar e disparar o último envio
+    uint32_t last_rx_packet;   // usadas para ler o último pacote recebido
+    uint32_t fifo_bytes;       // bytes movidos de/para a FIFO
+    uint32_t fifo_dma_transfers;
+    uint32_t fifo_cpu_us;      // tempo de CPU gasto nas transferências da FIFO
+} lora_spi_counters_t;
+
+// Callback chamado (em contexto de interrupção) quando a transmissão termina
+typedef void (*lora_tx_callback_t)(void);
+
+// Latências entre estágios e ocupação das filas entre núcleos
+typedef struct {
+    uint32_t rx_handoff_last_us;   // RxDone tratado → pacote emprestado pela aplicação
+    uint32_t rx_handoff_max_us;
+    uint32_t tx_handoff_last_us;   // lora_tx_enqueue() no núcleo 0 → fila do rádio no núcleo 1
+    uint32_t tx_handoff_max_us;
+    uint32_t remote_calls;         // chamadas de controle executadas no núcleo 1
+    uint32_t remote_call_max_us;
+    uint32_t tx_ring_full;         // quadros recusados com o anel entre núcleos cheio
+    uint8_t rx_ready_high_water;   // pacotes prontos aguardando a aplicação
+    uint8_t tx_ring_high_water;    // quadros aguardando o núcleo 1
+} lora_multicore_counters_t;
+
+// Fim da transmissão de um quadro da fila (lora_tx_enqueue_stamped)
+typedef struct {
+    volatile uint32_t done_us;     // hal_time_us() do TxDone (32 bits baixos)
+    volatile bool done;            // done_us já vale
+} lora_tx_stamp_t;
+
+// Contadores da fila de transmissão
+typedef struct {
+    uint32_t enqueued;
+    uint32_t sent;             // quadros da fila que receberam TxDone
+    uint32_t dropped;          // descartados pela política de fila cheia
+    uint8_t high_water;        // maior ocupação observada
+} lora_txq_counters_t;
+
+// Frequência já convertida para RegFrfMsb/Mid/Lsb (lora_frf()): com a tabela
+// calculada de antemão, trocar de canal custa só uma rajada de três bytes
+typedef struct {
+    uint8_t reg[3];
+} lora_frf_t;
+
+// Canais do FHSS (FhssPresentChannel tem 6 bits)
+#define LORA_FHSS_MAX_CHANNELS 64
+
+// Contadores de troca de canal
+typedef struct {
+    uint32_t retunes;          // escritas de FRF (cada uma uma rajada de 3 bytes)
+    uint32_t channel_frames;   // quadros enviados fora do canal base
+    uint32_t fhss_hops;        // saltos dentro de pacotes (FhssChangeChannel)
+} lora_hop_counters_t;
+
+// Resultado de lora_cad()
+typedef enum {
+    LORA_CAD_FREE = 0,         // nenhum preâmbulo LoRa no canal
+    LORA_CAD_DETECTED,         // preâmbulo detectado
+    LORA_CAD_BUSY              // rádio ocupado (transmissão, LBT ou recepção em ciclos)
+} lora_cad_result_t;
+
+// Listen-before-talk: um CAD antes de cada envio; com o canal ocupado o
+// quadro espera um tempo sorteado (escutando) e tenta de novo
+typedef struct {
+    uint8_t max_attempts;      // CADs por quadro (>= 1); esgotados, ele sai assim mesmo
+    uint32_t backoff_min_us;   // espera sorteada em [min, max] a cada detecção
+    uint32_t backoff_max_us;
+} lora_lbt_config_t;
+
+#define LORA_LBT_CONFIG_DEFAULT { 5, 10000, 100000 }
+
+// Contadores de CAD, LBT e recepção em ciclos
+typedef struct {
+    uint32_t cad_runs;
+    uint32_t cad_detected;
+    uint32_t lbt_backoffs;       // esperas sorteadas com o canal ocupado
+    uint32_t lbt_fallbacks;      // quadros enviados sem canal livre após max_attempts
+    uint32_t cycle_wakeups;      // CADs da recepção em ciclos
+    uint32_t cycle_rx_timeouts;  // preâmbulo detectado sem pacote em seguida
+} lora_cad_counters_t;
+
+// Coleta de estatísticas no driver (lora_stats_snapshot); desligada por padrão.
+// Compile com -DLORA_STATS=1 (opção LORA_STATS do CMake) para ativá-la
+#ifndef LORA_STATS
+#define LORA_STATS 0
+#endif
+
+// Intervalos dos histogramas de ciclos: o intervalo i conta as medidas em
+// [2^i, 2^(i+1)) ciclos e o último acumula todas as maiores
+#define LORA_STATS_HIST_BUCKETS 20
+
+// Estados de consumo do rádio
+typedef enum {
+    LORA_RADIO_SLEEP = 0,
+    LORA_RADIO_STANDBY,
+    LORA_RADIO_TX,
+    LORA_RADIO_RX,
+    LORA_RADIO_MODE_COUNT
+} lora_radio_mode_t;
+
+// Estatísticas acumuladas desde lora_init() ou lora_stats_reset()
+typedef struct {
+    uint32_t rx_packets;       // RxDone com CRC válido (pool ou polling)
+    uint32_t tx_packets;       // TxDone
+    uint32_t crc_errors;       // um cabeçalho inválido não gera RxDone nem é contado
+    uint32_t rx_timeouts;
+    uint32_t spi_transactions; // ciclos de CS
+    uint32_t spi_bytes;        // incluindo os bytes de endereço
+    uint64_t mode_us[LORA_RADIO_MODE_COUNT];   // tempo em cada estado
+    int16_t rssi_min;          // dBm, dos pacotes válidos
+    int16_t rssi_max;
+    float rssi_avg;
+    float snr_min;             // dB
+    float snr_max;
+    float snr_avg;
+    // Custo em ciclos de cada tratamento de DIO0 e de cada leitura da FIFO
+    uint32_t isr_cycles[LORA_STATS_HIST_BUCKETS];
+    uint32_t isr_cycles_max;
+    uint32_t fifo_read_cycles[LORA_STATS_HIST_BUCKETS];
+    uint32_t fifo_read_cycles_max;
+} lora_stats_t;
+
+// Corrente típica do módulo em cada estado (uA, índice lora_radio_mode_t),
+// usada na estimativa de carga; ajuste TX para a potência configurada
+typedef struct {
+    float current_ua[LORA_RADIO_MODE_COUNT];
+} lora_power_profile_t;
+
+// RFM95 (datasheet do SX1276, tabela 6): sleep 0,2 uA, standby 1,6 mA,
+// TX a +17 dBm no PA_BOOST 87 mA e RX com LNA boost 11,5 mA
+#define LORA_POWER_PROFILE_RFM95 { { 0.2f, 1600.0f, 87000.0f, 11500.0f } }
+
+// Tempo em cada estado e carga estimada desde lora_init() ou lora_power_reset()
+typedef struct {
+    uint64_t mode_us[LORA_RADIO_MODE_COUNT];
+    uint64_t elapsed_us;
+    double charge_uah;         // soma de corrente x tempo em cada estado
+    float average_ua;          // corrente média do rádio no período
+} lora_power_report_t;
+
+// Limites da janela de lora_receive_window_start() (timeout de 10 bits do RX single)
+#define LORA_RX_WINDOW_MIN_SYMBOLS 4
+#define LORA_RX_WINDOW_MAX_SYMBOLS 1023
+
 
 // Funções Públicas da Biblioteca
+//
+// As funções lora_* agem sobre a instância padrão (rfm95_radio(0), com os pinos
+// PIN_*); cada uma tem a equivalente rfm95_* que recebe o módulo, listada no fim
 
-// Inicializa o hardware SPI e o módulo RFM95
+// Inicializa o hardware SPI e o módulo RFM95 com LORA_CONFIG_DEFAULT
 // Retorna true se a comunicação foi bem-sucedida, false caso contrário
 bool lora_init();
 
+// Igual a lora_init(), escolhendo o clock SPI e o uso de DMA na FIFO
+bool lora_init_config(const lora_config_t* config);
+
 // Coloca o módulo em modo de espera (standby) - baixo consumo, pronto para TX/RX
 void lora_idle();
 
@@ -37,19 +338,249 @@ void lora_set_frequency(long frequency);
 // Configura a potência de transmissão em dBm (entre 2 e 17 para PA_BOOST)
 void lora_set_power(uint8_t power);
 
-// Envia um pacote de dados
+// Converte uma frequência em Hz para os registradores FRF (sem acessar o rádio)
+lora_frf_t lora_frf(uint32_t frequency_hz);
+
+// Canal base, já convertido: o da recepção e dos envios sem canal próprio.
+// lora_set_frequency() é o mesmo com a conversão na hora. Com a recepção por
+// interrupção ativa o rádio passa por standby e volta a escutar no novo canal
+void lora_set_channel(const lora_frf_t* frf);
+
+// Aplica os parâmetros do modem (SF, BW, CR, preâmbulo, CRC, cabeçalho, LDRO).
+// Retorna a duração de um símbolo em microssegundos, ou 0 se a combinação é
+// inválida ou se há uma transmissão em andamento (nada é alterado nesse caso).
+uint32_t lora_set_modem_config(const lora_modem_config_t* config);
+
+// Parâmetros do modem atualmente aplicados
+const lora_modem_config_t* lora_get_modem_config();
+
+// Tempo no ar (us) de um pacote de payload_length bytes com os parâmetros atuais
+uint32_t lora_time_on_air_us(uint8_t payload_length);
+
+// Mesmo cálculo para uma configuração qualquer; retorna 0 se ela for inválida
+uint32_t lora_time_on_air_config_us(const lora_modem_config_t* config, uint8_t payload_length);
+
+// Envia um pacote de dados e espera o fim da transmissão (TxDone); com outro
+// envio ou um CAD em andamento, espera o rádio ficar livre antes
 // buffer: ponteiro para os dados, size: número de bytes
 void lora_send_packet(const uint8_t* buffer, uint8_t size);
 
+// Inicia o envio de um pacote e retorna imediatamente; o TxDone chega por DIO0.
+// Ao terminar, o rádio volta para RX (se a recepção por interrupção estiver ativa)
+// ou para standby. Retorna false se ainda houver uma transmissão em andamento.
+// Com DMA, buffer é lido em segundo plano: mantenha-o válido até lora_tx_busy() = false.
+bool lora_send_packet_async(const uint8_t* buffer, uint8_t size);
+
+// Retorna true enquanto a transmissão iniciada ainda não terminou
+bool lora_tx_busy();
+
+// Registra o callback de TxDone (NULL para desativar)
+void lora_set_tx_callback(lora_tx_callback_t callback);
+
+// Copia o quadro para a fila de transmissão: com o rádio livre ele sai na hora,
+// senão é carregado na FIFO diretamente no TxDone do quadro anterior.
+// Retorna false se o quadro foi recusado (fila cheia ou tamanho inválido)
+bool lora_tx_enqueue(const uint8_t* buffer, uint8_t size, lora_priority_t priority);
+
+// Igual a lora_tx_enqueue(), mas o quadro sai no canal frf (copiado para a
+// fila); o LBT, se ligado, escuta esse canal e depois do TxDone o rádio volta
+// ao canal base. Com o FHSS ligado o canal é ignorado (todo pacote começa no
+// primeiro canal da tabela do FHSS)
+bool lora_tx_enqueue_channel(const uint8_t* buffer, uint8_t size, lora_priority_t priority,
+                             const lora_frf_t* frf);
+
+// Igual a lora_tx_enqueue(); no TxDone do quadro o driver grava o instante em
+// stamp (done_us e depois done = true, em contexto de interrupção ou no núcleo
+// do rádio). stamp deve continuar válido até lá; um quadro descartado pela fila
+// nunca marca done
+bool lora_tx_enqueue_stamped(const uint8_t* buffer, uint8_t size, lora_priority_t priority,
+                             lora_tx_stamp_t* stamp);
+
+// Quadros aguardando na fila (sem contar o que está no ar)
+uint8_t lora_tx_queue_length();
+
+// Descarta os quadros que ainda não foram carregados no rádio
+void lora_tx_queue_flush();
+
+const lora_txq_counters_t* lora_tx_queue_counters();
+
 // Tenta receber um pacote (modo não-bloqueante) - deve ser chamada em loop
 // buffer: buffer de destino, max_size: tamanho máximo do buffer
-// Retorna: número de bytes recebidos ou 0 se nenhum pacote foi recebido
+// Retorna: número de bytes recebidos ou 0 se nenhum pacote foi recebido.
+// Com uma transmissão, um CAD ou a recepção em ciclos em andamento retorna 0
+// sem mexer no rádio
 int lora_receive_packet(uint8_t* buffer, int max_size);
 
+// Inicia a recepção contínua dirigida por interrupção: RxDone é mapeado em DIO0
+// e cada pacote é copiado da FIFO para um slot livre do pool estático do driver.
+// callback: opcional (pode ser NULL), chamado dentro da interrupção
+void lora_receive_irq_start(lora_rx_callback_t callback);
+
+// Interrompe a recepção por interrupção e volta para standby; os pacotes já
+// recebidos continuam disponíveis
+void lora_receive_irq_stop();
+
+// Empresta o pacote pronto mais antigo (NULL se não há nenhum). O slot pertence
+// à aplicação até lora_receive_irq_release(); vários podem estar emprestados
+lora_packet_t* lora_receive_irq_lease();
+
+// Devolve ao pool um slot obtido com lora_receive_irq_lease(), em qualquer ordem
+void lora_receive_irq_release(lora_packet_t* packet);
+
+const lora_rx_pool_counters_t* lora_receive_irq_counters();
+
+// Channel Activity Detection: procura um preâmbulo LoRa no canal (cerca de
+// dois símbolos com o modem atual) e espera o resultado. Depois a recepção
+// por interrupção, se ativa, é retomada
+lora_cad_result_t lora_cad();
+
+// Liga (config != NULL) ou desliga o listen-before-talk para todos os envios.
+// Com ele ligado a FIFO só é carregada com o canal livre: o buffer de
+// lora_send_packet_async() deve continuar válido até lora_tx_busy() = false.
+// Retorna false se a configuração é inválida
+bool lora_set_lbt(const lora_lbt_config_t* config);
+
+// Recepção em ciclos de CAD: o rádio dorme e a cada period_ms acorda para um
+// CAD; só com preâmbulo detectado entra em RX single (RxTimeout em DIO1) e
+// volta a dormir depois do pacote. Os pacotes vão para o pool como em
+// lora_receive_irq_start(); lora_receive_irq_start() ou lora_receive_irq_stop()
+// encerram os ciclos. O transmissor precisa de um preâmbulo de pelo menos
+// lora_cad_preamble_length(period_ms) símbolos. Retorna false se period_ms = 0
+bool lora_receive_cad_start(uint32_t period_ms, lora_rx_callback_t callback);
+
+// Recepção agendada de baixo consumo: o rádio dorme e a cada period_ms abre
+// um RX single de window_symbols símbolos (RxTimeout em DIO1). Um preâmbulo
+// detectado na janela segura o rádio até o fim do pacote; depois ele volta a
+// dormir. Os pacotes vão para o pool e o fim é como em lora_receive_cad_start().
+// O transmissor precisa de um preâmbulo de pelo menos
+// lora_cad_preamble_length(period_ms) + window_symbols símbolos.
+// Retorna false se period_ms = 0 ou a janela está fora dos limites
+bool lora_receive_window_start(uint32_t period_ms, uint16_t window_symbols, lora_rx_callback_t callback);
+
+// FHSS do SX1276: dentro de cada pacote o rádio troca de canal a cada
+// hop_period símbolos (RegHopPeriod) e avisa com FhssChangeChannel em DIO1;
+// a interrupção grava o canal channels[FhssPresentChannel % count] da tabela
+// (que deve continuar válida, ex: lora_channels_frf(plano, 0)). Todo pacote,
+// no transmissor e no receptor, começa em channels[0], que passa a ser o canal
+// base. Útil para pacotes longos (SF11/SF12) sob limite de tempo por canal.
+// Só com envios assíncronos/fila e recepção por interrupção (não em polling
+// nem em ciclos). channels NULL desliga. Retorna false com parâmetros
+// inválidos, recepção em ciclos ativa ou transmissão/CAD em andamento
+bool lora_set_fhss(const lora_frf_t* channels, uint8_t count, uint8_t hop_period);
+
+const lora_hop_counters_t* lora_hop_counters();
+
+// Dorme o MCU (hal_low_power_wait) até a próxima interrupção de um rádio ou
+// alarme dos ciclos, a menos que já haja pacote pronto no pool de algum módulo.
+// Com um DMA de SPI ou I2C em andamento o sono é leve (hal_low_power_wait). No
+// modo multinúcleo as interrupções vão para o núcleo 1 e a chamada só cede a
+// vez. Outros usuários de DMA (ex: o display, ssd1306_busy()) devem ser
+// consultados antes, pela aplicação
+void lora_wait_for_event();
+
+// Preâmbulo (símbolos, modem atual) que garante um CAD do receptor em ciclos de
+// period_ms durante o preâmbulo, com folga para a sincronização
+uint16_t lora_cad_preamble_length(uint32_t period_ms);
+
+const lora_cad_counters_t* lora_cad_counters();
+
+// Modo multinúcleo (opcional): chamar logo após lora_init() (ou depois de
+// iniciar todos os módulos), antes de qualquer tráfego. O driver e as
+// interrupções de DIO0/DIO1 de todos os módulos passam para o núcleo 1; a API não
+// muda: quadros de lora_tx_enqueue() e pacotes do pool cruzam por anéis sem
+// trava e as demais chamadas são executadas no núcleo 1 (bloqueando até o fim).
+// Os callbacks de RX/TX passam a rodar no núcleo 1.
+// Retorna false se a plataforma não tiver segundo núcleo (build de host)
+bool lora_multicore_start();
+
+bool lora_multicore_active();
+
+const lora_multicore_counters_t* lora_multicore_counters();
+
 // Obtém o RSSI do último pacote recebido em dBm
 int lora_packet_rssi();
 
 // Obtém o SNR do último pacote recebido em dB
 float lora_packet_snr();
 
+// Contadores de transações SPI, para medir o custo de cada pacote
+const lora_spi_counters_t* lora_spi_counters();
+
+// Clock SPI efetivamente configurado (Hz)
+uint32_t lora_spi_baudrate();
+
+// Copia as estatísticas (médias e tempo no estado atual calculados na hora).
+// Retorna false, com out zerado, se o driver foi compilado sem LORA_STATS
+bool lora_stats_snapshot(lora_stats_t* out);
+
+// Zera as estatísticas; o tempo do estado atual volta a contar de agora
+void lora_stats_reset();
+
+// Troca as correntes usadas na estimativa (padrão LORA_POWER_PROFILE_RFM95)
+void lora_power_set_profile(const lora_power_profile_t* profile);
+
+// Tempo do rádio em cada estado e carga estimada (sempre disponível,
+// independente de LORA_STATS)
+void lora_power_report(lora_power_report_t* out);
+
+// Recomeça a contagem de tempo e carga a partir de agora
+void lora_power_reset();
+
+// Vários Módulos (ex: gateway escutando canais ou SFs diferentes ao mesmo tempo)
+
+// Módulo de índice 0 a LORA_MAX_RADIOS - 1 (NULL fora disso); o 0 é a instância padrão
+rfm95_t* rfm95_radio(uint16_t index);
+
+// Inicializa o módulo: pins NULL usa RFM95_PINS_DEFAULT e config NULL usa
+// LORA_CONFIG_DEFAULT. O primeiro módulo de um barramento inicializa o SPI com
+// o seu clock; os seguintes o dividem. Retorna false se o módulo não responde
+// ou se o CS (no mesmo SPI) ou um dos DIOs já pertence a outro módulo em uso
+bool rfm95_init(rfm95_t* radio, const rfm95_pins_t* pins, const lora_config_t* config);
+
+void rfm95_idle(rfm95_t* radio);
+void rfm95_sleep(rfm95_t* radio);
+void rfm95_set_frequency(rfm95_t* radio, long frequency);
+void rfm95_set_power(rfm95_t* radio, uint8_t power);
+void rfm95_set_channel(rfm95_t* radio, const lora_frf_t* frf);
+uint32_t rfm95_set_modem_config(rfm95_t* radio, const lora_modem_config_t* config);
+const lora_modem_config_t* rfm95_get_modem_config(rfm95_t* radio);
+uint32_t rfm95_time_on_air_us(rfm95_t* radio, uint8_t payload_length);
+void rfm95_send_packet(rfm95_t* radio, const uint8_t* buffer, uint8_t size);
+bool rfm95_send_packet_async(rfm95_t* radio, const uint8_t* buffer, uint8_t size);
+bool rfm95_tx_busy(rfm95_t* radio);
+void rfm95_set_tx_callback(rfm95_t* radio, lora_tx_callback_t callback);
+bool rfm95_tx_enqueue(rfm95_t* radio, const uint8_t* buffer, uint8_t size, lora_priority_t priority);
+bool rfm95_tx_enqueue_channel(rfm95_t* radio, const uint8_t* buffer, uint8_t size, lora_priority_t priority,
+                              const lora_frf_t* frf);
+bool rfm95_tx_enqueue_stamped(rfm95_t* radio, const uint8_t* buffer, uint8_t size, lora_priority_t priority,
+                              lora_tx_stamp_t* stamp);
+uint8_t rfm95_tx_queue_length(rfm95_t* radio);
+void rfm95_tx_queue_flush(rfm95_t* radio);
+const lora_txq_counters_t* rfm95_tx_queue_counters(rfm95_t* radio);
+int rfm95_receive_packet(rfm95_t* radio, uint8_t* buffer, int max_size);
+void rfm95_receive_irq_start(rfm95_t* radio, lora_rx_callback_t callback);
+void rfm95_receive_irq_stop(rfm95_t* radio);
+lora_packet_t* rfm95_receive_irq_lease(rfm95_t* radio);
+void rfm95_receive_irq_release(rfm95_t* radio, lora_packet_t* packet);
+const lora_rx_pool_counters_t* rfm95_receive_irq_counters(rfm95_t* radio);
+lora_cad_result_t rfm95_cad(rfm95_t* radio);
+bool rfm95_set_lbt(rfm95_t* radio, const lora_lbt_config_t* config);
+bool rfm95_receive_cad_start(rfm95_t* radio, uint32_t period_ms, lora_rx_callback_t callback);
+bool rfm95_receive_window_start(rfm95_t* radio, uint32_t period_ms, uint16_t window_symbols,
+                                lora_rx_callback_t callback);
+uint16_t rfm95_cad_preamble_length(rfm95_t* radio, uint32_t period_ms);
+const lora_cad_counters_t* rfm95_cad_counters(rfm95_t* radio);
+bool rfm95_set_fhss(rfm95_t* radio, const lora_frf_t* channels, uint8_t count, uint8_t hop_period);
+const lora_hop_counters_t* rfm95_hop_counters(rfm95_t* radio);
+const lora_multicore_counters_t* rfm95_multicore_counters(rfm95_t* radio);
+int rfm95_packet_rssi(rfm95_t* radio);
+float rfm95_packet_snr(rfm95_t* radio);
+const lora_spi_counters_t* rfm95_spi_counters(rfm95_t* radio);
+uint32_t rfm95_spi_baudrate(rfm95_t* radio);
+bool rfm95_stats_snapshot(rfm95_t* radio, lora_stats_t* out);
+void rfm95_stats_reset(rfm95_t* radio);
+void rfm95_power_set_profile(rfm95_t* radio, const lora_power_profile_t* profile);
+void rfm95_power_report(rfm95_t* radio, lora_power_report_t* out);
+void rfm95_power_reset(rfm95_t* radio);
+
 #endif // RFM95_LORA_H
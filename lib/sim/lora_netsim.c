@@ -0,0 +1,259 @@
+// lora_netsim.c - Rede LoRa simulada: perda de percurso, captura e colisões
+#include "sim/lora_netsim.h"
+#include "lora_adr.h"
+#include <string.h>
+#include <math.h>
+
+#define MODE_FSTX           0x02
+#define MODE_TX             0x03
+#define MODE_RX_CONTINUOUS  0x05
+#define MODE_RX_SINGLE      0x06
+#define MODE_CAD            0x07
+
+#define NETSIM_TWO_PI 6.283185307179586
+
+// ============================================================================
+// --- Funções Privadas ---
+// ============================================================================
+
+/* Mistura de 64 bits (splitmix64): sombreamento por enlace e semente do gerador */
+static uint64_t netsim_mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/* Normal padrão (Box-Muller) sorteada só pela semente e pelo par de nós, então
+   o enlace a-b tem o mesmo sombreamento nos dois sentidos e a cada consulta */
+static float netsim_link_gaussian(uint32_t seed, uint16_t a, uint16_t b) {
+    uint16_t lo = a < b ? a : b;
+    uint16_t hi = a < b ? b : a;
+    uint64_t h1 = netsim_mix(((uint64_t)seed << 32) | ((uint32_t)lo << 16) | hi);
+    uint64_t h2 = netsim_mix(h1);
+    double u1 = ((h1 >> 11) + 1) * (1.0 / 9007199254740992.0);   // (0, 1]
+    double u2 = (h2 >> 11) * (1.0 / 9007199254740992.0);
+    return (float)(sqrt(-2.0 * log(u1)) * cos(NETSIM_TWO_PI * u2));
+}
+
+static bool netsim_same_channel(const lora_netsim_node_t* a, const lora_netsim_node_t* b) {
+    return a->tx_frf == b->tx_frf && a->tx_sf == b->tx_sf && a->tx_bandwidth_hz == b->tx_bandwidth_hz;
+}
+
+/* Tira da lista os transmissores que já terminaram */
+static void netsim_prune(lora_netsim_t* net, uint64_t now) {
+    uint16_t kept = 0;
+    for (uint16_t i = 0; i < net->on_air_count; i++) {
+        if (net->nodes[net->on_air[i]].tx_end_us > now) {
+            net->on_air[kept++] = net->on_air[i];
+        }
+    }
+    net->on_air_count = kept;
+}
+
+/* Soma (mW) no receptor das transmissões no canal do pacote de from, menos a
+   dele próprio */
+static double netsim_interference_mw(const lora_netsim_t* net, uint16_t receiver, uint16_t from) {
+    const lora_netsim_node_t* wanted = &net->nodes[from];
+    double total = 0.0;
+    for (uint16_t i = 0; i < net->on_air_count; i++) {
+        uint16_t other = net->on_air[i];
+        const lora_netsim_node_t* node = &net->nodes[other];
+        if (other == from || other == receiver || !netsim_same_channel(node, wanted)) continue;
+        float rssi = node->tx_power_dbm - lora_netsim_path_loss_db(net, other, receiver);
+        total += pow(10.0, rssi / 10.0);
+    }
+    return total;
+}
+
+/* true se o pacote de rssi_dbm fica capture_db acima da interferência */
+static bool netsim_survives(const lora_netsim_t* net, float rssi_dbm, double interference_mw) {
+    return interference_mw <= 0.0 || rssi_dbm - 10.0 * log10(interference_mw) >= net->channel.capture_db;
+}
+
+/* Nova transmissão de from chegando ao receptor */
+static void netsim_arrive(lora_netsim_t* net, uint16_t receiver, uint16_t from,
+                          const uint8_t* data, uint8_t length, uint64_t airtime_us) {
+    lora_netsim_node_t* rx = &net->nodes[receiver];
+    lora_netsim_node_t* tx = &net->nodes[from];
+    uint64_t now = hal_time_us();
+    uint8_t mode = sx1276_sim_mode(&rx->sim);
+    bool listening = mode == MODE_RX_CONTINUOUS || mode == MODE_RX_SINGLE;
+    bool receiving = rx->rx_end_us > now && rx->sim.rx_end_us == rx->rx_end_us;
+
+    // O pacote que o receptor já tem sobrevive à nova soma de interferentes?
+    if (rx->rx_end_us > now && !rx->rx_corrupted) {
+        if (netsim_survives(net, rx->rx_rssi_dbm, netsim_interference_mw(net, receiver, rx->rx_from))) {
+            if (receiving) {
+                rx->counters.captures++;
+                net->counters.captures++;
+            }
+        } else {
+            sx1276_sim_corrupt(&rx->sim);
+            rx->rx_corrupted = true;
+            if (receiving) {
+                rx->counters.collisions++;
+                net->counters.collisions++;
+            }
+        }
+    }
+
+    float rssi = tx->tx_power_dbm - lora_netsim_path_loss_db(net, from, receiver);
+    float snr = rssi - lora_netsim_noise_floor_dbm(net, tx->tx_bandwidth_hz);
+    if (snr < lora_adr_required_snr(tx->tx_sf)) {
+        if (listening) {
+            rx->counters.below_sensitivity++;
+            net->counters.below_sensitivity++;
+        }
+        return;
+    }
+    if (rx->sim.rx_end_us != HAL_HOST_NO_EVENT) {
+        rx->counters.busy++;                             // travado no pacote anterior
+        net->counters.busy++;
+        return;
+    }
+
+    // Registradores do SX1276: RSSI a partir de -157 dBm, SNR em quartos de dB (int8)
+    bool crc_ok = netsim_survives(net, rssi, netsim_interference_mw(net, receiver, from));
+    int rssi_reg = (int)lroundf(rssi < -157.0f ? -157.0f : rssi);
+    float snr_reg = snr > 31.75f ? 31.75f : snr;
+    bool accepted = sx1276_sim_deliver_on(&rx->sim, tx->tx_frf, data, length, airtime_us,
+                                          rssi_reg, snr_reg, crc_ok);
+    rx->rx_from = from;
+    rx->rx_rssi_dbm = rssi;
+    rx->rx_end_us = now + airtime_us;
+    rx->rx_corrupted = !crc_ok;
+    if (accepted) {
+        rx->counters.receptions++;
+        net->counters.receptions++;
+        if (!crc_ok) {
+            rx->counters.collisions++;
+            net->counters.collisions++;
+        }
+    }
+}
+
+/* Gancho de TX de todos os nós: o pacote chega a cada rádio em RX ou CAD (ou
+   com idle_listen) no mesmo canal, SF e largura de banda, menos os que
+   transmitem e os do mesmo ponto */
+static void netsim_tx(void* ctx, sx1276_sim_t* sim, const uint8_t* data, uint8_t length, uint64_t airtime_us) {
+    lora_netsim_t* net = ctx;
+    lora_netsim_node_t* tx = (lora_netsim_node_t*)sim;  // sim é o primeiro campo do nó
+    uint16_t from = (uint16_t)(tx - net->nodes);
+    uint64_t now = hal_time_us();
+
+    netsim_prune(net, now);
+    tx->tx_end_us = now + airtime_us;
+    tx->tx_frf = sx1276_sim_frf(sim);
+    tx->tx_sf = sx1276_sim_sf(sim);
+    tx->tx_bandwidth_hz = sx1276_sim_bandwidth_hz(sim);
+    tx->tx_power_dbm = sx1276_sim_tx_power(sim);
+    net->on_air[net->on_air_count++] = from;
+    tx->counters.transmissions++;
+    net->counters.transmissions++;
+
+    for (uint16_t i = 0; i < net->count; i++) {
+        lora_netsim_node_t* rx = &net->nodes[i];
+        if (i == from || rx->site == tx->site) continue;
+        uint8_t mode = sx1276_sim_mode(&rx->sim);
+        bool listening = mode == MODE_RX_CONTINUOUS || mode == MODE_RX_SINGLE || mode == MODE_CAD;
+        if (mode == MODE_FSTX || mode == MODE_TX || (!listening && !rx->idle_listen)) continue;
+        if (sx1276_sim_frf(&rx->sim) != tx->tx_frf || sx1276_sim_sf(&rx->sim) != tx->tx_sf ||
+            sx1276_sim_bandwidth_hz(&rx->sim) != tx->tx_bandwidth_hz) {
+            continue;
+        }
+        netsim_arrive(net, i, from, data, length, airtime_us);
+    }
+}
+
+// ============================================================================
+// --- Implementação das Funções Públicas ---
+// ============================================================================
+
+void lora_netsim_init(lora_netsim_t* net, const lora_netsim_channel_t* channel, uint32_t seed) {
+    lora_netsim_channel_t default_channel = LORA_NETSIM_CHANNEL_DEFAULT;
+    hal_host_reset();
+    memset(net, 0, sizeof(*net));
+    net->channel = channel ? *channel : default_channel;
+    net->seed = seed;
+    net->random_state = netsim_mix(seed) | 1;
+}
+
+rfm95_t* lora_netsim_add(lora_netsim_t* net, hal_spi_t* spi, float x_m, float y_m,
+                         const lora_config_t* config) {
+    uint16_t index = net->count;
+    uint32_t pin = LORA_NETSIM_PIN_BASE + 4u * index;
+    if (index >= LORA_NETSIM_MAX_NODES || pin + 3 >= HAL_HOST_GPIO_COUNT || !rfm95_radio(index)) {
+        return NULL;
+    }
+    lora_netsim_node_t* node = &net->nodes[index];
+    node->x_m = x_m;
+    node->y_m = y_m;
+    node->site = index;
+    for (uint16_t i = 0; i < index; i++) {
+        if (net->nodes[i].x_m == x_m && net->nodes[i].y_m == y_m) {
+            node->site = net->nodes[i].site;
+            break;
+        }
+    }
+    sx1276_sim_init(&node->sim, spi, pin, pin + 1, pin + 2, pin + 3);
+    sx1276_sim_set_tx_hook(&node->sim, netsim_tx, net);
+    net->count++;
+
+    rfm95_pins_t pins = RFM95_PINS_DEFAULT;
+    pins.spi = spi;
+    pins.cs = pin;
+    pins.rst = pin + 1;
+    pins.dio0 = pin + 2;
+    pins.dio1 = pin + 3;
+    if (!rfm95_init(rfm95_radio(index), &pins, config)) {
+        return NULL;                                     // o nó existe, mas sem rádio
+    }
+    node->radio = rfm95_radio(index);
+    return node->radio;
+}
+
+void lora_netsim_set_idle_listen(lora_netsim_t* net, uint16_t index, bool enable) {
+    if (index < net->count) {
+        net->nodes[index].idle_listen = enable;
+    }
+}
+
+lora_netsim_node_t* lora_netsim_node(lora_netsim_t* net, uint16_t index) {
+    return index < net->count ? &net->nodes[index] : NULL;
+}
+
+float lora_netsim_path_loss_db(const lora_netsim_t* net, uint16_t a, uint16_t b) {
+    const lora_netsim_node_t* na = &net->nodes[a];
+    const lora_netsim_node_t* nb = &net->nodes[b];
+    float distance = hypotf(na->x_m - nb->x_m, na->y_m - nb->y_m);
+    if (distance < 1.0f) distance = 1.0f;
+    float loss = net->channel.path_loss_d0_db +
+                 10.0f * net->channel.path_loss_exponent * log10f(distance / net->channel.d0_m);
+    if (net->channel.shadowing_db > 0.0f) {
+        loss += net->channel.shadowing_db * netsim_link_gaussian(net->seed, na->site, nb->site);
+    }
+    return loss;
+}
+
+float lora_netsim_noise_floor_dbm(const lora_netsim_t* net, uint32_t bandwidth_hz) {
+    return -174.0f + 10.0f * log10f((float)bandwidth_hz) + net->channel.noise_figure_db;
+}
+
+/* xorshift64* */
+uint32_t lora_netsim_random(lora_netsim_t* net) {
+    uint64_t x = net->random_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    net->random_state = x;
+    return (uint32_t)((x * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+float lora_netsim_uniform(lora_netsim_t* net) {
+    return (lora_netsim_random(net) >> 8) * (1.0f / 16777216.0f);
+}
+
+const lora_netsim_counters_t* lora_netsim_counters(const lora_netsim_t* net) {
+    return &net->counters;
+}
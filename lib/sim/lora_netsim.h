@@ -0,0 +1,121 @@
+// lora_netsim.h
+// Rede LoRa simulada para o backend host: cada nó é um sx1276_sim controlado
+// por uma instância real do driver (rfm95_radio(i)), todos no mesmo relógio
+// virtual. O modelo de canal entrega cada transmissão aos rádios no mesmo
+// canal, SF e largura de banda com o RSSI da perda de percurso log-distância
+// (com sombreamento log-normal fixo por enlace, sorteado pela semente) e
+// ignora os pacotes abaixo do SNR mínimo do SF. Sobreposições: o receptor
+// trava no primeiro pacote que demodula; ele sobrevive se ficar capture_db
+// acima da soma dos interferentes durante todo o pacote (efeito captura), e
+// um pacote que já começa sob interferência forte termina com erro de CRC.
+// SFs diferentes são tratados como ortogonais. Com a mesma semente e o mesmo
+// tráfego o resultado é idêntico a cada execução.
+#ifndef LORA_NETSIM_H
+#define LORA_NETSIM_H
+
+#include "rfm95_lora.h"
+#include "sim/sx1276_sim.h"
+
+// Pinos virtuais: o nó i usa CS, RST, DIO0 e DIO1 a partir de
+// LORA_NETSIM_PIN_BASE + 4 * i (compile com HAL_HOST_GPIO_COUNT suficiente)
+#define LORA_NETSIM_PIN_BASE 32
+
+// Nós da rede (um por rádio do driver)
+#ifndef LORA_NETSIM_MAX_NODES
+#define LORA_NETSIM_MAX_NODES LORA_MAX_RADIOS
+#endif
+
+typedef struct {
+    float d0_m;                // distância de referência
+    float path_loss_d0_db;     // perda de percurso em d0
+    float path_loss_exponent;
+    float shadowing_db;        // desvio padrão do sombreamento (0 desliga)
+    float noise_figure_db;     // do receptor (ruído = -174 dBm/Hz + 10 log10(BW) + NF)
+    float capture_db;          // vantagem sobre os interferentes para o pacote sobreviver
+} lora_netsim_channel_t;
+
+// Urbano, 868 MHz (parâmetros do LoRaSim, Bor et al. 2016): SF7 alcança ~135 m
+// e SF12 ~550 m com 14 dBm e 125 kHz
+#define LORA_NETSIM_CHANNEL_DEFAULT { 40.0f, 127.41f, 2.08f, 3.57f, 6.0f, 6.0f }
+
+typedef struct {
+    uint32_t transmissions;      // pacotes postos no ar
+    uint32_t receptions;         // pacotes demodulados (inclusive os que terminam com erro)
+    uint32_t collisions;         // recepções perdidas por interferência
+    uint32_t captures;           // interferências superadas pelo pacote em recepção
+    uint32_t busy;               // pacotes perdidos por o receptor já estar travado em outro
+    uint32_t below_sensitivity;  // receptor em RX, mas SNR abaixo do mínimo do SF
+} lora_netsim_counters_t;
+
+typedef struct {
+    sx1276_sim_t sim;
+    rfm95_t* radio;
+    float x_m;
+    float y_m;
+    uint16_t site;               // primeiro nó no mesmo ponto (chave do sombreamento)
+    bool idle_listen;            // recebe os pacotes também fora de RX e CAD
+
+    // Transmissão em curso
+    uint64_t tx_end_us;
+    uint32_t tx_frf;
+    uint8_t tx_sf;
+    uint32_t tx_bandwidth_hz;
+    float tx_power_dbm;
+
+    // Último pacote entregue ao simulador (o que ele está recebendo ou ainda
+    // pode captar): transmissor, potência recebida e fim
+    uint16_t rx_from;
+    float rx_rssi_dbm;
+    uint64_t rx_end_us;
+    bool rx_corrupted;
+
+    lora_netsim_counters_t counters;   // transmissions como transmissor, o resto como receptor
+} lora_netsim_node_t;
+
+typedef struct {
+    lora_netsim_channel_t channel;
+    uint32_t seed;
+    lora_netsim_node_t nodes[LORA_NETSIM_MAX_NODES];
+    uint16_t count;
+    uint16_t on_air[LORA_NETSIM_MAX_NODES];   // nós transmitindo (ou que acabaram há pouco)
+    uint16_t on_air_count;
+    uint64_t random_state;
+    lora_netsim_counters_t counters;
+} lora_netsim_t;
+
+// Zera o host (hal_host_reset) e a rede; channel NULL usa
+// LORA_NETSIM_CHANNEL_DEFAULT. A semente fixa o sombreamento de cada enlace e
+// a sequência de lora_netsim_random()
+void lora_netsim_init(lora_netsim_t* net, const lora_netsim_channel_t* channel, uint32_t seed);
+
+// Cria o nó seguinte (o nó i é rfm95_radio(i)) na posição (x_m, y_m) e
+// inicializa seu rádio com rfm95_init() no barramento spi (config NULL usa
+// LORA_CONFIG_DEFAULT). Rádios no mesmo ponto (ex: um gateway com um módulo
+// por SF) não se ouvem entre si e têm o mesmo sombreamento para cada nó.
+// Retorna o rádio, ou NULL sem nós, pinos ou rádios livres
+rfm95_t* lora_netsim_add(lora_netsim_t* net, hal_spi_t* spi, float x_m, float y_m,
+                         const lora_config_t* config);
+
+// Por padrão só um rádio em RX ou CAD no início do pacote o ouve. Com
+// idle_listen o nó recebe os pacotes também em sleep ou standby, e os capta
+// se entrar em RX antes do fim do preâmbulo (ex: ciclo de escuta com
+// preâmbulo longo); custa o cálculo do enlace a cada transmissão na rede
+void lora_netsim_set_idle_listen(lora_netsim_t* net, uint16_t index, bool enable);
+
+lora_netsim_node_t* lora_netsim_node(lora_netsim_t* net, uint16_t index);
+
+// Perda de percurso (dB) entre dois nós, com o sombreamento do enlace
+float lora_netsim_path_loss_db(const lora_netsim_t* net, uint16_t a, uint16_t b);
+
+// Piso de ruído (dBm) do receptor na largura de banda indicada
+float lora_netsim_noise_floor_dbm(const lora_netsim_t* net, uint32_t bandwidth_hz);
+
+// Números pseudoaleatórios da semente (tráfego e posições reproduzíveis)
+uint32_t lora_netsim_random(lora_netsim_t* net);
+
+// Uniforme em [0, 1)
+float lora_netsim_uniform(lora_netsim_t* net);
+
+const lora_netsim_counters_t* lora_netsim_counters(const lora_netsim_t* net);
+
+#endif // LORA_NETSIM_H
@@ -0,0 +1,102 @@
+// ssd1306_sim.c - Simulador do controlador SSD1306 (lado I2C)
+#include "sim/ssd1306_sim.h"
+#include <string.h>
+
+/* Quantidade de bytes de argumento de cada comando usado pela biblioteca */
+static uint8_t sim_command_args(uint8_t command) {
+    switch (command) {
+    case 0x21: case 0x22:                        // janela de coluna/página
+        return 2;
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+    case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static void sim_execute(ssd1306_sim_t* sim) {
+    switch (sim->command) {
+    case 0x21:
+        sim->col_start = sim->args[0] & 0x7F;
+        sim->col_end   = sim->args[1] & 0x7F;
+        sim->col       = sim->col_start;
+        break;
+    case 0x22:
+        sim->page_start = sim->args[0] & 0x07;
+        sim->page_end   = sim->args[1] & 0x07;
+        sim->page       = sim->page_start;
+        break;
+    case 0xAE:
+        sim->display_on = false;
+        break;
+    case 0xAF:
+        sim->display_on = true;
+        break;
+    default:
+        break;
+    }
+}
+
+static void sim_command_byte(ssd1306_sim_t* sim, uint8_t value) {
+    sim->command_bytes++;
+    if (sim->args_received < sim->args_needed) {
+        sim->args[sim->args_received++] = value;
+    } else {
+        sim->command = value;
+        sim->args_needed = sim_command_args(value);
+        sim->args_received = 0;
+    }
+    if (sim->args_received == sim->args_needed) {
+        sim_execute(sim);
+        sim->args_needed = 0;
+        sim->args_received = 0;
+    }
+}
+
+/* Grava um byte na GDDRAM e avança o cursor dentro da janela (modo horizontal) */
+static void sim_data_byte(ssd1306_sim_t* sim, uint8_t value) {
+    sim->data_bytes++;
+    sim->gddram[sim->page][sim->col] = value;
+    if (sim->col >= sim->col_end) {
+        sim->col = sim->col_start;
+        sim->page = (sim->page >= sim->page_end) ? sim->page_start : sim->page + 1;
+    } else {
+        sim->col++;
+    }
+}
+
+static int sim_i2c_write(void* ctx, const uint8_t* data, size_t len) {
+    ssd1306_sim_t* sim = ctx;
+    size_t i = 0;
+    while (i < len) {
+        uint8_t control = data[i++];
+        bool is_data = (control & 0x40) != 0;
+        bool single = (control & 0x80) != 0;    // Co=1: um byte e novo controle
+        size_t end = single ? (i + 1 < len ? i + 1 : len) : len;
+        for (; i < end; i++) {
+            if (is_data) {
+                sim_data_byte(sim, data[i]);
+            } else {
+                sim_command_byte(sim, data[i]);
+            }
+        }
+    }
+    return (int)len;
+}
+
+void ssd1306_sim_init(ssd1306_sim_t* sim, hal_i2c_t* i2c, uint8_t address) {
+    memset(sim, 0, sizeof(*sim));
+    sim->col_end  = SSD1306_SIM_WIDTH - 1;
+    sim->page_end = SSD1306_SIM_PAGES - 1;
+
+    sim->dev.ctx       = sim;
+    sim->dev.i2c_write = sim_i2c_write;
+    hal_host_attach(&sim->dev);
+    hal_host_bind_i2c(i2c, address, &sim->dev);
+}
+
+bool ssd1306_sim_pixel(const ssd1306_sim_t* sim, uint8_t x, uint8_t y) {
+    if (x >= SSD1306_SIM_WIDTH || y >= SSD1306_SIM_PAGES * 8) return false;
+    return (sim->gddram[y / 8][x] >> (y % 8)) & 0x01;
+}
@@ -0,0 +1,36 @@
+// ssd1306_sim.h
+// Destino I2C simulado do SSD1306: interpreta o fluxo de comandos/dados e
+// mantém a GDDRAM (128x64, endereçamento horizontal) para inspeção no host.
+#ifndef SSD1306_SIM_H
+#define SSD1306_SIM_H
+
+#include "hal_host.h"
+
+#define SSD1306_SIM_WIDTH 128
+#define SSD1306_SIM_PAGES 8
+
+typedef struct {
+    hal_host_device_t dev;
+    uint8_t gddram[SSD1306_SIM_PAGES][SSD1306_SIM_WIDTH];
+
+    // Janela de endereçamento e cursor
+    uint8_t col_start, col_end, page_start, page_end;
+    uint8_t col, page;
+
+    // Comando aguardando argumentos
+    uint8_t command;
+    uint8_t args[2];
+    uint8_t args_needed, args_received;
+
+    bool display_on;
+    uint32_t command_bytes;
+    uint32_t data_bytes;
+} ssd1306_sim_t;
+
+// Cria o display e o liga ao barramento I2C no endereço indicado
+void ssd1306_sim_init(ssd1306_sim_t* sim, hal_i2c_t* i2c, uint8_t address);
+
+// Lê um pixel da GDDRAM simulada
+bool ssd1306_sim_pixel(const ssd1306_sim_t* sim, uint8_t x, uint8_t y);
+
+#endif // SSD1306_SIM_H
@@ -0,0 +1,481 @@
+// sx1276_sim.c - Simulador do SX1276 em nível de registradores
+#include "sim/sx1276_sim.h"
+#include <string.h>
+#include <math.h>
+
+#define REG_FIFO                  0x00
+#define REG_OP_MODE               0x01
+#define REG_FRF_MSB               0x06
+#define REG_FRF_MID               0x07
+#define REG_FRF_LSB               0x08
+#define REG_PA_CONFIG             0x09
+#define REG_FIFO_ADDR_PTR         0x0D
+#define REG_FIFO_TX_BASE_ADDR     0x0E
+#define REG_FIFO_RX_BASE_ADDR     0x0F
+#define REG_FIFO_RX_CURRENT_ADDR  0x10
+#define REG_IRQ_FLAGS             0x12
+#define REG_RX_NB_BYTES           0x13
+#define REG_PKT_SNR_VALUE         0x19
+#define REG_MODEM_STAT            0x18
+#define REG_PKT_RSSI_VALUE        0x1A
+#define REG_HOP_CHANNEL           0x1C
+#define REG_MODEM_CONFIG_1        0x1D
+#define REG_MODEM_CONFIG_2        0x1E
+#define REG_SYMB_TIMEOUT_LSB      0x1F
+#define REG_PREAMBLE_MSB          0x20
+#define REG_PREAMBLE_LSB          0x21
+#define REG_PAYLOAD_LENGTH        0x22
+#define REG_HOP_PERIOD            0x24
+#define REG_MODEM_CONFIG_3        0x26
+#define REG_DIO_MAPPING_1         0x40
+#define REG_VERSION               0x42
+
+#define MODE_MASK                 0x07
+#define MODE_SLEEP                0x00
+#define MODE_STDBY                0x01
+#define MODE_TX                   0x03
+#define MODE_RX_CONTINUOUS        0x05
+#define MODE_RX_SINGLE            0x06
+#define MODE_CAD                  0x07
+
+#define IRQ_RX_TIMEOUT            0x80
+#define IRQ_RX_DONE               0x40
+#define IRQ_PAYLOAD_CRC_ERROR     0x20
+#define IRQ_VALID_HEADER          0x10
+#define IRQ_TX_DONE               0x08
+#define IRQ_CAD_DONE              0x04
+#define IRQ_FHSS_CHANGE_CHANNEL   0x02
+#define IRQ_CAD_DETECTED          0x01
+
+// FhssPresentChannel (bits 5-0 de RegHopChannel)
+#define HOP_CHANNEL_MASK          0x3F
+
+// Bits de RegModemStat
+#define MODEM_STAT_SIGNAL_DETECTED  0x01
+#define MODEM_STAT_SIGNAL_SYNCED    0x02
+#define MODEM_STAT_RX_ONGOING       0x04
+#define MODEM_STAT_MODEM_CLEAR      0x10
+
+static const uint32_t bandwidth_hz[10] = {
+    7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000
+};
+
+/* Valores de reset relevantes (datasheet SX1276, tabela 41) */
+static void sim_reset_regs(sx1276_sim_t* sim) {
+    memset(sim->regs, 0, sizeof(sim->regs));
+    memset(sim->fifo, 0, sizeof(sim->fifo));
+    sim->regs[REG_OP_MODE]           = 0x09;
+    sim->regs[0x06]                  = 0x6C;     // FRF 434 MHz
+    sim->regs[0x07]                  = 0x80;
+    sim->regs[0x09]                  = 0x4F;
+    sim->regs[0x0C]                  = 0x20;
+    sim->regs[REG_FIFO_TX_BASE_ADDR] = 0x80;
+    sim->regs[REG_MODEM_CONFIG_1]    = 0x72;
+    sim->regs[REG_MODEM_CONFIG_2]    = 0x70;
+    sim->regs[REG_SYMB_TIMEOUT_LSB]  = 0x64;
+    sim->regs[REG_PREAMBLE_LSB]      = 0x08;
+    sim->regs[REG_PAYLOAD_LENGTH]    = 0x01;
+    sim->regs[0x23]                  = 0xFF;
+    sim->regs[REG_VERSION]           = 0x12;
+
+    sim->have_addr     = false;
+    sim->tx_end_us     = HAL_HOST_NO_EVENT;
+    sim->rx_end_us     = HAL_HOST_NO_EVENT;
+    sim->rx_timeout_us = HAL_HOST_NO_EVENT;
+    sim->cad_end_us    = HAL_HOST_NO_EVENT;
+    sim->hop_us        = HAL_HOST_NO_EVENT;
+    sim->air_sync_us   = 0;
+}
+
+/* Atualiza os níveis de DIO0/DIO1 a partir das flags e do mapeamento */
+static void sim_update_dio(sx1276_sim_t* sim) {
+    uint8_t flags = sim->regs[REG_IRQ_FLAGS];
+    uint8_t map = sim->regs[REG_DIO_MAPPING_1];
+    static const uint8_t dio0_sources[4] = { IRQ_RX_DONE, IRQ_TX_DONE, IRQ_CAD_DONE, 0 };
+    static const uint8_t dio1_sources[4] = { IRQ_RX_TIMEOUT, IRQ_FHSS_CHANGE_CHANNEL, IRQ_CAD_DETECTED, 0 };
+    hal_host_drive_pin(sim->dio0_pin, (flags & dio0_sources[(map >> 6) & 3]) != 0);
+    hal_host_drive_pin(sim->dio1_pin, (flags & dio1_sources[(map >> 4) & 3]) != 0);
+}
+
+static void sim_reschedule(sx1276_sim_t* sim) {
+    uint64_t next = sim->tx_end_us;
+    if (sim->rx_end_us < next) next = sim->rx_end_us;
+    if (sim->rx_timeout_us < next) next = sim->rx_timeout_us;
+    if (sim->cad_end_us < next) next = sim->cad_end_us;
+    if (sim->hop_us < next) next = sim->hop_us;
+    hal_host_schedule(&sim->dev, next);
+}
+
+/* true se o rádio está sintonizado em frf (0: pacote visto em qualquer canal) */
+static bool sim_on_channel(const sx1276_sim_t* sim, uint32_t frf) {
+    return frf == 0 || frf == sx1276_sim_frf(sim);
+}
+
+/* Guarda a frequência do trecho do pacote que está terminando */
+static void sim_log_hop(sx1276_sim_t* sim) {
+    if (sim->hop_log_length < SX1276_SIM_HOP_LOG) {
+        sim->hop_log[sim->hop_log_length++] = sx1276_sim_frf(sim);
+    }
+}
+
+/* Começo de um pacote (TX ou RX): o canal do FHSS volta a 0 e, com
+   RegHopPeriod != 0, há um salto a cada RegHopPeriod símbolos até o fim */
+static void sim_fhss_start(sx1276_sim_t* sim, uint64_t start_us, uint64_t end_us) {
+    sim->hop_log_length = 0;
+    sim->regs[REG_HOP_CHANNEL] &= ~HOP_CHANNEL_MASK;
+    sim->hop_us = HAL_HOST_NO_EVENT;
+    sim->frf_written = true;                     // o primeiro trecho usa o canal já gravado
+    if (sim->regs[REG_HOP_PERIOD] == 0) return;
+
+    uint64_t now = hal_time_us();
+    sim->hop_step_us = sim->regs[REG_HOP_PERIOD] * sx1276_sim_symbol_us(sim);
+    sim->hop_end_us = end_us;
+    sim->hop_us = start_us + sim->hop_step_us;
+    while (sim->hop_us <= now) {
+        sim->hop_us += sim->hop_step_us;         // entrou em RX com o pacote já no ar
+    }
+    if (sim->hop_us >= end_us) {
+        sim->hop_us = HAL_HOST_NO_EVENT;
+    }
+}
+
+/* Troca o modo de operação, iniciando ou abortando TX/RX */
+static void sim_set_mode(sx1276_sim_t* sim, uint8_t value) {
+    uint8_t mode = value & MODE_MASK;
+    sim->regs[REG_OP_MODE] = value;
+
+    sim->tx_end_us     = HAL_HOST_NO_EVENT;
+    sim->rx_timeout_us = HAL_HOST_NO_EVENT;
+    sim->cad_end_us    = HAL_HOST_NO_EVENT;
+    if (mode != MODE_RX_CONTINUOUS && mode != MODE_RX_SINGLE) {
+        sim->rx_end_us = HAL_HOST_NO_EVENT;      // recepção abortada
+    }
+
+    uint64_t now = hal_time_us();
+    if (mode == MODE_TX) {
+        uint8_t length = sim->regs[REG_PAYLOAD_LENGTH];
+        uint8_t data[256];
+        for (uint16_t i = 0; i < length; i++) {
+            data[i] = sim->fifo[(uint8_t)(sim->regs[REG_FIFO_TX_BASE_ADDR] + i)];
+        }
+        uint64_t airtime = sx1276_sim_airtime_us(sim, length);
+        sim->tx_end_us = now + airtime;
+        sim->tx_packets++;
+        sim_fhss_start(sim, now, sim->tx_end_us);
+        if (sim->tx_hook) {
+            sim->tx_hook(sim->tx_hook_ctx, sim, data, length, airtime);
+        }
+    } else if ((mode == MODE_RX_CONTINUOUS || mode == MODE_RX_SINGLE) &&
+               sim->rx_end_us == HAL_HOST_NO_EVENT && now < sim->air_sync_us &&
+               sim_on_channel(sim, sim->air_frf)) {
+        sim->rx_end_us = sim->air_end_us;        // ainda no preâmbulo de um pacote no ar
+        sim_fhss_start(sim, sim->air_start_us, sim->air_end_us);
+    } else if (mode == MODE_RX_SINGLE && sim->rx_end_us == HAL_HOST_NO_EVENT) {
+        uint16_t symbols = ((sim->regs[REG_MODEM_CONFIG_2] & 0x03) << 8) | sim->regs[REG_SYMB_TIMEOUT_LSB];
+        sim->rx_timeout_us = now + symbols * sx1276_sim_symbol_us(sim);
+    } else if (mode == MODE_CAD) {
+        // Um símbolo de escuta e cerca de meio símbolo de processamento
+        uint64_t symbol = sx1276_sim_symbol_us(sim);
+        sim->cad_start_us = now;
+        sim->cad_end_us = now + symbol + symbol / 2;
+        sim->cad_runs++;
+    }
+    if (sim->tx_end_us == HAL_HOST_NO_EVENT && sim->rx_end_us == HAL_HOST_NO_EVENT) {
+        sim->hop_us = HAL_HOST_NO_EVENT;         // sem pacote, sem saltos
+    }
+    sim_reschedule(sim);
+}
+
+static uint8_t sim_read(sx1276_sim_t* sim, uint8_t addr) {
+    if (addr == REG_FIFO) {
+        return sim->fifo[sim->regs[REG_FIFO_ADDR_PTR]++];
+    }
+    if (addr == REG_MODEM_STAT) {
+        return sim->rx_end_us != HAL_HOST_NO_EVENT
+            ? MODEM_STAT_SIGNAL_DETECTED | MODEM_STAT_SIGNAL_SYNCED | MODEM_STAT_RX_ONGOING
+            : MODEM_STAT_MODEM_CLEAR;
+    }
+    return sim->regs[addr];
+}
+
+static void sim_write(sx1276_sim_t* sim, uint8_t addr, uint8_t value) {
+    switch (addr) {
+    case REG_FIFO:
+        sim->fifo[sim->regs[REG_FIFO_ADDR_PTR]++] = value;
+        break;
+    case REG_OP_MODE:
+        sim_set_mode(sim, value);
+        break;
+    case REG_IRQ_FLAGS:
+        sim->regs[REG_IRQ_FLAGS] &= ~value;      // escrever 1 limpa a flag
+        sim_update_dio(sim);
+        break;
+    case REG_FIFO_RX_CURRENT_ADDR:
+    case REG_RX_NB_BYTES:
+    case REG_MODEM_STAT:
+    case REG_PKT_SNR_VALUE:
+    case REG_PKT_RSSI_VALUE:
+    case REG_VERSION:
+        break;                                   // somente leitura
+    case REG_DIO_MAPPING_1:
+        sim->regs[addr] = value;
+        sim_update_dio(sim);
+        break;
+    case REG_FRF_LSB:
+        sim->regs[addr] = value;
+        sim->frf_written = true;                 // a troca vale com a escrita do LSB
+        break;
+    default:
+        sim->regs[addr] = value;
+        break;
+    }
+}
+
+// ============================================================================
+// Callbacks da HAL host
+// ============================================================================
+
+static void sim_pin_changed(void* ctx, uint pin, bool level) {
+    sx1276_sim_t* sim = ctx;
+    if (pin == sim->cs_pin && !level) {
+        sim->have_addr = false;                  // nova transação
+    } else if (pin == sim->rst_pin && !level) {
+        sim_reset_regs(sim);
+        sim_update_dio(sim);
+        sim_reschedule(sim);
+    }
+}
+
+static void sim_spi_transfer(void* ctx, const uint8_t* tx, uint8_t* rx, size_t len) {
+    sx1276_sim_t* sim = ctx;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t in = tx ? tx[i] : 0;
+        uint8_t out = 0;
+        if (!sim->have_addr) {
+            sim->addr = in & 0x7F;
+            sim->write = (in & 0x80) != 0;
+            sim->have_addr = true;
+        } else {
+            if (sim->write) {
+                sim_write(sim, sim->addr, in);
+            } else {
+                out = sim_read(sim, sim->addr);
+            }
+            if (sim->addr != REG_FIFO) {
+                sim->addr = (sim->addr + 1) & 0x7F;  // auto-incremento em rajada
+            }
+        }
+        if (rx) rx[i] = out;
+    }
+}
+
+static void sim_advance(void* ctx, uint64_t now) {
+    sx1276_sim_t* sim = ctx;
+    uint8_t mode = sim->regs[REG_OP_MODE] & MODE_MASK;
+
+    if (sim->hop_us <= now) {
+        // Salto sem o anterior atendido (flag ainda ligada ou FRF não regravado)
+        if ((sim->regs[REG_IRQ_FLAGS] & IRQ_FHSS_CHANGE_CHANNEL) || !sim->frf_written) {
+            sim->fhss_missed++;
+        }
+        sim_log_hop(sim);
+        sim->fhss_hops++;
+        sim->frf_written = false;
+        sim->regs[REG_IRQ_FLAGS] |= IRQ_FHSS_CHANGE_CHANNEL;
+        uint8_t channel = (sim->regs[REG_HOP_CHANNEL] + 1) & HOP_CHANNEL_MASK;
+        sim->regs[REG_HOP_CHANNEL] = (sim->regs[REG_HOP_CHANNEL] & ~HOP_CHANNEL_MASK) | channel;
+        sim->hop_us += sim->hop_step_us;
+        if (sim->hop_us >= sim->hop_end_us) {
+            sim->hop_us = HAL_HOST_NO_EVENT;
+        }
+    }
+
+    if (sim->tx_end_us <= now) {
+        sim->tx_end_us = HAL_HOST_NO_EVENT;
+        sim->hop_us = HAL_HOST_NO_EVENT;
+        sim_log_hop(sim);
+        sim->regs[REG_IRQ_FLAGS] |= IRQ_TX_DONE;
+        sim->regs[REG_OP_MODE] = (sim->regs[REG_OP_MODE] & ~MODE_MASK) | MODE_STDBY;
+    }
+
+    if (sim->rx_end_us <= now) {
+        sim->rx_end_us = HAL_HOST_NO_EVENT;
+        sim->hop_us = HAL_HOST_NO_EVENT;
+        sim_log_hop(sim);
+        uint8_t start = sim->regs[REG_FIFO_RX_BASE_ADDR];
+        for (uint16_t i = 0; i < sim->rx_length; i++) {
+            sim->fifo[(uint8_t)(start + i)] = sim->rx_data[i];
+        }
+        sim->regs[REG_FIFO_RX_CURRENT_ADDR] = start;
+        sim->regs[REG_RX_NB_BYTES]    = sim->rx_length;
+        sim->regs[REG_PKT_RSSI_VALUE] = (uint8_t)(sim->rx_rssi + 157);
+        sim->regs[REG_PKT_SNR_VALUE]  = (uint8_t)(int8_t)lroundf(sim->rx_snr * 4);
+        sim->regs[REG_IRQ_FLAGS] |= IRQ_RX_DONE | IRQ_VALID_HEADER;
+        if (!sim->rx_crc_ok) {
+            sim->regs[REG_IRQ_FLAGS] |= IRQ_PAYLOAD_CRC_ERROR;
+        }
+        sim->rx_packets++;
+        if (mode == MODE_RX_SINGLE) {
+            sim->regs[REG_OP_MODE] = (sim->regs[REG_OP_MODE] & ~MODE_MASK) | MODE_STDBY;
+        }
+    }
+
+    if (sim->rx_timeout_us <= now) {
+        sim->rx_timeout_us = HAL_HOST_NO_EVENT;
+        sim->regs[REG_IRQ_FLAGS] |= IRQ_RX_TIMEOUT;
+        sim->regs[REG_OP_MODE] = (sim->regs[REG_OP_MODE] & ~MODE_MASK) | MODE_STDBY;
+    }
+
+    if (sim->cad_end_us <= now) {
+        sim->cad_end_us = HAL_HOST_NO_EVENT;
+        sim->regs[REG_IRQ_FLAGS] |= IRQ_CAD_DONE;
+        if (sim->channel_end_us > sim->cad_start_us && sim->channel_start_us < now &&
+            sim_on_channel(sim, sim->channel_frf)) {
+            sim->regs[REG_IRQ_FLAGS] |= IRQ_CAD_DETECTED;
+        }
+        sim->regs[REG_OP_MODE] = (sim->regs[REG_OP_MODE] & ~MODE_MASK) | MODE_STDBY;
+    }
+
+    sim_update_dio(sim);
+    sim_reschedule(sim);
+}
+
+// ============================================================================
+// Interface pública
+// ============================================================================
+
+void sx1276_sim_init(sx1276_sim_t* sim, hal_spi_t* spi, uint cs_pin, uint rst_pin,
+                     uint dio0_pin, uint dio1_pin) {
+    memset(sim, 0, sizeof(*sim));
+    sim->cs_pin   = cs_pin;
+    sim->rst_pin  = rst_pin;
+    sim->dio0_pin = dio0_pin;
+    sim->dio1_pin = dio1_pin;
+    sim_reset_regs(sim);
+
+    sim->dev.ctx          = sim;
+    sim->dev.pin_changed  = sim_pin_changed;
+    sim->dev.spi_transfer = sim_spi_transfer;
+    sim->dev.advance      = sim_advance;
+    hal_host_attach(&sim->dev);
+    hal_host_bind_spi(spi, cs_pin, &sim->dev);
+    hal_host_bind_pin(rst_pin, &sim->dev);
+}
+
+void sx1276_sim_set_tx_hook(sx1276_sim_t* sim, sx1276_sim_tx_hook_t hook, void* ctx) {
+    sim->tx_hook = hook;
+    sim->tx_hook_ctx = ctx;
+}
+
+bool sx1276_sim_deliver(sx1276_sim_t* sim, const uint8_t* data, uint8_t length,
+                        uint64_t airtime_us, int rssi_dbm, float snr_db, bool crc_ok) {
+    return sx1276_sim_deliver_on(sim, 0, data, length, airtime_us, rssi_dbm, snr_db, crc_ok);
+}
+
+bool sx1276_sim_deliver_on(sx1276_sim_t* sim, uint32_t frf, const uint8_t* data, uint8_t length,
+                           uint64_t airtime_us, int rssi_dbm, float snr_db, bool crc_ok) {
+    uint64_t now = hal_time_us();
+    sx1276_sim_set_channel_activity(sim, now + airtime_us);
+    sim->channel_frf = frf;
+    if (sim->rx_end_us != HAL_HOST_NO_EVENT) {
+        return false;                            // já recebendo outro pacote
+    }
+    memcpy(sim->rx_data, data, length);
+    sim->rx_length = length;
+    sim->rx_rssi   = rssi_dbm;
+    sim->rx_snr    = snr_db;
+    sim->rx_crc_ok = crc_ok;
+
+    // O trecho após o preâmbulo dura o mesmo com o modem deste rádio
+    uint64_t symbol = sx1276_sim_symbol_us(sim);
+    uint16_t preamble = (sim->regs[REG_PREAMBLE_MSB] << 8) | sim->regs[REG_PREAMBLE_LSB];
+    uint64_t tail = sx1276_sim_airtime_us(sim, length) - (preamble * symbol + symbol / 4);
+    sim->air_frf = frf;
+    sim->air_start_us = now;
+    sim->air_end_us  = now + airtime_us;
+    sim->air_sync_us = sim->air_end_us > tail ? sim->air_end_us - tail : now;
+
+    uint8_t mode = sim->regs[REG_OP_MODE] & MODE_MASK;
+    if ((mode != MODE_RX_CONTINUOUS && mode != MODE_RX_SINGLE) || !sim_on_channel(sim, frf)) {
+        return false;
+    }
+    sim->rx_end_us     = sim->air_end_us;
+    sim->rx_timeout_us = HAL_HOST_NO_EVENT;      // preâmbulo detectado
+    sim_fhss_start(sim, now, sim->air_end_us);
+    sim_reschedule(sim);
+    return true;
+}
+
+void sx1276_sim_set_channel_activity(sx1276_sim_t* sim, uint64_t until_us) {
+    uint64_t now = hal_time_us();
+    if (sim->channel_end_us <= now) {
+        sim->channel_start_us = now;                     // nova ocupação
+    }
+    sim->channel_frf = 0;
+    if (until_us > sim->channel_end_us) {
+        sim->channel_end_us = until_us;
+    }
+}
+
+uint64_t sx1276_sim_symbol_us(const sx1276_sim_t* sim) {
+    uint8_t bw = sim->regs[REG_MODEM_CONFIG_1] >> 4;
+    uint8_t sf = sim->regs[REG_MODEM_CONFIG_2] >> 4;
+    if (bw > 9) bw = 9;
+    return ((uint64_t)1000000 << sf) / bandwidth_hz[bw];
+}
+
+/* Fórmula de tempo no ar do datasheet (seção 4.1.1.7) */
+uint64_t sx1276_sim_airtime_us(const sx1276_sim_t* sim, uint8_t length) {
+    uint8_t config1 = sim->regs[REG_MODEM_CONFIG_1];
+    uint8_t config2 = sim->regs[REG_MODEM_CONFIG_2];
+    uint8_t bw_index = config1 >> 4;
+    if (bw_index > 9) bw_index = 9;
+
+    int sf  = config2 >> 4;
+    int cr  = (config1 >> 1) & 0x07;
+    int ih  = config1 & 0x01;
+    int crc = (config2 >> 2) & 0x01;
+    int de  = (sim->regs[REG_MODEM_CONFIG_3] >> 3) & 0x01;
+    int preamble = (sim->regs[REG_PREAMBLE_MSB] << 8) | sim->regs[REG_PREAMBLE_LSB];
+
+    double t_sym = (double)(1 << sf) * 1e6 / bandwidth_hz[bw_index];
+    double t_preamble = (preamble + 4.25) * t_sym;
+    double num = 8.0 * length - 4.0 * sf + 28 + 16 * crc - 20 * ih;
+    double den = 4.0 * (sf - 2 * de);
+    double payload_symbols = 8 + fmax(ceil(num / den) * (cr + 4), 0);
+    return (uint64_t)llround(t_preamble + payload_symbols * t_sym);
+}
+
+uint8_t sx1276_sim_mode(const sx1276_sim_t* sim) {
+    return sim->regs[REG_OP_MODE] & MODE_MASK;
+}
+
+uint32_t sx1276_sim_frf(const sx1276_sim_t* sim) {
+    return ((uint32_t)sim->regs[REG_FRF_MSB] << 16) | ((uint32_t)sim->regs[REG_FRF_MID] << 8) |
+           sim->regs[REG_FRF_LSB];
+}
+
+void sx1276_sim_corrupt(sx1276_sim_t* sim) {
+    if (sim->rx_end_us != HAL_HOST_NO_EVENT || sim->air_end_us > hal_time_us()) {
+        sim->rx_crc_ok = false;
+    }
+}
+
+uint8_t sx1276_sim_sf(const sx1276_sim_t* sim) {
+    return sim->regs[REG_MODEM_CONFIG_2] >> 4;
+}
+
+uint32_t sx1276_sim_bandwidth_hz(const sx1276_sim_t* sim) {
+    uint8_t bw = sim->regs[REG_MODEM_CONFIG_1] >> 4;
+    return bandwidth_hz[bw > 9 ? 9 : bw];
+}
+
+/* PA_BOOST: Pout = 2 + OutputPower; RFO: Pmax - (15 - OutputPower), com
+   Pmax = 10,8 + 0,6 * MaxPower (datasheet, RegPaConfig) */
+float sx1276_sim_tx_power(const sx1276_sim_t* sim) {
+    uint8_t pa = sim->regs[REG_PA_CONFIG];
+    if (pa & 0x80) {
+        return 2.0f + (pa & 0x0F);
+    }
+    return 10.8f + 0.6f * ((pa >> 4) & 0x07) - (15 - (pa & 0x0F));
+}
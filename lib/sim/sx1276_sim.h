@@ -0,0 +1,123 @@
+// sx1276_sim.h
+// Simulador em nível de registradores do SX1276 (RFM95) para o backend host da
+// HAL: FIFO com acesso em rajada, flags de IRQ, modos de operação (inclusive
+// CAD), saltos do FHSS, pinos DIO e duração dos pacotes segundo o tempo no ar
+// do modem configurado.
+#ifndef SX1276_SIM_H
+#define SX1276_SIM_H
+
+#include "hal_host.h"
+
+typedef struct sx1276_sim sx1276_sim_t;
+
+// Trechos do último pacote guardados em hop_log
+#ifndef SX1276_SIM_HOP_LOG
+#define SX1276_SIM_HOP_LOG 64
+#endif
+
+// Chamado quando o rádio entra em TX; airtime_us é o tempo no ar do pacote
+typedef void (*sx1276_sim_tx_hook_t)(void* ctx, sx1276_sim_t* radio,
+                                     const uint8_t* data, uint8_t length, uint64_t airtime_us);
+
+struct sx1276_sim {
+    hal_host_device_t dev;
+    uint8_t regs[0x80];
+    uint8_t fifo[256];
+    uint cs_pin, rst_pin, dio0_pin, dio1_pin;
+
+    // Transação SPI em andamento
+    bool have_addr;
+    bool write;
+    uint8_t addr;
+
+    // Eventos agendados (HAL_HOST_NO_EVENT quando inativos)
+    uint64_t tx_end_us;
+    uint64_t rx_end_us;
+    uint64_t rx_timeout_us;
+    uint64_t cad_start_us;
+    uint64_t cad_end_us;
+    uint64_t hop_us;                     // próximo salto do FHSS
+
+    // Atividade no canal vista pelo CAD: [channel_start_us, channel_end_us),
+    // em channel_frf (0: em qualquer frequência)
+    uint64_t channel_start_us;
+    uint64_t channel_end_us;
+    uint32_t channel_frf;
+
+    // Pacote sendo recebido (ou no ar, se o rádio ainda não está em RX)
+    uint64_t air_sync_us;                // fim do preâmbulo: último instante para entrar em RX
+    uint32_t air_frf;                    // canal do pacote (0: qualquer)
+    uint64_t air_start_us;
+    uint64_t air_end_us;
+    uint8_t rx_data[255];
+    uint8_t rx_length;
+    int rx_rssi;
+    float rx_snr;
+    bool rx_crc_ok;
+
+    // FHSS: duração de um trecho, fim do pacote e FRF (24 bits) de cada
+    // trecho do último pacote, do primeiro canal ao último salto
+    uint64_t hop_step_us;
+    uint64_t hop_end_us;
+    bool frf_written;                    // FRF regravado desde o último salto
+    uint32_t hop_log[SX1276_SIM_HOP_LOG];
+    uint8_t hop_log_length;
+
+    sx1276_sim_tx_hook_t tx_hook;
+    void* tx_hook_ctx;
+
+    uint32_t tx_packets;
+    uint32_t rx_packets;
+    uint32_t cad_runs;
+    uint32_t fhss_hops;
+    uint32_t fhss_missed;                // saltos com o anterior ainda não atendido
+};
+
+// Cria o rádio e o liga ao barramento SPI (CS), ao pino de reset e aos DIOs
+void sx1276_sim_init(sx1276_sim_t* sim, hal_spi_t* spi, uint cs_pin, uint rst_pin,
+                     uint dio0_pin, uint dio1_pin);
+
+// Define quem recebe os pacotes transmitidos por este rádio
+void sx1276_sim_set_tx_hook(sx1276_sim_t* sim, sx1276_sim_tx_hook_t hook, void* ctx);
+
+// Começa a receber um pacote agora; o RxDone ocorre após airtime_us.
+// Retorna false se o rádio não está escutando (fora de RX ou já recebendo);
+// fora de RX o pacote ainda é captado se o rádio entrar em RX antes do fim do
+// preâmbulo (o pacote pode ter um preâmbulo mais longo que o do receptor).
+bool sx1276_sim_deliver(sx1276_sim_t* sim, const uint8_t* data, uint8_t length,
+                        uint64_t airtime_us, int rssi_dbm, float snr_db, bool crc_ok);
+
+// Igual a sx1276_sim_deliver() para um pacote transmitido em frf (FRF de 24
+// bits, ex: sx1276_sim_frf() do transmissor): a recepção e o CAD só o veem
+// com o rádio sintonizado na mesma frequência
+bool sx1276_sim_deliver_on(sx1276_sim_t* sim, uint32_t frf, const uint8_t* data, uint8_t length,
+                           uint64_t airtime_us, int rssi_dbm, float snr_db, bool crc_ok);
+
+// Marca o canal como ocupado de agora até until_us (transmissão de outro nó,
+// mesmo que este rádio não esteja em RX); sx1276_sim_deliver() já faz isso
+void sx1276_sim_set_channel_activity(sx1276_sim_t* sim, uint64_t until_us);
+
+// Tempo no ar (us) de um pacote com a configuração atual dos registradores
+uint64_t sx1276_sim_airtime_us(const sx1276_sim_t* sim, uint8_t length);
+
+// Duração de um símbolo (us) com a configuração atual
+uint64_t sx1276_sim_symbol_us(const sx1276_sim_t* sim);
+
+// Modo de operação atual (bits 2-0 de RegOpMode)
+uint8_t sx1276_sim_mode(const sx1276_sim_t* sim);
+
+// Frequência gravada (RegFrfMsb/Mid/Lsb, 24 bits), ex: para o gancho de TX
+// entregar o pacote só aos rádios no mesmo canal
+uint32_t sx1276_sim_frf(const sx1276_sim_t* sim);
+
+// Colisão: o pacote em recepção (ou no ar, ainda captável) termina com erro
+// de CRC
+void sx1276_sim_corrupt(sx1276_sim_t* sim);
+
+// Spreading factor, largura de banda (Hz) e potência de saída (dBm) dos
+// registradores, ex: para um modelo de canal decidir quem demodula o pacote
+uint8_t sx1276_sim_sf(const sx1276_sim_t* sim);
+uint32_t sx1276_sim_bandwidth_hz(const sx1276_sim_t* sim);
+float sx1276_sim_tx_power(const sx1276_sim_t* sim);
+
+#endif // SX1276_SIM_H
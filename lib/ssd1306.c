@@ -1,11 +1,171 @@
 #include "ssd1306.h"
 #include "font.h"
+#include "ssd1306_glyphs.h"
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
-#include "hardware/i2c.h"
+
+// Bytes gastos para abrir uma janela: prefixo de comando + 6 bytes de endereço
+#define SSD1306_WINDOW_COST 7
+
+// Marca as colunas x0..x1 da página como alteradas
+static inline void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t page, uint8_t x0, uint8_t x1) {
+    if (x0 < ssd->dirty_x0[page]) ssd->dirty_x0[page] = x0;
+    if (x1 > ssd->dirty_x1[page]) ssd->dirty_x1[page] = x1;
+}
+
+static void ssd1306_clear_dirty(ssd1306_t *ssd) {
+    for (uint8_t p = 0; p < SSD1306_MAX_PAGES; ++p) {
+        ssd->dirty_x0[p] = 0xFF;
+        ssd->dirty_x1[p] = 0;
+    }
+}
+
+// Envia len bytes de ram_buffer a partir de index como dados; o byte anterior
+// vira temporariamente o prefixo 0x40, evitando uma cópia
+static void ssd1306_write_span(ssd1306_t *ssd, uint16_t index, uint16_t len) {
+    uint8_t saved = ssd->ram_buffer[index - 1];
+    ssd->ram_buffer[index - 1] = 0x40;
+    hal_i2c_write(ssd->i2c_port, ssd->address, &ssd->ram_buffer[index - 1], len + 1);
+    ssd->ram_buffer[index - 1] = saved;
+}
+
+// Liga/desliga o bloco de colunas x0..x1 e linhas y0..y1 (coordenadas já
+// recortadas pelo chamador), um byte de página por coluna em vez de um pixel
+static void ssd1306_fill_block(ssd1306_t *ssd, int x0, int x1, int y0, int y1, bool value) {
+    for (int p = y0 / 8; p <= y1 / 8; ++p) {
+        int top = (p * 8 > y0) ? 0 : y0 % 8;
+        int bottom = (p * 8 + 7 < y1) ? 7 : y1 % 8;
+        uint8_t mask = (uint8_t)((0xFF << top) & (0xFF >> (7 - bottom)));
+        uint8_t *row = &ssd->ram_buffer[p * ssd->width + 1];
+
+        if (mask == 0xFF) {
+            // Página inteira: só o trecho que muda é reescrito (memset)
+            uint8_t target = value ? 0xFF : 0x00;
+            int first = x0, last = x1;
+            while (first <= x1 && row[first] == target) ++first;
+            if (first > x1) continue;
+            while (row[last] == target) --last;
+            memset(&row[first], target, last - first + 1);
+            ssd1306_mark_dirty(ssd, p, first, last);
+        } else {
+            int first = -1, last = 0;
+            for (int x = x0; x <= x1; ++x) {
+                uint8_t updated = value ? (row[x] | mask) : (row[x] & ~mask);
+                if (updated != row[x]) {
+                    row[x] = updated;
+                    if (first < 0) first = x;
+                    last = x;
+                }
+            }
+            if (first >= 0) ssd1306_mark_dirty(ssd, p, first, last);
+        }
+    }
+}
+
+// Recorta o bloco à área visível do buffer e o preenche
+static void ssd1306_fill_clipped(ssd1306_t *ssd, int x0, int x1, int y0, int y1, bool value) {
+    int max_y = ssd->pages * 8 - 1;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= ssd->width) x1 = ssd->width - 1;
+    if (y1 >= ssd->height) y1 = ssd->height - 1;
+    if (y1 > max_y) y1 = max_y;
+    if (x0 > x1 || y0 > y1) return;
+    ssd1306_fill_block(ssd, x0, x1, y0, y1, value);
+}
+
+// Grava os bits de mask em um byte do buffer, marcando-o se mudou
+static inline void ssd1306_put_byte(ssd1306_t *ssd, uint8_t page, uint8_t x, uint8_t bits, uint8_t mask) {
+    uint8_t *dst = &ssd->ram_buffer[page * ssd->width + x + 1];
+    uint8_t updated = (*dst & ~mask) | (bits & mask);
+    if (updated != *dst) {
+        *dst = updated;
+        ssd1306_mark_dirty(ssd, page, x, x);
+    }
+}
+
+// Máscara das linhas da página que existem no buffer
+static inline uint8_t ssd1306_page_mask(ssd1306_t *ssd, int page) {
+    int rows = ssd->height < ssd->pages * 8 ? ssd->height : ssd->pages * 8;
+    int visible = rows - page * 8;
+    if (visible >= 8) return 0xFF;
+    return visible > 0 ? (uint8_t)(0xFF >> (8 - visible)) : 0x00;
+}
+
+// Copia um glifo 8x8 (colunas) para x, y: com y múltiplo de 8 é uma cópia
+// direta para uma página; senão cada coluna é deslocada sobre duas páginas
+static void ssd1306_blit_glyph(ssd1306_t *ssd, const uint8_t *columns, uint8_t x, uint8_t y) {
+    if (x > 255 - 7 || y > 255 - 7) {
+        // Coordenadas que dão a volta nos 8 bits: mesmo resultado do pixel a pixel
+        for (uint8_t i = 0; i < 8; ++i) {
+            for (uint8_t j = 0; j < 8; ++j) {
+                ssd1306_pixel(ssd, x + i, y + j, (columns[i] >> j) & 0x01);
+            }
+        }
+        return;
+    }
+
+    uint8_t page = y / 8, shift = y % 8;
+    uint8_t mask_low = (uint8_t)(0xFF << shift) & ssd1306_page_mask(ssd, page);
+    uint8_t mask_high = shift ? (uint8_t)(0xFF >> (8 - shift)) & ssd1306_page_mask(ssd, page + 1) : 0;
+    uint8_t count = (x + 8 <= ssd->width) ? 8 : (x < ssd->width ? ssd->width - x : 0);
+
+    for (uint8_t i = 0; i < count; ++i) {
+        if (mask_low) ssd1306_put_byte(ssd, page, x + i, columns[i] << shift, mask_low);
+        if (mask_high) ssd1306_put_byte(ssd, page + 1, x + i, columns[i] >> (8 - shift), mask_high);
+    }
+}
+
+// Bytes para enviar as páginas p0..p1 na janela de colunas c0..c1
+static uint16_t ssd1306_window_cost(ssd1306_t *ssd, uint8_t p0, uint8_t p1, uint8_t c0, uint8_t c1) {
+    uint16_t rows = p1 - p0 + 1;
+    uint16_t cols = c1 - c0 + 1;
+    if (cols == ssd->width) return SSD1306_WINDOW_COST + 1 + rows * cols;   // contíguo
+    return SSD1306_WINDOW_COST + rows * (1 + cols);
+}
+
+// Espera o envio assíncrono em andamento liberar o barramento
+static void ssd1306_wait(ssd1306_t *ssd) {
+    while (ssd1306_busy(ssd)) {
+        hal_yield();
+    }
+}
+
+// Monta os comandos de endereço de coluna/página em uma única escrita
+static void ssd1306_prepare_window(ssd1306_t *ssd, uint8_t p0, uint8_t p1, uint8_t c0, uint8_t c1) {
+    ssd->window_cmd[0] = 0x00;  // Prefixo de comando (Co=0, D/C=0)
+    ssd->window_cmd[1] = 0x21;  // Define endereço de coluna
+    ssd->window_cmd[2] = c0;
+    ssd->window_cmd[3] = c1;
+    ssd->window_cmd[4] = 0x22;  // Define endereço de página
+    ssd->window_cmd[5] = p0;
+    ssd->window_cmd[6] = p1;
+}
+
+static void ssd1306_set_window(ssd1306_t *ssd, uint8_t p0, uint8_t p1, uint8_t c0, uint8_t c1) {
+    ssd1306_prepare_window(ssd, p0, p1, c0, c1);
+    hal_i2c_write(ssd->i2c_port, ssd->address, ssd->window_cmd, sizeof(ssd->window_cmd));
+}
+
+// Abre a janela e envia as linhas das páginas p0..p1
+static void ssd1306_send_window(ssd1306_t *ssd, uint8_t p0, uint8_t p1, uint8_t c0, uint8_t c1) {
+    ssd1306_set_window(ssd, p0, p1, c0, c1);
+
+    uint16_t cols = c1 - c0 + 1;
+    if (cols == ssd->width) {
+        ssd1306_write_span(ssd, p0 * ssd->width + 1, (p1 - p0 + 1) * cols);
+    } else {
+        // O cursor do controlador continua entre escritas dentro da janela
+        for (uint8_t p = p0; p <= p1; ++p) {
+            ssd1306_write_span(ssd, p * ssd->width + c0 + 1, cols);
+        }
+    }
+}
 
 // Inicializa a estrutura do display SSD1306
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
+void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, hal_i2c_t *i2c) {
+    (void)external_vcc;   // a configuração liga sempre o charge pump interno
     ssd->width = width;
     ssd->height = height;
     ssd->pages = height / 8;
@@ -23,6 +183,16 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
     // Inicializa buffers
     ssd->ram_buffer[0] = 0x40; // Prefixo de dados
     ssd->port_buffer[0] = 0x00; // Prefixo de comando (Co=0, D/C=0)
+    ssd->front_buffer = NULL;   // buffer duplo só com ssd1306_enable_double_buffer()
+    ssd->pending_data = NULL;
+    ssd->busy = false;
+    ssd->deferred = false;
+
+    // O conteúdo da GDDRAM é desconhecido: o primeiro envio parcial cobre tudo
+    ssd1306_clear_dirty(ssd);
+    for (uint8_t p = 0; p < ssd->pages && p < SSD1306_MAX_PAGES; ++p) {
+        ssd1306_mark_dirty(ssd, p, 0, ssd->width - 1);
+    }
 }
 
 // Configura os parâmetros iniciais do display
@@ -56,19 +226,133 @@ void ssd1306_config(ssd1306_t *ssd) {
 
 // Envia um comando para o display via I2C
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+    ssd1306_wait(ssd);
     ssd->port_buffer[1] = command;
-    i2c_write_blocking(ssd->i2c_port, ssd->address, ssd->port_buffer, 2, false);
+    hal_i2c_write(ssd->i2c_port, ssd->address, ssd->port_buffer, 2);
 }
 
 // Envia o buffer de dados para o display
 void ssd1306_send_data(ssd1306_t *ssd) {
-    ssd1306_command(ssd, 0x21); // Define endereço de coluna
-    ssd1306_command(ssd, 0);
-    ssd1306_command(ssd, ssd->width - 1);
-    ssd1306_command(ssd, 0x22); // Define endereço de página
-    ssd1306_command(ssd, 0);
-    ssd1306_command(ssd, ssd->pages - 1);
-    i2c_write_blocking(ssd->i2c_port, ssd->address, ssd->ram_buffer, ssd->bufsize, false);
+    ssd1306_wait(ssd);
+    ssd1306_set_window(ssd, 0, ssd->pages - 1, 0, ssd->width - 1);
+    hal_i2c_write(ssd->i2c_port, ssd->address, ssd->ram_buffer, ssd->bufsize);
+    ssd1306_clear_dirty(ssd);
+}
+
+// Envia as páginas alteradas; páginas vizinhas dividem uma janela quando a
+// união das colunas custa menos que abrir uma janela nova
+void ssd1306_send_dirty(ssd1306_t *ssd) {
+    ssd1306_wait(ssd);
+    bool open = false;
+    uint8_t p0 = 0, p1 = 0, c0 = 0, c1 = 0;
+
+    for (uint8_t p = 0; p < ssd->pages && p < SSD1306_MAX_PAGES; ++p) {
+        uint8_t x0 = ssd->dirty_x0[p], x1 = ssd->dirty_x1[p];
+        if (x0 > x1) {                                   // página limpa fecha a janela
+            if (open) ssd1306_send_window(ssd, p0, p1, c0, c1);
+            open = false;
+            continue;
+        }
+        if (open && p == p1 + 1) {
+            uint8_t u0 = x0 < c0 ? x0 : c0;
+            uint8_t u1 = x1 > c1 ? x1 : c1;
+            uint16_t merged = ssd1306_window_cost(ssd, p0, p, u0, u1);
+            uint16_t split = ssd1306_window_cost(ssd, p0, p1, c0, c1) +
+                             ssd1306_window_cost(ssd, p, p, x0, x1);
+            if (merged <= split) {
+                p1 = p; c0 = u0; c1 = u1;
+                continue;
+            }
+        }
+        if (open) ssd1306_send_window(ssd, p0, p1, c0, c1);
+        open = true;
+        p0 = p1 = p; c0 = x0; c1 = x1;
+    }
+    if (open) ssd1306_send_window(ssd, p0, p1, c0, c1);
+    ssd1306_clear_dirty(ssd);
+}
+
+bool ssd1306_enable_double_buffer(ssd1306_t *ssd) {
+    if (ssd->front_buffer) return true;
+    ssd->front_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+    return ssd->front_buffer != NULL;
+}
+
+// Fim de uma etapa do envio assíncrono: depois da janela vêm os dados. Sem
+// DMA livre, a escrita fica para a próxima consulta: uma escrita bloqueante
+// de até 1 kB não pode rodar dentro da interrupção
+static void ssd1306_async_done(void *ctx) {
+    ssd1306_t *ssd = ctx;
+    if (ssd->pending_data) {
+        const uint8_t *data = ssd->pending_data;
+        ssd->pending_data = NULL;
+        if (!hal_i2c_write_async(ssd->i2c_port, ssd->address, data, ssd->pending_len,
+                                 ssd1306_async_done, ssd)) {
+            ssd->pending_data = data;
+            ssd->deferred = true;
+        }
+        return;
+    }
+    ssd->busy = false;
+}
+
+void ssd1306_flush_async(ssd1306_t *ssd) {
+    if (!ssd->front_buffer) {
+        ssd1306_send_dirty(ssd);
+        return;
+    }
+    ssd1306_wait(ssd);
+
+    // Faixa de páginas alteradas, enviada com largura total (dados contíguos)
+    int p0 = -1, p1 = -1;
+    for (uint8_t p = 0; p < ssd->pages && p < SSD1306_MAX_PAGES; ++p) {
+        if (ssd->dirty_x0[p] > ssd->dirty_x1[p]) continue;
+        if (p0 < 0) p0 = p;
+        p1 = p;
+    }
+    if (p0 < 0) return;
+
+    // O quadro pronto vira a frente; o de trás recebe uma cópia para o desenho
+    // continuar de onde parou
+    uint8_t *front = ssd->ram_buffer;
+    ssd->ram_buffer = ssd->front_buffer;
+    ssd->front_buffer = front;
+    memcpy(ssd->ram_buffer, front, ssd->bufsize);
+    ssd1306_clear_dirty(ssd);
+
+    // O byte antes do trecho vira o prefixo 0x40; a frente é descartada na
+    // próxima troca, então não precisa ser restaurado
+    uint16_t index = p0 * ssd->width + 1;
+    front[index - 1] = 0x40;
+    ssd->pending_data = &front[index - 1];
+    ssd->pending_len = (p1 - p0 + 1) * ssd->width + 1;
+
+    ssd1306_prepare_window(ssd, p0, p1, 0, ssd->width - 1);
+    ssd->busy = true;
+    if (!hal_i2c_write_async(ssd->i2c_port, ssd->address, ssd->window_cmd,
+                             sizeof(ssd->window_cmd), ssd1306_async_done, ssd)) {
+        // Sem DMA livre: envio bloqueante
+        hal_i2c_write(ssd->i2c_port, ssd->address, ssd->window_cmd, sizeof(ssd->window_cmd));
+        hal_i2c_write(ssd->i2c_port, ssd->address, ssd->pending_data, ssd->pending_len);
+        ssd->pending_data = NULL;
+        ssd->busy = false;
+    }
+}
+
+bool ssd1306_busy(ssd1306_t *ssd) {
+    if (ssd->deferred) {
+        // Dados adiados pela interrupção: tenta o DMA de novo; ainda ocupado,
+        // o envio segue adiado para a próxima consulta
+        const uint8_t *data = ssd->pending_data;
+        ssd->pending_data = NULL;
+        ssd->deferred = false;
+        if (!hal_i2c_write_async(ssd->i2c_port, ssd->address, data, ssd->pending_len,
+                                 ssd1306_async_done, ssd)) {
+            ssd->pending_data = data;
+            ssd->deferred = true;
+        }
+    }
+    return ssd->busy;
 }
 
 // Desenha um pixel no buffer
@@ -76,20 +360,17 @@ void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
     if (x >= ssd->width || y >= ssd->height) return; // Verifica limites
     uint16_t index = (y / 8) * ssd->width + x + 1;
     uint8_t pixel = y % 8;
-    if (value) {
-        ssd->ram_buffer[index] |= (1 << pixel);
-    } else {
-        ssd->ram_buffer[index] &= ~(1 << pixel);
+    uint8_t old = ssd->ram_buffer[index];
+    uint8_t updated = value ? (old | (1 << pixel)) : (old & ~(1 << pixel));
+    if (updated != old) {
+        ssd->ram_buffer[index] = updated;
+        ssd1306_mark_dirty(ssd, y / 8, x, x);
     }
 }
 
 // Preenche a tela com pixels ligados ou desligados
 void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+    ssd1306_fill_clipped(ssd, 0, ssd->width - 1, 0, ssd->height - 1, value);
 }
 
 // Desenha números pequenos (5x5 pixels)
@@ -115,54 +396,12 @@ void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y, bool use_sm
         return;
     }
 
-    uint16_t index = 0;
-    bool rotate = false;
-
-    // Mapeia caracteres
-    if (c >= '0' && c <= '9') {
-        index = (c - '0' + 1) * 8;
-    } else if (c >= 'A' && c <= 'Z') {
-        index = (c - 'A' + 11) * 8;
-    } else if (c >= 'a' && c <= 'z') {
-        index = (c - 'a' + 37) * 8;
-    } else if (c == ':') {
-        index = 64 * 8;
-        rotate = true;
-    } else if (c == '.') {
-        index = 65 * 8;
-        rotate = true;
-    } else if (c == '>') {
-        index = 66 * 8;
-        rotate = true;
-    } else if (c == '-') {
-        index = 67 * 8;
-        rotate = true;
-    } else if (c == 127) {
-        index = 68 * 8; // Símbolo Ohm
-    } else if (c == '!') {
-        index = 69 * 8;
-        rotate = true;
-    }
-    else if (c == '%') {
-        index = 70 * 8;
-        rotate = true;
-    } 
-    else if (c == '/') {
-        index = 71 * 8;
-        rotate = true;
-    } 
-    else {
+    // Glifos já no formato da GDDRAM, gerados de font[] (ssd1306_glyphs.h)
+    uint8_t code = (uint8_t)c;
+    if (code >= sizeof(ssd1306_glyph_lookup) || ssd1306_glyph_lookup[code] == SSD1306_GLYPH_NONE) {
         return; // Caractere não suportado
     }
-
-    // Renderiza caractere
-    for (uint8_t i = 0; i < 8; ++i) {
-        uint8_t line = font[index + i];
-        for (uint8_t j = 0; j < 8; ++j) {
-            bool pixel_value = rotate ? (line >> j) & 0x01 : (line >> j) & 0x01;
-            ssd1306_pixel(ssd, x + (rotate ? (7 - j) : i), y + (rotate ? i : j), pixel_value);
-        }
-    }
+    ssd1306_blit_glyph(ssd, ssd1306_glyph_columns[ssd1306_glyph_lookup[code]], x, y);
 }
 
 // Desenha uma string
@@ -184,22 +423,21 @@ void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y,
     }
 }
 
-// Desenha um retângulo
+// Desenha um retângulo (bordas e interior como blocos de bytes)
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-    for (uint8_t x = left; x < left + width; ++x) {
-        ssd1306_pixel(ssd, x, top, value);
-        ssd1306_pixel(ssd, x, top + height - 1, value);
+    // A borda inferior/direita usa coordenada de 8 bits, como ssd1306_pixel recebe
+    uint8_t bottom = top + height - 1;
+    uint8_t right = left + width - 1;
+    if (width > 0) {
+        ssd1306_fill_clipped(ssd, left, left + width - 1, top, top, value);
+        ssd1306_fill_clipped(ssd, left, left + width - 1, bottom, bottom, value);
     }
-    for (uint8_t y = top; y < top + height; ++y) {
-        ssd1306_pixel(ssd, left, y, value);
-        ssd1306_pixel(ssd, left + width - 1, y, value);
+    if (height > 0) {
+        ssd1306_fill_clipped(ssd, left, left, top, top + height - 1, value);
+        ssd1306_fill_clipped(ssd, right, right, top, top + height - 1, value);
     }
     if (fill) {
-        for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-            for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-                ssd1306_pixel(ssd, x, y, value);
-            }
-        }
+        ssd1306_fill_clipped(ssd, left + 1, left + width - 2, top + 1, top + height - 2, value);
     }
 }
 
@@ -218,16 +456,12 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0,
     }
 }
 
-// Desenha uma linha horizontal
+// Desenha uma linha horizontal (uma máscara de bit por coluna)
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-    for (uint8_t x = x0; x <= x1; ++x) {
-        ssd1306_pixel(ssd, x, y, value);
-    }
+    ssd1306_fill_clipped(ssd, x0, x1, y, y, value);
 }
 
-// Desenha uma linha vertical
+// Desenha uma linha vertical (bytes inteiros nas páginas do meio)
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-    for (uint8_t y = y0; y <= y1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-    }
+    ssd1306_fill_clipped(ssd, x, x, y0, y1, value);
 }
\ No newline at end of file
@@ -4,25 +4,53 @@
 
 #include <stdint.h>
 #include <stdbool.h>
-#include "hardware/i2c.h"
+#include "hal.h"
+
+// Maior número de páginas do controlador (64 linhas)
+#define SSD1306_MAX_PAGES 8
 
 // Estrutura principal do display SSD1306
 typedef struct {
     uint8_t width, height, pages, address;
-    i2c_inst_t *i2c_port;
+    hal_i2c_t *i2c_port;
     uint16_t bufsize;
     uint8_t *ram_buffer;
     uint8_t port_buffer[2];
+    // Colunas alteradas em cada página desde o último envio (x0 > x1: página limpa)
+    uint8_t dirty_x0[SSD1306_MAX_PAGES];
+    uint8_t dirty_x1[SSD1306_MAX_PAGES];
+    // Buffer duplo: o envio assíncrono lê front_buffer enquanto se desenha em ram_buffer
+    uint8_t *front_buffer;
+    uint8_t window_cmd[7];          // prefixo de comando + 0x21 c0 c1 + 0x22 p0 p1
+    const uint8_t *pending_data;    // dados a enviar depois da janela
+    uint16_t pending_len;
+    volatile bool busy;
+    // Sem DMA livre para os dados na interrupção: o envio termina na próxima
+    // consulta (ssd1306_busy(), ssd1306_flush_async()), fora da interrupção
+    volatile bool deferred;
 } ssd1306_t;
 
 // Inicialização e configuração
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height,
-                  bool external_vcc, uint8_t address, i2c_inst_t *i2c);
+                  bool external_vcc, uint8_t address, hal_i2c_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 
 // Comunicação I2C
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
 void ssd1306_send_data(ssd1306_t *ssd);
+// Envia apenas as regiões alteradas desde o último envio
+void ssd1306_send_dirty(ssd1306_t *ssd);
+
+// Aloca o segundo buffer usado por ssd1306_flush_async(); false se faltar memória
+bool ssd1306_enable_double_buffer(ssd1306_t *ssd);
+// Troca os buffers e envia as páginas alteradas por DMA, retornando em seguida.
+// O desenho pode continuar em ram_buffer durante o envio; se o anterior ainda
+// não terminou, espera por ele. Sem buffer duplo equivale a ssd1306_send_dirty()
+void ssd1306_flush_async(ssd1306_t *ssd);
+// true enquanto um envio assíncrono está em andamento. Também retoma por DMA um
+// envio adiado pela interrupção (sem DMA livre), que segue adiado se o DMA
+// ainda estiver ocupado
+bool ssd1306_busy(ssd1306_t *ssd);
 
 // Funções de desenho básicas
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
@@ -0,0 +1,100 @@
+// ssd1306_glyphs.h
+// Gerado por tools/gen_glyphs.c a partir de font.h: não edite à mão.
+// Regenere com: cmake --build <dir do build host> --target ssd1306_glyphs
+#ifndef SSD1306_GLYPHS_H
+#define SSD1306_GLYPHS_H
+
+#include <stdint.h>
+
+#define SSD1306_GLYPH_COUNT 72
+#define SSD1306_GLYPH_NONE  0xFF
+
+// Glifos 8x8 no formato da GDDRAM: um byte por coluna, bit 0 na linha de cima
+static const uint8_t ssd1306_glyph_columns[SSD1306_GLYPH_COUNT][8] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x3E, 0x41, 0x41, 0x49, 0x41, 0x41, 0x3E, 0x00 }, // 0
+    { 0x00, 0x00, 0x42, 0x7F, 0x40, 0x00, 0x00, 0x00 }, // 1
+    { 0x30, 0x49, 0x49, 0x49, 0x49, 0x46, 0x00, 0x00 }, // 2
+    { 0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x36, 0x00 }, // 3
+    { 0x3F, 0x20, 0x20, 0x78, 0x20, 0x20, 0x00, 0x00 }, // 4
+    { 0x4F, 0x49, 0x49, 0x49, 0x49, 0x30, 0x00, 0x00 }, // 5
+    { 0x3F, 0x48, 0x48, 0x48, 0x48, 0x48, 0x30, 0x00 }, // 6
+    { 0x01, 0x01, 0x01, 0x61, 0x31, 0x0D, 0x03, 0x00 }, // 7
+    { 0x36, 0x49, 0x49, 0x49, 0x49, 0x49, 0x36, 0x00 }, // 8
+    { 0x06, 0x09, 0x09, 0x09, 0x09, 0x09, 0x7F, 0x00 }, // 9
+    { 0x78, 0x14, 0x12, 0x11, 0x12, 0x14, 0x78, 0x00 }, // A
+    { 0x7F, 0x49, 0x49, 0x49, 0x49, 0x49, 0x7F, 0x00 }, // B
+    { 0x7E, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x00 }, // C
+    { 0x7F, 0x41, 0x41, 0x41, 0x41, 0x41, 0x7E, 0x00 }, // D
+    { 0x7F, 0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x00 }, // E
+    { 0x7F, 0x09, 0x09, 0x09, 0x09, 0x01, 0x01, 0x00 }, // F
+    { 0x7F, 0x41, 0x41, 0x41, 0x51, 0x51, 0x73, 0x00 }, // G
+    { 0x7F, 0x08, 0x08, 0x08, 0x08, 0x08, 0x7F, 0x00 }, // H
+    { 0x00, 0x00, 0x00, 0x7F, 0x00, 0x00, 0x00, 0x00 }, // I
+    { 0x21, 0x41, 0x41, 0x3F, 0x01, 0x01, 0x01, 0x00 }, // J
+    { 0x00, 0x7F, 0x08, 0x08, 0x14, 0x22, 0x41, 0x00 }, // K
+    { 0x7F, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00 }, // L
+    { 0x7F, 0x02, 0x04, 0x08, 0x04, 0x02, 0x7F, 0x00 }, // M
+    { 0x7F, 0x02, 0x04, 0x08, 0x10, 0x20, 0x7F, 0x00 }, // N
+    { 0x3E, 0x41, 0x41, 0x41, 0x41, 0x41, 0x3E, 0x00 }, // O
+    { 0x7F, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00 }, // P
+    { 0x3E, 0x41, 0x41, 0x49, 0x51, 0x61, 0x7E, 0x00 }, // Q
+    { 0x7F, 0x11, 0x11, 0x11, 0x31, 0x51, 0x0E, 0x00 }, // R
+    { 0x46, 0x49, 0x49, 0x49, 0x49, 0x30, 0x00, 0x00 }, // S
+    { 0x01, 0x01, 0x01, 0x7F, 0x01, 0x01, 0x01, 0x00 }, // T
+    { 0x3F, 0x40, 0x40, 0x40, 0x40, 0x40, 0x3F, 0x00 }, // U
+    { 0x0F, 0x10, 0x20, 0x40, 0x20, 0x10, 0x0F, 0x00 }, // V
+    { 0x7F, 0x20, 0x10, 0x08, 0x10, 0x20, 0x7F, 0x00 }, // W
+    { 0x00, 0x41, 0x22, 0x14, 0x14, 0x22, 0x41, 0x00 }, // X
+    { 0x01, 0x02, 0x04, 0x78, 0x04, 0x02, 0x01, 0x00 }, // Y
+    { 0x41, 0x61, 0x59, 0x45, 0x43, 0x41, 0x00, 0x00 }, // Z
+    { 0x00, 0x20, 0x54, 0x54, 0x54, 0x34, 0x78, 0x00 }, // a
+    { 0x00, 0x7E, 0x50, 0x48, 0x48, 0x48, 0x30, 0x00 }, // b
+    { 0x00, 0x38, 0x44, 0x44, 0x44, 0x44, 0x28, 0x00 }, // c
+    { 0x00, 0x30, 0x48, 0x48, 0x48, 0x50, 0x7E, 0x00 }, // d
+    { 0x00, 0x38, 0x54, 0x54, 0x54, 0x54, 0x18, 0x00 }, // e
+    { 0x00, 0x00, 0x08, 0x7C, 0x0A, 0x0A, 0x00, 0x00 }, // f
+    { 0x00, 0x48, 0x94, 0x94, 0x94, 0xB4, 0x78, 0x00 }, // g
+    { 0x00, 0x7E, 0x10, 0x08, 0x08, 0x08, 0x70, 0x00 }, // h
+    { 0x00, 0x00, 0x00, 0x74, 0x00, 0x00, 0x00, 0x00 }, // i
+    { 0x00, 0x60, 0x40, 0x74, 0x00, 0x00, 0x00, 0x00 }, // j
+    { 0x00, 0x7E, 0x08, 0x1C, 0x32, 0x42, 0x00, 0x00 }, // k
+    { 0x00, 0x00, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00 }, // l
+    { 0x00, 0x00, 0x78, 0x04, 0x78, 0x04, 0x78, 0x00 }, // m
+    { 0x00, 0x00, 0x00, 0x04, 0x78, 0x04, 0x78, 0x00 }, // n
+    { 0x00, 0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00 }, // o
+    { 0x00, 0xFC, 0x24, 0x24, 0x24, 0x18, 0x00, 0x00 }, // p
+    { 0x00, 0x18, 0x24, 0x24, 0x24, 0xFC, 0x00, 0x00 }, // q
+    { 0x00, 0x78, 0x10, 0x08, 0x08, 0x08, 0x00, 0x00 }, // r
+    { 0x00, 0x48, 0x54, 0x54, 0x24, 0x00, 0x00, 0x00 }, // s
+    { 0x00, 0x00, 0x04, 0x7E, 0x44, 0x00, 0x00, 0x00 }, // t
+    { 0x00, 0x3C, 0x40, 0x40, 0x40, 0x20, 0x7C, 0x00 }, // u
+    { 0x00, 0x1C, 0x20, 0x40, 0x40, 0x20, 0x1C, 0x00 }, // v
+    { 0x00, 0x7C, 0x40, 0x30, 0x30, 0x40, 0x7C, 0x00 }, // w
+    { 0x00, 0x44, 0x28, 0x10, 0x10, 0x28, 0x44, 0x00 }, // x
+    { 0x00, 0x0C, 0x10, 0x60, 0x60, 0x10, 0x0C, 0x00 }, // y
+    { 0x00, 0x44, 0x64, 0x54, 0x4C, 0x44, 0x00, 0x00 }, // z
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00 }, // :
+    { 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00 }, // .
+    { 0x00, 0x00, 0x44, 0x28, 0x10, 0x44, 0x28, 0x10 }, // >
+    { 0x00, 0x00, 0x00, 0x00, 0x08, 0x08, 0x08, 0x08 }, // -
+    { 0x1C, 0x3E, 0x62, 0x02, 0x02, 0x62, 0x3E, 0x1C }, // Ohm
+    { 0x00, 0x00, 0x00, 0x5E, 0x5E, 0x00, 0x00, 0x00 }, // !
+    { 0xE6, 0x10, 0xCE, 0x00, 0x00, 0x00, 0x00, 0x00 }, // %
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40 }, // /
+};
+
+// Caractere → glifo (SSD1306_GLYPH_NONE: não suportado)
+static const uint8_t ssd1306_glyph_lookup[128] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x45, 0xFF, 0xFF, 0xFF, 0x46, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x43, 0x41, 0x47,
+    0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x40, 0xFF, 0xFF, 0xFF, 0x42, 0xFF,
+    0xFF, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
+    0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0xFF, 0xFF, 0xFF, 0xFF, 0x44,
+};
+
+#endif // SSD1306_GLYPHS_H
@@ -0,0 +1,180 @@
+// lora_codecbench.c - Tamanho, ciclos e tempo no ar do codec de telemetria
+//
+// Um transmissor e um receptor de lora_codec trocam uma série de telemetria
+// (contador, tempo, temperatura, tensão, RSSI e pressão, com variações
+// sorteadas) com quadros e ACKs perdidos. Para cada perfil saem os bytes por
+// quadro do texto (como o "Ola #n" de lora_tx.c, com os campos), do binário
+// cru (4 bytes por campo) e do codec, a razão de compressão, a divisão em
+// quadros completos, deltas e LZ, e o tempo no ar médio de cada formato com o
+// cabeçalho de lora_link em SF7 e SF12, com a economia do codec.
+//
+// Nas linhas com '#' saem os ciclos por quadro de lora_codec_encode() e
+// lora_codec_decode() (hal_cycles(); no host são nanossegundos reais, variam
+// entre execuções e máquinas). O resto depende só do código e da semente fixa.
+//
+// Uso: lora_codecbench [quadros]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lora_codec.h"
+#include "lora_link.h"
+
+#define FIELDS 6
+#define DEFAULT_FRAMES 2000
+// Medidas de ciclos por perfil (vale a menor)
+#define ROUNDS 5
+
+typedef struct {
+    const char* name;
+    uint8_t frame_loss;        // % de quadros perdidos
+    uint8_t ack_loss;          // % de ACKs perdidos
+    int32_t temperature_step;  // variação máxima por quadro (centésimos de grau)
+    int32_t pressure_step;     // Pa
+    bool use_lz;
+} profile_t;
+
+static const profile_t profiles[] = {
+    { "estavel",        0,  0,   3,  10, true },
+    { "estavel-perdas", 10, 10,  3,  10, true },
+    { "ruidoso",        10, 10, 80, 400, true },
+};
+
+static const lora_modem_config_t modems[] = { LORA_MODEM_SF7_BW125, LORA_MODEM_SF12_BW125 };
+static const char* const modem_names[] = { "SF7", "SF12" };
+
+enum { FORMAT_TEXT, FORMAT_BINARY, FORMAT_CODEC, FORMAT_COUNT };
+static const char* const format_names[FORMAT_COUNT] = { "texto", "binario", "codec" };
+
+typedef struct {
+    uint64_t bytes[FORMAT_COUNT];
+    uint64_t airtime_us[FORMAT_COUNT][2];
+    uint32_t decoded;
+    uint32_t no_reference;
+    uint32_t encode_cycles;    // soma de uma rodada
+    uint32_t decode_cycles;
+} result_t;
+
+static uint32_t random_state;
+
+static uint32_t next_random(void) {
+    uint32_t x = random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    random_state = x;
+    return x;
+}
+
+static int32_t random_step(int32_t max) {
+    return (int32_t)(next_random() % (uint32_t)(2 * max + 1)) - max;
+}
+
+static bool chance(uint8_t percent) {
+    return next_random() % 100 < percent;
+}
+
+static void account(result_t* r, int format, uint8_t payload_length) {
+    uint8_t length = LORA_LINK_HEADER_SIZE + payload_length;
+    r->bytes[format] += payload_length;
+    for (int m = 0; m < 2; m++) {
+        r->airtime_us[format][m] += lora_time_on_air_config_us(&modems[m], length);
+    }
+}
+
+/* Uma rodada completa do perfil; com verify, confere cada quadro decodificado */
+static void run(const profile_t* p, uint32_t frames, result_t* r, bool verify) {
+    lora_codec_stream_t tx;
+    lora_codec_stream_t rx;
+    lora_codec_stream_init(&tx, FIELDS, p->use_lz);
+    lora_codec_stream_init(&rx, FIELDS, p->use_lz);
+    memset(r, 0, sizeof(*r));
+    random_state = 0x2545F491;
+
+    int32_t values[FIELDS] = { 0, 0, 2345, 3300, -90, 101325 };
+    for (uint32_t f = 0; f < frames; f++) {
+        values[0] = (int32_t)f;
+        values[1] = (int32_t)(f * 5000);
+        values[2] += random_step(p->temperature_step);
+        values[3] -= next_random() % 3 == 0;
+        values[4] = -90 + random_step(3);
+        values[5] += random_step(p->pressure_step);
+
+        char text[LORA_LINK_MAX_PAYLOAD];
+        int text_length = snprintf(text, sizeof(text), "Ola #%ld t=%ld T=%ld V=%ld RSSI=%ld P=%ld",
+                                   (long)values[0], (long)values[1], (long)values[2], (long)values[3],
+                                   (long)values[4], (long)values[5]);
+        account(r, FORMAT_TEXT, (uint8_t)text_length);
+        account(r, FORMAT_BINARY, 4 * FIELDS);
+
+        uint8_t frame[LORA_LINK_MAX_PAYLOAD];
+        uint8_t id;
+        uint32_t start = hal_cycles();
+        uint8_t length = lora_codec_encode(&tx, values, frame, sizeof(frame), &id);
+        r->encode_cycles += hal_cycles_since(start);
+        if (length == 0) {
+            fprintf(stderr, "%s: quadro %u não coube\n", p->name, f);
+            exit(1);
+        }
+        account(r, FORMAT_CODEC, length);
+
+        if (chance(p->frame_loss)) continue;
+        int32_t decoded[FIELDS];
+        start = hal_cycles();
+        lora_codec_result_t result = lora_codec_decode(&rx, frame, length, decoded);
+        r->decode_cycles += hal_cycles_since(start);
+        if (result == LORA_CODEC_NO_REFERENCE) {
+            r->no_reference++;
+            continue;
+        }
+        if (verify && (result != LORA_CODEC_OK || memcmp(decoded, values, sizeof(values)) != 0)) {
+            fprintf(stderr, "%s: quadro %u decodificado errado\n", p->name, f);
+            exit(1);
+        }
+        r->decoded++;
+        if (!chance(p->ack_loss)) {
+            lora_codec_ack(&tx, id);
+        }
+    }
+    if (verify) {
+        const lora_codec_counters_t* c = lora_codec_counters(&tx);
+        printf("%-15s %u quadros: %u completos, %u deltas, %u com LZ; recebidos %u, sem referência %u\n",
+               p->name, c->frames, c->keyframes, c->delta_frames, c->lz_frames, r->decoded, r->no_reference);
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t frames = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : DEFAULT_FRAMES;
+    if (frames == 0) frames = DEFAULT_FRAMES;
+
+    printf("Telemetria de %d campos, cabeçalho de enlace de %d bytes\n", FIELDS, LORA_LINK_HEADER_SIZE);
+    for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++) {
+        const profile_t* p = &profiles[i];
+        result_t r;
+        run(p, frames, &r, true);
+
+        for (int format = 0; format < FORMAT_COUNT; format++) {
+            printf("    %-8s %6.2f B/quadro  %5.2fx", format_names[format], (double)r.bytes[format] / frames,
+                   (double)r.bytes[FORMAT_BINARY] / r.bytes[format]);
+            for (int m = 0; m < 2; m++) {
+                printf("  %s %8.0f us", modem_names[m], (double)r.airtime_us[format][m] / frames);
+            }
+            printf("\n");
+        }
+        for (int m = 0; m < 2; m++) {
+            printf("    economia no ar em %-4s %5.1f%% contra o binário, %5.1f%% contra o texto\n", modem_names[m],
+                   100.0 * (1.0 - (double)r.airtime_us[FORMAT_CODEC][m] / r.airtime_us[FORMAT_BINARY][m]),
+                   100.0 * (1.0 - (double)r.airtime_us[FORMAT_CODEC][m] / r.airtime_us[FORMAT_TEXT][m]));
+        }
+
+        uint32_t encode = 0;
+        uint32_t decode = 0;
+        for (int round = 0; round < ROUNDS; round++) {
+            run(p, frames, &r, false);
+            if (round == 0 || r.encode_cycles < encode) encode = r.encode_cycles;
+            if (round == 0 || r.decode_cycles < decode) decode = r.decode_cycles;
+        }
+        printf("#   encode %6.0f ciclos/quadro   decode %6.0f ciclos/quadro\n", (double)encode / frames,
+               (double)decode / (r.decoded + r.no_reference));
+    }
+    return 0;
+}
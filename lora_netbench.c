@@ -0,0 +1,300 @@
+// lora_netbench.c - Benchmark de vazão de uma rede LoRa simulada no host
+//
+// Cada cenário põe N nós transmissores e um gateway (um rádio por SF em uso)
+// numa lora_netsim_t e roda o driver real de cada rádio pelo relógio virtual.
+// Os nós enviam quadros de tamanho fixo com intervalos exponenciais (tráfego
+// de Poisson, ALOHA puro como no LoRaWAN classe A) e o SF de cada um é o
+// menor que fecha o enlace com LINK_MARGIN_DB, como o ADR escolheria.
+//
+// Uso: lora_netbench [--seed N] [--duration S] [cenário ...]
+// Sem cenários, roda todos. Tudo que não começa com '#' depende só da semente
+// e do código: a saída de dois commits pode ser comparada com diff. As linhas
+// '#' trazem o custo de processamento por pacote como tempo de CPU do processo
+// no host (ns, não ciclos do RP2040), que varia a cada execução.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "rfm95_lora.h"
+#include "lora_adr.h"
+#include "sim/lora_netsim.h"
+
+// Gateway na origem e nós com 14 dBm e 3 dB de folga sobre o SNR mínimo
+#define TX_POWER_DBM     14
+#define LINK_MARGIN_DB   3.0f
+
+// Tempo extra para esvaziar as filas depois do fim do tráfego
+#define DRAIN_US         30000000ull
+
+// Cabeçalho do quadro: nó, sequência e instante do enfileiramento (us, 64 bits),
+// então a latência vale com qualquer número de quadros na fila do nó
+#define FRAME_HEADER     12
+
+// Latências guardadas para os percentis
+#define MAX_SAMPLES      (1u << 20)
+
+typedef struct {
+    const char* name;
+    uint16_t nodes;
+    float radius_m;            // nós uniformes num disco em torno do gateway
+    uint8_t min_sf;
+    uint8_t max_sf;
+    uint32_t interval_s;       // intervalo médio entre envios de cada nó
+    uint8_t payload;           // bytes por quadro (mínimo FRAME_HEADER)
+} scenario_t;
+
+// Carga oferecida cresce com os nós; sf7-* tem um só SF num raio pequeno e
+// mix-* distribui SF7 a SF12 até o limite de alcance do SF12
+static const scenario_t scenarios[] = {
+    { "sf7-10",   10,   100.0f, 7, 7,  60, 20 },
+    { "sf7-100",  100,  100.0f, 7, 7,  60, 20 },
+    { "sf7-1000", 1000, 100.0f, 7, 7,  60, 20 },
+    { "mix-10",   10,   500.0f, 7, 12, 60, 20 },
+    { "mix-100",  100,  500.0f, 7, 12, 60, 20 },
+    { "mix-1000", 1000, 500.0f, 7, 12, 60, 20 },
+};
+#define SCENARIO_COUNT (sizeof(scenarios) / sizeof(scenarios[0]))
+
+typedef struct {
+    rfm95_t* radio;
+    uint8_t sf;
+    uint64_t next_us;
+    uint16_t seq;
+} node_t;
+
+static lora_netsim_t net;
+static node_t nodes[LORA_NETSIM_MAX_NODES];
+static rfm95_t* gateway[13];               // índice = SF
+static uint32_t latencies[MAX_SAMPLES];
+
+// Acorda o laço principal no próximo envio (o tráfego roda fora do "hardware")
+static hal_host_device_t traffic;
+
+static void traffic_advance(void* ctx, uint64_t now_us) {
+    (void)ctx;
+    (void)now_us;
+    hal_host_schedule(&traffic, HAL_HOST_NO_EVENT);     // o laço reagenda
+}
+
+static uint64_t exponential_us(uint32_t mean_s) {
+    float u = lora_netsim_uniform(&net);
+    return (uint64_t)(-logf(1.0f - u) * mean_s * 1e6f) + 1;
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_ms(uint32_t count, double p) {
+    if (count == 0) return 0.0;
+    uint32_t index = (uint32_t)ceil(p * count) - 1;
+    return latencies[index > count - 1 ? count - 1 : index] / 1000.0;
+}
+
+static bool set_sf(rfm95_t* radio, uint8_t sf) {
+    lora_modem_config_t config = LORA_MODEM_SF7_BW125;
+    config.spreading_factor = sf;
+    return rfm95_set_modem_config(radio, &config);
+}
+
+static uint64_t cpu_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int run(const scenario_t* sc, uint32_t seed, uint32_t duration_s) {
+    lora_netsim_init(&net, NULL, seed);
+    lora_config_t gateway_config = LORA_CONFIG_DEFAULT;
+    lora_config_t node_config = LORA_CONFIG_DEFAULT;
+    node_config.fifo_dma = false;                        // cada nó seria um MCU com SPI próprio
+
+    // Gateway: um rádio por SF, co-localizados e no barramento spi0
+    memset(gateway, 0, sizeof(gateway));
+    for (uint8_t sf = sc->min_sf; sf <= sc->max_sf; sf++) {
+        gateway[sf] = lora_netsim_add(&net, spi0, 0.0f, 0.0f, &gateway_config);
+        if (!gateway[sf] || !set_sf(gateway[sf], sf)) {
+            fprintf(stderr, "%s: rádio %u do gateway falhou\n", sc->name, sf);
+            return 1;
+        }
+        rfm95_receive_irq_start(gateway[sf], NULL);
+    }
+    uint16_t first = net.count;
+    uint16_t gateway_index = 0;
+
+    // Nós no spi1, posições e SF sorteados pela semente
+    uint32_t per_sf[13] = { 0 };
+    for (uint16_t i = 0; i < sc->nodes; i++) {
+        float r = sc->radius_m * sqrtf(lora_netsim_uniform(&net));
+        float a = 6.2831853f * lora_netsim_uniform(&net);
+        node_t* node = &nodes[i];
+        memset(node, 0, sizeof(*node));
+        node->radio = lora_netsim_add(&net, spi1, r * cosf(a), r * sinf(a), &node_config);
+        if (!node->radio) {
+            fprintf(stderr, "%s: nó %u falhou (LORA_MAX_RADIOS = %u)\n", sc->name, i, LORA_MAX_RADIOS);
+            return 1;
+        }
+        float snr = TX_POWER_DBM - lora_netsim_path_loss_db(&net, first + i, gateway_index) -
+                    lora_netsim_noise_floor_dbm(&net, 125000);
+        node->sf = sc->max_sf;
+        for (uint8_t sf = sc->min_sf; sf < sc->max_sf; sf++) {
+            if (snr >= lora_adr_required_snr(sf) + LINK_MARGIN_DB) {
+                node->sf = sf;
+                break;
+            }
+        }
+        per_sf[node->sf]++;
+        rfm95_set_power(node->radio, TX_POWER_DBM);
+        if (!set_sf(node->radio, node->sf)) return 1;
+    }
+
+    memset(&traffic, 0, sizeof(traffic));
+    traffic.advance = traffic_advance;
+    hal_host_attach(&traffic);
+
+    uint64_t start_us = hal_time_us();
+    uint64_t end_us = start_us + (uint64_t)duration_s * 1000000ull;
+    for (uint16_t i = 0; i < sc->nodes; i++) {
+        nodes[i].next_us = start_us + exponential_us(sc->interval_s);
+    }
+    hal_host_stats_reset();
+
+    uint32_t offered = 0, rejected = 0, delivered = 0, samples = 0;
+    uint64_t cpu_start = cpu_ns();
+    for (;;) {
+        uint64_t now = hal_time_us();
+        uint64_t next = HAL_HOST_NO_EVENT;
+        for (uint16_t i = 0; i < sc->nodes && now < end_us; i++) {
+            node_t* node = &nodes[i];
+            while (node->next_us <= now) {
+                uint8_t frame[LORA_MAX_PACKET_SIZE] = { 0 };
+                frame[0] = (uint8_t)i;
+                frame[1] = (uint8_t)(i >> 8);
+                frame[2] = (uint8_t)node->seq;
+                frame[3] = (uint8_t)(node->seq >> 8);
+                memcpy(frame + 4, &now, sizeof(now));
+                node->seq++;
+                offered++;
+                if (!rfm95_tx_enqueue(node->radio, frame, sc->payload, LORA_PRIO_NORMAL)) rejected++;
+                node->next_us += exponential_us(sc->interval_s);
+            }
+            if (node->next_us < next) next = node->next_us;
+        }
+        if (now >= end_us) next = end_us + DRAIN_US;
+        hal_host_schedule(&traffic, next);
+
+        for (uint8_t sf = sc->min_sf; sf <= sc->max_sf; sf++) {
+            lora_packet_t* packet;
+            while ((packet = rfm95_receive_irq_lease(gateway[sf]))) {
+                uint16_t id = packet->data[0] | (packet->data[1] << 8);
+                uint64_t sent_us;
+                memcpy(&sent_us, packet->data + 4, sizeof(sent_us));
+                if (packet->length == sc->payload && id < sc->nodes) {
+                    delivered++;
+                    if (samples < MAX_SAMPLES) {
+                        latencies[samples++] = (uint32_t)(packet->timestamp_us - sent_us);
+                    }
+                }
+                rfm95_receive_irq_release(gateway[sf], packet);
+            }
+        }
+
+        if (now >= end_us) {
+            bool idle = true;
+            for (uint16_t i = 0; i < sc->nodes && idle; i++) {
+                idle = !rfm95_tx_busy(nodes[i].radio);
+            }
+            if (idle || now >= end_us + DRAIN_US) break;
+        }
+        lora_wait_for_event();
+    }
+    uint64_t cpu_used = cpu_ns() - cpu_start;
+
+    const lora_netsim_counters_t* counters = lora_netsim_counters(&net);
+    const hal_host_stats_t* bus = hal_host_stats();
+    qsort(latencies, samples, sizeof(latencies[0]), compare_u32);
+    uint32_t packets = counters->transmissions + counters->receptions;
+
+    printf("%-9s %5u  SF%u-%u [", sc->name, sc->nodes, sc->min_sf, sc->max_sf);
+    for (uint8_t sf = sc->min_sf; sf <= sc->max_sf; sf++) {
+        printf("%s%u", sf == sc->min_sf ? "" : " ", per_sf[sf]);
+    }
+    printf("]\n");
+    printf("  quadros: %u oferecidos, %u recusados pela fila, %u no ar, %u entregues  PDR %.2f%%\n",
+           offered, rejected, counters->transmissions, delivered,
+           offered ? 100.0 * delivered / offered : 0.0);
+    printf("  vazão útil: %.1f bit/s  latência (ms): p50 %.1f  p90 %.1f  p99 %.1f  máx %.1f\n",
+           (double)delivered * sc->payload * 8 / duration_s, percentile_ms(samples, 0.50),
+           percentile_ms(samples, 0.90), percentile_ms(samples, 0.99), percentile_ms(samples, 1.0));
+    printf("  canal: %u colisões, %u capturas, %u com receptor ocupado, %u abaixo da sensibilidade\n",
+           counters->collisions, counters->captures, counters->busy, counters->below_sensitivity);
+    printf("  driver: %.1f transações SPI e %.1f bytes por pacote (TX + RX)\n",
+           packets ? (double)bus->spi_transactions / packets : 0.0,
+           packets ? (double)bus->spi_bytes / packets : 0.0);
+    printf("# %s: CPU do host %.0f ns por pacote (%.2f s no total)\n", sc->name,
+           packets ? (double)cpu_used / packets : 0.0, cpu_used / 1e9);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    uint32_t seed = 1;
+    uint32_t duration_s = 600;
+    const char* selected[SCENARIO_COUNT + 1];
+    size_t selected_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--duration") && i + 1 < argc) {
+            duration_s = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (argv[i][0] != '-' && selected_count < SCENARIO_COUNT) {
+            selected[selected_count++] = argv[i];
+        } else {
+            fprintf(stderr, "uso: %s [--seed N] [--duration S] [cenário ...]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (duration_s == 0) duration_s = 1;
+    for (size_t k = 0; k < selected_count; k++) {
+        bool known = false;
+        for (size_t s = 0; s < SCENARIO_COUNT; s++) {
+            if (!strcmp(selected[k], scenarios[s].name)) known = true;
+        }
+        if (!known) {
+            fprintf(stderr, "cenário desconhecido: %s\n", selected[k]);
+            return 2;
+        }
+    }
+
+    lora_netsim_channel_t channel = LORA_NETSIM_CHANNEL_DEFAULT;
+    printf("semente %u, %u s de tráfego, perda %.2f dB em %.0f m, expoente %.2f, sombreamento %.2f dB, "
+           "captura %.0f dB\n", seed, duration_s, channel.path_loss_d0_db, channel.d0_m,
+           channel.path_loss_exponent, channel.shadowing_db, channel.capture_db);
+
+    // Cada cenário num processo novo: o driver e a HAL simulada partem do zero
+    int status = 0;
+    for (size_t s = 0; s < SCENARIO_COUNT; s++) {
+        bool wanted = selected_count == 0;
+        for (size_t k = 0; k < selected_count; k++) {
+            if (!strcmp(selected[k], scenarios[s].name)) wanted = true;
+        }
+        if (!wanted) continue;
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+            int result = run(&scenarios[s], seed, duration_s);
+            fflush(stdout);
+            _exit(result);
+        }
+        int child = 1;
+        if (pid < 0 || waitpid(pid, &child, 0) < 0 || !WIFEXITED(child) || WEXITSTATUS(child) != 0) {
+            status = 1;
+        }
+    }
+    return status;
+}
@@ -5,6 +5,8 @@
 #include "ssd1306.h"
 #include "font.h"
 #include "rfm95_lora.h"
+#include "lora_link.h"
+#include "lora_adr.h"
 
 // Definições do display
 #define I2C_PORT_DISP i2c1
@@ -15,6 +17,12 @@
 #define DISP_H 64
 ssd1306_t ssd;
 
+// Endereços de enlace e tipo do payload (contador de 16 bits, little-endian)
+#define LINK_ADDR_RX 0x02
+#define LINK_TYPE_COUNTER 0x1
+lora_link_t link;
+lora_adr_t adr;
+
 void setup_display() {
     i2c_init(I2C_PORT_DISP, 400 * 1000);
     gpio_set_function(I2C_SDA_DISP, GPIO_FUNC_I2C);
@@ -25,6 +33,7 @@ void setup_display() {
     // Chamada correta com 6 argumentos
     ssd1306_init(&ssd, DISP_W, DISP_H, false, ENDERECO_DISP, I2C_PORT_DISP);
     ssd1306_config(&ssd); // Adicionado para configurar os registradores do display
+    ssd1306_enable_double_buffer(&ssd); // Envio por DMA não bloqueia o laço de RX
 
     // Usando as funções corretas da sua biblioteca
     ssd1306_fill(&ssd, false); // Equivalente a clear()
@@ -50,35 +59,70 @@ int main() {
     printf("Comunicacao com RFM95 OK! ✅\n");
     printf("Aguardando pacotes...\n");
 
-    uint8_t buffer[256];
+    // Rádio no núcleo 1: printf na USB e o display não atrasam o atendimento do DIO0
+    if (lora_multicore_start()) {
+        printf("Driver do radio no nucleo 1\n");
+    }
+
+    lora_link_init(&link, LINK_ADDR_RX);
+    lora_adr_config_t adr_config = LORA_ADR_CONFIG_DEFAULT;
+    lora_adr_init(&adr, rfm95_radio(0), &link, &adr_config);
+
+    // Pacotes vão direto da FIFO para o pool do driver, na interrupção de DIO0
+    lora_receive_irq_start(NULL);
 
     while (1) {
-        int packet_size = lora_receive_packet(buffer, sizeof(buffer));
-        
-        if (packet_size > 0) {
-            buffer[packet_size] = '\0'; 
-            
-            int rssi = lora_packet_rssi();
-            float snr = lora_packet_snr();
-
-            printf("--------------------------------\n");
-            printf("Pacote Recebido!\n");
-            printf("  Mensagem: '%s'\n", buffer);
-            printf("  Bytes: %d\n", packet_size);
-            printf("  RSSI: %d dBm\n", rssi);
-            printf("  SNR: %.2f dB\n", snr);
-            printf("--------------------------------\n");
-
-            char display_line[32];
-            ssd1306_fill(&ssd, false);
-            ssd1306_draw_string(&ssd, (char*)buffer, 5, 10, false);
-            
-            snprintf(display_line, sizeof(display_line), "RSSI:%d SNR:%.1f", rssi, snr);
-            ssd1306_draw_string(&ssd, display_line, 5, 30, false);
-            ssd1306_send_data(&ssd);
+        lora_adr_service(&adr);
+        lora_packet_t* packet = lora_receive_irq_lease();
+        if (packet == NULL) {
+            ssd1306_busy(&ssd);      // conclui um envio do display adiado pela interrupção
+            tight_loop_contents();   // nenhuma transação SPI enquanto não há pacote
+            continue;
+        }
+
+        // Cabeçalho e payload lidos direto do slot emprestado, sem cópia
+        lora_link_header_t header;
+        const uint8_t* payload;
+        uint8_t payload_length;
+        lora_link_rx_result_t result = lora_link_receive(&link, packet->data, packet->length,
+                                                         &header, &payload, &payload_length);
+        // Todo quadro novo alimenta o ADR (o SNR decide o SF e a potência do transmissor)
+        bool control = result == LORA_LINK_RX_NEW &&
+                       lora_adr_receive(&adr, &header, payload, payload_length, packet->snr);
+        if (result != LORA_LINK_RX_NEW || control || header.type != LINK_TYPE_COUNTER || payload_length < 2) {
+            lora_receive_irq_release(packet);    // duplicata, outro destino ou formato desconhecido
+            continue;
         }
-        
-        sleep_ms(10);
+        unsigned counter = payload[0] | (payload[1] << 8);
+        const lora_link_source_t* source = lora_link_source(&link, header.src);
+
+        printf("--------------------------------\n");
+        printf("Pacote Recebido!\n");
+        printf("  Origem: 0x%02X  Seq: %u  Contador: %u\n", header.src, header.seq, counter);
+        printf("  Bytes: %d\n", packet->length);
+        printf("  RSSI: %d dBm\n", packet->rssi);
+        printf("  SNR: %.2f dB\n", packet->snr);
+        const lora_adr_node_state_t* adr_state = lora_adr_node_state(&adr, header.src);
+        printf("  ADR: SF%u %u dBm, margem %.1f dB\n", adr_state->sf, adr_state->power, adr_state->margin_db);
+        printf("  Perdidos: %u  Duplicados: %u  Fora de ordem: %u\n",
+               source->lost, source->duplicates, source->reordered);
+        printf("  Latencia RxDone->app: %u us (max %u us)\n",
+               lora_multicore_counters()->rx_handoff_last_us,
+               lora_multicore_counters()->rx_handoff_max_us);
+        printf("--------------------------------\n");
+
+        char display_line[32];
+        ssd1306_fill(&ssd, false);
+        snprintf(display_line, sizeof(display_line), "Ola #%u", counter);
+        ssd1306_draw_string(&ssd, display_line, 5, 10, false);
+
+        snprintf(display_line, sizeof(display_line), "RSSI:%d SNR:%.1f", packet->rssi, packet->snr);
+        ssd1306_draw_string(&ssd, display_line, 5, 30, false);
+
+        snprintf(display_line, sizeof(display_line), "Perdidos:%u", (unsigned)source->lost);
+        ssd1306_draw_string(&ssd, display_line, 5, 50, false);
+        lora_receive_irq_release(packet);
+        ssd1306_flush_async(&ssd);     // só as páginas que mudaram, por DMA
     }
 
     return 0;
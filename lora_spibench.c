@@ -0,0 +1,110 @@
+// lora_spibench.c - Custo SPI da FIFO do RFM95: DMA x cópia bloqueante
+//
+// Envia e recebe (por interrupção) pacotes de vários tamanhos no SX1276
+// simulado com cada clock SPI e cada caminho da FIFO, e mede pelo barramento
+// simulado (hal_host_stats) o tempo de barramento e o tempo em que a CPU fica
+// presa em transferências bloqueantes, por pacote, incluindo os acessos aos
+// registradores. As vazões são payload / tempo: no barramento elas sobem com o
+// clock e, na CPU, o caminho por DMA deixa a FIFO em segundo plano e só os
+// registradores prendem a CPU.
+//
+// Uso: lora_spibench
+// Tudo depende só do código (relógio virtual): a saída de dois commits pode
+// ser comparada com diff.
+#include <stdio.h>
+#include <string.h>
+#include "rfm95_lora.h"
+#include "sim/sx1276_sim.h"
+
+// Pacotes de cada medida
+#define PACKETS 32
+
+static const uint32_t baudrates[] = { 1000000, 4000000, 10000000 };
+static const uint8_t payloads[] = { 16, 64, 255 };
+
+static sx1276_sim_t sim;
+
+typedef struct {
+    uint64_t bus_ns;          // barramento ocupado (CPU ou DMA)
+    uint64_t cpu_ns;          // CPU presa em transferências bloqueantes
+    uint32_t bytes;           // bytes no barramento
+} measure_t;
+
+static void measure_take(measure_t* m) {
+    const hal_host_stats_t* stats = hal_host_stats();
+    m->bus_ns = stats->spi_blocking_ns + stats->spi_dma_ns;
+    m->cpu_ns = stats->spi_blocking_ns;
+    m->bytes = stats->spi_bytes;
+}
+
+static bool setup(uint32_t baudrate, bool fifo_dma) {
+    hal_host_reset();
+    sx1276_sim_init(&sim, SPI_PORT, PIN_CS, PIN_RST, PIN_DIO0, PIN_DIO1);
+    lora_config_t config = { baudrate, fifo_dma, LORA_TXQ_DROP_OLDEST };
+    if (!lora_init_config(&config)) return false;
+    lora_receive_irq_start(NULL);
+    return true;
+}
+
+/* PACKETS envios assíncronos do payload, cada um até o TxDone */
+static void run_tx(uint8_t payload, measure_t* m) {
+    uint8_t frame[LORA_MAX_PACKET_SIZE];
+    memset(frame, 0x5A, sizeof(frame));
+    hal_host_stats_reset();
+    for (int i = 0; i < PACKETS; i++) {
+        while (!lora_send_packet_async(frame, payload)) {
+            hal_yield();
+        }
+        while (lora_tx_busy()) {
+            hal_yield();
+        }
+    }
+    measure_take(m);
+}
+
+/* PACKETS recepções pelo pool, do RxDone até o slot devolvido */
+static void run_rx(uint8_t payload, measure_t* m) {
+    uint8_t frame[LORA_MAX_PACKET_SIZE];
+    memset(frame, 0xA5, sizeof(frame));
+    uint64_t airtime_us = sx1276_sim_airtime_us(&sim, payload);
+    hal_host_stats_reset();
+    for (int i = 0; i < PACKETS; i++) {
+        sx1276_sim_deliver(&sim, frame, payload, airtime_us, -60, 9.0f, true);
+        lora_packet_t* packet;
+        while (!(packet = lora_receive_irq_lease())) {
+            hal_yield();
+        }
+        lora_receive_irq_release(packet);
+    }
+    measure_take(m);
+}
+
+static void report(const char* dir, uint32_t baudrate, bool dma, uint8_t payload, const measure_t* m) {
+    double cpu_us = m->cpu_ns / 1000.0 / PACKETS;
+    double bus_us = m->bus_ns / 1000.0 / PACKETS;
+    double bus_rate = m->bus_ns ? (double)payload * PACKETS * 1e9 / m->bus_ns : 0.0;
+    double cpu_rate = m->cpu_ns ? (double)payload * PACKETS * 1e9 / m->cpu_ns : 0.0;
+    printf("%-3s %5.1f MHz %-4s %4u B | %4u B SPI | %6.1f us %8.0f B/s barramento | %6.1f us %9.0f B/s CPU\n",
+           dir, baudrate / 1e6, dma ? "dma" : "cpu", payload, m->bytes / PACKETS,
+           bus_us, bus_rate, cpu_us, cpu_rate);
+}
+
+int main(void) {
+    printf("Por pacote (%u pacotes por medida), FIFO e registradores\n", PACKETS);
+    for (size_t b = 0; b < sizeof(baudrates) / sizeof(baudrates[0]); b++) {
+        for (int dma = 0; dma < 2; dma++) {
+            if (!setup(baudrates[b], dma)) {
+                fprintf(stderr, "rádio simulado não respondeu\n");
+                return 1;
+            }
+            for (size_t p = 0; p < sizeof(payloads); p++) {
+                measure_t tx, rx;
+                run_tx(payloads[p], &tx);
+                run_rx(payloads[p], &rx);
+                report("tx", lora_spi_baudrate(), dma, payloads[p], &tx);
+                report("rx", lora_spi_baudrate(), dma, payloads[p], &rx);
+            }
+        }
+    }
+    return 0;
+}
@@ -5,6 +5,9 @@
 #include "ssd1306.h"
 #include "font.h"
 #include "rfm95_lora.h"
+#include "lora_link.h"
+#include "lora_adr.h"
+#include "lora_dutycycle.h"
 
 // Definições do display
 #define I2C_PORT_DISP i2c1
@@ -15,6 +18,25 @@
 #define DISP_H 64
 ssd1306_t ssd;
 
+// Endereços de enlace e tipo do payload (contador de 16 bits, little-endian)
+#define LINK_ADDR_TX 0x01
+#define LINK_ADDR_RX 0x02
+#define LINK_TYPE_COUNTER 0x1
+lora_link_t link;
+lora_adr_node_t adr;
+
+// Duty-cycle de 1% por hora no canal base: com SF alto os quadros esperam
+// orçamento em vez de estourar o limite
+lora_dc_t dc;
+
+// Fim da espera entre envios, sinalizado por um alarme (acorda o MCU)
+static volatile bool send_due;
+
+static void send_timer_fired(void* ctx) {
+    (void)ctx;
+    send_due = true;
+}
+
 void setup_display() {
     i2c_init(I2C_PORT_DISP, 400 * 1000);
     gpio_set_function(I2C_SDA_DISP, GPIO_FUNC_I2C);
@@ -48,25 +70,73 @@ int main() {
     }
     printf("Comunicacao com RFM95 OK! ✅\n");
 
-    lora_set_power(17);
+    // SF e potência vêm do ADR do receptor; parte de 17 dBm e escuta os
+    // comandos entre um envio e outro
+    lora_link_init(&link, LINK_ADDR_TX);
+    lora_adr_config_t adr_config = LORA_ADR_CONFIG_DEFAULT;
+    lora_adr_node_init(&adr, rfm95_radio(0), &link, LINK_ADDR_RX, &adr_config);
+    lora_dc_limits_t dc_limits = LORA_DC_LIMITS_1_PERCENT;
+    lora_dc_init(&dc, rfm95_radio(0), &dc_limits, 1);
+    lora_receive_irq_start(NULL);
 
-    int counter = 0;
+    uint16_t counter = 0;
+    uint8_t frame[LORA_LINK_HEADER_SIZE + 2];
     char message_buffer[50];
 
     while (1) {
-        snprintf(message_buffer, sizeof(message_buffer), "Ola #%d", counter);
-        
-        lora_send_packet((uint8_t*)message_buffer, strlen(message_buffer));
-        
-        printf("Pacote enviado: '%s'\n", message_buffer);
-        
+        // O payload é montado no próprio quadro; o cabeçalho é escrito na frente
+        uint8_t* payload = lora_link_payload(frame);
+        payload[0] = (uint8_t)counter;
+        payload[1] = (uint8_t)(counter >> 8);
+        uint8_t length = lora_link_encode(&link, frame, LINK_ADDR_RX, LINK_TYPE_COUNTER,
+                                          lora_adr_node_uplink(&adr), 2);
+
+        // O quadro é copiado (para a fila do driver ou do escalonador) e o
+        // laço segue trabalhando enquanto o rádio transmite
+        lora_dc_result_t result = lora_dc_send(&dc, 0, frame, length);
+
+        snprintf(message_buffer, sizeof(message_buffer), "Ola #%u", counter);
         ssd1306_fill(&ssd, false);
         ssd1306_draw_string(&ssd, "Pacote Enviado:", 5, 10, false);
         ssd1306_draw_string(&ssd, message_buffer, 5, 30, false);
-        ssd1306_send_data(&ssd);
-        
+        ssd1306_send_dirty(&ssd);
+
+        printf("Pacote %s: '%s' (seq %u, %u bytes, SF%u, %u dBm, %lu us de orçamento)\n",
+               result == LORA_DC_SENT ? "enviado" : result == LORA_DC_QUEUED ? "na fila" : "recusado",
+               message_buffer, frame[2], length, adr.sf, adr.power,
+               (unsigned long)lora_dc_remaining_us(&dc, 0));
+
         counter++;
-        sleep_ms(5000);
+
+        // Até o próximo envio, atende os comandos do ADR e a fila do
+        // escalonador; entre um evento e outro (TxDone, RxDone, alarme) o MCU dorme
+        send_due = false;
+        hal_alarm_start(5000 * 1000, send_timer_fired, (void*)&send_due);
+        while (!send_due) {
+            lora_packet_t* packet = lora_receive_irq_lease();
+            if (packet != NULL) {
+                lora_link_header_t header;
+                const uint8_t* command;
+                uint8_t command_length;
+                if (lora_link_receive(&link, packet->data, packet->length, &header, &command,
+                                      &command_length) == LORA_LINK_RX_NEW) {
+                    lora_adr_node_receive(&adr, &header, command, command_length);
+                }
+                lora_receive_irq_release(packet);
+            }
+            lora_adr_node_service(&adr);
+            lora_dc_service(&dc);
+
+            // send_due é conferido com as interrupções mascaradas: um alarme que
+            // dispare agora fica pendente e acorda o lora_wait_for_event(). Com o
+            // display ocupado (envio por DMA ou adiado pela interrupção) não dorme
+            bool display_busy = ssd1306_busy(&ssd);
+            uint32_t irq_state = hal_irq_save();
+            if (!send_due && !display_busy) {
+                lora_wait_for_event();
+            }
+            hal_irq_restore(irq_state);
+        }
     }
 
     return 0;
@@ -0,0 +1,138 @@
+// ssd1306_drawbench.c - Ciclos por primitiva de desenho do SSD1306
+//
+// Mede cada primitiva de ssd1306.c (caminhos por byte de página e glifos
+// pré-renderizados) contra a versão pixel a pixel de tests/ssd1306_reference.c,
+// alternando a cor a cada chamada para que todo o desenho mude de fato.
+// Para cada primitiva sai a área desenhada e os bytes do buffer que ela altera
+// (determinístico) e, nas linhas com '#', os ciclos por chamada (hal_cycles();
+// no host são nanossegundos reais, variam entre execuções e máquinas).
+//
+// Uso: ssd1306_drawbench [chamadas]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssd1306.h"
+#include "ssd1306_reference.h"
+
+#define DISP_W 128
+#define DISP_H 64
+
+// Chamadas por medida (padrão) e medidas por primitiva (vale a menor)
+#define DEFAULT_CALLS 2000
+#define ROUNDS 5
+
+typedef void (*draw_fn)(ssd1306_t* ssd, bool value);
+
+typedef struct {
+    const char* name;
+    uint32_t pixels;
+    draw_fn fast;
+    draw_fn reference;
+} primitive_t;
+
+static void fast_fill(ssd1306_t* ssd, bool v)   { ssd1306_fill(ssd, v); }
+static void ref_fill(ssd1306_t* ssd, bool v)    { ssd1306_ref_fill(ssd, v); }
+static void fast_hline(ssd1306_t* ssd, bool v)  { ssd1306_hline(ssd, 0, 127, 13, v); }
+static void ref_hline(ssd1306_t* ssd, bool v)   { ssd1306_ref_hline(ssd, 0, 127, 13, v); }
+static void fast_vline(ssd1306_t* ssd, bool v)  { ssd1306_vline(ssd, 5, 0, 63, v); }
+static void ref_vline(ssd1306_t* ssd, bool v)   { ssd1306_ref_vline(ssd, 5, 0, 63, v); }
+static void fast_rect(ssd1306_t* ssd, bool v)   { ssd1306_rect(ssd, 7, 10, 100, 50, v, false); }
+static void ref_rect(ssd1306_t* ssd, bool v)    { ssd1306_ref_rect(ssd, 7, 10, 100, 50, v, false); }
+static void fast_box(ssd1306_t* ssd, bool v)    { ssd1306_rect(ssd, 7, 10, 100, 50, v, true); }
+static void ref_box(ssd1306_t* ssd, bool v)     { ssd1306_ref_rect(ssd, 7, 10, 100, 50, v, true); }
+
+// Texto: desenha em branco sobre o fundo escuro e apaga com o bloco
+static void fast_char(ssd1306_t* ssd, bool v) {
+    if (v) ssd1306_draw_char(ssd, 'W', 20, 19, false);
+    else ssd1306_rect(ssd, 19, 20, 8, 8, false, true);
+}
+static void ref_char(ssd1306_t* ssd, bool v) {
+    if (v) ssd1306_ref_draw_char(ssd, 'W', 20, 19, false);
+    else ssd1306_rect(ssd, 19, 20, 8, 8, false, true);
+}
+static void fast_aligned(ssd1306_t* ssd, bool v) {
+    if (v) ssd1306_draw_char(ssd, 'W', 20, 16, false);
+    else ssd1306_rect(ssd, 16, 20, 8, 8, false, true);
+}
+static void ref_aligned(ssd1306_t* ssd, bool v) {
+    if (v) ssd1306_ref_draw_char(ssd, 'W', 20, 16, false);
+    else ssd1306_rect(ssd, 16, 20, 8, 8, false, true);
+}
+
+#define RX_LINE "RSSI:-87 SNR:9.5"
+static void fast_string(ssd1306_t* ssd, bool v) {
+    if (v) ssd1306_draw_string(ssd, RX_LINE, 5, 30, false);
+    else ssd1306_rect(ssd, 30, 5, 8 * (sizeof(RX_LINE) - 1), 8, false, true);
+}
+static void ref_string(ssd1306_t* ssd, bool v) {
+    if (v) ssd1306_ref_draw_string(ssd, RX_LINE, 5, 30, false);
+    else ssd1306_rect(ssd, 30, 5, 8 * (sizeof(RX_LINE) - 1), 8, false, true);
+}
+
+static const primitive_t primitives[] = {
+    { "fill",               DISP_W * DISP_H, fast_fill,    ref_fill },
+    { "hline 128",          128,             fast_hline,   ref_hline },
+    { "vline 64",           64,              fast_vline,   ref_vline },
+    { "rect 100x50",        2 * (100 + 48),  fast_rect,    ref_rect },
+    { "rect cheio 100x50",  100 * 50,        fast_box,     ref_box },
+    { "char y=19",          64,              fast_char,    ref_char },
+    { "char y=16",          64,              fast_aligned, ref_aligned },
+    { "string 16 chars",    64 * 16,         fast_string,  ref_string },
+};
+
+static ssd1306_t ssd;
+
+static void clear(void) {
+    memset(ssd.ram_buffer + 1, 0, ssd.bufsize - 1);
+}
+
+// Menor média de ciclos por chamada em ROUNDS medidas
+static double measure(draw_fn draw, uint32_t calls) {
+    double best = 0.0;
+    for (int r = 0; r < ROUNDS; r++) {
+        clear();
+        uint32_t start = hal_cycles();
+        for (uint32_t i = 0; i < calls; i++) {
+            draw(&ssd, (i & 1) == 0);
+        }
+        double per_call = (double)hal_cycles_since(start) / calls;
+        if (r == 0 || per_call < best) best = per_call;
+    }
+    return best;
+}
+
+// Bytes do buffer alterados por uma chamada, a partir da tela apagada
+static uint32_t changed_bytes(draw_fn draw) {
+    static uint8_t before[DISP_W * DISP_H / 8 + 1];
+    clear();
+    memcpy(before, ssd.ram_buffer, ssd.bufsize);
+    draw(&ssd, true);
+    uint32_t changed = 0;
+    for (uint16_t i = 1; i < ssd.bufsize; i++) {
+        changed += ssd.ram_buffer[i] != before[i];
+    }
+    return changed;
+}
+
+int main(int argc, char** argv) {
+    uint32_t calls = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : DEFAULT_CALLS;
+    if (calls == 0) calls = DEFAULT_CALLS;
+    ssd1306_init(&ssd, DISP_W, DISP_H, false, 0x3C, i2c1);
+
+    printf("Primitivas sobre %ux%u (área desenhada e bytes do buffer alterados)\n", DISP_W, DISP_H);
+    for (size_t i = 0; i < sizeof(primitives) / sizeof(primitives[0]); i++) {
+        const primitive_t* p = &primitives[i];
+        uint32_t fast_bytes = changed_bytes(p->fast);
+        uint32_t ref_bytes = changed_bytes(p->reference);
+        if (fast_bytes != ref_bytes) {
+            fprintf(stderr, "%s: %u bytes alterados, referência %u\n", p->name, fast_bytes, ref_bytes);
+            return 1;
+        }
+        printf("%-18s %5u pixels %4u bytes\n", p->name, p->pixels, fast_bytes);
+        double ref_cycles = measure(p->reference, calls);
+        double fast_cycles = measure(p->fast, calls);
+        printf("#   pixel a pixel %9.0f ciclos   por byte %8.0f ciclos   %6.1fx\n",
+               ref_cycles, fast_cycles, fast_cycles > 0 ? ref_cycles / fast_cycles : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+// ssd1306_flushbench.c - Bytes I2C por atualização da tela do receptor
+//
+// Redesenha a tela de lora_rx.c (contador, RSSI/SNR e perdidos) a cada pacote
+// simulado, como o receptor faz: ssd1306_fill() e as três linhas de texto,
+// seguidos de um envio. Compara o envio completo (ssd1306_send_data), as
+// janelas das regiões alteradas (ssd1306_send_dirty) e o envio assíncrono com
+// buffer duplo (ssd1306_flush_async, páginas alteradas com largura total).
+// Depois de cada envio a GDDRAM do display simulado é conferida com o buffer.
+//
+// Uso: ssd1306_flushbench
+// Tudo depende só do código: a saída de dois commits pode ser comparada com diff.
+#include <stdio.h>
+#include <string.h>
+#include "ssd1306.h"
+#include "sim/ssd1306_sim.h"
+
+#define DISP_W 128
+#define DISP_H 64
+#define DISP_ADDR 0x3C
+
+// Pacotes (redesenhos) por modo
+#define UPDATES 200
+
+typedef enum {
+    FLUSH_FULL = 0,
+    FLUSH_DIRTY,
+    FLUSH_ASYNC,
+    FLUSH_COUNT
+} flush_mode_t;
+
+static const char* const mode_names[FLUSH_COUNT] = { "send_data", "send_dirty", "flush_async" };
+
+static ssd1306_sim_t sim;
+static ssd1306_t ssd;
+
+// Pacote simulado: contador sequencial, RSSI/SNR variando devagar e uma perda
+// de vez em quando (sequência fixa)
+typedef struct {
+    unsigned counter;
+    int rssi;
+    float snr;
+    unsigned lost;
+    uint32_t random;
+} rx_state_t;
+
+static uint32_t next_random(rx_state_t* s) {
+    s->random = s->random * 1664525u + 1013904223u;
+    return s->random >> 16;
+}
+
+static void next_packet(rx_state_t* s) {
+    s->counter++;
+    if (next_random(s) % 16 == 0) {
+        s->lost++;
+        s->counter++;
+    }
+    s->rssi += (int)(next_random(s) % 5) - 2;
+    if (s->rssi > -40) s->rssi = -40;
+    if (s->rssi < -120) s->rssi = -120;
+    s->snr = (float)((int)(next_random(s) % 200) - 50) / 10.0f;
+}
+
+/* O mesmo desenho de lora_rx.c */
+static void draw_rx_screen(const rx_state_t* s) {
+    char line[32];
+    ssd1306_fill(&ssd, false);
+    snprintf(line, sizeof(line), "Ola #%u", s->counter);
+    ssd1306_draw_string(&ssd, line, 5, 10, false);
+    snprintf(line, sizeof(line), "RSSI:%d SNR:%.1f", s->rssi, s->snr);
+    ssd1306_draw_string(&ssd, line, 5, 30, false);
+    snprintf(line, sizeof(line), "Perdidos:%u", s->lost);
+    ssd1306_draw_string(&ssd, line, 5, 50, false);
+}
+
+static void flush(flush_mode_t mode) {
+    switch (mode) {
+        case FLUSH_FULL:  ssd1306_send_data(&ssd); break;
+        case FLUSH_DIRTY: ssd1306_send_dirty(&ssd); break;
+        default:          ssd1306_flush_async(&ssd); break;
+    }
+    while (ssd1306_busy(&ssd)) {
+        hal_yield();
+    }
+}
+
+/* A GDDRAM simulada é igual ao quadro enviado? (no modo assíncrono o
+   desenho segue em ram_buffer, que começa como cópia do quadro enviado) */
+static bool display_matches() {
+    for (uint8_t y = 0; y < DISP_H; y++) {
+        for (uint8_t x = 0; x < DISP_W; x++) {
+            bool expected = (ssd.ram_buffer[1 + (y / 8) * DISP_W + x] >> (y % 8)) & 1;
+            if (ssd1306_sim_pixel(&sim, x, y) != expected) return false;
+        }
+    }
+    return true;
+}
+
+static int run(flush_mode_t mode) {
+    hal_host_reset();
+    ssd1306_sim_init(&sim, i2c1, DISP_ADDR);
+    ssd1306_init(&ssd, DISP_W, DISP_H, false, DISP_ADDR, i2c1);
+    ssd1306_config(&ssd);
+    if (mode == FLUSH_ASYNC && !ssd1306_enable_double_buffer(&ssd)) return 1;
+
+    // Tela inicial (fora da medida)
+    rx_state_t state = { 0, -80, 5.0f, 0, 1 };
+    draw_rx_screen(&state);
+    flush(mode);
+
+    hal_host_stats_reset();
+    uint32_t max_bytes = 0, min_bytes = UINT32_MAX;
+    for (int i = 0; i < UPDATES; i++) {
+        uint32_t before = hal_host_stats()->i2c_bytes;
+        next_packet(&state);
+        draw_rx_screen(&state);
+        flush(mode);
+        if (!display_matches()) {
+            fprintf(stderr, "%s: display diferente do buffer no pacote %d\n", mode_names[mode], i);
+            return 1;
+        }
+        uint32_t bytes = hal_host_stats()->i2c_bytes - before;
+        if (bytes > max_bytes) max_bytes = bytes;
+        if (bytes < min_bytes) min_bytes = bytes;
+    }
+
+    const hal_host_stats_t* stats = hal_host_stats();
+    double bytes = (double)stats->i2c_bytes / UPDATES;
+    double transactions = (double)stats->i2c_transactions / UPDATES;
+    // Cada byte (e o endereço de cada transação) ocupa 9 bits no barramento
+    double bus_ms = (bytes + transactions) * 9.0 * 1000.0 / HAL_HOST_I2C_HZ;
+    printf("%-12s %7.1f bytes (min %4u, máx %4u) %5.1f transações %6.2f ms a 400 kHz\n",
+           mode_names[mode], bytes, min_bytes, max_bytes, transactions, bus_ms);
+    return 0;
+}
+
+int main(void) {
+    printf("Por atualização da tela do receptor (%u pacotes)\n", UPDATES);
+    for (int mode = 0; mode < FLUSH_COUNT; mode++) {
+        if (run((flush_mode_t)mode) != 0) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include "ssd1306_reference.h"
+#include "font.h"
+
+// Marca as colunas x0..x1 da página como alteradas (igual a ssd1306.c)
+static inline void ref_mark_dirty(ssd1306_t *ssd, uint8_t page, uint8_t x0, uint8_t x1) {
+    if (x0 < ssd->dirty_x0[page]) ssd->dirty_x0[page] = x0;
+    if (x1 > ssd->dirty_x1[page]) ssd->dirty_x1[page] = x1;
+}
+
+void ssd1306_ref_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
+    if (x >= ssd->width || y >= ssd->height) return; // Verifica limites
+    uint16_t index = (y / 8) * ssd->width + x + 1;
+    uint8_t pixel = y % 8;
+    uint8_t old = ssd->ram_buffer[index];
+    uint8_t updated = value ? (old | (1 << pixel)) : (old & ~(1 << pixel));
+    if (updated != old) {
+        ssd->ram_buffer[index] = updated;
+        ref_mark_dirty(ssd, y / 8, x, x);
+    }
+}
+
+void ssd1306_ref_fill(ssd1306_t *ssd, bool value) {
+    for (uint8_t y = 0; y < ssd->height; ++y) {
+        for (uint8_t x = 0; x < ssd->width; ++x) {
+            ssd1306_ref_pixel(ssd, x, y, value);
+        }
+    }
+}
+
+static void ref_draw_small_number(ssd1306_t *ssd, char c, uint8_t x, uint8_t y) {
+    if (c < '0' || c > '9') return;
+    uint16_t index = 568 + (c - '0') * 5; // Início dos números pequenos em font[568]
+    for (uint8_t i = 0; i < 5; ++i) {
+        uint8_t line = font[index + i];
+        for (uint8_t j = 0; j < 5; ++j) {
+            if ((line >> (4 - j)) & 0x01) {
+                ssd1306_ref_pixel(ssd, x + j, y + i, true);
+            }
+        }
+    }
+}
+
+void ssd1306_ref_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y, bool use_small_numbers) {
+    if (use_small_numbers && c >= '0' && c <= '9') {
+        ref_draw_small_number(ssd, c, x, y);
+        return;
+    }
+
+    uint16_t index = 0;
+    bool rotate = false;
+
+    // Mapeia caracteres
+    if (c >= '0' && c <= '9') {
+        index = (c - '0' + 1) * 8;
+    } else if (c >= 'A' && c <= 'Z') {
+        index = (c - 'A' + 11) * 8;
+    } else if (c >= 'a' && c <= 'z') {
+        index = (c - 'a' + 37) * 8;
+    } else if (c == ':') {
+        index = 64 * 8;
+        rotate = true;
+    } else if (c == '.') {
+        index = 65 * 8;
+        rotate = true;
+    } else if (c == '>') {
+        index = 66 * 8;
+        rotate = true;
+    } else if (c == '-') {
+        index = 67 * 8;
+        rotate = true;
+    } else if (c == 127) {
+        index = 68 * 8; // Símbolo Ohm
+    } else if (c == '!') {
+        index = 69 * 8;
+        rotate = true;
+    } else if (c == '%') {
+        index = 70 * 8;
+        rotate = true;
+    } else if (c == '/') {
+        index = 71 * 8;
+        rotate = true;
+    } else {
+        return; // Caractere não suportado
+    }
+
+    // Renderiza caractere
+    for (uint8_t i = 0; i < 8; ++i) {
+        uint8_t line = font[index + i];
+        for (uint8_t j = 0; j < 8; ++j) {
+            bool pixel_value = (line >> j) & 0x01;
+            ssd1306_ref_pixel(ssd, x + (rotate ? (7 - j) : i), y + (rotate ? i : j), pixel_value);
+        }
+    }
+}
+
+void ssd1306_ref_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y, bool use_small_numbers) {
+    while (*str) {
+        char c = *str;
+        uint8_t char_width = (use_small_numbers && c >= '0' && c <= '9') ? 5 : 8;
+
+        // Quebra de linha automática
+        if (x + char_width > ssd->width) {
+            x = 0;
+            y += 8;
+            if (y + 8 > ssd->height) break;
+        }
+
+        ssd1306_ref_draw_char(ssd, c, x, y, use_small_numbers);
+        x += char_width;
+        str++;
+    }
+}
+
+void ssd1306_ref_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
+    for (uint8_t x = left; x < left + width; ++x) {
+        ssd1306_ref_pixel(ssd, x, top, value);
+        ssd1306_ref_pixel(ssd, x, top + height - 1, value);
+    }
+    for (uint8_t y = top; y < top + height; ++y) {
+        ssd1306_ref_pixel(ssd, left, y, value);
+        ssd1306_ref_pixel(ssd, left + width - 1, y, value);
+    }
+    if (fill) {
+        for (uint8_t x = left + 1; x < left + width - 1; ++x) {
+            for (uint8_t y = top + 1; y < top + height - 1; ++y) {
+                ssd1306_ref_pixel(ssd, x, y, value);
+            }
+        }
+    }
+}
+
+void ssd1306_ref_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
+    for (uint8_t x = x0; x <= x1; ++x) {
+        ssd1306_ref_pixel(ssd, x, y, value);
+    }
+}
+
+void ssd1306_ref_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
+    for (uint8_t y = y0; y <= y1; ++y) {
+        ssd1306_ref_pixel(ssd, x, y, value);
+    }
+}
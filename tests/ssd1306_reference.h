@@ -0,0 +1,22 @@
+// ssd1306_reference.h
+// Primitivas de desenho pixel a pixel, como eram antes dos caminhos por byte
+// de ssd1306.c. Servem de referência (imagem e regiões alteradas) para
+// test_ssd1306 e de base de comparação para ssd1306_drawbench.
+//
+// Como as originais, recebem coordenadas de 8 bits e não devem ser chamadas
+// com intervalos que passem de 254 (o laço de 8 bits nunca termina).
+#ifndef SSD1306_REFERENCE_H
+#define SSD1306_REFERENCE_H
+
+#include "ssd1306.h"
+
+void ssd1306_ref_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
+void ssd1306_ref_fill(ssd1306_t *ssd, bool value);
+void ssd1306_ref_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
+void ssd1306_ref_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
+void ssd1306_ref_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height,
+                      bool value, bool fill);
+void ssd1306_ref_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y, bool use_small_numbers);
+void ssd1306_ref_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y, bool use_small_numbers);
+
+#endif // SSD1306_REFERENCE_H
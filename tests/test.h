@@ -0,0 +1,46 @@
+// test.h
+// Verificações dos testes de host (ctest): cada teste é um executável que
+// termina com código 1 na primeira falha. Valem também com NDEBUG.
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "hal_host.h"
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond);   \
+            exit(1);                                                             \
+        }                                                                        \
+    } while (0)
+
+// Igual a CHECK(), mostrando os dois valores inteiros quando diferem
+#define CHECK_EQ(a, b)                                                           \
+    do {                                                                         \
+        long long check_a_ = (long long)(a), check_b_ = (long long)(b);          \
+        if (check_a_ != check_b_) {                                              \
+            fprintf(stderr, "%s:%d: falhou: %s == %s (%lld != %lld)\n",          \
+                    __FILE__, __LINE__, #a, #b, check_a_, check_b_);             \
+            exit(1);                                                             \
+        }                                                                        \
+    } while (0)
+
+// Roda um caso de teste e anuncia o nome (a saída aparece no ctest -V)
+#define RUN(test)                                                                \
+    do {                                                                         \
+        printf("%s\n", #test);                                                   \
+        fflush(stdout);                                                          \
+        test();                                                                  \
+    } while (0)
+
+// Avança o relógio virtual como o laço principal de uma aplicação
+static inline void test_run_for_us(uint64_t us) {
+    uint64_t end = hal_time_us() + us;
+    while (hal_time_us() < end) {
+        hal_yield();
+    }
+}
+
+#endif // TEST_H
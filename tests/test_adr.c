@@ -0,0 +1,270 @@
+// test_adr.c - ADR entre dois rádios simulados com roteiros de perda de percurso
+#include <string.h>
+#include "test.h"
+#include "lora_adr.h"
+#include "sim/sx1276_sim.h"
+
+#define ADDR_GATEWAY 0x02
+#define ADDR_NODE    0x01
+
+// Nó no segundo módulo (spi1), gateway na instância padrão
+#define N_CS   40
+#define N_RST  41
+#define N_DIO0 42
+#define N_DIO1 43
+
+// Piso de ruído em 125 kHz (dBm): SNR = RSSI + 117
+#define NOISE_FLOOR_DBM (-117.0f)
+#define UPLINK_PERIOD_US 2000000
+
+// Trecho do roteiro: perda de percurso (dB) a partir de um envio do nó
+typedef struct {
+    uint16_t from_frame;
+    float path_loss_db;
+} trace_step_t;
+
+typedef struct {
+    uint32_t sent;
+    uint32_t received;
+    uint32_t received_tail;    // recebidos no último quarto do trecho (já convergido)
+    uint32_t sent_tail;
+} phase_t;
+
+static sx1276_sim_t gateway_sim;
+static sx1276_sim_t node_sim;
+static rfm95_t* gateway_radio;
+static rfm95_t* node_radio;
+static lora_link_t gateway_link;
+static lora_link_t node_link;
+static lora_adr_t adr;
+static lora_adr_node_t node;
+
+static const trace_step_t* trace;
+static uint8_t trace_steps;
+static float path_loss_db;
+static uint32_t noise_random;
+
+/* Ruído de SNR determinístico, aproximadamente gaussiano (soma de 4 uniformes, desvio ~1.7 dB) */
+static float snr_noise(void) {
+    float sum = 0;
+    for (int i = 0; i < 4; i++) {
+        noise_random ^= noise_random << 13;
+        noise_random ^= noise_random >> 17;
+        noise_random ^= noise_random << 5;
+        sum += (float)(noise_random % 1000) / 1000.0f - 0.5f;
+    }
+    return sum * 3.0f;
+}
+
+/* Potência programada no PA_BOOST (RegPaConfig: 2 + OutputPower dBm) */
+static int tx_power_dbm(const sx1276_sim_t* sim) {
+    return (sim->regs[0x09] & 0x0F) + 2;
+}
+
+/* Entrega o quadro se o outro rádio escuta no mesmo SF e o SNR recebido
+   supera o mínimo de demodulação */
+static void deliver(sx1276_sim_t* to, rfm95_t* receiver, rfm95_t* sender, int power_dbm, const uint8_t* data,
+                    uint8_t length, uint64_t airtime_us) {
+    uint8_t sf = rfm95_get_modem_config(sender)->spreading_factor;
+    if (rfm95_get_modem_config(receiver)->spreading_factor != sf) return;
+    float rssi = (float)power_dbm - path_loss_db;
+    float snr = rssi - NOISE_FLOOR_DBM + snr_noise();
+    if (snr < lora_adr_required_snr(sf)) return;
+    if (snr > 12.0f) snr = 12.0f;
+    sx1276_sim_deliver(to, data, length, airtime_us, (int)rssi, (float)(int)(snr * 4) / 4, true);
+}
+
+static void node_tx_hook(void* ctx, sx1276_sim_t* radio, const uint8_t* data, uint8_t length, uint64_t airtime_us) {
+    (void)ctx;
+    deliver(&gateway_sim, gateway_radio, node_radio, tx_power_dbm(radio), data, length, airtime_us);
+}
+
+static void gateway_tx_hook(void* ctx, sx1276_sim_t* radio, const uint8_t* data, uint8_t length,
+                            uint64_t airtime_us) {
+    (void)ctx;
+    deliver(&node_sim, node_radio, gateway_radio, tx_power_dbm(radio), data, length, airtime_us);
+}
+
+static void setup(void) {
+    hal_host_reset();
+    noise_random = 2463534242u;
+    sx1276_sim_init(&gateway_sim, SPI_PORT, PIN_CS, PIN_RST, PIN_DIO0, PIN_DIO1);
+    sx1276_sim_init(&node_sim, spi1, N_CS, N_RST, N_DIO0, N_DIO1);
+    sx1276_sim_set_tx_hook(&gateway_sim, gateway_tx_hook, NULL);
+    sx1276_sim_set_tx_hook(&node_sim, node_tx_hook, NULL);
+
+    rfm95_pins_t pins = RFM95_PINS_DEFAULT;
+    pins.spi = spi1;
+    pins.cs = N_CS;
+    pins.rst = N_RST;
+    pins.dio0 = N_DIO0;
+    pins.dio1 = N_DIO1;
+    gateway_radio = rfm95_radio(0);
+    node_radio = rfm95_radio(1);
+    CHECK(lora_init());
+    CHECK(rfm95_init(node_radio, &pins, NULL));
+
+    lora_adr_config_t config = LORA_ADR_CONFIG_DEFAULT;
+    lora_link_init(&gateway_link, ADDR_GATEWAY);
+    lora_link_init(&node_link, ADDR_NODE);
+    CHECK(lora_adr_init(&adr, gateway_radio, &gateway_link, &config));
+    CHECK(lora_adr_node_init(&node, node_radio, &node_link, ADDR_GATEWAY, &config));
+    CHECK_EQ(tx_power_dbm(&node_sim), 17);
+    rfm95_receive_irq_start(gateway_radio, NULL);
+    rfm95_receive_irq_start(node_radio, NULL);
+}
+
+static uint8_t phase_of(uint16_t frame) {
+    uint8_t phase = 0;
+    while (phase + 1 < trace_steps && frame >= trace[phase + 1].from_frame) phase++;
+    return phase;
+}
+
+static bool in_tail(uint16_t frame, uint8_t phase, uint16_t frames) {
+    uint16_t end = phase + 1 < trace_steps ? trace[phase + 1].from_frame : frames;
+    return frame >= end - (end - trace[phase].from_frame) / 4;
+}
+
+/* Laço do gateway e do nó: um envio a cada UPLINK_PERIOD_US com a perda do
+   roteiro; chama check(frame) antes de cada envio */
+static void run_trace(const trace_step_t* steps, uint8_t count, uint16_t frames, phase_t* phases,
+                      void (*check)(uint16_t frame)) {
+    trace = steps;
+    trace_steps = count;
+    memset(phases, 0, count * sizeof(phase_t));
+    uint16_t frame = 0;
+    uint64_t next_uplink = hal_time_us() + UPLINK_PERIOD_US;
+    while (frame < frames || rfm95_tx_busy(node_radio)) {
+        lora_packet_t* packet;
+        while ((packet = rfm95_receive_irq_lease(gateway_radio)) != NULL) {
+            lora_link_header_t header;
+            const uint8_t* payload;
+            uint8_t payload_length;
+            if (lora_link_receive(&gateway_link, packet->data, packet->length, &header, &payload,
+                                  &payload_length) == LORA_LINK_RX_NEW &&
+                !lora_adr_receive(&adr, &header, payload, payload_length, packet->snr)) {
+                uint16_t sent = payload[0] | (uint16_t)(payload[1] << 8);
+                uint8_t phase = phase_of(sent);
+                phases[phase].received++;
+                phases[phase].received_tail += in_tail(sent, phase, frames);
+            }
+            rfm95_receive_irq_release(gateway_radio, packet);
+        }
+        while ((packet = rfm95_receive_irq_lease(node_radio)) != NULL) {
+            lora_link_header_t header;
+            const uint8_t* payload;
+            uint8_t payload_length;
+            if (lora_link_receive(&node_link, packet->data, packet->length, &header, &payload, &payload_length) ==
+                LORA_LINK_RX_NEW) {
+                lora_adr_node_receive(&node, &header, payload, payload_length);
+            }
+            rfm95_receive_irq_release(node_radio, packet);
+        }
+        lora_adr_service(&adr);
+        lora_adr_node_service(&node);
+
+        if (frame < frames && hal_time_us() >= next_uplink) {
+            next_uplink += UPLINK_PERIOD_US;
+            if (check) check(frame);
+            uint8_t phase = phase_of(frame);
+            path_loss_db = trace[phase].path_loss_db;
+            uint8_t buffer[LORA_LINK_HEADER_SIZE + 2];
+            uint8_t* payload = lora_link_payload(buffer);
+            payload[0] = (uint8_t)frame;
+            payload[1] = (uint8_t)(frame >> 8);
+            uint8_t length = lora_link_encode(&node_link, buffer, ADDR_GATEWAY, 1, lora_adr_node_uplink(&node), 2);
+            CHECK(rfm95_tx_enqueue(node_radio, buffer, length, LORA_PRIO_NORMAL));
+            phases[phase].sent++;
+            phases[phase].sent_tail += in_tail(frame, phase, frames);
+            frame++;
+        }
+        hal_yield();
+    }
+    test_run_for_us(5000000);
+}
+
+// Roteiro 1: enlace forte, degradado, no limite do SF12 e de volta
+static const trace_step_t fading[] = {
+    { 0, 100.0f },
+    { 120, 138.0f },
+    { 300, 148.0f },
+    { 520, 110.0f },
+};
+#define FADING_FRAMES 700
+
+static uint8_t fading_sf_at_phase_end[4];
+static uint8_t fading_power_at_phase_end[4];
+
+static void record_phase_end(uint16_t frame) {
+    for (uint8_t p = 1; p < 4; p++) {
+        if (frame == fading[p].from_frame) {
+            fading_sf_at_phase_end[p - 1] = node.sf;
+            fading_power_at_phase_end[p - 1] = node.power;
+        }
+    }
+}
+
+/* A cada trecho o ADR converge para o SF mais rápido e a menor potência com
+   folga, e depois dela a entrega fica perto do alvo de perdas */
+static void test_fading_trace(void) {
+    setup();
+    phase_t phases[4];
+    run_trace(fading, 4, FADING_FRAMES, phases, record_phase_end);
+    fading_sf_at_phase_end[3] = node.sf;
+    fading_power_at_phase_end[3] = node.power;
+    for (int p = 0; p < 4; p++) {
+        printf("  trecho %d (%.0f dB): SF%u %u dBm, %u/%u recebidos, %u/%u no fim\n", p, fading[p].path_loss_db,
+               fading_sf_at_phase_end[p], fading_power_at_phase_end[p], phases[p].received, phases[p].sent,
+               phases[p].received_tail, phases[p].sent_tail);
+    }
+
+    // Enlace forte: SF7 com potência reduzida
+    CHECK_EQ(fading_sf_at_phase_end[0], 7);
+    CHECK(fading_power_at_phase_end[0] < 17);
+    // Degradado: SF maior que 7, mas não o máximo
+    CHECK(fading_sf_at_phase_end[1] > 7 && fading_sf_at_phase_end[1] < 12);
+    // No limite: SF12 em potência máxima
+    CHECK_EQ(fading_sf_at_phase_end[2], 12);
+    CHECK_EQ(fading_power_at_phase_end[2], 17);
+    // De volta: desce de novo
+    CHECK(fading_sf_at_phase_end[3] < 10);
+
+    // Convergido, a entrega fica perto do alvo (10% de perdas, com folga)
+    for (int p = 0; p < 4; p++) {
+        CHECK(phases[p].received_tail * 100 >= phases[p].sent_tail * 80);
+    }
+    CHECK_EQ(node.sf, rfm95_get_modem_config(gateway_radio)->spreading_factor);
+    // Um comando pode se perder na queda brusca, mas cada trecho teve o seu confirmado
+    CHECK(lora_adr_counters(&adr)->confirmed >= 4);
+}
+
+// Roteiro 2: o enlace cai de vez em SF7 (gateway fora de alcance) e volta
+static const trace_step_t outage[] = {
+    { 0, 100.0f },
+    { 80, 200.0f },
+    { 200, 125.0f },
+};
+#define OUTAGE_FRAMES 400
+
+/* Sem respostas o nó recua sozinho e o gateway, em silêncio, o acompanha;
+   quando o enlace volta os dois se reencontram e o ADR retoma */
+static void test_outage_trace(void) {
+    setup();
+    phase_t phases[3];
+    run_trace(outage, 3, OUTAGE_FRAMES, phases, NULL);
+    for (int p = 0; p < 3; p++) {
+        printf("  trecho %d (%.0f dB): %u/%u recebidos, %u/%u no fim\n", p, outage[p].path_loss_db,
+               phases[p].received, phases[p].sent, phases[p].received_tail, phases[p].sent_tail);
+    }
+    CHECK_EQ(phases[1].received, 0);
+    CHECK(lora_adr_node_counters(&node)->backoffs > 0);
+    CHECK(lora_adr_counters(&adr)->fallback_steps > 0);
+    CHECK(phases[2].received_tail * 100 >= phases[2].sent_tail * 80);
+    CHECK_EQ(node.sf, rfm95_get_modem_config(gateway_radio)->spreading_factor);
+}
+
+int main(void) {
+    RUN(test_fading_trace);
+    RUN(test_outage_trace);
+    return 0;
+}
@@ -0,0 +1,290 @@
+// test_arq.c - Entrega confiável entre dois rádios simulados com perdas
+#include <string.h>
+#include "test.h"
+#include "lora_arq.h"
+#include "sim/sx1276_sim.h"
+
+#define ADDR_A 0x10
+#define ADDR_B 0x01
+
+// Nó A no segundo módulo (spi1), nó B na instância padrão
+#define A_CS   40
+#define A_RST  41
+#define A_DIO0 42
+#define A_DIO1 43
+
+typedef struct {
+    sx1276_sim_t sim;
+    sx1276_sim_t* peer;
+    rfm95_t* radio;
+    lora_link_t link;
+    lora_arq_t arq;
+    uint32_t on_air;             // quadros postos no ar
+    uint32_t data_on_air;        // dos quais de dados (sem LORA_LINK_FLAG_ACK)
+    uint32_t dropped;            // perdidos pelo roteiro
+    uint32_t deaf;               // perdidos porque o outro nó não escutava
+    uint64_t last_tx_end_us;     // fim do último quadro no ar
+    bool (*drop)(uint32_t index, bool ack);   // roteiro de perdas (NULL: nenhuma)
+    uint32_t delivered;          // payloads inéditos entregues à aplicação
+    uint64_t seen;               // bit i: payload i já entregue
+    uint8_t last_payload;
+} node_t;
+
+static node_t a;
+static node_t b;
+
+static uint32_t done_acked;
+static uint32_t done_failed;
+
+/* Põe o quadro no ar até o outro nó, a menos que o roteiro o perca */
+static void tx_hook(void* ctx, sx1276_sim_t* radio, const uint8_t* data, uint8_t length, uint64_t airtime_us) {
+    (void)radio;
+    node_t* node = ctx;
+    bool ack = length > 3 && ((data[3] >> 4) & LORA_LINK_FLAG_ACK);
+    uint32_t index = ack ? node->on_air - node->data_on_air : node->data_on_air;
+    node->on_air++;
+    node->data_on_air += !ack;
+    node->last_tx_end_us = hal_time_us() + airtime_us;
+    if (node->drop && node->drop(index, ack)) {
+        node->dropped++;
+        return;
+    }
+    if (!sx1276_sim_deliver(node->peer, data, length, airtime_us, -70, 8.0f, true)) {
+        node->deaf++;                                    // o outro estava transmitindo
+    }
+}
+
+static void on_done(uint8_t dst, uint8_t seq, bool acked) {
+    (void)dst;
+    (void)seq;
+    if (acked) {
+        done_acked++;
+    } else {
+        done_failed++;
+    }
+}
+
+static void setup(void) {
+    hal_host_reset();
+    memset(&a, 0, sizeof(a));
+    memset(&b, 0, sizeof(b));
+    done_acked = 0;
+    done_failed = 0;
+
+    sx1276_sim_init(&a.sim, spi1, A_CS, A_RST, A_DIO0, A_DIO1);
+    sx1276_sim_init(&b.sim, SPI_PORT, PIN_CS, PIN_RST, PIN_DIO0, PIN_DIO1);
+    a.peer = &b.sim;
+    b.peer = &a.sim;
+    sx1276_sim_set_tx_hook(&a.sim, tx_hook, &a);
+    sx1276_sim_set_tx_hook(&b.sim, tx_hook, &b);
+
+    rfm95_pins_t pins = RFM95_PINS_DEFAULT;
+    pins.spi = spi1;
+    pins.cs = A_CS;
+    pins.rst = A_RST;
+    pins.dio0 = A_DIO0;
+    pins.dio1 = A_DIO1;
+    a.radio = rfm95_radio(1);
+    b.radio = rfm95_radio(0);
+    CHECK(rfm95_init(a.radio, &pins, NULL));
+    CHECK(lora_init());
+
+    lora_link_init(&a.link, ADDR_A);
+    lora_link_init(&b.link, ADDR_B);
+    lora_arq_init(&a.arq, a.radio, &a.link);
+    lora_arq_init(&b.arq, b.radio, &b.link);
+    lora_arq_set_callback(&a.arq, on_done);
+    rfm95_receive_irq_start(a.radio, NULL);
+    rfm95_receive_irq_start(b.radio, NULL);
+}
+
+/* Laço principal de um nó: recebe pelo ARQ e retransmite os vencidos */
+static void node_poll(node_t* node) {
+    lora_packet_t* packet;
+    while ((packet = rfm95_receive_irq_lease(node->radio)) != NULL) {
+        lora_link_header_t header;
+        const uint8_t* payload;
+        uint8_t payload_length;
+        if (lora_arq_receive(&node->arq, packet->data, packet->length, &header, &payload, &payload_length) ==
+            LORA_LINK_RX_NEW) {
+            CHECK(payload[0] < 64 && !(node->seen & (1ull << payload[0])));   // nunca duas vezes
+            node->seen |= 1ull << payload[0];
+            node->delivered++;
+            node->last_payload = payload[0];
+        }
+        rfm95_receive_irq_release(node->radio, packet);
+    }
+    lora_arq_service(&node->arq);
+}
+
+static void run_for_us(uint64_t us) {
+    uint64_t end = hal_time_us() + us;
+    while (hal_time_us() < end) {
+        hal_yield();
+        node_poll(&a);
+        node_poll(&b);
+    }
+}
+
+// Roteiros de perda: índice do quadro de dados (ou de ACK) posto no ar pelo nó
+static uint32_t loss_random;
+static uint32_t loss_one_in;
+
+/* Perde um quadro em loss_one_in, por sorteio fixo (reprodutível) */
+static bool drop_some(uint32_t index, bool ack) {
+    (void)index;
+    (void)ack;
+    loss_random ^= loss_random << 13;
+    loss_random ^= loss_random >> 17;
+    loss_random ^= loss_random << 5;
+    return loss_random % loss_one_in == 0;
+}
+
+static bool drop_all_data(uint32_t index, bool ack) {
+    (void)index;
+    return !ack;
+}
+
+/* A envia total payloads numerados a B, com até window quadros em voo */
+static uint32_t send_all(uint32_t total, uint8_t window) {
+    uint32_t sent = 0;
+    uint64_t end = hal_time_us() + 300000000;
+    while ((sent < total || lora_arq_in_flight(&a.arq) > 0) && hal_time_us() < end) {
+        uint8_t payload[8] = { (uint8_t)sent };
+        if (sent < total && lora_arq_in_flight(&a.arq) < window &&
+            lora_arq_send(&a.arq, ADDR_B, 1, payload, sizeof(payload))) {
+            sent++;
+        }
+        run_for_us(1000);
+    }
+    return sent;
+}
+
+/* Parando a cada quadro, um em oito quadros de dados ou de ACK perdido:
+   tudo chega uma única vez e é confirmado; as duplicatas (ACK perdido)
+   recebem o ACK de novo */
+static void test_stop_and_wait_with_loss(void) {
+    setup();
+    loss_random = 12345;
+    loss_one_in = 8;
+    a.drop = drop_some;
+    b.drop = drop_some;
+    CHECK_EQ(send_all(40, 1), 40);
+
+    const lora_arq_counters_t* counters = lora_arq_counters(&a.arq);
+    CHECK_EQ(b.delivered, 40);
+    CHECK_EQ(counters->acked, 40);
+    CHECK_EQ(done_acked, 40);
+    CHECK_EQ(counters->failed, 0);
+    CHECK(a.dropped > 0 && b.dropped > 0);
+    CHECK_EQ(counters->retransmissions, a.dropped + b.dropped);
+    CHECK_EQ(lora_arq_counters(&b.arq)->duplicates, b.dropped);
+    CHECK_EQ(lora_link_source(&b.link, ADDR_A)->duplicates, b.dropped);
+}
+
+/* Janela cheia com perdas nos dois sentidos (e os ACKs que colidem com a
+   próxima transmissão do remetente): nenhum payload chega duas vezes à
+   aplicação, nada confirmado deixa de chegar e cada quadro termina
+   confirmado ou descartado */
+static void test_window_with_loss(void) {
+    setup();
+    loss_random = 2024;
+    loss_one_in = 10;
+    a.drop = drop_some;
+    b.drop = drop_some;
+    CHECK_EQ(send_all(40, LORA_ARQ_WINDOW), 40);
+
+    const lora_arq_counters_t* counters = lora_arq_counters(&a.arq);
+    CHECK_EQ(counters->acked + counters->failed, 40);
+    CHECK_EQ(done_acked, counters->acked);
+    CHECK_EQ(done_failed, counters->failed);
+    CHECK(counters->acked <= b.delivered);
+    CHECK(b.delivered + counters->failed >= 40);
+    CHECK(counters->acked >= 30);
+    CHECK(counters->retransmissions > 0);
+    CHECK(lora_arq_counters(&b.arq)->duplicates > 0);
+}
+
+/* Sem resposta, o quadro vai ao ar 1 + LORA_ARQ_MAX_RETRIES vezes, cada
+   cópia só depois do timeout contado do TxDone da anterior, e é descartado */
+static void test_give_up(void) {
+    setup();
+    a.drop = drop_all_data;
+    uint8_t payload[4] = { 7 };
+    uint32_t timeout = lora_arq_timeout_us(&a.arq, sizeof(payload));
+    uint32_t airtime = rfm95_time_on_air_us(a.radio, LORA_LINK_HEADER_SIZE + sizeof(payload));
+    CHECK(lora_arq_send(&a.arq, ADDR_B, 1, payload, sizeof(payload)));
+
+    uint32_t seen = 0;
+    uint64_t tx_end = 0;
+    uint64_t end = hal_time_us() + 60000000;
+    while (lora_arq_in_flight(&a.arq) > 0 && hal_time_us() < end) {
+        run_for_us(100);
+        if (a.on_air != seen) {
+            if (seen > 0) {
+                uint64_t wait = (uint64_t)(timeout - airtime) << (seen - 1);
+                CHECK(hal_time_us() >= tx_end + wait);
+            }
+            seen = a.on_air;
+            tx_end = a.last_tx_end_us;
+        }
+    }
+    CHECK_EQ(a.on_air, 1 + LORA_ARQ_MAX_RETRIES);
+    CHECK_EQ(lora_arq_counters(&a.arq)->retransmissions, LORA_ARQ_MAX_RETRIES);
+    CHECK_EQ(lora_arq_counters(&a.arq)->failed, 1);
+    CHECK_EQ(done_failed, 1);
+    CHECK_EQ(b.delivered, 0);
+}
+
+/* O RTT conta do TxDone: quadros longos à frente na fila não o inflam, e o
+   valor medido é o tempo no ar do quadro e do ACK mais o processamento */
+static void test_rtt_with_queue_ahead(void) {
+    setup();
+    uint8_t filler[200];
+    memset(filler, 0xEE, sizeof(filler));
+    for (int i = 0; i < 3; i++) {
+        CHECK(rfm95_tx_enqueue(a.radio, filler, sizeof(filler), LORA_PRIO_NORMAL));
+    }
+    uint8_t payload[4] = { 42 };
+    CHECK(lora_arq_send(&a.arq, ADDR_B, 1, payload, sizeof(payload)));
+    CHECK(!a.arq.slots[0].stamp.done);                  // ainda atrás dos outros na fila
+    run_for_us(5000000);
+
+    CHECK_EQ(lora_arq_in_flight(&a.arq), 0);
+    CHECK_EQ(b.delivered, 1);
+    CHECK_EQ(b.last_payload, 42);
+    CHECK_EQ(lora_arq_counters(&a.arq)->retransmissions, 0);
+    CHECK(a.arq.slots[0].stamp.done);
+    CHECK_EQ(a.arq.slots[0].stamp.done_us, (uint32_t)a.last_tx_end_us);
+
+    uint32_t airtime = rfm95_time_on_air_us(a.radio, LORA_LINK_HEADER_SIZE + sizeof(payload)) +
+                       rfm95_time_on_air_us(a.radio, LORA_LINK_HEADER_SIZE + LORA_ARQ_ACK_SIZE);
+    uint32_t rtt = lora_arq_counters(&a.arq)->rtt_last_us;
+    CHECK(rtt >= airtime);
+    CHECK(rtt < airtime + 10000);
+}
+
+/* Uma marca de quadro descartado pela fila nunca é gravada */
+static void test_stamp_dropped(void) {
+    setup();
+    uint8_t frame[16] = { 0 };
+    lora_tx_stamp_t first;
+    lora_tx_stamp_t dropped;
+    CHECK(rfm95_tx_enqueue_stamped(a.radio, frame, sizeof(frame), LORA_PRIO_NORMAL, &first));
+    CHECK(rfm95_tx_enqueue_stamped(a.radio, frame, sizeof(frame), LORA_PRIO_NORMAL, &dropped));
+    rfm95_tx_queue_flush(a.radio);
+    run_for_us(1000000);
+    CHECK(first.done);                                   // já estava no ar
+    CHECK_EQ(first.done_us, (uint32_t)a.last_tx_end_us);
+    CHECK(!dropped.done);
+    CHECK_EQ(a.on_air, 1);
+}
+
+int main(void) {
+    RUN(test_stop_and_wait_with_loss);
+    RUN(test_window_with_loss);
+    RUN(test_give_up);
+    RUN(test_rtt_with_queue_ahead);
+    RUN(test_stamp_dropped);
+    return 0;
+}
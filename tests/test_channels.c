@@ -0,0 +1,228 @@
+// test_channels.c - Plano de canais: sequência de saltos, envio, acompanhamento,
+// FHSS dentro do pacote e varredura por CAD entre dois rádios simulados
+#include <string.h>
+#include "test.h"
+#include "lora_channels.h"
+#include "sim/sx1276_sim.h"
+
+#define SEED 0x5EED1234
+
+// Transmissor no segundo módulo (spi1), receptor na instância padrão
+#define TX_CS   40
+#define TX_RST  41
+#define TX_DIO0 42
+#define TX_DIO1 43
+
+static sx1276_sim_t tx_sim;
+static sx1276_sim_t rx_sim;
+static rfm95_t* tx_radio;
+static rfm95_t* rx_radio;
+static lora_channels_t tx_channels;
+static lora_channels_t rx_channels;
+static uint32_t base_frf;
+
+/* O pacote chega ao receptor só se ele está no canal em que saiu */
+static void tx_hook(void* ctx, sx1276_sim_t* radio, const uint8_t* data, uint8_t length, uint64_t airtime_us) {
+    (void)ctx;
+    sx1276_sim_deliver_on(&rx_sim, sx1276_sim_frf(radio), data, length, airtime_us, -70, 8.0f, true);
+}
+
+static uint32_t frf_value(const lora_frf_t* frf) {
+    return ((uint32_t)frf->reg[0] << 16) | ((uint32_t)frf->reg[1] << 8) | frf->reg[2];
+}
+
+static void setup(const lora_channel_plan_t* plan, const lora_modem_config_t* modem) {
+    hal_host_reset();
+    sx1276_sim_init(&tx_sim, spi1, TX_CS, TX_RST, TX_DIO0, TX_DIO1);
+    sx1276_sim_init(&rx_sim, SPI_PORT, PIN_CS, PIN_RST, PIN_DIO0, PIN_DIO1);
+    sx1276_sim_set_tx_hook(&tx_sim, tx_hook, NULL);
+
+    rfm95_pins_t pins = RFM95_PINS_DEFAULT;
+    pins.spi = spi1;
+    pins.cs = TX_CS;
+    pins.rst = TX_RST;
+    pins.dio0 = TX_DIO0;
+    pins.dio1 = TX_DIO1;
+    tx_radio = rfm95_radio(1);
+    rx_radio = rfm95_radio(0);
+    CHECK(rfm95_init(tx_radio, &pins, NULL));
+    CHECK(lora_init());
+    CHECK(rfm95_set_modem_config(tx_radio, modem) > 0);
+    CHECK(rfm95_set_modem_config(rx_radio, modem) > 0);
+    base_frf = sx1276_sim_frf(&tx_sim);
+
+    CHECK(lora_channels_init(&tx_channels, tx_radio, plan, SEED));
+    CHECK(lora_channels_init(&rx_channels, rx_radio, plan, SEED));
+}
+
+static void wait_tx_idle(void) {
+    while (rfm95_tx_busy(tx_radio) || rfm95_tx_queue_length(tx_radio) > 0) {
+        hal_yield();
+    }
+}
+
+/* Mesma semente, mesma sequência nos dois lados (inclusive pulando quadros); a
+   cada ciclo de N quadros cada canal sai uma vez, em ordem diferente por ciclo */
+static void test_sequence(void) {
+    const lora_channel_plan_t plans[] = { LORA_PLAN_AU915_SUBBAND(1), LORA_PLAN_AU915_125K };
+    for (size_t p = 0; p < sizeof(plans) / sizeof(plans[0]); p++) {
+        uint8_t count = plans[p].count;
+        CHECK(lora_channels_init(&tx_channels, rfm95_radio(1), &plans[p], SEED));
+        CHECK(lora_channels_init(&rx_channels, rfm95_radio(0), &plans[p], SEED));
+        uint8_t first_cycle[LORA_CHANNELS_MAX];
+        bool order_changed = false;
+        for (uint32_t cycle = 0; cycle < 8; cycle++) {
+            uint64_t used = 0;
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t sequence = cycle * count + i;
+                uint8_t channel = lora_channels_for(&tx_channels, sequence);
+                CHECK(channel < count);
+                CHECK(!(used & (1ull << channel)));
+                used |= 1ull << channel;
+                if (cycle == 0) {
+                    first_cycle[i] = channel;
+                } else if (channel != first_cycle[i]) {
+                    order_changed = true;
+                }
+            }
+            CHECK_EQ(used, count == 64 ? UINT64_MAX : (1ull << count) - 1);
+        }
+        CHECK(order_changed);
+
+        // O receptor consulta fora de ordem, de trás para a frente
+        for (uint32_t sequence = 8u * count; sequence-- > 0;) {
+            CHECK_EQ(lora_channels_for(&rx_channels, sequence), lora_channels_for(&tx_channels, sequence));
+        }
+    }
+
+    // Outra semente, outra ordem
+    const lora_channel_plan_t plan = LORA_PLAN_AU915_SUBBAND(1);
+    CHECK(lora_channels_init(&rx_channels, rfm95_radio(0), &plan, SEED + 1));
+    bool differs = false;
+    for (uint32_t sequence = 0; sequence < 32; sequence++) {
+        differs |= lora_channels_for(&rx_channels, sequence) != lora_channels_for(&tx_channels, sequence);
+    }
+    CHECK(differs);
+}
+
+/* Cada quadro sai no FRF do seu canal e o transmissor volta ao canal base; o
+   receptor que segue a sequência recebe todos, o que segue o número errado não */
+static void test_send_follow(void) {
+    const lora_channel_plan_t plan = LORA_PLAN_AU915_SUBBAND(1);
+    const lora_modem_config_t modem = LORA_MODEM_SF7_BW125;
+    setup(&plan, &modem);
+    rfm95_receive_irq_start(rx_radio, NULL);
+
+    for (uint8_t sequence = 0; sequence < 2 * plan.count; sequence++) {
+        uint8_t channel = lora_channels_for(&tx_channels, sequence);
+        uint32_t expected = frf_value(lora_channels_frf(&tx_channels, channel));
+        lora_channels_follow(&rx_channels, sequence);
+        CHECK_EQ(sx1276_sim_frf(&rx_sim), expected);
+
+        uint8_t frame[8] = { sequence };
+        CHECK(lora_channels_send(&tx_channels, sequence, frame, sizeof(frame), LORA_PRIO_NORMAL));
+        wait_tx_idle();
+        CHECK_EQ(tx_sim.hop_log_length, 1);              // o pacote inteiro num canal
+        CHECK_EQ(tx_sim.hop_log[0], expected);
+        CHECK_EQ(sx1276_sim_frf(&tx_sim), base_frf);
+
+        test_run_for_us(1000);
+        lora_packet_t* packet = rfm95_receive_irq_lease(rx_radio);
+        CHECK(packet != NULL);
+        CHECK_EQ(packet->data[0], sequence);
+        rfm95_receive_irq_release(rx_radio, packet);
+    }
+    CHECK_EQ(lora_channels_counters(&tx_channels)->frames, 2 * plan.count);
+    CHECK_EQ(lora_channels_counters(&rx_channels)->follows, 2 * plan.count);
+    CHECK_EQ(rfm95_hop_counters(tx_radio)->channel_frames, 2 * plan.count);
+
+    // Dentro de um ciclo dois quadros nunca dividem o canal
+    lora_channels_follow(&rx_channels, 2 * plan.count + 1);
+    uint8_t frame[8] = { 0xEE };
+    CHECK(lora_channels_send(&tx_channels, 2 * plan.count, frame, sizeof(frame), LORA_PRIO_NORMAL));
+    wait_tx_idle();
+    test_run_for_us(1000);
+    CHECK(rfm95_receive_irq_lease(rx_radio) == NULL);
+}
+
+/* FHSS nos dois lados: um quadro em SF12 passa por vários canais da tabela,
+   um a cada hop_period símbolos, todos atendidos a tempo, e chega inteiro */
+static void test_fhss(void) {
+    const lora_channel_plan_t plan = LORA_PLAN_AU915_SUBBAND(1);
+    const lora_modem_config_t modem = LORA_MODEM_SF12_BW125;
+    const uint8_t hop_period = 8;
+    setup(&plan, &modem);
+    CHECK(rfm95_set_fhss(tx_radio, lora_channels_frf(&tx_channels, 0), plan.count, hop_period));
+    CHECK(rfm95_set_fhss(rx_radio, lora_channels_frf(&rx_channels, 0), plan.count, hop_period));
+    rfm95_receive_irq_start(rx_radio, NULL);
+
+    uint8_t frame[20];
+    memset(frame, 0x3C, sizeof(frame));
+    CHECK(rfm95_tx_enqueue(tx_radio, frame, sizeof(frame), LORA_PRIO_NORMAL));
+    wait_tx_idle();
+    test_run_for_us(1000);
+
+    uint64_t step_us = hop_period * sx1276_sim_symbol_us(&tx_sim);
+    uint32_t hops = (uint32_t)((sx1276_sim_airtime_us(&tx_sim, sizeof(frame)) - 1) / step_us);
+    CHECK(hops >= 4);
+    CHECK_EQ(tx_sim.fhss_hops, hops);
+    CHECK_EQ(tx_sim.fhss_missed, 0);
+    CHECK_EQ(rfm95_hop_counters(tx_radio)->fhss_hops, hops);
+    CHECK_EQ(tx_sim.hop_log_length, hops + 1);
+    for (uint32_t i = 0; i <= hops; i++) {
+        CHECK_EQ(tx_sim.hop_log[i], frf_value(lora_channels_frf(&tx_channels, (uint8_t)i)));
+    }
+
+    // O receptor saltou junto, trecho a trecho
+    CHECK_EQ(rx_sim.fhss_hops, hops);
+    CHECK_EQ(rx_sim.fhss_missed, 0);
+    CHECK(memcmp(rx_sim.hop_log, tx_sim.hop_log, (hops + 1) * sizeof(uint32_t)) == 0);
+    lora_packet_t* packet = rfm95_receive_irq_lease(rx_radio);
+    CHECK(packet != NULL);
+    CHECK(packet->length == sizeof(frame) && memcmp(packet->data, frame, sizeof(frame)) == 0);
+    rfm95_receive_irq_release(rx_radio, packet);
+}
+
+/* Receptor sem a sequência: a varredura acha o canal do transmissor durante o
+   preâmbulo longo e o pacote ainda é recebido; sem transmissor ela volta ao
+   canal em que estava */
+static void test_scan(void) {
+    const lora_channel_plan_t plan = LORA_PLAN_AU915_SUBBAND(1);
+    lora_modem_config_t modem = LORA_MODEM_SF7_BW125;
+    setup(&plan, &modem);
+    modem.preamble_length = 4 * plan.count + 8;          // cobre duas voltas de CAD
+    CHECK(rfm95_set_modem_config(tx_radio, &modem) > 0);
+
+    lora_channels_follow(&rx_channels, 0);
+    uint8_t current = rx_channels.current;
+    CHECK_EQ(lora_channels_scan(&rx_channels, 2), -1);
+    CHECK_EQ(sx1276_sim_frf(&rx_sim), frf_value(lora_channels_frf(&rx_channels, current)));
+
+    const uint32_t sequence = 5;
+    uint8_t channel = lora_channels_for(&tx_channels, sequence);
+    CHECK(channel != current);
+    uint8_t frame[8] = { 0x55, 0xAA };
+    CHECK(lora_channels_send(&tx_channels, sequence, frame, sizeof(frame), LORA_PRIO_NORMAL));
+    test_run_for_us(1000);                               // preâmbulo no ar
+    CHECK_EQ(lora_channels_scan(&rx_channels, 2), channel);
+    CHECK_EQ(rx_channels.current, channel);
+    CHECK_EQ(sx1276_sim_frf(&rx_sim), frf_value(lora_channels_frf(&rx_channels, channel)));
+    rfm95_receive_irq_start(rx_radio, NULL);
+    wait_tx_idle();
+    test_run_for_us(1000);
+
+    lora_packet_t* packet = rfm95_receive_irq_lease(rx_radio);
+    CHECK(packet != NULL);
+    CHECK(packet->length == sizeof(frame) && memcmp(packet->data, frame, sizeof(frame)) == 0);
+    rfm95_receive_irq_release(rx_radio, packet);
+    CHECK_EQ(lora_channels_counters(&rx_channels)->scans, 2);
+    CHECK_EQ(lora_channels_counters(&rx_channels)->scan_hits, 1);
+}
+
+int main(void) {
+    RUN(test_sequence);
+    RUN(test_send_follow);
+    RUN(test_fhss);
+    RUN(test_scan);
+    return 0;
+}
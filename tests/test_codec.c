@@ -0,0 +1,203 @@
+// test_codec.c - Varint/zigzag nos extremos, entradas inválidas do LZ e
+// recuperação de um receptor sem referência
+#include <string.h>
+#include "test.h"
+#include "lora_codec.h"
+
+#define FIELDS 4
+
+static uint8_t encode_uvarint(uint32_t value, uint8_t* out) {
+    lora_codec_writer_t writer;
+    lora_codec_writer_init(&writer, out, 8);
+    lora_codec_put_uvarint(&writer, value);
+    CHECK(!writer.overflow);
+    return writer.length;
+}
+
+/* Zigzag e varint de 0 a INT32_MIN/MAX: tamanhos, ida e volta e o limite do
+   escritor; varint truncado ou com mais de 5 bytes é erro, não um valor */
+static void test_varint_edges(void) {
+    CHECK_EQ(lora_codec_zigzag(0), 0);
+    CHECK_EQ(lora_codec_zigzag(-1), 1);
+    CHECK_EQ(lora_codec_zigzag(1), 2);
+    CHECK_EQ(lora_codec_zigzag(INT32_MAX), 0xFFFFFFFEu);
+    CHECK_EQ(lora_codec_zigzag(INT32_MIN), 0xFFFFFFFFu);
+    CHECK_EQ(lora_codec_unzigzag(0xFFFFFFFEu), INT32_MAX);
+    CHECK_EQ(lora_codec_unzigzag(0xFFFFFFFFu), INT32_MIN);
+
+    uint8_t buffer[8];
+    CHECK_EQ(encode_uvarint(0, buffer), 1);
+    CHECK_EQ(encode_uvarint(127, buffer), 1);
+    CHECK_EQ(encode_uvarint(128, buffer), 2);
+    CHECK_EQ(encode_uvarint(UINT32_MAX, buffer), 5);
+
+    const int32_t values[] = { 0, -1, 1, 63, -64, 64, INT32_MAX, INT32_MIN, INT32_MAX - 1, INT32_MIN + 1 };
+    uint8_t stream[64];
+    lora_codec_writer_t writer;
+    lora_codec_writer_init(&writer, stream, sizeof(stream));
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        lora_codec_put_svarint(&writer, values[i]);
+    }
+    CHECK(!writer.overflow);
+    lora_codec_reader_t reader;
+    lora_codec_reader_init(&reader, stream, writer.length);
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        CHECK_EQ(lora_codec_get_svarint(&reader), values[i]);
+    }
+    CHECK(!reader.error);
+    CHECK_EQ(reader.position, writer.length);
+
+    // Os quatro primeiros bytes de um varint de 5: falta o último
+    uint8_t length = encode_uvarint(UINT32_MAX, buffer);
+    lora_codec_reader_init(&reader, buffer, length - 1);
+    CHECK_EQ(lora_codec_get_uvarint(&reader), 0);
+    CHECK(reader.error);
+
+    // Continuação no quinto byte: passaria de 32 bits
+    const uint8_t too_long[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0x8F, 0x01 };
+    lora_codec_reader_init(&reader, too_long, sizeof(too_long));
+    CHECK_EQ(lora_codec_get_uvarint(&reader), 0);
+    CHECK(reader.error);
+
+    // Quinto byte com bits além do 32º
+    const uint8_t overflow[5] = { 0xFF, 0xFF, 0xFF, 0xFF, 0x1F };
+    lora_codec_reader_init(&reader, overflow, sizeof(overflow));
+    CHECK_EQ(lora_codec_get_uvarint(&reader), 0);
+    CHECK(reader.error);
+
+    // Escritor cheio: marca o overflow e não passa do limite
+    memset(buffer, 0xAA, sizeof(buffer));
+    lora_codec_writer_init(&writer, buffer, 4);
+    lora_codec_put_svarint(&writer, INT32_MIN);
+    CHECK(writer.overflow);
+    CHECK(writer.length <= 4);
+    CHECK_EQ(buffer[4], 0xAA);
+}
+
+/* Entradas inválidas do LZ retornam -1 sem escrever fora da saída: distância
+   antes do início, cópia ou literais além da capacidade e controles cortados */
+static void test_lz_malformed(void) {
+    uint8_t out[16];
+    memset(out, 0xEE, sizeof(out));
+
+    // Cópia logo no início, sem bytes produzidos
+    const uint8_t no_history[] = { 0x80, 0x00 };
+    CHECK_EQ(lora_codec_lz_decompress(no_history, sizeof(no_history), out, 8), -1);
+
+    // Distância maior que os 2 bytes já produzidos
+    const uint8_t far[] = { 0x01, 'a', 'b', 0x80, 0x02 };
+    CHECK_EQ(lora_codec_lz_decompress(far, sizeof(far), out, 8), -1);
+    const uint8_t near[] = { 0x01, 'a', 'b', 0x80, 0x01 };
+    CHECK_EQ(lora_codec_lz_decompress(near, sizeof(near), out, 8), 5);
+    CHECK(memcmp(out, "ababa", 5) == 0);
+
+    // Cópia que estoura a capacidade: 2 + 130 bytes em 8
+    memset(out, 0xEE, sizeof(out));
+    const uint8_t long_copy[] = { 0x01, 'a', 'b', 0xFF, 0x00 };
+    CHECK_EQ(lora_codec_lz_decompress(long_copy, sizeof(long_copy), out, 8), -1);
+    CHECK_EQ(out[8], 0xEE);
+
+    // Literais além da capacidade e além da entrada
+    const uint8_t literals[] = { 0x09, '0', '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    CHECK_EQ(lora_codec_lz_decompress(literals, sizeof(literals), out, 8), -1);
+    CHECK_EQ(out[8], 0xEE);
+    CHECK_EQ(lora_codec_lz_decompress(literals, sizeof(literals) - 1, out, sizeof(out)), -1);
+
+    // Controle de cópia sem o byte de distância
+    const uint8_t cut[] = { 0x01, 'a', 'b', 0x80 };
+    CHECK_EQ(lora_codec_lz_decompress(cut, sizeof(cut), out, sizeof(out)), -1);
+
+    // O compressor também respeita a capacidade
+    const char* text = "temp=21.5;temp=21.5;temp=21.5;temp=21.5";
+    uint8_t length = (uint8_t)strlen(text);
+    uint8_t packed[LORA_CODEC_LZ_BOUND(64)];
+    uint8_t packed_length = lora_codec_lz_compress((const uint8_t*)text, length, packed, sizeof(packed));
+    CHECK(packed_length > 0 && packed_length < length);
+    CHECK_EQ(lora_codec_lz_compress((const uint8_t*)text, length, packed, packed_length - 1), 0);
+    uint8_t unpacked[64];
+    CHECK_EQ(lora_codec_lz_decompress(packed, packed_length, unpacked, sizeof(unpacked)), length);
+    CHECK(memcmp(unpacked, text, length) == 0);
+    CHECK_EQ(lora_codec_lz_decompress(packed, packed_length, unpacked, length - 1), -1);
+}
+
+static void sample(uint32_t n, int32_t* values) {
+    values[0] = 2150 + (int32_t)(n % 7);                 // temperatura
+    values[1] = -87 - (int32_t)(n % 3);                  // RSSI
+    values[2] = (int32_t)(n * 1000);                     // contador
+    values[3] = n % 2 ? INT32_MIN : INT32_MAX;           // salto de 2^32 - 1 no delta
+}
+
+/* Receptor reiniciado (sem o quadro de referência): os deltas são recusados
+   sem alterar values, o quadro completo forçado depois de
+   LORA_CODEC_KEYFRAME_INTERVAL deltas é decodificado e, confirmado, volta a
+   servir de referência para os deltas seguintes */
+static void test_delta_recovery(void) {
+    lora_codec_stream_t tx;
+    lora_codec_stream_t rx;
+    lora_codec_stream_init(&tx, FIELDS, true);
+    lora_codec_stream_init(&rx, FIELDS, true);
+    int32_t values[FIELDS];
+    int32_t decoded[FIELDS];
+    uint8_t frame[64];
+    uint8_t id;
+    uint32_t n = 0;
+
+    // Quadro completo recebido e confirmado, depois um delta
+    sample(n++, values);
+    uint8_t length = lora_codec_encode(&tx, values, frame, sizeof(frame), &id);
+    CHECK(length > 0 && !(frame[0] & LORA_CODEC_FLAG_DELTA));
+    CHECK_EQ(lora_codec_decode(&rx, frame, length, decoded), LORA_CODEC_OK);
+    lora_codec_ack(&tx, id);
+    sample(n++, values);
+    length = lora_codec_encode(&tx, values, frame, sizeof(frame), &id);
+    CHECK(frame[0] & LORA_CODEC_FLAG_DELTA);
+    CHECK_EQ(lora_codec_decode(&rx, frame, length, decoded), LORA_CODEC_OK);
+    CHECK(memcmp(decoded, values, sizeof(values)) == 0);
+
+    // O receptor reinicia e perde o histórico
+    lora_codec_stream_init(&rx, FIELDS, true);
+    uint32_t deltas = 1;
+    for (;;) {
+        sample(n++, values);
+        length = lora_codec_encode(&tx, values, frame, sizeof(frame), &id);
+        CHECK(length > 0);
+        if (!(frame[0] & LORA_CODEC_FLAG_DELTA)) break;
+        deltas++;
+        memset(decoded, 0x5A, sizeof(decoded));
+        CHECK_EQ(lora_codec_decode(&rx, frame, length, decoded), LORA_CODEC_NO_REFERENCE);
+        CHECK_EQ(decoded[0], 0x5A5A5A5A);
+    }
+    CHECK_EQ(deltas, LORA_CODEC_KEYFRAME_INTERVAL);
+    CHECK_EQ(lora_codec_counters(&rx)->no_reference, LORA_CODEC_KEYFRAME_INTERVAL - 1);
+    CHECK_EQ(lora_codec_decode(&rx, frame, length, decoded), LORA_CODEC_OK);
+    CHECK(memcmp(decoded, values, sizeof(values)) == 0);
+    lora_codec_ack(&tx, id);
+
+    for (int i = 0; i < 4; i++) {
+        sample(n++, values);
+        length = lora_codec_encode(&tx, values, frame, sizeof(frame), &id);
+        CHECK(frame[0] & LORA_CODEC_FLAG_DELTA);
+        CHECK_EQ(lora_codec_decode(&rx, frame, length, decoded), LORA_CODEC_OK);
+        CHECK(memcmp(decoded, values, sizeof(values)) == 0);
+    }
+    CHECK_EQ(lora_codec_counters(&rx)->frames, 5);
+    CHECK_EQ(lora_codec_counters(&rx)->keyframes, 1);
+    CHECK_EQ(lora_codec_counters(&rx)->malformed, 0);
+
+    // Quadros cortados ou com outro número de campos não chegam a values
+    memset(decoded, 0x5A, sizeof(decoded));
+    CHECK_EQ(lora_codec_decode(&rx, frame, 1, decoded), LORA_CODEC_MALFORMED);
+    CHECK_EQ(lora_codec_decode(&rx, frame, LORA_CODEC_DELTA_HEADER_SIZE, decoded), LORA_CODEC_MALFORMED);
+    CHECK_EQ(lora_codec_decode(&rx, frame, length - 1, decoded), LORA_CODEC_MALFORMED);
+    frame[0] = (frame[0] & 0xF0) | (FIELDS - 2);
+    CHECK_EQ(lora_codec_decode(&rx, frame, length, decoded), LORA_CODEC_MALFORMED);
+    CHECK_EQ(decoded[0], 0x5A5A5A5A);
+    CHECK_EQ(lora_codec_counters(&rx)->malformed, 4);
+}
+
+int main(void) {
+    RUN(test_varint_edges);
+    RUN(test_lz_malformed);
+    RUN(test_delta_recovery);
+    return 0;
+}
@@ -0,0 +1,234 @@
+// test_dutycycle.c - Tempo no ar (grade SF/BW/CR) e escalonador com orçamento
+#include <math.h>
+#include <string.h>
+#include "test.h"
+#include "rfm95_lora.h"
+#include "lora_dutycycle.h"
+#include "sim/sx1276_sim.h"
+
+// Larguras de banda nominais do datasheet do SX1276 (tabela 13), em Hz
+static const double reference_bw_hz[] = {
+    7800, 10400, 15600, 20800, 31250, 41700, 62500, 125000, 250000, 500000
+};
+
+/* Fórmula da Semtech (AN1200.13 / datasheet do SX1276, seção 4.1.1.7) em
+   ponto flutuante; retorna us, ou 0 para as combinações que o rádio não aceita.
+   O driver satura em UINT32_MAX (preâmbulos de milhares de símbolos) */
+static double reference_toa_us(const lora_modem_config_t* cfg, int payload) {
+    int sf = cfg->spreading_factor;
+    double symbol_s = pow(2.0, sf) / reference_bw_hz[cfg->bandwidth];
+    bool ldro_required = symbol_s > 0.016;
+    if (sf == 6 && !cfg->implicit_header) return 0.0;
+    if (cfg->ldro == LORA_LDRO_OFF && ldro_required) return 0.0;
+    int de = (cfg->ldro == LORA_LDRO_ON || ldro_required) ? 1 : 0;
+
+    double preamble_s = (cfg->preamble_length + 4.25) * symbol_s;
+    double blocks = ceil((8.0 * payload - 4.0 * sf + 28 + 16 * cfg->crc - 20 * cfg->implicit_header) /
+                         (4.0 * (sf - 2 * de)));
+    double payload_symbols = 8 + fmax(blocks * (cfg->coding_rate + 4), 0.0);
+    return (preamble_s + payload_symbols * symbol_s) * 1e6;
+}
+
+/* Toda a grade SF6-12 x 10 larguras x CR 4/5-4/8 x CRC x cabeçalho x LDRO,
+   com preâmbulos e payloads variados */
+static void test_time_on_air_grid(void) {
+    static const uint16_t preambles[] = { 6, 8, 12, 65535 };
+    uint32_t checked = 0;
+    for (uint8_t sf = 6; sf <= 12; sf++) {
+        for (int bw = LORA_BW_7K8; bw <= LORA_BW_500K; bw++) {
+            for (int cr = LORA_CR_4_5; cr <= LORA_CR_4_8; cr++) {
+                for (int flags = 0; flags < 4; flags++) {
+                    for (int ldro = LORA_LDRO_AUTO; ldro <= LORA_LDRO_ON; ldro++) {
+                        for (size_t p = 0; p < sizeof(preambles) / sizeof(preambles[0]); p++) {
+                            lora_modem_config_t cfg = {
+                                sf, (lora_bandwidth_t)bw, (lora_coding_rate_t)cr, preambles[p],
+                                flags & 1, (flags & 2) != 0, (lora_ldro_t)ldro
+                            };
+                            for (int payload = 0; payload <= LORA_MAX_PACKET_SIZE; payload += 17) {
+                                double expected = reference_toa_us(&cfg, payload);
+                                uint32_t got = lora_time_on_air_config_us(&cfg, (uint8_t)payload);
+                                if (expected == 0.0) {
+                                    CHECK_EQ(got, 0);
+                                } else {
+                                    CHECK(fabs(got - fmin(expected, UINT32_MAX)) <= 1.0);
+                                }
+                                checked++;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    CHECK(checked > 100000);
+}
+
+/* Pontos conhecidos (calculadora de tempo no ar da Semtech) */
+static void test_time_on_air_known(void) {
+    lora_modem_config_t sf7 = LORA_MODEM_SF7_BW125;
+    CHECK_EQ(lora_time_on_air_config_us(&sf7, 20), 56576);
+    lora_modem_config_t sf12 = LORA_MODEM_SF12_BW125;
+    sf12.coding_rate = LORA_CR_4_5;
+    CHECK_EQ(lora_time_on_air_config_us(&sf12, 51), 2465792);
+    lora_modem_config_t sf6 = { 6, LORA_BW_500K, LORA_CR_4_5, 8, true, false, LORA_LDRO_AUTO };
+    CHECK_EQ(lora_time_on_air_config_us(&sf6, 10), 0);           // SF6 só com cabeçalho implícito
+}
+
+// Escalonador sobre o segundo módulo do driver (não a instância padrão)
+#define DC_CS    40
+#define DC_RST   41
+#define DC_DIO0  42
+#define DC_DIO1  43
+
+static sx1276_sim_t sim;
+static rfm95_t* radio;
+
+typedef struct {
+    uint8_t data[LORA_MAX_PACKET_SIZE];
+    uint8_t length;
+    uint32_t frf;
+    uint64_t at_us;
+    uint64_t airtime_us;
+} air_frame_t;
+
+static air_frame_t air[16];
+static uint32_t air_count;
+
+static void tx_hook(void* ctx, sx1276_sim_t* r, const uint8_t* data, uint8_t length, uint64_t airtime_us) {
+    (void)ctx;
+    if (air_count < sizeof(air) / sizeof(air[0])) {
+        air_frame_t* frame = &air[air_count];
+        memcpy(frame->data, data, length);
+        frame->length = length;
+        frame->frf = sx1276_sim_frf(r);
+        frame->at_us = hal_time_us();
+        frame->airtime_us = airtime_us;
+    }
+    air_count++;
+}
+
+static void setup(void) {
+    hal_host_reset();
+    sx1276_sim_init(&sim, spi1, DC_CS, DC_RST, DC_DIO0, DC_DIO1);
+    sx1276_sim_set_tx_hook(&sim, tx_hook, NULL);
+    rfm95_pins_t pins = RFM95_PINS_DEFAULT;
+    pins.spi = spi1;
+    pins.cs = DC_CS;
+    pins.rst = DC_RST;
+    pins.dio0 = DC_DIO0;
+    pins.dio1 = DC_DIO1;
+    radio = rfm95_radio(1);
+    CHECK(rfm95_init(radio, &pins, NULL));
+    air_count = 0;
+}
+
+static uint32_t frf24(uint32_t frequency_hz) {
+    lora_frf_t frf = lora_frf(frequency_hz);
+    return ((uint32_t)frf.reg[0] << 16) | ((uint32_t)frf.reg[1] << 8) | frf.reg[2];
+}
+
+/* Quadros da fila do escalonador: cada um sai com o próprio conteúdo, mesmo
+   com os seguintes andando na fila antes de a FIFO ser carregada (com LBT,
+   só depois do CAD), e o buffer do chamador pode ser reusado logo depois */
+static void test_queue_contents(void) {
+    setup();
+    lora_lbt_config_t lbt = LORA_LBT_CONFIG_DEFAULT;
+    CHECK(rfm95_set_lbt(radio, &lbt));
+    lora_dc_t dc;
+    lora_dc_limits_t limits = LORA_DC_LIMITS_1_PERCENT;
+    lora_dc_init(&dc, radio, &limits, 1);
+
+    uint8_t frame[64];
+    for (uint8_t i = 0; i < LORA_DC_QUEUE_SIZE + 1; i++) {
+        memset(frame, 'A' + i, sizeof(frame));
+        CHECK_EQ(lora_dc_send(&dc, 0, frame, sizeof(frame)), i == 0 ? LORA_DC_SENT : LORA_DC_QUEUED);
+    }
+    memset(frame, 0, sizeof(frame));
+    CHECK_EQ(lora_dc_pending(&dc), LORA_DC_QUEUE_SIZE);
+
+    while (lora_dc_pending(&dc) > 0 || rfm95_tx_busy(radio)) {
+        lora_dc_service(&dc);
+        hal_yield();
+    }
+    CHECK_EQ(air_count, LORA_DC_QUEUE_SIZE + 1);
+    for (uint32_t i = 0; i < air_count; i++) {
+        CHECK_EQ(air[i].length, sizeof(frame));
+        for (size_t b = 0; b < sizeof(frame); b++) {
+            CHECK_EQ(air[i].data[b], 'A' + i);
+        }
+    }
+    CHECK_EQ(dc.sent, LORA_DC_QUEUE_SIZE + 1);
+    CHECK_EQ(rfm95_tx_queue_counters(radio)->dropped, 0);
+}
+
+/* O orçamento da janela nunca é excedido; o quadro seguinte sai quando o
+   intervalo mais antigo expira */
+static void test_budget(void) {
+    setup();
+    uint8_t frame[20] = { 0 };
+    uint32_t airtime_us = rfm95_time_on_air_us(radio, sizeof(frame));
+    lora_dc_limits_t limits = { 16000, 3 * airtime_us, 0 };      // janela de 16 s, 3 quadros
+    lora_dc_t dc;
+    lora_dc_init(&dc, radio, &limits, 1);
+
+    CHECK_EQ(lora_dc_remaining_us(&dc, 0), 3 * airtime_us);
+    for (int i = 0; i < 3; i++) {
+        while (rfm95_tx_busy(radio)) {
+            hal_yield();
+        }
+        CHECK_EQ(lora_dc_send(&dc, 0, frame, sizeof(frame)), LORA_DC_SENT);
+    }
+    CHECK_EQ(lora_dc_remaining_us(&dc, 0), 0);
+    uint32_t wait_us = lora_dc_wait_us(&dc, 0, sizeof(frame));
+    CHECK(wait_us > 0 && wait_us <= 16000000);
+    CHECK_EQ(lora_dc_send(&dc, 0, frame, sizeof(frame)), LORA_DC_QUEUED);
+    CHECK_EQ(dc.delayed, 1);
+
+    uint64_t until_us = hal_time_us() + wait_us;
+    while (lora_dc_pending(&dc) > 0) {
+        lora_dc_service(&dc);
+        hal_yield();
+    }
+    CHECK_EQ(air_count, 4);
+    CHECK(air[3].at_us >= until_us);
+    CHECK(air[3].at_us - air[0].at_us >= 16000000 / LORA_DC_BUCKETS * (LORA_DC_BUCKETS - 1));
+
+    // Dwell: um quadro maior que o limite é recusado
+    limits.max_dwell_us = airtime_us - 1;
+    lora_dc_init(&dc, radio, &limits, 1);
+    CHECK_EQ(lora_dc_send(&dc, 0, frame, sizeof(frame)), LORA_DC_REJECTED);
+    CHECK_EQ(lora_dc_send(&dc, 1, frame, 1), LORA_DC_REJECTED);   // canal inexistente
+    CHECK_EQ(dc.rejected, 2);
+}
+
+/* Cada canal sai na sua frequência e o rádio volta ao canal base */
+static void test_channel_frequency(void) {
+    setup();
+    lora_dc_t dc;
+    lora_dc_limits_t limits = LORA_DC_LIMITS_1_PERCENT;
+    lora_dc_init(&dc, radio, &limits, 2);
+    lora_dc_set_channel_frequency(&dc, 1, 916800000);
+    uint32_t base = sx1276_sim_frf(&sim);
+
+    uint8_t frame[8] = { 1 };
+    CHECK_EQ(lora_dc_send(&dc, 1, frame, sizeof(frame)), LORA_DC_SENT);
+    CHECK_EQ(lora_dc_send(&dc, 0, frame, sizeof(frame)), LORA_DC_QUEUED);
+    while (lora_dc_pending(&dc) > 0 || rfm95_tx_busy(radio)) {
+        lora_dc_service(&dc);
+        hal_yield();
+    }
+    CHECK_EQ(air_count, 2);
+    CHECK_EQ(air[0].frf, frf24(916800000));
+    CHECK_EQ(air[1].frf, base);
+    CHECK_EQ(sx1276_sim_frf(&sim), base);
+    CHECK(lora_dc_remaining_us(&dc, 0) == lora_dc_remaining_us(&dc, 1));
+}
+
+int main(void) {
+    RUN(test_time_on_air_grid);
+    RUN(test_time_on_air_known);
+    RUN(test_queue_contents);
+    RUN(test_budget);
+    RUN(test_channel_frequency);
+    return 0;
+}
@@ -0,0 +1,213 @@
+// test_fec.c - Grupos FEC com perdas, atrasos e reinícios do transmissor
+#include <string.h>
+#include "test.h"
+#include "lora_fec.h"
+#include "sim/sx1276_sim.h"
+
+#define AIR_MAX    256
+#define BOOTS      8
+#define PER_BOOT   96
+
+static sx1276_sim_t sim;
+static lora_fec_encoder_t encoder;
+static lora_fec_decoder_t decoder;
+
+// Pacotes postos no ar pelo transmissor, na ordem
+static uint8_t air[AIR_MAX][LORA_MAX_PACKET_SIZE];
+static uint8_t air_length[AIR_MAX];
+static uint32_t air_count;
+static uint32_t air_fed;
+
+// Entregas por (boot, número do quadro)
+static uint8_t delivered[BOOTS][PER_BOOT];
+static uint8_t boot;
+static uint8_t sent;
+
+static void tx_hook(void* ctx, sx1276_sim_t* radio, const uint8_t* data, uint8_t length, uint64_t airtime_us) {
+    (void)ctx;
+    (void)radio;
+    (void)airtime_us;
+    CHECK(air_count < AIR_MAX);
+    memcpy(air[air_count], data, length);
+    air_length[air_count++] = length;
+}
+
+static void on_frame(const uint8_t* frame, uint8_t length, bool recovered) {
+    (void)recovered;
+    CHECK(length >= 2 && frame[0] < BOOTS && frame[1] < PER_BOOT);
+    CHECK_EQ(length, 2 + frame[1] % 5);                  // o tamanho original, sem o preenchimento
+    delivered[frame[0]][frame[1]]++;
+}
+
+static void setup(uint8_t k, uint8_t m) {
+    hal_host_reset();
+    memset(delivered, 0, sizeof(delivered));
+    air_count = 0;
+    air_fed = 0;
+    boot = 0;
+    sent = 0;
+    sx1276_sim_init(&sim, SPI_PORT, PIN_CS, PIN_RST, PIN_DIO0, PIN_DIO1);
+    sx1276_sim_set_tx_hook(&sim, tx_hook, NULL);
+    CHECK(lora_init());
+    CHECK(lora_fec_encoder_init(&encoder, rfm95_radio(0), k, m));
+    lora_fec_decoder_init(&decoder, on_frame);
+}
+
+/* Transmissor reiniciado: grupos voltam a 0 e o primeiro leva SYNC */
+static void reboot(uint8_t k, uint8_t m) {
+    CHECK(lora_fec_encoder_init(&encoder, rfm95_radio(0), k, m));
+    boot++;
+    sent = 0;
+}
+
+/* Envia groups grupos completos e espera todos os pacotes saírem */
+static void send_groups(uint8_t groups) {
+    for (uint8_t g = 0; g < groups; g++) {
+        for (uint8_t i = 0; i < encoder.k; i++) {
+            // Cheia, a fila do driver descarta os quadros mais antigos: um por vez
+            uint8_t frame[2 + 4] = { boot, sent, 0xA5, 0x5A, 0xC3, 0x3C };
+            while (lora_tx_queue_length() > 0 || !lora_fec_send(&encoder, frame, 2 + sent % 5, LORA_PRIO_NORMAL)) {
+                test_run_for_us(10000);
+            }
+            sent++;
+        }
+    }
+    while (lora_fec_repairs_pending(&encoder) > 0 || lora_tx_queue_length() > 0) {
+        lora_fec_service(&encoder);
+        test_run_for_us(10000);
+    }
+    test_run_for_us(1000000);
+}
+
+/* Entrega ao decodificador os pacotes ainda não entregues, menos os que
+   drop aponta (posição do pacote no grupo de k + m) */
+static void feed(bool (*drop)(uint32_t position)) {
+    uint8_t period = encoder.k + encoder.m;
+    for (; air_fed < air_count; air_fed++) {
+        if (drop && drop(air_fed % period)) continue;
+        lora_fec_receive(&decoder, air[air_fed], air_length[air_fed]);
+    }
+}
+
+static void check_all_delivered_once(void) {
+    for (uint8_t b = 0; b <= boot; b++) {
+        for (uint8_t n = 0; n < PER_BOOT; n++) {
+            if (delivered[b][n] > 1) {
+                fprintf(stderr, "boot %u quadro %u entregue %u vezes\n", b, n, delivered[b][n]);
+            }
+            CHECK(delivered[b][n] <= 1);
+        }
+    }
+}
+
+static uint32_t delivered_count(uint8_t b) {
+    uint32_t count = 0;
+    for (uint8_t n = 0; n < PER_BOOT; n++) count += delivered[b][n];
+    return count;
+}
+
+static bool drop_two_data(uint32_t position) {
+    return position == 1 || position == 3;
+}
+
+static bool drop_one_data(uint32_t position) {
+    return position == 2;
+}
+
+/* Até M perdas por grupo são reconstruídas, cada quadro entregue uma vez */
+static void test_recovery(void) {
+    setup(4, 2);
+    send_groups(6);
+    feed(drop_two_data);
+    check_all_delivered_once();
+    CHECK_EQ(delivered_count(0), 24);
+    CHECK_EQ(lora_fec_rx_counters(&decoder)->recovered, 12);
+    CHECK_EQ(lora_fec_rx_counters(&decoder)->unrecoverable, 0);
+    CHECK_EQ(lora_fec_rx_counters(&decoder)->resyncs, 0);
+}
+
+/* Transmissor reiniciado com o receptor de pé: o grupo volta a 0 (atrás do
+   receptor, ou igual ao grupo atual) e nenhum quadro é descartado */
+static void test_transmitter_reboot(void) {
+    setup(4, 1);
+    send_groups(10);                                     // receptor no grupo 9
+    feed(drop_one_data);
+    reboot(4, 1);
+    send_groups(3);                                      // grupos 0..2 de novo
+    feed(drop_one_data);
+    for (int i = 0; i < 3; i++) {                        // reinicia a cada grupo: sempre o grupo 0
+        reboot(4, 1);
+        send_groups(1);
+        feed(drop_one_data);
+    }
+
+    check_all_delivered_once();
+    CHECK_EQ(delivered_count(0), 40);
+    CHECK_EQ(delivered_count(1), 12);
+    for (uint8_t b = 2; b <= boot; b++) {
+        CHECK_EQ(delivered_count(b), 4);
+    }
+    const lora_fec_rx_counters_t* c = lora_fec_rx_counters(&decoder);
+    CHECK_EQ(c->resyncs, 4);
+    CHECK_EQ(c->recovered, 16);
+    CHECK_EQ(c->unrecoverable, 0);
+    CHECK_EQ(c->invalid, 0);
+}
+
+/* Sem SYNC (primeiro quadro após o reinício perdido, ou um transmissor
+   antigo), um salto grande para trás também recomeça a contagem */
+static void test_resync_without_flag(void) {
+    setup(4, 1);
+    send_groups(20);
+    feed(NULL);
+    reboot(4, 1);
+    send_groups(2);
+    for (uint32_t i = air_fed; i < air_count; i++) {
+        air[i][1] &= LORA_FEC_INDEX_MASK;
+    }
+    feed(drop_one_data);
+    check_all_delivered_once();
+    CHECK_EQ(delivered_count(0), 80);
+    CHECK_EQ(delivered_count(1), 8);
+    CHECK_EQ(lora_fec_rx_counters(&decoder)->resyncs, 1);
+    CHECK_EQ(lora_fec_rx_counters(&decoder)->recovered, 2);
+}
+
+/* Quadro atrasado de um grupo anterior: o dado é entregue (uma vez só), o
+   reparo é descartado e o grupo atual segue intacto */
+static void test_late_frames(void) {
+    setup(4, 1);
+    send_groups(3);
+    // Grupo 0 sem o dado 2 nem o reparo: irrecuperável quando o grupo 1 chega
+    for (uint32_t i = 0; i < 5; i++) {
+        if (i != 2 && i != 4) lora_fec_receive(&decoder, air[i], air_length[i]);
+    }
+    lora_fec_receive(&decoder, air[5], air_length[5]);
+    CHECK_EQ(lora_fec_rx_counters(&decoder)->unrecoverable, 1);
+    CHECK_EQ(lora_fec_receive(&decoder, air[2], air_length[2]), LORA_FEC_RX_DATA);
+    CHECK_EQ(delivered[0][2], 1);
+    CHECK_EQ(lora_fec_receive(&decoder, air[2], air_length[2]), LORA_FEC_RX_STORED);   // duplicata
+    CHECK_EQ(lora_fec_receive(&decoder, air[4], air_length[4]), LORA_FEC_RX_INVALID);  // reparo velho
+
+    // Grupo 1 segue: o dado 7 (posição 2) chega depois do grupo 2 inteiro e
+    // já foi reconstruído pelo reparo, então não sai de novo
+    for (uint32_t i = 6; i < 15; i++) {
+        if (i != 7) lora_fec_receive(&decoder, air[i], air_length[i]);
+    }
+    CHECK_EQ(lora_fec_receive(&decoder, air[7], air_length[7]), LORA_FEC_RX_STORED);
+
+    check_all_delivered_once();
+    CHECK_EQ(delivered_count(0), 12);
+    const lora_fec_rx_counters_t* c = lora_fec_rx_counters(&decoder);
+    CHECK_EQ(c->late, 1);
+    CHECK_EQ(c->resyncs, 0);
+    CHECK_EQ(c->recovered, 1);
+}
+
+int main(void) {
+    RUN(test_recovery);
+    RUN(test_transmitter_reboot);
+    RUN(test_resync_without_flag);
+    RUN(test_late_frames);
+    return 0;
+}
@@ -0,0 +1,132 @@
+// test_link.c - Sequência por origem: perdas, duplicatas, atrasos e reinícios
+#include <string.h>
+#include "test.h"
+#include "lora_link.h"
+
+#define ADDR_TX 0x10
+#define ADDR_RX 0x01
+
+static lora_link_t tx;
+static lora_link_t rx;
+
+static void setup(void) {
+    hal_host_reset();
+    lora_link_init(&tx, ADDR_TX);
+    lora_link_init(&rx, ADDR_RX);
+}
+
+// Quadro com a sequência e as flags dadas, como lora_link_encode() montaria
+static lora_link_rx_result_t receive_seq(uint8_t seq, uint8_t flags) {
+    uint8_t frame[LORA_LINK_HEADER_SIZE + 1] = { ADDR_RX, ADDR_TX, seq, (uint8_t)(flags << 4), 0x55 };
+    lora_link_header_t header;
+    const uint8_t* payload;
+    uint8_t payload_length;
+    return lora_link_receive(&rx, frame, sizeof(frame), &header, &payload, &payload_length);
+}
+
+// Próximo quadro do transmissor (a primeira chamada leva FLAG_SYNC)
+static lora_link_rx_result_t send_next(bool deliver) {
+    uint8_t frame[LORA_MAX_PACKET_SIZE];
+    lora_link_payload(frame)[0] = 0x55;
+    uint8_t length = lora_link_encode(&tx, frame, ADDR_RX, 1, 0, 1);
+    if (!deliver) return LORA_LINK_RX_INVALID;
+    lora_link_header_t header;
+    const uint8_t* payload;
+    uint8_t payload_length;
+    return lora_link_receive(&rx, frame, length, &header, &payload, &payload_length);
+}
+
+static const lora_link_source_t* source(void) {
+    return lora_link_source(&rx, ADDR_TX);
+}
+
+/* Lacunas contam como perdas; atrasados descontam; repetidos são duplicatas */
+static void test_loss_and_reorder(void) {
+    setup();
+    for (int i = 0; i < 10; i++) {
+        CHECK_EQ(send_next(i != 3 && i != 4 && i != 7), i == 3 || i == 4 || i == 7 ? LORA_LINK_RX_INVALID
+                                                                                    : LORA_LINK_RX_NEW);
+    }
+    CHECK_EQ(source()->lost, 3);
+    CHECK_EQ(source()->received, 7);
+    CHECK_EQ(receive_seq(4, 0), LORA_LINK_RX_NEW);       // atrasado preenche a lacuna
+    CHECK_EQ(source()->lost, 2);
+    CHECK_EQ(source()->reordered, 1);
+    CHECK_EQ(receive_seq(4, 0), LORA_LINK_RX_DUPLICATE);
+    CHECK_EQ(receive_seq(9, 0), LORA_LINK_RX_DUPLICATE);
+    CHECK_EQ(source()->duplicates, 2);
+    CHECK_EQ(source()->resyncs, 0);
+}
+
+/* Origem reiniciada: o primeiro quadro (FLAG_SYNC) recomeça a contagem em
+   qualquer direção, sem perdas pelo salto e sem ser tomado como duplicata */
+static void test_sync_resets(void) {
+    static const struct { uint8_t highest; uint8_t seq; } cases[] = {
+        { 10, 0 },       // para trás, dentro da janela
+        { 100, 0 },      // para trás, além da janela
+        { 10, 60 },      // para frente: não são 49 perdas
+        { 10, 137 },     // para frente, no limite do int8
+        { 10, 10 },      // mesma sequência: não é duplicata
+        { 250, 3 },      // dando a volta nos 8 bits
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        setup();
+        CHECK_EQ(receive_seq((uint8_t)(cases[i].highest - 2), LORA_LINK_FLAG_SYNC), LORA_LINK_RX_NEW);
+        CHECK_EQ(receive_seq((uint8_t)(cases[i].highest - 1), 0), LORA_LINK_RX_NEW);
+        CHECK_EQ(receive_seq(cases[i].highest, 0), LORA_LINK_RX_NEW);
+        CHECK_EQ(source()->lost, 0);
+
+        CHECK_EQ(receive_seq(cases[i].seq, LORA_LINK_FLAG_SYNC), LORA_LINK_RX_NEW);
+        CHECK_EQ(source()->lost, 0);
+        CHECK_EQ(source()->resyncs, 1);
+        CHECK_EQ(source()->highest_seq, cases[i].seq);
+
+        // A contagem continua da nova sequência
+        CHECK_EQ(receive_seq((uint8_t)(cases[i].seq + 1), 0), LORA_LINK_RX_NEW);
+        CHECK_EQ(receive_seq((uint8_t)(cases[i].seq + 3), 0), LORA_LINK_RX_NEW);
+        CHECK_EQ(source()->lost, 1);
+        CHECK_EQ(receive_seq((uint8_t)(cases[i].seq + 1), 0), LORA_LINK_RX_DUPLICATE);
+    }
+}
+
+/* Sem FLAG_SYNC, só um salto para trás além da janela recomeça a contagem */
+static void test_resync_without_flag(void) {
+    setup();
+    for (int i = 0; i < 50; i++) {
+        send_next(true);
+    }
+    CHECK_EQ(receive_seq(5, 0), LORA_LINK_RX_NEW);       // 44 atrás: origem reiniciada
+    CHECK_EQ(source()->resyncs, 1);
+    CHECK_EQ(source()->lost, 0);
+    CHECK_EQ(receive_seq(6, 0), LORA_LINK_RX_NEW);
+    CHECK_EQ(source()->lost, 0);
+}
+
+/* Transmissor reiniciado no meio da contagem, com o receptor de pé: as
+   perdas são só as reais, antes e depois */
+static void test_transmitter_reboot(void) {
+    setup();
+    for (int i = 0; i < 40; i++) {
+        send_next(i % 10 != 9);                          // perde um a cada dez
+    }
+    CHECK_EQ(source()->lost, 3);                         // 9, 19, 29 (39 ainda não apareceu)
+
+    for (int boot = 0; boot < 3; boot++) {
+        lora_link_init(&tx, ADDR_TX);                    // reinício: sequência volta a 0
+        tx.tx_seq = (uint8_t)(boot * 70 + 13);           // ou começa em qualquer ponto
+        for (int i = 0; i < 20; i++) {
+            CHECK_EQ(send_next(true), LORA_LINK_RX_NEW);
+        }
+    }
+    CHECK_EQ(source()->lost, 3);
+    CHECK_EQ(source()->resyncs, 3);
+    CHECK_EQ(source()->duplicates, 0);
+}
+
+int main(void) {
+    RUN(test_loss_and_reorder);
+    RUN(test_sync_resets);
+    RUN(test_resync_without_flag);
+    RUN(test_transmitter_reboot);
+    return 0;
+}
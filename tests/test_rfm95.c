@@ -0,0 +1,836 @@
+// test_rfm95.c - Caminhos do driver do RFM95 sobre o SX1276 simulado
+#include <string.h>
+#include "test.h"
+#include "rfm95_lora.h"
+#include "ssd1306.h"
+#include "sim/sx1276_sim.h"
+#include "sim/ssd1306_sim.h"
+
+#define MODE_SLEEP          0x00
+#define MODE_STDBY          0x01
+#define MODE_TX             0x03
+#define MODE_RX_CONTINUOUS  0x05
+#define REG_PA_CONFIG       0x09
+
+// Segundo módulo (rfm95_radio(1)): no spi0 com a instância padrão ou no spi1
+#define B_CS   40
+#define B_RST  41
+#define B_DIO0 42
+#define B_DIO1 43
+
+static sx1276_sim_t sim;
+
+// Último pacote posto no ar pelo simulador
+static uint8_t air_data[256];
+static uint8_t air_length;
+static uint64_t air_time_us;
+static uint32_t air_count;
+
+static uint32_t tx_done;
+
+static void tx_hook(void* ctx, sx1276_sim_t* radio, const uint8_t* data, uint8_t length, uint64_t airtime_us) {
+    (void)ctx;
+    (void)radio;
+    memcpy(air_data, data, length);
+    air_length = length;
+    air_time_us = airtime_us;
+    air_count++;
+}
+
+static void on_tx_done(void) {
+    tx_done++;
+}
+
+static void setup(const lora_config_t* config) {
+    hal_host_reset();
+    sx1276_sim_init(&sim, SPI_PORT, PIN_CS, PIN_RST, PIN_DIO0, PIN_DIO1);
+    sx1276_sim_set_tx_hook(&sim, tx_hook, NULL);
+    air_count = 0;
+    tx_done = 0;
+    CHECK(config ? lora_init_config(config) : lora_init());
+}
+
+static void test_init_standby(void) {
+    setup(NULL);
+    CHECK_EQ(sx1276_sim_mode(&sim), MODE_STDBY);
+    CHECK_EQ(lora_spi_baudrate(), LORA_DEFAULT_SPI_BAUDRATE);
+    CHECK_EQ(sx1276_sim_frf(&sim), (uint32_t)((uint64_t)LORA_FREQUENCY_HZ * 524288 / 32000000));
+}
+
+/* O envio bloqueante só retorna depois do TxDone, um tempo no ar depois */
+static void test_send_blocking(void) {
+    setup(NULL);
+    lora_set_tx_callback(on_tx_done);
+    uint64_t start = hal_time_us();
+    lora_send_packet((const uint8_t*)"hello", 5);
+    CHECK_EQ(air_count, 1);
+    CHECK_EQ(air_length, 5);
+    CHECK(memcmp(air_data, "hello", 5) == 0);
+    CHECK_EQ(tx_done, 1);
+    CHECK(hal_time_us() - start >= air_time_us);
+    CHECK_EQ(air_time_us, sx1276_sim_airtime_us(&sim, 5));
+    CHECK(!lora_tx_busy());
+}
+
+/* Quadros longos (FIFO por DMA e por cópia) chegam inteiros ao ar */
+static void test_send_async_long(void) {
+    uint8_t frame[LORA_MAX_PACKET_SIZE];
+    for (int i = 0; i < LORA_MAX_PACKET_SIZE; i++) {
+        frame[i] = (uint8_t)(i * 7 + 3);
+    }
+    for (int dma = 0; dma < 2; dma++) {
+        lora_config_t config = LORA_CONFIG_DEFAULT;
+        config.fifo_dma = dma;
+        setup(&config);
+        CHECK(lora_send_packet_async(frame, sizeof(frame)));
+        CHECK(lora_tx_busy());
+        CHECK(!lora_send_packet_async(frame, 1));        // o anterior ainda está no ar
+        while (lora_tx_busy()) {
+            hal_yield();
+        }
+        CHECK_EQ(air_count, 1);
+        CHECK_EQ(air_length, LORA_MAX_PACKET_SIZE);
+        CHECK(memcmp(air_data, frame, sizeof(frame)) == 0);
+        CHECK_EQ(sx1276_sim_mode(&sim), MODE_STDBY);
+    }
+}
+
+/* A fila copia os quadros: o buffer do chamador pode mudar logo depois */
+static void test_tx_queue_order(void) {
+    setup(NULL);
+    uint8_t frame[20];
+    for (uint8_t i = 0; i < 3; i++) {
+        memset(frame, 'a' + i, sizeof(frame));
+        CHECK(lora_tx_enqueue(frame, sizeof(frame), LORA_PRIO_NORMAL));
+    }
+    memset(frame, 'z', sizeof(frame));
+    CHECK(lora_tx_enqueue(frame, 1, LORA_PRIO_HIGH));   // passa à frente dos que esperam
+    CHECK_EQ(lora_tx_queue_length(), 3);
+
+    char order[5] = { (char)air_data[0] };             // o primeiro saiu na hora
+    for (uint32_t n = 1; n < 4; n++) {
+        while (air_count == n) {
+            hal_yield();
+        }
+        order[n] = (char)air_data[0];
+    }
+    while (lora_tx_busy()) {
+        hal_yield();
+    }
+    CHECK(strcmp(order, "azbc") == 0);
+    CHECK_EQ(lora_tx_queue_counters()->sent, 4);
+    CHECK_EQ(lora_tx_queue_length(), 0);
+}
+
+/* RxDone por interrupção: pacote no pool com RSSI, SNR e instante; CRC
+   inválido não chega à aplicação */
+static void test_receive_irq(void) {
+    setup(NULL);
+    lora_receive_irq_start(NULL);
+    CHECK_EQ(sx1276_sim_mode(&sim), MODE_RX_CONTINUOUS);
+    CHECK(lora_receive_irq_lease() == NULL);
+
+    CHECK(sx1276_sim_deliver(&sim, (const uint8_t*)"abc", 3, 30000, -80, 7.5f, true));
+    hal_host_advance_us(29999);
+    CHECK(lora_receive_irq_lease() == NULL);
+    hal_host_advance_us(1);
+    lora_packet_t* packet = lora_receive_irq_lease();
+    CHECK(packet != NULL);
+    CHECK_EQ(packet->length, 3);
+    CHECK(memcmp(packet->data, "abc", 3) == 0);
+    CHECK_EQ(packet->rssi, -80);
+    CHECK(packet->snr == 7.5f);
+    CHECK_EQ(packet->radio, 0);
+    lora_receive_irq_release(packet);
+
+    CHECK(sx1276_sim_deliver(&sim, (const uint8_t*)"bad", 3, 1000, -80, 1.0f, false));
+    hal_host_advance_us(1000);
+    CHECK(lora_receive_irq_lease() == NULL);
+    CHECK_EQ(lora_receive_irq_counters()->crc_errors, 1);
+    CHECK_EQ(lora_receive_irq_counters()->received, 1);
+}
+
+static uint64_t rx_callback_us;
+
+static void on_rx(const lora_packet_t* packet) {
+    (void)packet;
+    rx_callback_us = hal_time_us();
+}
+
+/* Caminho da latência: o pacote chega à aplicação no próprio RxDone, e sem
+   pacote no ar a recepção por interrupção não gera tráfego SPI. O polling a
+   cada 10 ms de antes atrasa o pacote e lê o rádio o tempo todo */
+static void test_receive_irq_latency(void) {
+    setup(NULL);
+    lora_receive_irq_start(on_rx);
+    hal_host_stats_reset();
+    test_run_for_us(1000000);
+    CHECK_EQ(hal_host_stats()->spi_transactions, 0);
+
+    uint64_t airtime_us = sx1276_sim_airtime_us(&sim, 16);
+    uint8_t payload[16] = { 0 };
+    uint64_t rx_done_us = hal_time_us() + airtime_us;
+    rx_callback_us = 0;
+    CHECK(sx1276_sim_deliver(&sim, payload, sizeof(payload), airtime_us, -80, 5.0f, true));
+    while (rx_callback_us == 0) {
+        hal_yield();
+    }
+    lora_packet_t* packet = lora_receive_irq_lease();
+    CHECK(packet != NULL);
+    CHECK_EQ(packet->timestamp_us, rx_done_us);
+    CHECK(rx_callback_us - rx_done_us < 100);          // só a leitura da FIFO
+    lora_receive_irq_release(packet);
+
+    // Referência: polling com hal_sleep_ms(10) entre as leituras
+    setup(NULL);
+    uint8_t buffer[32];
+    lora_receive_packet(buffer, sizeof(buffer));
+    hal_sleep_ms(3);                                   // fora de fase com o pacote
+    rx_done_us = hal_time_us() + airtime_us;
+    CHECK(sx1276_sim_deliver(&sim, payload, sizeof(payload), airtime_us, -80, 5.0f, true));
+    hal_host_stats_reset();
+    while (lora_receive_packet(buffer, sizeof(buffer)) == 0) {
+        hal_sleep_ms(10);
+    }
+    CHECK(hal_time_us() - rx_done_us >= 1000);
+    CHECK(hal_host_stats()->spi_transactions > airtime_us / 10000);
+}
+
+/* Custo SPI de um pacote: o que lora_spi_counters() atribui ao último envio e
+   à última recepção é o que passou pelo barramento */
+static void test_spi_per_packet(void) {
+    setup(NULL);
+    const lora_spi_counters_t* c = lora_spi_counters();
+    uint32_t total = c->total;
+    hal_host_stats_reset();
+    CHECK(lora_send_packet_async((const uint8_t*)"hello", 5));
+    // Ponteiro da FIFO, dados, tamanho, DIO0 e TX (já em standby, no canal base)
+    CHECK_EQ(c->last_tx_packet, 5);
+    CHECK_EQ(hal_host_stats()->spi_transactions, c->last_tx_packet);
+    CHECK_EQ(c->total - total, c->last_tx_packet);
+    while (lora_tx_busy()) {
+        hal_yield();
+    }
+
+    // RxDone por interrupção: flags e metadados numa rajada, ponteiro da FIFO,
+    // dados e limpeza das flags
+    lora_receive_irq_start(NULL);
+    hal_host_stats_reset();
+    CHECK(sx1276_sim_deliver(&sim, (const uint8_t*)"abcdefgh", 8, 5000, -80, 5.0f, true));
+    hal_host_advance_us(5000);
+    lora_packet_t* packet = lora_receive_irq_lease();
+    CHECK(packet != NULL);
+    lora_receive_irq_release(packet);
+    CHECK_EQ(c->last_rx_packet, 4);
+    CHECK_EQ(hal_host_stats()->spi_transactions, c->last_rx_packet);
+
+    // Saindo de RX o envio passa por standby, e antes procura um RxDone
+    // pendente (uma leitura fora do custo do pacote)
+    hal_host_stats_reset();
+    CHECK(lora_send_packet_async((const uint8_t*)"hello", 5));
+    CHECK_EQ(c->last_tx_packet, 6);
+    CHECK_EQ(hal_host_stats()->spi_transactions, c->last_tx_packet + 1);
+    while (lora_tx_busy()) {
+        hal_yield();
+    }
+    lora_receive_irq_stop();
+}
+
+/* Pool cheio: os pacotes excedentes são contados e os emprestados ficam intactos */
+static void test_receive_pool_exhausted(void) {
+    setup(NULL);
+    lora_receive_irq_start(NULL);
+    lora_packet_t* held = NULL;
+    for (int i = 0; i < LORA_RX_POOL_SIZE + 2; i++) {
+        uint8_t byte = (uint8_t)i;
+        CHECK(sx1276_sim_deliver(&sim, &byte, 1, 1000, -70, 5.0f, true));
+        hal_host_advance_us(1000);
+        if (i == 0) {
+            held = lora_receive_irq_lease();
+            CHECK(held != NULL);
+        }
+    }
+    CHECK_EQ(lora_receive_irq_counters()->exhausted, 2);
+    CHECK_EQ(lora_receive_irq_counters()->high_water, LORA_RX_POOL_SIZE);
+    CHECK_EQ(held->data[0], 0);
+    lora_receive_irq_release(held);
+    for (int i = 1; i < LORA_RX_POOL_SIZE; i++) {
+        lora_packet_t* packet = lora_receive_irq_lease();
+        CHECK(packet != NULL);
+        CHECK_EQ(packet->data[0], i);                    // em ordem de chegada
+        lora_receive_irq_release(packet);
+    }
+    CHECK(lora_receive_irq_lease() == NULL);
+}
+
+/* Depois do TxDone com a recepção por interrupção ativa o rádio volta a escutar */
+static void test_tx_resumes_rx(void) {
+    setup(NULL);
+    lora_receive_irq_start(NULL);
+    CHECK(lora_send_packet_async((const uint8_t*)"x", 1));
+    CHECK_EQ(sx1276_sim_mode(&sim), MODE_TX);
+    while (lora_tx_busy()) {
+        hal_yield();
+    }
+    CHECK_EQ(sx1276_sim_mode(&sim), MODE_RX_CONTINUOUS);
+    CHECK(sx1276_sim_deliver(&sim, (const uint8_t*)"y", 1, 1000, -70, 5.0f, true));
+    hal_host_advance_us(1000);
+    lora_packet_t* packet = lora_receive_irq_lease();
+    CHECK(packet != NULL && packet->data[0] == 'y');
+    lora_receive_irq_release(packet);
+}
+
+/* Recepção por polling */
+static void test_receive_polling(void) {
+    setup(NULL);
+    uint8_t buffer[16];
+    CHECK_EQ(lora_receive_packet(buffer, sizeof(buffer)), 0);  // entra em RX
+    CHECK_EQ(sx1276_sim_mode(&sim), MODE_RX_CONTINUOUS);
+    CHECK(sx1276_sim_deliver(&sim, (const uint8_t*)"poll", 4, 2000, -90, -2.25f, true));
+    hal_host_advance_us(2000);
+    CHECK_EQ(lora_receive_packet(buffer, sizeof(buffer)), 4);
+    CHECK(memcmp(buffer, "poll", 4) == 0);
+    CHECK_EQ(lora_packet_rssi(), -90);
+    CHECK(lora_packet_snr() == -2.25f);
+}
+
+/* Polling durante um envio (com e sem LBT) não tira o rádio de TX/CAD: o
+   envio termina e o polling volta a funcionar depois */
+static void test_receive_polling_during_tx(void) {
+    setup(NULL);
+    uint8_t buffer[16];
+    for (int lbt = 0; lbt < 2; lbt++) {
+        lora_lbt_config_t config = LORA_LBT_CONFIG_DEFAULT;
+        CHECK(lora_set_lbt(lbt ? &config : NULL));
+        if (lbt) {
+            sx1276_sim_set_channel_activity(&sim, hal_time_us() + 50000);   // força esperas
+        }
+        air_count = 0;
+        CHECK(lora_send_packet_async((const uint8_t*)"tx", 2));
+        uint32_t polls = 0;
+        while (lora_tx_busy()) {
+            uint8_t mode = sx1276_sim_mode(&sim);
+            CHECK_EQ(lora_receive_packet(buffer, sizeof(buffer)), 0);
+            CHECK_EQ(sx1276_sim_mode(&sim), mode);
+            polls++;
+            hal_yield();
+        }
+        CHECK(polls > 1);
+        CHECK_EQ(air_count, 1);
+    }
+    CHECK(lora_set_lbt(NULL));
+    lora_send_packet((const uint8_t*)"ok", 2);
+    CHECK_EQ(air_count, 2);
+    CHECK_EQ(lora_receive_packet(buffer, sizeof(buffer)), 0);
+    CHECK_EQ(sx1276_sim_mode(&sim), MODE_RX_CONTINUOUS);
+}
+
+/* O tempo no ar calculado pelo driver é o mesmo que o simulador usa */
+static void test_modem_config(void) {
+    setup(NULL);
+    const lora_modem_config_t configs[] = {
+        LORA_MODEM_SF7_BW125, LORA_MODEM_SF9_BW125, LORA_MODEM_SF12_BW125
+    };
+    for (size_t i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+        CHECK(lora_set_modem_config(&configs[i]) > 0);
+        CHECK_EQ(sx1276_sim_sf(&sim), configs[i].spreading_factor);
+        for (int length = 1; length <= LORA_MAX_PACKET_SIZE; length += 37) {
+            CHECK_EQ(lora_time_on_air_us((uint8_t)length), sx1276_sim_airtime_us(&sim, (uint8_t)length));
+        }
+    }
+    // Com uma transmissão em andamento nada muda
+    CHECK(lora_send_packet_async((const uint8_t*)"x", 1));
+    CHECK_EQ(lora_set_modem_config(&configs[0]), 0);
+    CHECK_EQ(sx1276_sim_sf(&sim), 12);
+    while (lora_tx_busy()) {
+        hal_yield();
+    }
+}
+
+/* CAD direto: canal ocupado dá DETECTED e canal livre FREE; depois dele a
+   recepção por interrupção continua; com o rádio transmitindo, BUSY */
+static void test_cad(void) {
+    setup(NULL);
+    CHECK_EQ(lora_cad(), LORA_CAD_FREE);
+    sx1276_sim_set_channel_activity(&sim, hal_time_us() + 50000);
+    CHECK_EQ(lora_cad(), LORA_CAD_DETECTED);
+    test_run_for_us(50000);
+    lora_receive_irq_start(NULL);
+    CHECK_EQ(lora_cad(), LORA_CAD_FREE);
+    CHECK_EQ(sx1276_sim_mode(&sim), MODE_RX_CONTINUOUS);
+    CHECK_EQ(lora_cad_counters()->cad_runs, 3);
+    CHECK_EQ(lora_cad_counters()->cad_detected, 1);
+    CHECK_EQ(sim.cad_runs, 3);
+
+    CHECK(lora_send_packet_async((const uint8_t*)"x", 1));
+    CHECK_EQ(lora_cad(), LORA_CAD_BUSY);
+    CHECK_EQ(sim.cad_runs, 3);
+    while (lora_tx_busy()) {
+        hal_yield();
+    }
+    lora_receive_irq_stop();
+}
+
+static uint64_t air_us;
+
+static void tx_hook_timed(void* ctx, sx1276_sim_t* radio, const uint8_t* data, uint8_t length, uint64_t airtime_us) {
+    air_us = hal_time_us();
+    tx_hook(ctx, radio, data, length, airtime_us);
+}
+
+/* LBT com o canal ocupado por 35 ms: cada CAD que detecta sorteia uma espera
+   e o quadro sai no primeiro CAD livre; esgotadas as tentativas ele sai
+   assim mesmo; com o LBT desligado sai na hora */
+static void test_lbt(void) {
+    setup(NULL);
+    sx1276_sim_set_tx_hook(&sim, tx_hook_timed, NULL);
+    lora_lbt_config_t config = { 5, 10000, 20000 };
+    CHECK(lora_set_lbt(&config));
+    uint64_t busy_until = hal_time_us() + 35000;
+    sx1276_sim_set_channel_activity(&sim, busy_until);
+    uint64_t start = hal_time_us();
+    CHECK(lora_send_packet_async((const uint8_t*)"lbt", 3));
+    CHECK_EQ(air_count, 0);
+    while (lora_tx_busy()) {
+        hal_yield();
+    }
+    const lora_cad_counters_t* c = lora_cad_counters();
+    CHECK_EQ(air_count, 1);
+    CHECK(air_us >= busy_until);
+    // A semente do sorteio muda a cada execução: no máximo uma espera e dois
+    // CADs (1,5 símbolo cada) além da ocupação
+    CHECK(air_us - start <= 35000 + 20000 + 4 * sx1276_sim_symbol_us(&sim));
+    CHECK(c->lbt_backoffs >= 2 && c->lbt_backoffs <= 4);
+    CHECK_EQ(c->cad_detected, c->lbt_backoffs);
+    CHECK_EQ(c->cad_runs, c->lbt_backoffs + 1);
+    CHECK_EQ(c->lbt_fallbacks, 0);
+
+    // Canal ocupado além de max_attempts CADs
+    uint32_t backoffs = c->lbt_backoffs;
+    config.max_attempts = 3;
+    CHECK(lora_set_lbt(&config));
+    busy_until = hal_time_us() + 1000000;
+    sx1276_sim_set_channel_activity(&sim, busy_until);
+    CHECK(lora_send_packet_async((const uint8_t*)"lbt", 3));
+    while (lora_tx_busy()) {
+        hal_yield();
+    }
+    CHECK_EQ(air_count, 2);
+    CHECK(air_us < busy_until);
+    CHECK_EQ(c->lbt_backoffs - backoffs, 2);
+    CHECK_EQ(c->lbt_fallbacks, 1);
+
+    // Desligado: nenhum CAD, o quadro sai com o canal ocupado
+    uint32_t cad_runs = c->cad_runs;
+    CHECK(lora_set_lbt(NULL));
+    uint64_t now = hal_time_us();
+    CHECK(lora_send_packet_async((const uint8_t*)"lbt", 3));
+    CHECK_EQ(air_count, 3);
+    CHECK_EQ(air_us, now);
+    while (lora_tx_busy()) {
+        hal_yield();
+    }
+    CHECK_EQ(c->cad_runs, cad_runs);
+    CHECK_EQ(c->lbt_fallbacks, 1);
+}
+
+/* Recepção em ciclos de CAD: o rádio dorme entre os CADs, um preâmbulo longo
+   (lora_cad_preamble_length()) que começa logo depois de um despertar é
+   pego no seguinte, o pacote chega inteiro e o rádio volta a dormir */
+static void test_cad_cycle_receive(void) {
+    setup(NULL);
+    const uint32_t period_ms = 100;
+    CHECK(lora_receive_cad_start(period_ms, on_rx));
+    uint32_t wakeups = lora_cad_counters()->cycle_wakeups;
+    test_run_for_us(period_ms * 1000 + 2000);             // logo depois de um CAD vazio
+    CHECK_EQ(lora_cad_counters()->cycle_wakeups - wakeups, 1);
+    CHECK_EQ(lora_cad_counters()->cad_detected, 0);
+    CHECK_EQ(sx1276_sim_mode(&sim), MODE_SLEEP);
+
+    lora_modem_config_t tx_modem = *lora_get_modem_config();
+    tx_modem.preamble_length = lora_cad_preamble_length(period_ms);
+    uint8_t payload[12] = "cad cycle";
+    uint32_t airtime = lora_time_on_air_config_us(&tx_modem, sizeof(payload));
+    uint64_t rx_done_us = hal_time_us() + airtime;
+    rx_callback_us = 0;
+    CHECK(!sx1276_sim_deliver(&sim, payload, sizeof(payload), airtime, -95, 2.0f, true));   // dormindo
+    while (rx_callback_us == 0 && hal_time_us() < rx_done_us + 1000) {
+        hal_yield();
+    }
+    CHECK_EQ(rx_callback_us, rx_done_us);
+    lora_packet_t* packet = lora_receive_irq_lease();
+    CHECK(packet != NULL);
+    CHECK(packet->length == sizeof(payload) && memcmp(packet->data, payload, sizeof(payload)) == 0);
+    lora_receive_irq_release(packet);
+
+    const lora_cad_counters_t* c = lora_cad_counters();
+    CHECK_EQ(c->cad_detected, 1);
+    CHECK_EQ(c->cycle_rx_timeouts, 0);
+    CHECK_EQ(sx1276_sim_mode(&sim), MODE_SLEEP);
+    lora_receive_irq_stop();
+}
+
+/* Carga esperada de um relatório com as correntes do perfil (uAh) */
+static double power_charge_uah(const lora_power_report_t* report, const lora_power_profile_t* profile) {
+    double ua_us = 0;
+    for (int mode = 0; mode < LORA_RADIO_MODE_COUNT; mode++) {
+        ua_us += (double)profile->current_ua[mode] * report->mode_us[mode];
+    }
+    return ua_us / 3600e6;
+}
+
+static bool close_to(double value, double expected) {
+    return value >= expected * (1 - 1e-6) && value <= expected * (1 + 1e-6);
+}
+
+/* Relatório de consumo sobre um roteiro conhecido: 1 s de janelas de 16
+   símbolos (o período conta do fim de cada janela) e um envio. No relógio
+   simulado o SPI não gasta tempo, então cada estado tem exatamente o tempo do
+   roteiro e a carga segue as correntes do perfil */
+static void test_power_report(void) {
+    setup(NULL);
+    const uint32_t period_ms = 100;
+    const uint16_t window_symbols = 16;
+    const uint8_t payload[10] = "power";
+    uint64_t window_us = window_symbols * sx1276_sim_symbol_us(&sim);
+    uint64_t airtime = sx1276_sim_airtime_us(&sim, sizeof(payload));
+    lora_power_reset();
+    uint64_t start = hal_time_us();
+    uint32_t wakeups = lora_cad_counters()->cycle_wakeups;
+    CHECK(lora_receive_window_start(period_ms, window_symbols, NULL));
+    test_run_for_us(1000000);
+    uint32_t windows = lora_cad_counters()->cycle_wakeups - wakeups;
+    CHECK_EQ(windows, 1000000 / (period_ms * 1000 + window_us));
+    lora_receive_irq_stop();
+    uint64_t listen_us = hal_time_us() - start;
+    lora_send_packet(payload, sizeof(payload));
+
+    lora_power_report_t report;
+    lora_power_report(&report);
+    CHECK_EQ(report.elapsed_us, hal_time_us() - start);
+    CHECK_EQ(report.mode_us[LORA_RADIO_RX], windows * window_us);
+    CHECK_EQ(report.mode_us[LORA_RADIO_TX], airtime);
+    CHECK_EQ(report.mode_us[LORA_RADIO_SLEEP], listen_us - windows * window_us);
+    CHECK_EQ(report.mode_us[LORA_RADIO_STANDBY], 0);
+    uint64_t total = 0;
+    for (int mode = 0; mode < LORA_RADIO_MODE_COUNT; mode++) {
+        total += report.mode_us[mode];
+    }
+    CHECK_EQ(total, report.elapsed_us);
+
+    const lora_power_profile_t rfm95 = LORA_POWER_PROFILE_RFM95;
+    CHECK(close_to(report.charge_uah, power_charge_uah(&report, &rfm95)));
+    CHECK(close_to(report.average_ua, report.charge_uah * 3600e6 / report.elapsed_us));
+
+    // Outro perfil vale para o tempo já contado: só o TX consome, 120 mA
+    const lora_power_profile_t tx_only = { { 0.0f, 0.0f, 120000.0f, 0.0f } };
+    lora_power_set_profile(&tx_only);
+    lora_power_report(&report);
+    CHECK(close_to(report.charge_uah, 120000.0 * airtime / 3600e6));
+    CHECK(close_to(report.average_ua, 120000.0 * airtime / report.elapsed_us));
+
+    // Depois do reset a contagem recomeça, no estado atual (standby)
+    lora_power_reset();
+    test_run_for_us(5000);
+    lora_power_report(&report);
+    CHECK_EQ(report.elapsed_us, 5000);
+    CHECK_EQ(report.mode_us[LORA_RADIO_STANDBY], 5000);
+    CHECK(report.charge_uah == 0);
+}
+
+static void set_flag(void* ctx) {
+    *(volatile bool*)ctx = true;
+}
+
+// O display simulado mostra o buffer de desenho
+static bool display_matches(ssd1306_sim_t* display, const ssd1306_t* ssd) {
+    for (uint8_t y = 0; y < ssd->height; y++) {
+        for (uint8_t x = 0; x < ssd->width; x++) {
+            bool expected = (ssd->ram_buffer[1 + (y / 8) * ssd->width + x] >> (y % 8)) & 1;
+            if (ssd1306_sim_pixel(display, x, y) != expected) return false;
+        }
+    }
+    return true;
+}
+
+/* Laço de baixo consumo como o de lora_tx.c, com janelas de recepção e o
+   display enviando por DMA (um envio em dois adiado pela interrupção): o sono
+   profundo nunca acontece com um DMA em andamento, as janelas abrem no
+   período e cada envio do display termina no tempo de barramento, sem
+   esperar o próximo alarme */
+static void test_wait_for_event_schedule(void) {
+    setup(NULL);
+    ssd1306_sim_t display_sim;
+    ssd1306_sim_init(&display_sim, i2c1, 0x3C);
+    ssd1306_t ssd;
+    ssd1306_init(&ssd, 128, 64, false, 0x3C, i2c1);
+    ssd1306_config(&ssd);
+    CHECK(ssd1306_enable_double_buffer(&ssd));
+    ssd1306_flush_async(&ssd);                          // tela inteira antes de medir
+    while (ssd1306_busy(&ssd)) {
+        hal_yield();
+    }
+    CHECK(lora_receive_window_start(100, 16, NULL));
+    hal_host_stats_reset();
+    uint32_t wakeups = lora_cad_counters()->cycle_wakeups;
+
+    volatile bool draw_due = false;
+    uint32_t frames = 0;
+    uint64_t flush_start = 0;
+    uint64_t flush_max_us = 0;
+    uint64_t start = hal_time_us();
+    hal_alarm_start(30000, set_flag, (void*)&draw_due);
+    while (hal_time_us() - start < 1050000 || ssd.busy) {
+        if (draw_due && !ssd.busy) {
+            draw_due = false;
+            char text[8] = "F:";
+            text[2] = (char)('0' + frames % 10);
+            text[3] = 0;
+            ssd1306_draw_string(&ssd, text, 5, 32, false);   // uma página
+            ssd1306_flush_async(&ssd);
+            if (frames % 2 == 1) {
+                hal_host_i2c_dma_refuse(1);              // dados adiados para ssd1306_busy()
+            }
+            flush_start = hal_time_us();
+            frames++;
+            if (hal_time_us() - start < 900000) {
+                hal_alarm_start(70000, set_flag, (void*)&draw_due);
+            }
+        }
+
+        bool display_busy = ssd1306_busy(&ssd);
+        if (flush_start && !display_busy) {
+            uint64_t elapsed = hal_time_us() - flush_start;
+            if (elapsed > flush_max_us) flush_max_us = elapsed;
+            flush_start = 0;
+        }
+        uint32_t irq_state = hal_irq_save();
+        if (!draw_due && !display_busy) {
+            lora_wait_for_event();
+        }
+        hal_irq_restore(irq_state);
+        if (display_busy) {
+            hal_yield();                                 // o laço gira até o DMA terminar
+        }
+    }
+
+    // Sem a consulta ao display, a HAL dorme sem cortar os clocks e o fim do
+    // DMA (não o próximo alarme) acorda o núcleo
+    ssd1306_draw_string(&ssd, "OK", 5, 32, false);
+    ssd1306_flush_async(&ssd);
+    uint64_t before = hal_time_us();
+    uint32_t irq_state = hal_irq_save();
+    lora_wait_for_event();
+    hal_irq_restore(irq_state);
+    CHECK(hal_time_us() - before < 1000);                // janela de comando: 4 bytes
+    CHECK_EQ(hal_host_stats()->light_sleeps, 1);
+    while (ssd1306_busy(&ssd)) {
+        hal_yield();
+    }
+    lora_receive_irq_stop();
+
+    CHECK_EQ(frames, 14);
+    CHECK(display_matches(&display_sim, &ssd));
+    CHECK(flush_max_us < 5000);                          // 129 bytes a 400 kHz: ~3 ms
+    CHECK_EQ(lora_cad_counters()->cycle_wakeups - wakeups, 10);
+    CHECK(hal_host_stats()->deep_sleeps > 0);
+}
+
+static sx1276_sim_t sim_b;
+static rfm95_t* radio_b;
+static uint8_t air_b_data[256];
+static uint32_t air_b_count;
+static uint64_t air_start_us;                            // instante em que o módulo 0 entrou em TX
+
+static void tx_hook_b(void* ctx, sx1276_sim_t* radio, const uint8_t* data, uint8_t length, uint64_t airtime_us) {
+    (void)ctx;
+    (void)radio;
+    (void)airtime_us;
+    memcpy(air_b_data, data, length);
+    air_b_count++;
+}
+
+static void tx_hook_stamped(void* ctx, sx1276_sim_t* radio, const uint8_t* data, uint8_t length,
+                            uint64_t airtime_us) {
+    air_start_us = hal_time_us();
+    tx_hook(ctx, radio, data, length, airtime_us);
+}
+
+// Conta os dois CS em nível baixo ao mesmo tempo e repassa a borda ao simulador
+static hal_host_device_t cs_monitor;
+static bool cs_low[2];
+static uint32_t cs_overlaps;
+
+static void cs_changed(void* ctx, uint pin, bool level) {
+    (void)ctx;
+    int i = pin == B_CS;
+    cs_low[i] = !level;
+    if (cs_low[0] && cs_low[1]) {
+        cs_overlaps++;
+    }
+    sx1276_sim_t* target = i ? &sim_b : &sim;
+    target->dev.pin_changed(target->dev.ctx, pin, level);
+}
+
+/* Instância padrão como em setup() e o segundo módulo no barramento spi */
+static void setup_two(hal_spi_t* spi) {
+    // Os pinos da instância padrão são recusados, e o rádio 1 da rodada
+    // anterior deixa o barramento antes de setup() configurar o spi0 de novo
+    CHECK(!rfm95_init(rfm95_radio(1), NULL, NULL));
+    setup(NULL);
+    sx1276_sim_init(&sim_b, spi, B_CS, B_RST, B_DIO0, B_DIO1);
+    sx1276_sim_set_tx_hook(&sim_b, tx_hook_b, NULL);
+    memset(&cs_monitor, 0, sizeof(cs_monitor));
+    cs_monitor.pin_changed = cs_changed;
+    hal_host_bind_pin(PIN_CS, &cs_monitor);
+    hal_host_bind_pin(B_CS, &cs_monitor);
+    memset(cs_low, 0, sizeof(cs_low));
+    cs_overlaps = 0;
+    air_b_count = 0;
+
+    rfm95_pins_t pins = RFM95_PINS_DEFAULT;
+    pins.spi = spi;
+    pins.cs = B_CS;
+    pins.rst = B_RST;
+    pins.dio0 = B_DIO0;
+    pins.dio1 = B_DIO1;
+    radio_b = rfm95_radio(1);
+    CHECK(rfm95_init(radio_b, &pins, NULL));
+    CHECK_EQ(sx1276_sim_mode(&sim_b), MODE_STDBY);
+}
+
+/* Dois módulos, no mesmo SPI (CS diferentes) ou em barramentos separados, em
+   SFs diferentes: cada um transmite e recebe sem mexer no outro */
+static void test_two_radios_independent(void) {
+    const lora_modem_config_t sf7 = LORA_MODEM_SF7_BW125;
+    const lora_modem_config_t sf9 = LORA_MODEM_SF9_BW125;
+    hal_spi_t* const buses[] = { spi0, spi1 };
+    for (int b = 0; b < 2; b++) {
+        setup_two(buses[b]);
+        CHECK(lora_set_modem_config(&sf7) > 0);
+        CHECK(rfm95_set_modem_config(radio_b, &sf9) > 0);
+        CHECK_EQ(sx1276_sim_sf(&sim), 7);
+        CHECK_EQ(sx1276_sim_sf(&sim_b), 9);
+        CHECK_EQ(rfm95_time_on_air_us(radio_b, 20), sx1276_sim_airtime_us(&sim_b, 20));
+        CHECK(rfm95_time_on_air_us(radio_b, 20) > lora_time_on_air_us(20));
+
+        // O módulo 0 transmite em SF7 enquanto o 1 recebe em SF9
+        rfm95_receive_irq_start(radio_b, NULL);
+        uint8_t frame[20];
+        for (uint8_t i = 0; i < 3; i++) {
+            memset(frame, 'a' + i, sizeof(frame));
+            CHECK(lora_tx_enqueue(frame, sizeof(frame), LORA_PRIO_NORMAL));
+        }
+        uint64_t airtime_b = sx1276_sim_airtime_us(&sim_b, 4);
+        CHECK(sx1276_sim_deliver(&sim_b, (const uint8_t*)"sf9!", 4, airtime_b, -85, 3.0f, true));
+        while (lora_tx_busy() || lora_tx_queue_length() > 0) {
+            hal_yield();
+        }
+        test_run_for_us(airtime_b);
+        CHECK_EQ(air_count, 3);
+        CHECK_EQ(air_data[0], 'c');
+        CHECK_EQ(air_time_us, sx1276_sim_airtime_us(&sim, sizeof(frame)));
+        lora_packet_t* packet = rfm95_receive_irq_lease(radio_b);
+        CHECK(packet != NULL);
+        CHECK_EQ(packet->radio, 1);
+        CHECK(packet->length == 4 && memcmp(packet->data, "sf9!", 4) == 0);
+        rfm95_receive_irq_release(radio_b, packet);
+        CHECK(lora_receive_irq_lease() == NULL);
+        CHECK_EQ(sx1276_sim_mode(&sim_b), MODE_RX_CONTINUOUS);
+        CHECK_EQ(air_b_count, 0);
+
+        // E o contrário: o 1 transmite e volta a escutar, o 0 recebe
+        lora_receive_irq_start(NULL);
+        uint64_t airtime = sx1276_sim_airtime_us(&sim, 3);
+        CHECK(sx1276_sim_deliver(&sim, (const uint8_t*)"sf7", 3, airtime, -70, 8.0f, true));
+        rfm95_send_packet(radio_b, (const uint8_t*)"b", 1);
+        CHECK_EQ(air_b_count, 1);
+        CHECK_EQ(air_b_data[0], 'b');
+        CHECK_EQ(sx1276_sim_mode(&sim_b), MODE_RX_CONTINUOUS);
+        test_run_for_us(airtime);
+        packet = lora_receive_irq_lease();
+        CHECK(packet != NULL);
+        CHECK_EQ(packet->radio, 0);
+        CHECK(packet->length == 3 && memcmp(packet->data, "sf7", 3) == 0);
+        lora_receive_irq_release(packet);
+        CHECK_EQ(air_count, 3);
+        lora_receive_irq_stop();
+        rfm95_receive_irq_stop(radio_b);
+    }
+}
+
+/* DMA da FIFO do módulo 0 em andamento: no mesmo SPI a chamada do módulo 1
+   espera o fim do DMA e o RxDone dele é atendido depois, sem dois CS em
+   nível baixo; em barramentos separados nenhum espera o outro */
+static void test_two_radios_bus_arbitration(void) {
+    uint8_t frame[LORA_MAX_PACKET_SIZE];
+    for (int i = 0; i < LORA_MAX_PACKET_SIZE; i++) {
+        frame[i] = (uint8_t)(i * 13 + 1);
+    }
+    hal_spi_t* const buses[] = { spi0, spi1 };
+    for (int b = 0; b < 2; b++) {
+        bool shared = buses[b] == spi0;
+        setup_two(buses[b]);
+        sx1276_sim_set_tx_hook(&sim, tx_hook_stamped, NULL);
+        rfm95_receive_irq_start(radio_b, NULL);
+
+        // RxDone do módulo 1 no meio do DMA de 255 bytes (~200 us a 10 MHz)
+        uint64_t rx_done_us = hal_time_us() + 1000;
+        CHECK(sx1276_sim_deliver(&sim_b, (const uint8_t*)"rx", 2, 1000, -80, 5.0f, true));
+        hal_host_advance_us(950);
+        air_start_us = 0;
+        CHECK(lora_send_packet_async(frame, sizeof(frame)));
+        CHECK_EQ(air_count, 0);                          // a FIFO ainda está sendo escrita
+        uint64_t call_us = hal_time_us();
+        rfm95_set_power(radio_b, 10);
+        CHECK_EQ(sim_b.regs[REG_PA_CONFIG], 0x80 | 8);
+        if (shared) {
+            CHECK(air_start_us != 0 && hal_time_us() >= air_start_us);   // esperou o DMA
+        } else {
+            CHECK_EQ(hal_time_us(), call_us);
+            CHECK_EQ(air_count, 0);
+        }
+        while (lora_tx_busy()) {
+            hal_yield();
+        }
+
+        CHECK_EQ(air_count, 1);
+        CHECK(air_length == sizeof(frame) && memcmp(air_data, frame, sizeof(frame)) == 0);
+        lora_packet_t* packet = rfm95_receive_irq_lease(radio_b);
+        CHECK(packet != NULL);
+        CHECK(packet->length == 2 && memcmp(packet->data, "rx", 2) == 0);
+        if (shared) {
+            CHECK_EQ(packet->timestamp_us, air_start_us);  // atendido no fim do DMA
+            CHECK_EQ(cs_overlaps, 0);
+        } else {
+            CHECK_EQ(packet->timestamp_us, rx_done_us);
+            CHECK(packet->timestamp_us < air_start_us);
+            CHECK(cs_overlaps > 0);                      // o spi1 seguiu durante o DMA do spi0
+        }
+        rfm95_receive_irq_release(radio_b, packet);
+        rfm95_receive_irq_stop(radio_b);
+    }
+}
+
+int main(void) {
+    RUN(test_init_standby);
+    RUN(test_send_blocking);
+    RUN(test_send_async_long);
+    RUN(test_tx_queue_order);
+    RUN(test_receive_irq);
+    RUN(test_receive_irq_latency);
+    RUN(test_spi_per_packet);
+    RUN(test_receive_pool_exhausted);
+    RUN(test_tx_resumes_rx);
+    RUN(test_receive_polling);
+    RUN(test_receive_polling_during_tx);
+    RUN(test_modem_config);
+    RUN(test_cad);
+    RUN(test_lbt);
+    RUN(test_cad_cycle_receive);
+    RUN(test_power_report);
+    RUN(test_wait_for_event_schedule);
+    RUN(test_two_radios_independent);
+    RUN(test_two_radios_bus_arbitration);
+    return 0;
+}
@@ -0,0 +1,412 @@
+// test_ssd1306.c - Primitivas por byte x referência pixel a pixel (bit a bit)
+#include <string.h>
+#include "test.h"
+#include "ssd1306.h"
+#include "ssd1306_reference.h"
+#include "ssd1306_glyphs.h"
+#include "sim/ssd1306_sim.h"
+
+#define DISP_ADDR 0x3C
+
+// O mesmo desenho aplicado a um buffer com as primitivas de ssd1306.c e a
+// outro com as de referência
+typedef struct {
+    ssd1306_t fast;
+    ssd1306_t ref;
+} pair_t;
+
+static void pair_init(pair_t* pair, uint8_t width, uint8_t height) {
+    ssd1306_init(&pair->fast, width, height, false, DISP_ADDR, i2c1);
+    ssd1306_init(&pair->ref, width, height, false, DISP_ADDR, i2c1);
+}
+
+static void pair_free(pair_t* pair) {
+    free(pair->fast.ram_buffer);
+    free(pair->ref.ram_buffer);
+}
+
+/* Imagem e regiões alteradas idênticas? (a GDDRAM recebe o mesmo conteúdo
+   e ssd1306_send_dirty() as mesmas janelas) */
+static void check_same(const pair_t* pair) {
+    CHECK(memcmp(pair->fast.ram_buffer + 1, pair->ref.ram_buffer + 1, pair->fast.bufsize - 1) == 0);
+    for (uint8_t p = 0; p < pair->fast.pages; p++) {
+        CHECK_EQ(pair->fast.dirty_x0[p], pair->ref.dirty_x0[p]);
+        CHECK_EQ(pair->fast.dirty_x1[p], pair->ref.dirty_x1[p]);
+    }
+}
+
+// Começa uma comparação com o buffer limpo e sem regiões alteradas
+static void pair_reset(pair_t* pair, bool value) {
+    ssd1306_fill(&pair->fast, value);
+    ssd1306_ref_fill(&pair->ref, value);
+    for (uint8_t p = 0; p < SSD1306_MAX_PAGES; p++) {
+        pair->fast.dirty_x0[p] = pair->ref.dirty_x0[p] = 0xFF;
+        pair->fast.dirty_x1[p] = pair->ref.dirty_x1[p] = 0;
+    }
+}
+
+static uint32_t random_state = 1;
+
+static uint32_t next_random(uint32_t range) {
+    random_state = random_state * 1664525u + 1013904223u;
+    return (random_state >> 8) % range;
+}
+
+static void test_fill(void) {
+    pair_t pair;
+    pair_init(&pair, 128, 64);
+    check_same(&pair);                       // depois do init tudo está marcado
+    for (int i = 0; i < 4; i++) {
+        ssd1306_fill(&pair.fast, i & 1);
+        ssd1306_ref_fill(&pair.ref, i & 1);
+        check_same(&pair);
+    }
+    // Preencher com o mesmo valor não marca nada
+    pair_reset(&pair, true);
+    ssd1306_fill(&pair.fast, true);
+    ssd1306_ref_fill(&pair.ref, true);
+    check_same(&pair);
+    CHECK(pair.fast.dirty_x0[0] > pair.fast.dirty_x1[0]);
+    pair_free(&pair);
+}
+
+/* Todas as linhas de uma coluna/linha: começos e fins dentro da página, nas
+   bordas de página e fora da tela */
+static void test_lines(void) {
+    pair_t pair;
+    pair_init(&pair, 128, 64);
+    for (int value = 0; value < 2; value++) {
+        for (int a = 0; a < 80; a += 3) {
+            for (int b = 0; b < 80; b += 5) {
+                pair_reset(&pair, !value);
+                ssd1306_vline(&pair.fast, 17, a, b, value);
+                ssd1306_ref_vline(&pair.ref, 17, a, b, value);
+                ssd1306_vline(&pair.fast, 127, a, b, value);
+                ssd1306_ref_vline(&pair.ref, 127, a, b, value);
+                check_same(&pair);
+
+                pair_reset(&pair, !value);
+                ssd1306_hline(&pair.fast, a + 60, b + 60, a % 64, value);
+                ssd1306_ref_hline(&pair.ref, a + 60, b + 60, a % 64, value);
+                check_same(&pair);
+            }
+        }
+    }
+    pair_free(&pair);
+}
+
+/* Retângulos de todos os tamanhos até passar da tela, vazios e cheios, sobre
+   fundo claro, escuro e listrado */
+static void test_rect(void) {
+    pair_t pair;
+    pair_init(&pair, 128, 64);
+    for (int background = 0; background < 3; background++) {
+        for (int w = 0; w <= 40; w += 3) {
+            for (int h = 0; h <= 40; h += 3) {
+                for (int fill = 0; fill < 2; fill++) {
+                    uint8_t top = (uint8_t)((w * 7 + h) % 70);
+                    uint8_t left = (uint8_t)((h * 11 + w) % 140);
+                    pair_reset(&pair, background == 1);
+                    if (background == 2) {
+                        for (uint8_t y = 0; y < 64; y += 3) {
+                            ssd1306_hline(&pair.fast, 0, 127, y, true);
+                            ssd1306_ref_hline(&pair.ref, 0, 127, y, true);
+                        }
+                    }
+                    ssd1306_rect(&pair.fast, top, left, w, h, fill ^ (w & 1), fill);
+                    ssd1306_ref_rect(&pair.ref, top, left, w, h, fill ^ (w & 1), fill);
+                    check_same(&pair);
+                }
+            }
+        }
+    }
+    pair_free(&pair);
+}
+
+/* Todos os caracteres em todas as posições, inclusive as que saem da tela e
+   as que dão a volta nos 8 bits */
+static void test_text(void) {
+    pair_t pair;
+    pair_init(&pair, 128, 64);
+    for (int small = 0; small < 2; small++) {
+        for (int c = 1; c < 128; c++) {
+            for (int y = 0; y < 256; y += 7) {
+                pair_reset(&pair, (c + y) & 1);
+                for (int x = 0; x < 256; x += 9) {
+                    ssd1306_draw_char(&pair.fast, (char)c, x, y, small);
+                    ssd1306_ref_draw_char(&pair.ref, (char)c, x, y, small);
+                }
+                check_same(&pair);
+            }
+        }
+    }
+    // Quebra de linha automática e fim da tela
+    const char* text = "RSSI:-87 SNR:9.5 Perdidos:12 100% a/b>c! 0123456789 Ola #42";
+    for (int x = 0; x < 128; x += 5) {
+        for (int y = 0; y < 64; y += 3) {
+            pair_reset(&pair, false);
+            ssd1306_draw_string(&pair.fast, text, x, y, x & 1);
+            ssd1306_ref_draw_string(&pair.ref, text, x, y, x & 1);
+            check_same(&pair);
+        }
+    }
+    pair_free(&pair);
+}
+
+/* A tabela gerada (ssd1306_glyphs.h) é font[] desenhado pela referência:
+   cada caractere em y = 0 ocupa os 8 primeiros bytes da página 0 */
+static void test_glyph_table(void) {
+    pair_t pair;
+    pair_init(&pair, 128, 64);
+    for (int c = 0; c < 128; c++) {
+        pair_reset(&pair, false);
+        ssd1306_ref_draw_char(&pair.ref, (char)c, 0, 0, false);
+        uint8_t glyph = ssd1306_glyph_lookup[c];
+        if (glyph == SSD1306_GLYPH_NONE) {
+            CHECK(pair.ref.dirty_x0[0] > pair.ref.dirty_x1[0]);      // nada desenhado
+            continue;
+        }
+        CHECK(glyph < SSD1306_GLYPH_COUNT);
+        CHECK(memcmp(&pair.ref.ram_buffer[1], ssd1306_glyph_columns[glyph], 8) == 0);
+    }
+    pair_free(&pair);
+}
+
+/* Sequências aleatórias de todas as primitivas sobre o mesmo buffer, em
+   telas de alturas diferentes */
+static void test_random_ops(void) {
+    static const uint8_t geometries[][2] = { { 128, 64 }, { 128, 32 }, { 64, 48 } };
+    static const char charset[] = "0123456789ABCXYZabcxyz:.>-!%/ #\x7f";
+    for (size_t g = 0; g < sizeof(geometries) / sizeof(geometries[0]); g++) {
+        pair_t pair;
+        pair_init(&pair, geometries[g][0], geometries[g][1]);
+        for (int i = 0; i < 20000; i++) {
+            bool value = next_random(2);
+            switch (next_random(7)) {
+                case 0: {
+                    uint8_t x = next_random(256), y = next_random(256);
+                    ssd1306_pixel(&pair.fast, x, y, value);
+                    ssd1306_ref_pixel(&pair.ref, x, y, value);
+                    break;
+                }
+                case 1: {
+                    uint8_t x0 = next_random(160), x1 = next_random(160), y = next_random(80);
+                    ssd1306_hline(&pair.fast, x0, x1, y, value);
+                    ssd1306_ref_hline(&pair.ref, x0, x1, y, value);
+                    break;
+                }
+                case 2: {
+                    uint8_t x = next_random(160), y0 = next_random(80), y1 = next_random(80);
+                    ssd1306_vline(&pair.fast, x, y0, y1, value);
+                    ssd1306_ref_vline(&pair.ref, x, y0, y1, value);
+                    break;
+                }
+                case 3: {
+                    uint8_t top = next_random(80), left = next_random(150);
+                    uint8_t w = next_random(100), h = next_random(80);
+                    bool fill = next_random(2);
+                    ssd1306_rect(&pair.fast, top, left, w, h, value, fill);
+                    ssd1306_ref_rect(&pair.ref, top, left, w, h, value, fill);
+                    break;
+                }
+                case 4: {
+                    char c = charset[next_random(sizeof(charset) - 1)];
+                    uint8_t x = next_random(256), y = next_random(256);
+                    ssd1306_draw_char(&pair.fast, c, x, y, value);
+                    ssd1306_ref_draw_char(&pair.ref, c, x, y, value);
+                    break;
+                }
+                case 5: {
+                    char text[12];
+                    uint32_t length = next_random(sizeof(text));
+                    for (uint32_t k = 0; k < length; k++) {
+                        text[k] = charset[next_random(sizeof(charset) - 1)];
+                    }
+                    text[length] = '\0';
+                    uint8_t x = next_random(geometries[g][0]), y = next_random(geometries[g][1]);
+                    ssd1306_draw_string(&pair.fast, text, x, y, value);
+                    ssd1306_ref_draw_string(&pair.ref, text, x, y, value);
+                    break;
+                }
+                default:
+                    if (next_random(50) == 0) {
+                        ssd1306_fill(&pair.fast, value);
+                        ssd1306_ref_fill(&pair.ref, value);
+                    }
+                    break;
+            }
+            check_same(&pair);
+            // Limpa as regiões alteradas de vez em quando, como um envio faria
+            if (next_random(8) == 0) {
+                for (uint8_t p = 0; p < SSD1306_MAX_PAGES; p++) {
+                    pair.fast.dirty_x0[p] = pair.ref.dirty_x0[p] = 0xFF;
+                    pair.fast.dirty_x1[p] = pair.ref.dirty_x1[p] = 0;
+                }
+            }
+        }
+        pair_free(&pair);
+    }
+}
+
+/* Imagem de referência da tela do receptor no display simulado: o que chega
+   à GDDRAM pelos envios parciais é o quadro desenhado pixel a pixel */
+static void test_golden_screen(void) {
+    hal_host_reset();
+    ssd1306_sim_t sim;
+    ssd1306_sim_init(&sim, i2c1, DISP_ADDR);
+    pair_t pair;
+    pair_init(&pair, 128, 64);
+    ssd1306_config(&pair.fast);
+
+    for (int n = 0; n < 20; n++) {
+        char line[32];
+        ssd1306_fill(&pair.fast, false);
+        ssd1306_ref_fill(&pair.ref, false);
+        snprintf(line, sizeof(line), "Ola #%d", n * 37);
+        ssd1306_draw_string(&pair.fast, line, 5, 10, false);
+        ssd1306_ref_draw_string(&pair.ref, line, 5, 10, false);
+        snprintf(line, sizeof(line), "RSSI:%d SNR:%.1f", -60 - n, 9.5 - n);
+        ssd1306_draw_string(&pair.fast, line, 5, 30, false);
+        ssd1306_ref_draw_string(&pair.ref, line, 5, 30, false);
+        ssd1306_rect(&pair.fast, 0, 0, 128, 64, true, false);
+        ssd1306_ref_rect(&pair.ref, 0, 0, 128, 64, true, false);
+        ssd1306_hline(&pair.fast, 2, 2 + n * 6, 58, true);
+        ssd1306_ref_hline(&pair.ref, 2, 2 + n * 6, 58, true);
+        check_same(&pair);
+
+        ssd1306_send_dirty(&pair.fast);
+        for (uint8_t y = 0; y < 64; y++) {
+            for (uint8_t x = 0; x < 128; x++) {
+                bool expected = (pair.ref.ram_buffer[1 + (y / 8) * 128 + x] >> (y % 8)) & 1;
+                CHECK_EQ(ssd1306_sim_pixel(&sim, x, y), expected);
+            }
+        }
+        for (uint8_t p = 0; p < SSD1306_MAX_PAGES; p++) {
+            pair.ref.dirty_x0[p] = 0xFF;
+            pair.ref.dirty_x1[p] = 0;
+        }
+    }
+    pair_free(&pair);
+}
+
+/* A GDDRAM simulada é igual ao buffer? */
+static bool display_matches(const ssd1306_sim_t* sim, const ssd1306_t* ssd) {
+    for (uint8_t y = 0; y < ssd->height; y++) {
+        for (uint8_t x = 0; x < ssd->width; x++) {
+            bool expected = (ssd->ram_buffer[1 + (y / 8) * ssd->width + x] >> (y % 8)) & 1;
+            if (ssd1306_sim_pixel(sim, x, y) != expected) return false;
+        }
+    }
+    return true;
+}
+
+/* Sem DMA livre para os dados quando a janela termina, a interrupção não
+   escreve nada: o envio é retomado por DMA na consulta a ssd1306_busy() e, com
+   o DMA ainda ocupado, segue adiado para a consulta seguinte, sem bloquear */
+static void test_flush_async_deferred(void) {
+    for (uint32_t refusals = 1; refusals <= 3; refusals++) {
+        hal_host_reset();
+        ssd1306_sim_t sim;
+        ssd1306_sim_init(&sim, i2c1, DISP_ADDR);
+        ssd1306_t ssd;
+        ssd1306_init(&ssd, 128, 64, false, DISP_ADDR, i2c1);
+        ssd1306_config(&ssd);
+        CHECK(ssd1306_enable_double_buffer(&ssd));
+        ssd1306_draw_string(&ssd, "RSSI:-87", 5, 30, false);
+
+        hal_host_stats_reset();
+        ssd1306_flush_async(&ssd);
+        hal_host_i2c_dma_refuse(refusals);
+        test_run_for_us(5000);                  // a janela termina e a interrupção roda
+        CHECK_EQ(hal_host_stats()->i2c_transactions, 1);
+        CHECK_EQ(hal_host_stats()->i2c_bytes, sizeof(ssd.window_cmd));
+        CHECK(ssd.busy);
+
+        for (uint32_t i = 1; i < refusals; i++) {
+            CHECK(ssd1306_busy(&ssd));          // DMA ainda ocupado: nada escrito
+            CHECK(ssd.deferred);
+            CHECK_EQ(hal_host_stats()->i2c_transactions, 1);
+        }
+        CHECK(ssd1306_busy(&ssd));              // dados por DMA a partir da consulta
+        CHECK(!ssd.deferred);
+        while (ssd1306_busy(&ssd)) {
+            hal_yield();
+        }
+        CHECK_EQ(hal_host_stats()->i2c_transactions, 2);
+        CHECK_EQ(hal_host_stats()->i2c_bytes, sizeof(ssd.window_cmd) + 128 * 8 + 1);
+        CHECK(display_matches(&sim, &ssd));
+
+        // O quadro seguinte sai normalmente
+        ssd1306_draw_string(&ssd, "SNR:9.5", 5, 50, false);
+        ssd1306_flush_async(&ssd);
+        while (ssd1306_busy(&ssd)) {
+            hal_yield();
+        }
+        CHECK(display_matches(&sim, &ssd));
+        free(ssd.ram_buffer);
+        free(ssd.front_buffer);
+    }
+}
+
+/* ssd1306_send_dirty() leva ao display só os bytes que mudaram: nada sem
+   alterações, uma janela pequena para um pixel e, para a tela do receptor,
+   menos que o envio completo, com a GDDRAM sempre igual ao buffer */
+static void test_send_dirty(void) {
+    hal_host_reset();
+    ssd1306_sim_t sim;
+    ssd1306_sim_init(&sim, i2c1, DISP_ADDR);
+    ssd1306_t ssd;
+    ssd1306_init(&ssd, 128, 64, false, DISP_ADDR, i2c1);
+    ssd1306_config(&ssd);
+    ssd1306_fill(&ssd, false);
+    ssd1306_send_data(&ssd);
+    CHECK(display_matches(&sim, &ssd));
+    uint32_t full_bytes = sim.data_bytes;
+
+    // Sem alterações, nada no barramento
+    hal_host_stats_reset();
+    ssd1306_send_dirty(&ssd);
+    CHECK_EQ(hal_host_stats()->i2c_bytes, 0);
+
+    // Um pixel com o valor que já tinha não marca nada
+    ssd1306_pixel(&ssd, 10, 20, false);
+    CHECK_EQ(ssd.dirty_x0[2], 0xFF);
+
+    // Um pixel: uma coluna de uma página
+    ssd1306_pixel(&ssd, 10, 20, true);
+    CHECK_EQ(ssd.dirty_x0[2], 10);
+    CHECK_EQ(ssd.dirty_x1[2], 10);
+    uint32_t before = sim.data_bytes;
+    ssd1306_send_dirty(&ssd);
+    CHECK_EQ(sim.data_bytes - before, 1);
+    CHECK(display_matches(&sim, &ssd));
+    CHECK_EQ(ssd.dirty_x0[2], 0xFF);
+
+    // Redesenhos da tela do receptor
+    for (int n = 0; n < 20; n++) {
+        char line[32];
+        ssd1306_fill(&ssd, false);
+        snprintf(line, sizeof(line), "Ola #%d", n * 37);
+        ssd1306_draw_string(&ssd, line, 5, 10, false);
+        snprintf(line, sizeof(line), "RSSI:%d SNR:%.1f", -60 - n, 9.5 - n);
+        ssd1306_draw_string(&ssd, line, 5, 30, false);
+        before = sim.data_bytes;
+        ssd1306_send_dirty(&ssd);
+        CHECK(sim.data_bytes - before < full_bytes);
+        CHECK(display_matches(&sim, &ssd));
+    }
+    free(ssd.ram_buffer);
+}
+
+int main(void) {
+    RUN(test_fill);
+    RUN(test_lines);
+    RUN(test_rect);
+    RUN(test_text);
+    RUN(test_glyph_table);
+    RUN(test_random_ops);
+    RUN(test_golden_screen);
+    RUN(test_flush_async_deferred);
+    RUN(test_send_dirty);
+    return 0;
+}
@@ -0,0 +1,140 @@
+// test_stats.c - Estatísticas do driver (compilado com LORA_STATS=1)
+#include <string.h>
+#include "test.h"
+#include "rfm95_lora.h"
+#include "sim/sx1276_sim.h"
+
+static sx1276_sim_t sim;
+static uint64_t reset_us;
+
+static void setup(void) {
+    hal_host_reset();
+    sx1276_sim_init(&sim, SPI_PORT, PIN_CS, PIN_RST, PIN_DIO0, PIN_DIO1);
+    CHECK(lora_init());
+    lora_stats_reset();
+    hal_host_stats_reset();
+    reset_us = hal_time_us();
+}
+
+static void receive(const char* text, int rssi, float snr, bool corrupt) {
+    uint8_t length = (uint8_t)strlen(text);
+    uint64_t airtime = sx1276_sim_airtime_us(&sim, length);
+    CHECK(sx1276_sim_deliver(&sim, (const uint8_t*)text, length, airtime, rssi, snr, true));
+    if (corrupt) {
+        test_run_for_us(airtime / 2);
+        sx1276_sim_corrupt(&sim);                        // colisão no meio do pacote
+    }
+    test_run_for_us(airtime + 1000);
+    lora_packet_t* packet;
+    while ((packet = lora_receive_irq_lease()) != NULL) {
+        lora_receive_irq_release(packet);
+    }
+}
+
+static uint64_t mode_total(const lora_stats_t* stats) {
+    uint64_t total = 0;
+    for (int i = 0; i < LORA_RADIO_MODE_COUNT; i++) {
+        total += stats->mode_us[i];
+    }
+    return total;
+}
+
+/* Pacotes válidos, erros de CRC, extremos e médias de RSSI/SNR, TxDone e
+   tráfego SPI igual ao visto pelo barramento simulado */
+static void test_counters(void) {
+    setup();
+    lora_stats_t stats;
+    CHECK(lora_stats_snapshot(&stats));
+    CHECK_EQ(stats.rx_packets, 0);
+    CHECK_EQ(stats.rssi_min, 0);                         // sem pacotes, sem extremos
+    CHECK_EQ(stats.rssi_max, 0);
+
+    lora_receive_irq_start(NULL);
+    receive("forte", -60, 9.5f, false);
+    receive("fraco", -100, -3.25f, false);
+    receive("colidiu", -70, 5.0f, true);
+    receive("medio", -80, 2.75f, false);
+    lora_send_packet((const uint8_t*)"tx", 2);
+
+    CHECK(lora_stats_snapshot(&stats));
+    CHECK_EQ(stats.rx_packets, 3);
+    CHECK_EQ(stats.crc_errors, 1);
+    CHECK_EQ(stats.tx_packets, 1);
+    CHECK_EQ(stats.rx_packets, lora_receive_irq_counters()->received);
+    CHECK_EQ(stats.crc_errors, lora_receive_irq_counters()->crc_errors);
+    CHECK_EQ(stats.rssi_min, -100);
+    CHECK_EQ(stats.rssi_max, -60);
+    CHECK(stats.rssi_avg == -80.0f);
+    CHECK(stats.snr_min == -3.25f);
+    CHECK(stats.snr_max == 9.5f);
+    CHECK(stats.snr_avg == 3.0f);
+    CHECK_EQ(stats.spi_transactions, hal_host_stats()->spi_transactions);
+    CHECK(stats.spi_bytes > 0);
+    CHECK(stats.isr_cycles_max > 0);
+    uint32_t isr_count = 0;
+    for (int i = 0; i < LORA_STATS_HIST_BUCKETS; i++) {
+        isr_count += stats.isr_cycles[i];
+    }
+    CHECK(isr_count >= 5);                               // 4 RxDone e 1 TxDone
+    lora_receive_irq_stop();
+}
+
+/* O tempo por estado soma o tempo decorrido, com o estado atual contado até a
+   hora do snapshot; sem atividade dois snapshots só diferem nesse tempo */
+static void test_snapshot_consistency(void) {
+    setup();
+    lora_receive_irq_start(NULL);
+    receive("rx", -90, 1.0f, false);
+    lora_send_packet((const uint8_t*)"tx", 2);
+    test_run_for_us(250000);
+
+    lora_stats_t first;
+    lora_stats_t second;
+    CHECK(lora_stats_snapshot(&first));
+    CHECK_EQ(mode_total(&first), hal_time_us() - reset_us);
+    CHECK(first.mode_us[LORA_RADIO_TX] >= sx1276_sim_airtime_us(&sim, 2));
+    CHECK(first.mode_us[LORA_RADIO_RX] > 250000);
+
+    test_run_for_us(100000);                             // ainda em RX, sem pacotes
+    CHECK(lora_stats_snapshot(&second));
+    CHECK_EQ(mode_total(&second), hal_time_us() - reset_us);
+    CHECK_EQ(second.mode_us[LORA_RADIO_RX] - first.mode_us[LORA_RADIO_RX], 100000);
+    second.mode_us[LORA_RADIO_RX] = first.mode_us[LORA_RADIO_RX];
+    CHECK(memcmp(&first, &second, sizeof(first)) == 0);
+    lora_receive_irq_stop();
+}
+
+/* lora_stats_reset() zera os contadores e extremos; o tempo do estado atual
+   volta a contar de agora */
+static void test_reset(void) {
+    setup();
+    lora_receive_irq_start(NULL);
+    receive("antes", -50, 10.0f, false);
+    receive("ruim", -50, 10.0f, true);
+    lora_stats_reset();
+    uint64_t since = hal_time_us();
+
+    lora_stats_t stats;
+    CHECK(lora_stats_snapshot(&stats));
+    CHECK_EQ(stats.rx_packets, 0);
+    CHECK_EQ(stats.crc_errors, 0);
+    CHECK_EQ(stats.spi_transactions, 0);
+    CHECK_EQ(stats.isr_cycles_max, 0);
+    CHECK_EQ(mode_total(&stats), 0);
+
+    receive("depois", -110, -5.0f, false);
+    CHECK(lora_stats_snapshot(&stats));
+    CHECK_EQ(stats.rx_packets, 1);
+    CHECK_EQ(stats.rssi_min, -110);
+    CHECK_EQ(stats.rssi_max, -110);                      // os -50 de antes não contam
+    CHECK(stats.snr_max == -5.0f);
+    CHECK_EQ(mode_total(&stats), hal_time_us() - since);
+    lora_receive_irq_stop();
+}
+
+int main(void) {
+    RUN(test_counters);
+    RUN(test_snapshot_consistency);
+    RUN(test_reset);
+    return 0;
+}
@@ -0,0 +1,95 @@
+// gen_glyphs.c - Gera lib/ssd1306_glyphs.h a partir de font[] (lib/font.h)
+//
+// Os glifos ficam no formato da GDDRAM do SSD1306: um byte por coluna, bit 0
+// na linha de cima. Os símbolos que font.h guarda por linha são transpostos.
+// A tabela gerada é static const e fica na flash; o header está no
+// repositório, então o build do Pico não depende desta ferramenta.
+//
+// Uso (build host): cmake --build <dir> --target ssd1306_glyphs
+//        ou: gen_glyphs [arquivo]   (sem arquivo, escreve na saída padrão)
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "font.h"
+
+#define GLYPH_COUNT 72
+#define GLYPH_NONE  0xFF
+
+// Símbolos guardados por linha em font[] (linha i, bit j → coluna 7 - j)
+static const struct { char c; uint8_t glyph; const char* name; } symbols[] = {
+    { ':', 64, ":" }, { '.', 65, "." }, { '>', 66, ">" }, { '-', 67, "-" },
+    { '!', 69, "!" }, { '%', 70, "%" }, { '/', 71, "/" },
+};
+
+static uint8_t columns[GLYPH_COUNT][8];
+static uint8_t lookup[128];
+static const char* names[GLYPH_COUNT];
+
+static void build(void) {
+    static char letters[GLYPH_COUNT][2];
+    memset(lookup, GLYPH_NONE, sizeof(lookup));
+    for (char c = '0'; c <= '9'; ++c) lookup[(uint8_t)c] = c - '0' + 1;
+    for (char c = 'A'; c <= 'Z'; ++c) lookup[(uint8_t)c] = c - 'A' + 11;
+    for (char c = 'a'; c <= 'z'; ++c) lookup[(uint8_t)c] = c - 'a' + 37;
+    lookup[127] = 68;                                    // Símbolo Ohm
+    for (int c = 0; c < 128; ++c) {
+        if (lookup[c] != GLYPH_NONE) {
+            letters[lookup[c]][0] = (char)c;
+            names[lookup[c]] = letters[lookup[c]];
+        }
+    }
+    names[68] = "Ohm";
+
+    for (uint8_t g = 0; g < GLYPH_COUNT; ++g) {
+        memcpy(columns[g], &font[g * 8], 8);
+    }
+    for (size_t k = 0; k < sizeof(symbols) / sizeof(symbols[0]); ++k) {
+        uint8_t g = symbols[k].glyph;
+        lookup[(uint8_t)symbols[k].c] = g;
+        names[g] = symbols[k].name;
+        memset(columns[g], 0, 8);
+        for (uint8_t i = 0; i < 8; ++i) {
+            uint8_t line = font[g * 8 + i];
+            for (uint8_t j = 0; j < 8; ++j) {
+                columns[g][7 - j] |= ((line >> j) & 0x01) << i;
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && !freopen(argv[1], "w", stdout)) {
+        perror(argv[1]);
+        return 1;
+    }
+    build();
+    printf("// ssd1306_glyphs.h\n");
+    printf("// Gerado por tools/gen_glyphs.c a partir de font.h: não edite à mão.\n");
+    printf("// Regenere com: cmake --build <dir do build host> --target ssd1306_glyphs\n");
+    printf("#ifndef SSD1306_GLYPHS_H\n#define SSD1306_GLYPHS_H\n\n#include <stdint.h>\n\n");
+    printf("#define SSD1306_GLYPH_COUNT %d\n", GLYPH_COUNT);
+    printf("#define SSD1306_GLYPH_NONE  0x%02X\n\n", GLYPH_NONE);
+
+    printf("// Glifos 8x8 no formato da GDDRAM: um byte por coluna, bit 0 na linha de cima\n");
+    printf("static const uint8_t ssd1306_glyph_columns[SSD1306_GLYPH_COUNT][8] = {\n");
+    for (int g = 0; g < GLYPH_COUNT; ++g) {
+        printf("    {");
+        for (int i = 0; i < 8; ++i) {
+            printf(" 0x%02X%s", columns[g][i], i < 7 ? "," : "");
+        }
+        printf(" },%s%s\n", names[g] ? " // " : "", names[g] ? names[g] : "");
+    }
+    printf("};\n\n");
+
+    printf("// Caractere → glifo (SSD1306_GLYPH_NONE: não suportado)\n");
+    printf("static const uint8_t ssd1306_glyph_lookup[128] = {\n");
+    for (int c = 0; c < 128; c += 16) {
+        printf("   ");
+        for (int i = c; i < c + 16; ++i) {
+            printf(" 0x%02X,", lookup[i]);
+        }
+        printf("\n");
+    }
+    printf("};\n\n#endif // SSD1306_GLYPHS_H\n");
+    return 0;
+}